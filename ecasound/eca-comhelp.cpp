@@ -1,6 +1,7 @@
 // ------------------------------------------------------------------------
 // ecasound.cpp: Console mode user interface to ecasound.
 // Copyright (C) 2000,2009 Kai Vehmanen
+// Copyright (C) 2026 agent
 //
 // Attributes:
 //     eca-style-version: 3 (see Ecasound Programmer's Guide)
@@ -40,6 +41,7 @@ static const char* ecasound_parameter_help_rep =
 "     --no-server              disable the daemon mode (default)\n"
 "     --osc-udp-port=NNN       listen for OSC messages on UDP port NNN\n"
 "     --keep-running (or -K)   do not exit from batchmode\n"
+"     --trace=FILE             record a timeline trace, write to FILE at exit\n"
 "     --help (or -h)           show this help\n"
 "     --version                print version info\n"
 " --- \n"
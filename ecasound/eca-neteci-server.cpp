@@ -1,6 +1,7 @@
 // ------------------------------------------------------------------------
 // eca-neteci-server.c: NetECI server implementation.
 // Copyright (C) 2002,2004,2009 Kai Vehmanen
+// Copyright (C) 2026 agent
 //
 // Attributes:
 //     eca-style-version: 3
@@ -42,6 +43,8 @@
 #include <eca-control-mt.h>
 #include <eca-logger.h>
 #include <eca-logger-wellformed.h>
+#include <eca-thread-affinity.h>
+#include <eca-trace-recorder.h>
 
 #include "ecasound.h"
 #include "eca-neteci-server.h"
@@ -94,6 +97,8 @@ ECA_NETECI_SERVER::~ECA_NETECI_SERVER(void)
 void* ECA_NETECI_SERVER::launch_server_thread(void* arg)
 {
   ECA_LOG_MSG(ECA_LOGGER::user_objects, "Server thread started");
+  ECA_THREAD_AFFINITY::apply("neteci");
+  ECA_TRACE_RECORDER::set_thread_name("neteci");
 
   ECA_NETECI_SERVER* self = 
     reinterpret_cast<ECA_NETECI_SERVER*>(arg);
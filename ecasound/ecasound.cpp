@@ -1,6 +1,7 @@
 // ------------------------------------------------------------------------
 // ecasound.cpp: Console mode user interface to ecasound.
 // Copyright (C) 2002-2012 Kai Vehmanen
+// Copyright (C) 2026 agent
 //
 // Attributes:
 //     eca-style-version: 3 (see Ecasound Programmer's Guide)
@@ -43,6 +44,7 @@
 #include <eca-logger.h>
 #include <eca-logger-default.h>
 #include <eca-session.h>
+#include <eca-trace-recorder.h>
 #include <eca-version.h>
 
 #ifdef ECA_USE_LIBLO
@@ -158,6 +160,7 @@ ECASOUND_RUN_STATE::ECASOUND_RUN_STATE(void)
     neteci_tcp_port(2868),
     osc_mode(false),
     osc_udp_port(-1),
+    trace_file(""),
     keep_running_mode(false),
     cerr_output_only_mode(false),
     interactive_mode(false),
@@ -237,6 +240,10 @@ int main(int argc, char *argv[])
   ecasound_parse_command_line(&state, *cline, clineout); 
   delete cline; cline = 0;
 
+  ECA_TRACE_RECORDER::set_thread_name("control");
+  if (state.trace_file.size() > 0)
+    ECA_TRACE_RECORDER::set_enabled(true);
+
   /* 3. create console interface */
   if (state.retval == ECASOUND_RETVAL_SUCCESS) {
 
@@ -313,6 +320,12 @@ int main(int argc, char *argv[])
     }
   }
 
+  /* step: write the trace requested with '--trace' */
+  if (state.trace_file.size() > 0) {
+    if (ECA_TRACE_RECORDER::export_file(state.trace_file) != true)
+      cerr << "ecasound: ERROR: Unable to write trace to \"" << state.trace_file << "\"." << endl;
+  }
+
   state.lock();
   glovar_ecasound_exit_phase = ECASOUND_EXIT_PHASE_WAIT_FOR_WD;
   state.unlock();
@@ -646,6 +659,11 @@ void ecasound_parse_command_line(ECASOUND_RUN_STATE* state,
 
       }
 
+      else if (cline.current().compare(0, 8, "--trace=") == 0) {
+	/* --trace=FILE */
+	state->trace_file = cline.current().substr(8);
+      }
+
       else if (cline.current() == "-h" ||
 	       cline.current() == "--help") {
 	ecasound_print_usage();
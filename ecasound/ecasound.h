@@ -70,6 +70,8 @@ class ECASOUND_RUN_STATE {
   bool osc_mode;
   int osc_udp_port;
 
+  std::string trace_file;
+
   bool keep_running_mode;
   bool cerr_output_only_mode;
   bool interactive_mode;
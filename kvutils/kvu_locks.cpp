@@ -19,6 +19,7 @@
 
 #include <signal.h>         /* ANSI-C: sig_atomic_t */
 #include <pthread.h>        /* POSIX: threading */
+#include <sched.h>          /* POSIX: sched_yield() */
 
 #include "kvu_dbc.h"
 #include "kvu_locks.h"
@@ -69,6 +70,69 @@ void ATOMIC_INTEGER::set(int value)
   value_rep = value;
 }
 
+/* note: the sequence lock relies on full memory barriers,
+ *       which are provided by the gcc __sync builtins */
+
+KVU_SEQLOCK::KVU_SEQLOCK(void)
+  : seq_rep(0)
+{
+}
+
+KVU_SEQLOCK::KVU_SEQLOCK(const KVU_SEQLOCK& v)
+  : seq_rep(0)
+{
+}
+
+KVU_SEQLOCK& KVU_SEQLOCK::operator=(const KVU_SEQLOCK& v)
+{
+  return *this;
+}
+
+KVU_SEQLOCK::~KVU_SEQLOCK(void)
+{
+}
+
+void KVU_SEQLOCK::write_begin(void)
+{
+  DBC_CHECK((seq_rep & 1) == 0);
+  seq_rep = seq_rep + 1;
+  __sync_synchronize();
+}
+
+void KVU_SEQLOCK::write_end(void)
+{
+  __sync_synchronize();
+  seq_rep = seq_rep + 1;
+  DBC_CHECK((seq_rep & 1) == 0);
+}
+
+unsigned int KVU_SEQLOCK::read_begin(void) const
+{
+  unsigned int seq = seq_rep;
+  while(seq & 1) {
+    sched_yield();
+    seq = seq_rep;
+  }
+  __sync_synchronize();
+  return seq;
+}
+
+bool KVU_SEQLOCK::try_read_begin(unsigned int* seq) const
+{
+  unsigned int value = seq_rep;
+  if (value & 1)
+    return false;
+  __sync_synchronize();
+  *seq = value;
+  return true;
+}
+
+bool KVU_SEQLOCK::read_retry(unsigned int seq) const
+{
+  __sync_synchronize();
+  return seq_rep != seq;
+}
+
 KVU_GUARD_LOCK::KVU_GUARD_LOCK(pthread_mutex_t* lock_arg)
 {
   lock_repp = lock_arg;
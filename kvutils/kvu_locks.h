@@ -48,6 +48,65 @@ class ATOMIC_INTEGER {
   ATOMIC_INTEGER(const ATOMIC_INTEGER& v);
 };
 
+/**
+ * Sequence lock for publishing small blocks of data from
+ * a single writer to any number of readers.
+ *
+ * The writer never blocks, which makes it suitable for
+ * real-time threads. Readers copy the protected data
+ * between read_begin() and read_retry(), and redo the copy
+ * if read_retry() returns true. Only one writer thread is
+ * allowed per object.
+ *
+ * Copying a lock object creates a new, unlocked lock, so 
+ * that classes embedding a lock can still be cloned.
+ */
+class KVU_SEQLOCK {
+
+ public:
+
+  /**
+   * Marks the start of a write. Non-blocking.
+   */
+  void write_begin(void);
+
+  /**
+   * Marks the end of a write. Non-blocking.
+   */
+  void write_end(void);
+
+  /**
+   * Marks the start of a read and returns a sequence
+   * number that is to be passed to read_retry().
+   *
+   * Spins until no write is in progress.
+   */
+  unsigned int read_begin(void) const;
+
+  /**
+   * Non-blocking variant of read_begin(). Returns false
+   * if a write is in progress. Otherwise stores the 
+   * sequence number to 'seq' and returns true.
+   */
+  bool try_read_begin(unsigned int* seq) const;
+
+  /**
+   * Returns true if a write was started or completed
+   * after read_begin() returned 'seq', meaning that
+   * the copied data may be inconsistent.
+   */
+  bool read_retry(unsigned int seq) const;
+
+  KVU_SEQLOCK(void);
+  KVU_SEQLOCK(const KVU_SEQLOCK& v);
+  KVU_SEQLOCK& operator=(const KVU_SEQLOCK& v);
+  ~KVU_SEQLOCK(void);
+
+ private:
+
+  volatile unsigned int seq_rep;
+};
+
 /**
  * A simple guarded lock wrapper for pthread_mutex_lock
  * and pthread_mutex_unlock. Lock is acquired 
@@ -0,0 +1,117 @@
+// ------------------------------------------------------------------------
+// kvu_ringbuffer.cpp: Lock-free single-reader/single-writer byte FIFO
+// Copyright (C) 2026 agent
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
+// ------------------------------------------------------------------------
+
+#include <cstring> /* memcpy() */
+
+#include "kvu_dbc.h"
+#include "kvu_ringbuffer.h"
+
+/* note: positions are free-running counters; the
+ *       buffer size is a power of two, so wrap-around 
+ *       of the counters is harmless */
+
+KVU_RINGBUFFER::KVU_RINGBUFFER(size_t size)
+  : write_pos_rep(0),
+    read_pos_rep(0)
+{
+  DBC_REQUIRE(size > 0);
+
+  size_t capacity = 1;
+  while(capacity < size)
+    capacity <<= 1;
+
+  buffer_repp = new char [capacity];
+  mask_rep = capacity - 1;
+}
+
+KVU_RINGBUFFER::~KVU_RINGBUFFER(void)
+{
+  delete[] buffer_repp;
+}
+
+size_t KVU_RINGBUFFER::read_space(void) const
+{
+  size_t w = write_pos_rep;
+  __sync_synchronize();
+  return w - read_pos_rep;
+}
+
+size_t KVU_RINGBUFFER::write_space(void) const
+{
+  size_t r = read_pos_rep;
+  __sync_synchronize();
+  return mask_rep + 1 - (write_pos_rep - r);
+}
+
+bool KVU_RINGBUFFER::write(const void* src, size_t bytes)
+{
+  if (write_space() < bytes)
+    return false;
+
+  size_t pos = write_pos_rep & mask_rep;
+  size_t first = mask_rep + 1 - pos;
+  if (first > bytes) first = bytes;
+
+  std::memcpy(buffer_repp + pos, src, first);
+  std::memcpy(buffer_repp, static_cast<const char*>(src) + first, bytes - first);
+
+  /* note: data must be visible before the new position */
+  __sync_synchronize();
+  write_pos_rep = write_pos_rep + bytes;
+  return true;
+}
+
+void KVU_RINGBUFFER::copy_out(size_t pos, void* dst, size_t bytes) const
+{
+  pos &= mask_rep;
+  size_t first = mask_rep + 1 - pos;
+  if (first > bytes) first = bytes;
+
+  std::memcpy(dst, buffer_repp + pos, first);
+  std::memcpy(static_cast<char*>(dst) + first, buffer_repp, bytes - first);
+}
+
+bool KVU_RINGBUFFER::peek(void* dst, size_t bytes) const
+{
+  if (read_space() < bytes)
+    return false;
+
+  copy_out(read_pos_rep, dst, bytes);
+  return true;
+}
+
+bool KVU_RINGBUFFER::read(void* dst, size_t bytes)
+{
+  if (read_space() < bytes)
+    return false;
+
+  if (dst != 0)
+    copy_out(read_pos_rep, dst, bytes);
+
+  /* note: data must be copied before the space is released */
+  __sync_synchronize();
+  read_pos_rep = read_pos_rep + bytes;
+  return true;
+}
+
+void KVU_RINGBUFFER::reset(void)
+{
+  write_pos_rep = 0;
+  read_pos_rep = 0;
+}
@@ -0,0 +1,107 @@
+// ------------------------------------------------------------------------
+// kvu_ringbuffer.h: Lock-free single-reader/single-writer byte FIFO
+// Copyright (C) 2026 agent
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
+// ------------------------------------------------------------------------
+
+#ifndef INCLUDED_KVU_RINGBUFFER_H
+#define INCLUDED_KVU_RINGBUFFER_H
+
+#include <cstddef>
+
+/**
+ * Lock-free FIFO of bytes, for passing messages from
+ * one writer thread to one reader thread.
+ *
+ * All functions except the constructor and destructor
+ * are non-blocking and do not allocate memory, so
+ * either end can be used from a real-time thread.
+ * Only one thread may write and one thread read
+ * at a time.
+ *
+ * Messages are written with write(), which stores
+ * all of the data or nothing. Variable-size messages
+ * are typically written as a fixed-size header followed
+ * by the payload, and read with peek() and read().
+ */
+class KVU_RINGBUFFER {
+
+ public:
+
+  KVU_RINGBUFFER(size_t size);
+  ~KVU_RINGBUFFER(void);
+
+  /**
+   * Number of bytes that can be read.
+   */
+  size_t read_space(void) const;
+
+  /**
+   * Number of bytes that can be written.
+   */
+  size_t write_space(void) const;
+
+  /**
+   * Total capacity in bytes. At least the size given
+   * to the constructor.
+   */
+  size_t size(void) const { return mask_rep + 1; }
+
+  /**
+   * Writes 'bytes' bytes from 'src'.
+   *
+   * @return false if there is not enough space, in which
+   *         case nothing is written
+   */
+  bool write(const void* src, size_t bytes);
+
+  /**
+   * Copies 'bytes' bytes to 'dst' without removing
+   * them from the FIFO.
+   *
+   * @return false if less than 'bytes' bytes are available
+   */
+  bool peek(void* dst, size_t bytes) const;
+
+  /**
+   * Reads and removes 'bytes' bytes to 'dst'. If 'dst'
+   * is null, the data is only removed.
+   *
+   * @return false if less than 'bytes' bytes are available,
+   *         in which case nothing is read
+   */
+  bool read(void* dst, size_t bytes);
+
+  /**
+   * Discards all data. Must not be called while the
+   * FIFO is in use by other threads.
+   */
+  void reset(void);
+
+ private:
+
+  KVU_RINGBUFFER(const KVU_RINGBUFFER&);
+  KVU_RINGBUFFER& operator=(const KVU_RINGBUFFER&);
+
+  void copy_out(size_t pos, void* dst, size_t bytes) const;
+
+  char* buffer_repp;
+  size_t mask_rep;
+  volatile size_t write_pos_rep;
+  volatile size_t read_pos_rep;
+};
+
+#endif
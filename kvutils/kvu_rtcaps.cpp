@@ -1,6 +1,7 @@
 // ------------------------------------------------------------------------
 // kvu_rtcaps.h: Routines for utilizing POSIX RT extensions.
 // Copyright (C) 2001-2003,2009 Kai Vehmanen
+// Copyright (C) 2026 agent
 //
 // This program is free software; you can redistribute it and/or modify
 // it under the terms of the GNU General Public License as published by
@@ -21,7 +22,9 @@
 #include <config.h>
 #endif
 
+#include <algorithm>
 #include <iostream>
+#include <cstdlib> /* strtol() */
 #include <unistd.h> /* getpid(), _POSIX_MEMLOCK */
 
 #ifdef HAVE_SCHED_H
@@ -32,6 +35,7 @@
 #endif
 #include <pthread.h>
 
+#include "kvu_numtostr.h"
 #include "kvu_rtcaps.h"
 
 static bool kvu_check_for_sched_sub(int policy);
@@ -150,3 +154,124 @@ int kvu_set_thread_scheduling(int policy, int priority)
   
   return ret;
 }
+
+/**
+ * Restricts the calling thread to run only on 'cpus'.
+ *
+ * @param cpus CPU numbers, starting from 0
+ *
+ * @return Zero on success, non-zero on error.
+ */
+int kvu_set_thread_affinity(const std::vector<int>& cpus)
+{
+  int ret = -1;
+
+#if defined(HAVE_PTHREAD_SETAFFINITY_NP) && defined(HAVE_PTHREAD_SELF)
+  cpu_set_t cpuset;
+  CPU_ZERO(&cpuset);
+  for(size_t n = 0; n < cpus.size(); n++) {
+    if (cpus[n] < 0 || cpus[n] >= CPU_SETSIZE)
+      return -1;
+    CPU_SET(cpus[n], &cpuset);
+  }
+  ret = pthread_setaffinity_np(pthread_self(), sizeof(cpuset), &cpuset);
+#else
+  std::cerr << "(libkvutils) kvu_rtcaps: warning! unable to set thread affinity" << std::endl;
+#endif
+
+  return ret;
+}
+
+/**
+ * Stores the CPUs the calling thread is allowed to
+ * run on to 'cpus', in ascending order.
+ *
+ * @return Zero on success, non-zero on error.
+ */
+int kvu_get_thread_affinity(std::vector<int>* cpus)
+{
+  int ret = -1;
+  cpus->clear();
+
+#if defined(HAVE_PTHREAD_GETAFFINITY_NP) && defined(HAVE_PTHREAD_SELF)
+  cpu_set_t cpuset;
+  CPU_ZERO(&cpuset);
+  ret = pthread_getaffinity_np(pthread_self(), sizeof(cpuset), &cpuset);
+  if (ret == 0) {
+    for(int n = 0; n < CPU_SETSIZE; n++) {
+      if (CPU_ISSET(n, &cpuset))
+	cpus->push_back(n);
+    }
+  }
+#endif
+
+  return ret;
+}
+
+/**
+ * Parses a list of CPUs in the format used by Linux
+ * cpusets and taskset(1), for example "0-3,6". 
+ * Result is stored to 'cpus' in ascending order,
+ * without duplicates.
+ *
+ * @return true if 'list' was valid and not empty
+ */
+bool kvu_parse_cpu_list(const std::string& list, std::vector<int>* cpus)
+{
+  cpus->clear();
+
+  const char* p = list.c_str();
+  while(*p != 0) {
+    char* end;
+    long first = std::strtol(p, &end, 10);
+    if (end == p || first < 0) return false;
+    long last = first;
+    p = end;
+    if (*p == '-') {
+      ++p;
+      last = std::strtol(p, &end, 10);
+      if (end == p || last < first) return false;
+      p = end;
+    }
+    if (last > 65535) return false;
+    for(long n = first; n <= last; n++)
+      cpus->push_back(static_cast<int>(n));
+    if (*p == ',') {
+      ++p;
+      if (*p == 0) return false;
+    }
+    else if (*p != 0)
+      return false;
+  }
+
+  std::sort(cpus->begin(), cpus->end());
+  cpus->erase(std::unique(cpus->begin(), cpus->end()), cpus->end());
+
+  return (cpus->size() > 0);
+}
+
+/**
+ * Formats 'cpus' as a list understood by 
+ * kvu_parse_cpu_list(), with consecutive CPUs 
+ * collapsed into ranges.
+ */
+std::string kvu_cpu_list_to_string(const std::vector<int>& cpus)
+{
+  std::vector<int> sorted (cpus);
+  std::sort(sorted.begin(), sorted.end());
+
+  std::string result;
+  size_t n = 0;
+  while(n < sorted.size()) {
+    size_t m = n;
+    while(m + 1 < sorted.size() && sorted[m + 1] <= sorted[m] + 1)
+      ++m;
+    if (result.size() > 0) result += ",";
+    result += kvu_numtostr(sorted[n]);
+    if (sorted[m] != sorted[n])
+      result += "-" + kvu_numtostr(sorted[m]);
+    n = m + 1;
+  }
+
+  return result;
+}
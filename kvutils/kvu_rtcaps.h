@@ -1,9 +1,16 @@
 #ifndef INCLUDED_KVU_RTCAPS_H
 #define INCLUDED_KVU_RTCAPS_H
 
+#include <string>
+#include <vector>
+
 bool kvu_check_for_sched_fifo(void);
 bool kvu_check_for_sched_rr(void);
 bool kvu_check_for_mlockall(void);
 int kvu_set_thread_scheduling(int policy, int priority);
+int kvu_set_thread_affinity(const std::vector<int>& cpus);
+int kvu_get_thread_affinity(std::vector<int>* cpus);
+bool kvu_parse_cpu_list(const std::string& list, std::vector<int>* cpus);
+std::string kvu_cpu_list_to_string(const std::vector<int>& cpus);
 
 #endif /* INCLUDED_KVU_RTCAPS_H */
@@ -1,6 +1,7 @@
 // ------------------------------------------------------------------------
 // libkvutils_tester.cpp: Runs a set of libkvutils unit tests.
 // Copyright (C) 2002-2004,2009 Kai Vehmanen
+// Copyright (C) 2026 agent
 //
 // Attributes:
 //     eca-style-version: 2
@@ -25,17 +26,21 @@
 #endif
 
 #include <string>
+#include <vector>
 
 #include <cstdio>
 #include <cstdlib>
+#include <cstring>
 #include <ctime>
 #include <stddef.h>  /* ANSI-C: size_t */
 #include <stdio.h>   /* for AIX */
 #include <time.h>    /* ANSI-C: clock() */
+#include <sched.h>   /* POSIX: sched_yield() */
 
 #include "kvu_dbc.h"
 #include "kvu_locks.h"
 #include "kvu_numtostr.h"
+#include "kvu_ringbuffer.h"
 #include "kvu_rtcaps.h"
 #include "kvu_timestamp.h"
 #include "kvu_utils.h"
@@ -82,6 +87,9 @@ static int kvu_test_3(void);
 static int kvu_test_4(void);
 static int kvu_test_5_timestamp(void);
 static int kvu_test_6_msgqueue(void);
+static int kvu_test_7_seqlock(void);
+static int kvu_test_8_ringbuffer(void);
+static int kvu_test_9_affinity(void);
 
 static kvu_test_t kvu_funcs[] = { 
   kvu_test_1,  /* kvu_locks.h: ATOMIC_INTEGER */
@@ -90,6 +98,9 @@ static kvu_test_t kvu_funcs[] = {
   kvu_test_4,  /* kvu_value_queue.h */
   kvu_test_5_timestamp, /* kvu_timestamp.h */
   kvu_test_6_msgqueue,  /* kvu_message_queue.h */
+  kvu_test_7_seqlock,   /* kvu_locks.h: KVU_SEQLOCK */
+  kvu_test_8_ringbuffer, /* kvu_ringbuffer.h */
+  kvu_test_9_affinity,   /* kvu_rtcaps.h: CPU affinity */
   NULL 
 };
 
@@ -600,3 +611,229 @@ static void* kvu_test_6_helper(void* ptr)
   /* never reached */
   return 0;
 }
+
+static const int kvu_test_7_iterations_const = 1000000;
+
+struct kvu_test_7_data {
+  KVU_SEQLOCK lock;
+  volatile long int first;
+  volatile long int second;
+  volatile int done;
+};
+
+static void* kvu_test_7_helper(void* ptr);
+
+/**
+ * Tests the KVU_SEQLOCK class implementation. The writer
+ * thread keeps 'first' and 'second' in sync, so any
+ * mismatch seen by the reader is a consistency error.
+ */
+static int kvu_test_7_seqlock(void)
+{
+  ECA_TEST_ENTRY();
+
+  kvu_test_7_data data;
+  data.first = data.second = 0;
+  data.done = 0;
+
+  pthread_t thread;
+  pthread_create(&thread, NULL, kvu_test_7_helper, (void*)&data);
+
+  long int reads = 0, last = 0;
+  while(data.done == 0) {
+    long int first, second;
+    unsigned int seq;
+    if ((reads & 1) == 0) {
+      do {
+	seq = data.lock.read_begin();
+	first = data.first;
+	second = data.second;
+      }
+      while(data.lock.read_retry(seq) == true);
+    }
+    else {
+      /* note: non-blocking reader, skips reads that 
+       *       overlap with a write */
+      if (data.lock.try_read_begin(&seq) != true) 
+	continue;
+      first = data.first;
+      second = data.second;
+      if (data.lock.read_retry(seq) == true) 
+	continue;
+    }
+
+    if (first != -second)
+      ECA_TEST_FAIL(1, "kvu_test_7 inconsistent snapshot");
+    if (first < last)
+      ECA_TEST_FAIL(1, "kvu_test_7 snapshot went backwards");
+    last = first;
+    ++reads;
+  }
+
+  pthread_join(thread, NULL);
+
+  if (data.first != kvu_test_7_iterations_const)
+    ECA_TEST_FAIL(1, "kvu_test_7 writer did not finish");
+
+  ECA_TEST_NOTE(("reads done: " + kvu_numtostr(reads)).c_str());
+
+  ECA_TEST_SUCCESS();
+}
+
+/**
+ * The writer thread.
+ */
+static void* kvu_test_7_helper(void* ptr)
+{
+  kvu_test_7_data *data = static_cast<kvu_test_7_data*>(ptr);
+
+  for(int n = 1; n <= kvu_test_7_iterations_const; n++) {
+    data->lock.write_begin();
+    data->first = n;
+    data->second = -n;
+    data->lock.write_end();
+  }
+
+  data->done = 1;
+
+  return 0;
+}
+
+static const int kvu_test_8_messages_const = 200000;
+
+static void* kvu_test_8_helper(void* ptr);
+
+/**
+ * Tests the KVU_RINGBUFFER class implementation. The 
+ * writer thread sends variable-size messages, each
+ * consisting of a length field and a payload filled
+ * with the message sequence number.
+ */
+static int kvu_test_8_ringbuffer(void)
+{
+  ECA_TEST_ENTRY();
+
+  /* case: basic operations and wrap-around */
+  {
+    KVU_RINGBUFFER ring (10);
+    if (ring.size() != 16 || 
+	ring.write_space() != 16 ||
+	ring.read_space() != 0)
+      ECA_TEST_FAIL(1, "kvu_test_8 initial state");
+
+    char data[16];
+    for(int n = 0; n < 16; n++) data[n] = n;
+    for(int round = 0; round < 10; round++) {
+      if (ring.write(data, 11) != true)
+	ECA_TEST_FAIL(1, "kvu_test_8 write");
+      if (ring.write(data, 6) == true)
+	ECA_TEST_FAIL(1, "kvu_test_8 overfill");
+
+      char out[16];
+      if (ring.peek(out, 2) != true || out[1] != 1 ||
+	  ring.read_space() != 11)
+	ECA_TEST_FAIL(1, "kvu_test_8 peek");
+      if (ring.read(out, 12) == true)
+	ECA_TEST_FAIL(1, "kvu_test_8 underflow");
+      if (ring.read(out, 11) != true || out[0] != 0 || out[10] != 10)
+	ECA_TEST_FAIL(1, "kvu_test_8 read");
+    }
+  }
+
+  /* case: concurrent reader and writer */
+  KVU_RINGBUFFER ring (256);
+  pthread_t thread;
+  pthread_create(&thread, NULL, kvu_test_8_helper, (void*)&ring);
+
+  int expected = 0;
+  while(expected < kvu_test_8_messages_const) {
+    int len;
+    if (ring.peek(&len, sizeof(len)) != true ||
+	ring.read_space() < sizeof(len) + len) {
+      sched_yield();
+      continue;
+    }
+    ring.read(0, sizeof(len));
+
+    unsigned char payload[64];
+    ring.read(payload, len);
+    for(int n = 0; n < len; n++) {
+      if (payload[n] != static_cast<unsigned char>(expected)) {
+	pthread_join(thread, NULL);
+	ECA_TEST_FAIL(1, "kvu_test_8 corrupted message");
+      }
+    }
+    ++expected;
+  }
+
+  pthread_join(thread, NULL);
+
+  if (ring.read_space() != 0)
+    ECA_TEST_FAIL(1, "kvu_test_8 extra data");
+
+  ECA_TEST_SUCCESS();
+}
+
+/**
+ * The writer thread.
+ */
+static void* kvu_test_8_helper(void* ptr)
+{
+  KVU_RINGBUFFER *ring = static_cast<KVU_RINGBUFFER*>(ptr);
+
+  for(int n = 0; n < kvu_test_8_messages_const; n++) {
+    unsigned char msg[sizeof(int) + 64];
+    int len = 1 + n % 60;
+    std::memcpy(msg, &len, sizeof(len));
+    std::memset(msg + sizeof(len), static_cast<unsigned char>(n), len);
+    while(ring->write(msg, sizeof(len) + len) != true)
+      sched_yield();
+  }
+
+  return 0;
+}
+
+/**
+ * Tests CPU list handling and thread affinity.
+ */
+static int kvu_test_9_affinity(void)
+{
+  ECA_TEST_ENTRY();
+
+  vector<int> cpus;
+  if (kvu_parse_cpu_list("0-3,6,2", &cpus) != true ||
+      cpus.size() != 5 || cpus[0] != 0 || cpus[3] != 3 || cpus[4] != 6)
+    ECA_TEST_FAIL(1, "kvu_test_9 kvu_parse_cpu_list (1)");
+
+  if (kvu_cpu_list_to_string(cpus) != "0-3,6")
+    ECA_TEST_FAIL(1, "kvu_test_9 kvu_cpu_list_to_string");
+
+  if (kvu_parse_cpu_list("", &cpus) == true ||
+      kvu_parse_cpu_list("1-", &cpus) == true ||
+      kvu_parse_cpu_list("3-1", &cpus) == true ||
+      kvu_parse_cpu_list("0,", &cpus) == true ||
+      kvu_parse_cpu_list("a", &cpus) == true)
+    ECA_TEST_FAIL(1, "kvu_test_9 kvu_parse_cpu_list (2)");
+
+  /* case: set affinity to the current set, and one 
+   *       CPU of it */
+  vector<int> orig;
+  if (kvu_get_thread_affinity(&orig) != 0) {
+    ECA_TEST_NOTE("Thread affinity not supported, skipping.");
+    ECA_TEST_SUCCESS();
+  }
+  if (orig.size() == 0)
+    ECA_TEST_FAIL(1, "kvu_test_9 kvu_get_thread_affinity");
+
+  if (kvu_set_thread_affinity(vector<int> (1, orig.back())) != 0 ||
+      kvu_get_thread_affinity(&cpus) != 0 ||
+      cpus.size() != 1 || cpus[0] != orig.back())
+    ECA_TEST_FAIL(1, "kvu_test_9 kvu_set_thread_affinity");
+
+  if (kvu_set_thread_affinity(orig) != 0 ||
+      kvu_get_thread_affinity(&cpus) != 0 ||
+      cpus != orig)
+    ECA_TEST_FAIL(1, "kvu_test_9 restoring affinity");
+
+  ECA_TEST_SUCCESS();
+}
@@ -70,6 +70,16 @@ EFFECT_AMPLIFY::~EFFECT_AMPLIFY(void)
 }
 
 void EFFECT_AMPLIFY::set_parameter(int param, parameter_t value)
+{
+  switch (param) {
+  case 1: 
+    gain_rep = value / 100.0;
+    gain_start_rep = gain_rep;
+    break;
+  }
+}
+
+void EFFECT_AMPLIFY::set_parameter_ramp(int param, parameter_t value)
 {
   switch (param) {
   case 1: 
@@ -105,7 +115,13 @@ void EFFECT_AMPLIFY::release(void)
 
 void EFFECT_AMPLIFY::process(void)
 {
-  sbuf_repp->multiply_by(gain_rep);
+  if (gain_start_rep != gain_rep) {
+    sbuf_repp->multiply_by_ramp(gain_start_rep, gain_rep);
+    gain_start_rep = gain_rep;
+  }
+  else {
+    sbuf_repp->multiply_by(gain_rep);
+  }
 }
 
 /**
@@ -113,6 +129,11 @@ void EFFECT_AMPLIFY::process(void)
  */
 void EFFECT_AMPLIFY::process_ref(void)
 {
+  if (gain_start_rep != gain_rep) {
+    process();
+    return;
+  }
+
   i.begin();
   while(!i.end()) {
     *i.current() = *i.current() *  gain_rep;
@@ -137,6 +158,7 @@ void EFFECT_AMPLIFY_DB::set_parameter(int param, parameter_t value)
   switch (param) {
   case 1: 
     gain_rep = EFFECT_AMPLITUDE::db_to_linear(value);
+    gain_start_rep = gain_rep;
     gain_db_rep = value;
     break;
 
@@ -163,6 +185,22 @@ void EFFECT_AMPLIFY_DB::set_parameter(int param, parameter_t value)
   }
 }
 
+/**
+ * Ramps are linear in dB, i.e. exponential in linear gain.
+ */
+void EFFECT_AMPLIFY_DB::set_parameter_ramp(int param, parameter_t value)
+{
+  switch (param) {
+  case 1: 
+    gain_rep = EFFECT_AMPLITUDE::db_to_linear(value);
+    gain_db_rep = value;
+    break;
+
+  default:
+    set_parameter(param, value);
+  }
+}
+
 CHAIN_OPERATOR::parameter_t EFFECT_AMPLIFY_DB::get_parameter(int param) const
 {
   switch (param) {
@@ -195,6 +233,19 @@ void EFFECT_AMPLIFY_DB::release(void)
 
 void EFFECT_AMPLIFY_DB::process(void)
 {
+  if (gain_start_rep != gain_rep) {
+    if (channel_rep > 0 && channel_rep <= channels()) {
+      sbuf_repp->multiply_by_ramp(gain_start_rep, gain_rep, channel_rep - 1,
+				  SAMPLE_BUFFER::ramp_exponential);
+    }  
+    else {
+      sbuf_repp->multiply_by_ramp(gain_start_rep, gain_rep,
+				  SAMPLE_BUFFER::ramp_exponential);
+    }
+    gain_start_rep = gain_rep;
+    return;
+  }
+
   if (channel_rep > 0 && channel_rep <= channels()) {
     sbuf_repp->multiply_by(gain_rep, channel_rep - 1);
   }  
@@ -208,6 +259,11 @@ void EFFECT_AMPLIFY_DB::process(void)
  */
 void EFFECT_AMPLIFY_DB::process_ref(void)
 {
+  if (gain_start_rep != gain_rep) {
+    process();
+    return;
+  }
+
   if (channel_rep > 0 && channel_rep < channels()) {
     i_ch.begin();
     while(!i_ch.end()) {
@@ -315,6 +371,7 @@ void EFFECT_AMPLIFY_CHANNEL::set_parameter(int param, parameter_t value)
   switch (param) {
     case 1: 
       gain = value / 100.0;
+      gain_start_rep = gain;
       break;
       
     case 2: 
@@ -326,6 +383,18 @@ void EFFECT_AMPLIFY_CHANNEL::set_parameter(int param, parameter_t value)
   }
 }
 
+void EFFECT_AMPLIFY_CHANNEL::set_parameter_ramp(int param, parameter_t value)
+{
+  switch (param) {
+    case 1: 
+      gain = value / 100.0;
+      break;
+
+  default:
+    set_parameter(param, value);
+  }
+}
+
 CHAIN_OPERATOR::parameter_t EFFECT_AMPLIFY_CHANNEL::get_parameter(int param) const
 { 
   switch (param) {
@@ -364,8 +433,12 @@ void EFFECT_AMPLIFY_CHANNEL::init(SAMPLE_BUFFER *insample)
 void EFFECT_AMPLIFY_CHANNEL::process(void)
 {
   if (channel_rep >= 0 && channel_rep < channels()) {
-    cur_sbuf_repp->multiply_by(gain, channel_rep);
+    if (gain_start_rep != gain)
+      cur_sbuf_repp->multiply_by_ramp(gain_start_rep, gain, channel_rep);
+    else
+      cur_sbuf_repp->multiply_by(gain, channel_rep);
   }
+  gain_start_rep = gain;
 }
 
 /**
@@ -373,6 +446,11 @@ void EFFECT_AMPLIFY_CHANNEL::process(void)
  */
 void EFFECT_AMPLIFY_CHANNEL::process_ref(void)
 {
+  if (gain_start_rep != gain) {
+    process();
+    return;
+  }
+
   if (channel_rep >= 0 && channel_rep < channels()) {
     i.begin(channel_rep);
     while(!i.end()) {
@@ -733,22 +811,45 @@ EFFECT_NORMAL_PAN::EFFECT_NORMAL_PAN (parameter_t right_percent)
   set_parameter(1, right_percent);
 }
 
+void EFFECT_NORMAL_PAN::update_gains(parameter_t value)
+{
+  right_percent_rep = value;
+  if (value == 50.0) {
+    l_gain = r_gain = 1.0;
+  }
+  else if (value < 50.0) {
+    l_gain = 1.0;
+    r_gain = value / 50.0;
+  }
+  else if (value > 50.0) {
+    r_gain = 1.0;
+    l_gain = (100.0 - value) / 50.0;
+  }
+}
+
 void EFFECT_NORMAL_PAN::set_parameter(int param, parameter_t value)
 {
   switch (param) {
   case 1: 
-    right_percent_rep = value;
-    if (value == 50.0) {
-      l_gain = r_gain = 1.0;
-    }
-    else if (value < 50.0) {
-      l_gain = 1.0;
-      r_gain = value / 50.0;
-    }
-    else if (value > 50.0) {
-      r_gain = 1.0;
-      l_gain = (100.0 - value) / 50.0;
-    }
+    update_gains(value);
+    l_gain_start_rep = l_gain;
+    r_gain_start_rep = r_gain;
+    break;
+  default:
+    DBC_NEVER_REACHED();
+  }
+}
+
+/**
+ * Both channel gains are ramped linearly, which
+ * approximates the pan law if the ramp crosses 
+ * the center position.
+ */
+void EFFECT_NORMAL_PAN::set_parameter_ramp(int param, parameter_t value)
+{
+  switch (param) {
+  case 1: 
+    update_gains(value);
     break;
   default:
     DBC_NEVER_REACHED();
@@ -793,8 +894,16 @@ void EFFECT_NORMAL_PAN::process(void)
   /* to match with out_channels() */
   cur_sbuf_repp->number_of_channels(2);
  
-  cur_sbuf_repp->multiply_by(l_gain, SAMPLE_SPECS::ch_left);
-  cur_sbuf_repp->multiply_by(r_gain, SAMPLE_SPECS::ch_right);
+  if (l_gain_start_rep != l_gain || r_gain_start_rep != r_gain) {
+    cur_sbuf_repp->multiply_by_ramp(l_gain_start_rep, l_gain, SAMPLE_SPECS::ch_left);
+    cur_sbuf_repp->multiply_by_ramp(r_gain_start_rep, r_gain, SAMPLE_SPECS::ch_right);
+    l_gain_start_rep = l_gain;
+    r_gain_start_rep = r_gain;
+  }
+  else {
+    cur_sbuf_repp->multiply_by(l_gain, SAMPLE_SPECS::ch_left);
+    cur_sbuf_repp->multiply_by(r_gain, SAMPLE_SPECS::ch_right);
+  }
 }
 
 /**
@@ -802,6 +911,11 @@ void EFFECT_NORMAL_PAN::process(void)
  */
 void EFFECT_NORMAL_PAN::process_ref(void)
 {
+  if (l_gain_start_rep != l_gain || r_gain_start_rep != r_gain) {
+    process();
+    return;
+  }
+
   i.begin(0);
   while(!i.end()) {
     *i.current() = *i.current() * l_gain;
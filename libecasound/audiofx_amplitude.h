@@ -36,6 +36,7 @@ protected:
 class EFFECT_AMPLIFY: public EFFECT_AMPLITUDE {
 
   parameter_t gain_rep;
+  parameter_t gain_start_rep;
   SAMPLE_ITERATOR i;
   SAMPLE_BUFFER* sbuf_repp;
 
@@ -47,6 +48,8 @@ class EFFECT_AMPLIFY: public EFFECT_AMPLITUDE {
 
   virtual void set_parameter(int param, parameter_t value);
   virtual parameter_t get_parameter(int param) const;
+  virtual bool parameter_ramp_supported(int param) const { return param == 1; }
+  virtual void set_parameter_ramp(int param, parameter_t value);
 
   virtual void init(SAMPLE_BUFFER *insample);
   virtual void release(void);
@@ -68,6 +71,7 @@ class EFFECT_AMPLIFY_DB: public EFFECT_AMPLITUDE {
  private:
 
   parameter_t gain_rep;
+  parameter_t gain_start_rep;
   parameter_t gain_db_rep; 
   int channel_rep;
   SAMPLE_BUFFER *sbuf_repp;
@@ -81,6 +85,8 @@ class EFFECT_AMPLIFY_DB: public EFFECT_AMPLITUDE {
 
   virtual void set_parameter(int param, parameter_t value);
   virtual parameter_t get_parameter(int param) const;
+  virtual bool parameter_ramp_supported(int param) const { return param == 1; }
+  virtual void set_parameter_ramp(int param, parameter_t value);
 
   virtual void init(SAMPLE_BUFFER *insample);
   virtual void release(void);
@@ -129,6 +135,7 @@ class EFFECT_AMPLIFY_CLIPCOUNT : public EFFECT_AMPLITUDE {
 class EFFECT_AMPLIFY_CHANNEL: public EFFECT_AMPLITUDE {
 
   parameter_t gain;
+  parameter_t gain_start_rep;
   int channel_rep;
   SAMPLE_ITERATOR_CHANNEL i;
 
@@ -140,6 +147,8 @@ class EFFECT_AMPLIFY_CHANNEL: public EFFECT_AMPLITUDE {
 
   virtual void set_parameter(int param, parameter_t value);
   virtual parameter_t get_parameter(int param) const;
+  virtual bool parameter_ramp_supported(int param) const { return param == 1; }
+  virtual void set_parameter_ramp(int param, parameter_t value);
 
   virtual int output_channels(int i_channels) const;
 
@@ -270,6 +279,9 @@ private:
 
   parameter_t right_percent_rep;
   parameter_t l_gain, r_gain;
+  parameter_t l_gain_start_rep, r_gain_start_rep;
+
+  void update_gains(parameter_t right_percent);
   
 public:
 
@@ -282,6 +294,8 @@ public:
     
   virtual void set_parameter(int param, parameter_t value);
   virtual parameter_t get_parameter(int param) const;
+  virtual bool parameter_ramp_supported(int param) const { return param == 1; }
+  virtual void set_parameter_ramp(int param, parameter_t value);
 
   virtual void init(SAMPLE_BUFFER *insample);
   virtual void process(void);
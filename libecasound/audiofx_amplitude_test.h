@@ -86,6 +86,53 @@ void EFFECT_AMPLIFY_TEST::do_run(void)
       ECA_TEST_FAILURE("optimized EFFECT_AMPLIFY");
     }
   }
+
+  /* case: set_parameter_ramp */
+  {
+    std::fprintf(stdout, "%s: EFFECT_AMPLIFY::set_parameter_ramp\n",
+		 __FILE__);
+    SAMPLE_BUFFER sbuf_test (bufsize, channels);
+
+    EFFECT_AMPLIFY amp_test;
+    amp_test.init(&sbuf_test);
+    amp_test.set_parameter(1, 100.0f);
+
+    if (amp_test.parameter_ramp_supported(1) != true) {
+      ECA_TEST_FAILURE("EFFECT_AMPLIFY ramp not supported");
+    }
+
+    for(int ch = 0; ch < channels; ch++)
+      for(int n = 0; n < bufsize; n++)
+	sbuf_test.buffer[ch][n] = 1.0f;
+
+    amp_test.set_parameter_ramp(1, 200.0f);
+    amp_test.process();
+
+    for(int ch = 0; ch < channels; ch++) {
+      if (sbuf_test.buffer[ch][0] <= 1.0f ||
+	  sbuf_test.buffer[ch][bufsize / 2] >= 2.0f ||
+	  sbuf_test.buffer[ch][bufsize - 1] != 2.0f) {
+	ECA_TEST_FAILURE("EFFECT_AMPLIFY ramp end-points");
+      }
+      for(int n = 1; n < bufsize; n++) {
+	if (sbuf_test.buffer[ch][n] < sbuf_test.buffer[ch][n - 1]) {
+	  ECA_TEST_FAILURE("EFFECT_AMPLIFY ramp not monotonic");
+	  break;
+	}
+      }
+    }
+
+    /* note: once the target is reached, gain is constant */
+    for(int ch = 0; ch < channels; ch++)
+      for(int n = 0; n < bufsize; n++)
+	sbuf_test.buffer[ch][n] = 1.0f;
+
+    amp_test.process();
+    if (sbuf_test.buffer[0][0] != 2.0f ||
+	sbuf_test.buffer[channels - 1][bufsize - 1] != 2.0f) {
+      ECA_TEST_FAILURE("EFFECT_AMPLIFY gain after ramp");
+    }
+  }
 }
 
 /**
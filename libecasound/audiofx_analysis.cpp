@@ -85,8 +85,6 @@ EFFECT_VOLUME_BUCKETS::~EFFECT_VOLUME_BUCKETS (void)
 
 void EFFECT_VOLUME_BUCKETS::status_entry(const std::vector<unsigned long int>& buckets, std::string& otemp) const
 {
-  /* note: is called with 'lock_rep' taken */
-
   for(unsigned int n = 0; n < buckets.size(); n++) {
     string samples = kvu_numtostr(buckets[n]);
 
@@ -109,21 +107,69 @@ void EFFECT_VOLUME_BUCKETS::status_entry(const std::vector<unsigned long int>& b
 void EFFECT_VOLUME_BUCKETS::reset_all_stats(void)
 {
   reset_period_stats();
-  max_pos = max_neg = 0.0f;
+  work_rep.max_pos = work_rep.max_neg = 0.0f;
+  published_rep.max_pos = published_rep.max_neg = 0.0f;
 }
 
 void EFFECT_VOLUME_BUCKETS::reset_period_stats(void)
 {
-  for(unsigned int nm = 0; nm < pos_samples_db.size(); nm++)
-    for(unsigned int ch = 0; ch < pos_samples_db[nm].size(); ch++)
-      pos_samples_db[nm][ch] = 0;
+  for(unsigned int nm = 0; nm < work_rep.pos_samples_db.size(); nm++)
+    for(unsigned int ch = 0; ch < work_rep.pos_samples_db[nm].size(); ch++)
+      work_rep.pos_samples_db[nm][ch] = 0;
+
+  for(unsigned int nm = 0; nm < work_rep.neg_samples_db.size(); nm++)
+    for(unsigned int ch = 0; ch < work_rep.neg_samples_db[nm].size(); ch++)
+      work_rep.neg_samples_db[nm][ch] = 0;
+
+  for(unsigned int nm = 0; nm < work_rep.num_of_samples.size(); nm++)
+    work_rep.num_of_samples[nm] = 0;
+
+  published_rep.num_of_samples = work_rep.num_of_samples;
+  published_rep.pos_samples_db = work_rep.pos_samples_db;
+  published_rep.neg_samples_db = work_rep.neg_samples_db;
+}
+
+/**
+ * Copies the working set to the published set.
+ *
+ * Called from process(), so must not allocate memory. 
+ * Both sets are sized in init().
+ */
+void EFFECT_VOLUME_BUCKETS::publish_stats(void)
+{
+  publish_lock_rep.write_begin();
+
+  for(unsigned int nm = 0; nm < work_rep.pos_samples_db.size(); nm++)
+    for(unsigned int ch = 0; ch < work_rep.pos_samples_db[nm].size(); ch++)
+      published_rep.pos_samples_db[nm][ch] = work_rep.pos_samples_db[nm][ch];
+
+  for(unsigned int nm = 0; nm < work_rep.neg_samples_db.size(); nm++)
+    for(unsigned int ch = 0; ch < work_rep.neg_samples_db[nm].size(); ch++)
+      published_rep.neg_samples_db[nm][ch] = work_rep.neg_samples_db[nm][ch];
+
+  for(unsigned int nm = 0; nm < work_rep.num_of_samples.size(); nm++)
+    published_rep.num_of_samples[nm] = work_rep.num_of_samples[nm];
 
-  for(unsigned int nm = 0; nm < neg_samples_db.size(); nm++)
-    for(unsigned int ch = 0; ch < neg_samples_db[nm].size(); ch++)
-      neg_samples_db[nm][ch] = 0;
+  published_rep.max_pos = work_rep.max_pos;
+  published_rep.max_neg = work_rep.max_neg;
 
-  for(unsigned int nm = 0; nm < num_of_samples.size(); nm++)
-    num_of_samples[nm] = 0;
+  publish_lock_rep.write_end();
+}
+
+/**
+ * Takes a consistent copy of the published set.
+ *
+ * Called with 'lock_rep' taken, which guarantees that
+ * the dimensions of the published set do not change.
+ */
+void EFFECT_VOLUME_BUCKETS::snapshot_stats(stats* dst) const
+{
+  unsigned int seq;
+  do {
+    seq = publish_lock_rep.read_begin();
+    *dst = published_rep;
+  }
+  while(publish_lock_rep.read_retry(seq) == true);
 }
 
 string EFFECT_VOLUME_BUCKETS::status(void) const
@@ -131,37 +177,40 @@ string EFFECT_VOLUME_BUCKETS::status(void) const
   int res = pthread_mutex_lock(&lock_rep);
   DBC_CHECK(res == 0);
 
+  stats snapshot;
+  snapshot_stats(&snapshot);
+
+  res = pthread_mutex_unlock(&lock_rep);
+  DBC_CHECK(res == 0);
+
   std::string status_str;
 
   status_str = "-- Amplitude statistics --\n";
   status_str += "Pos/neg, count,(%), ch1...n";
 
-  for(unsigned j = 0; j < pos_samples_db.size(); j++) {
+  for(unsigned j = 0; j < snapshot.pos_samples_db.size(); j++) {
     status_str += std::string("\nPos ")
       + priv_align_right(bucket_table[j].name, 4, ' ')
       + "dB: ";
-    status_entry(pos_samples_db[j], status_str);
+    status_entry(snapshot.pos_samples_db[j], status_str);
   }
 
-  for(unsigned int j = neg_samples_db.size(); j > 0; j--) {
+  for(unsigned int j = snapshot.neg_samples_db.size(); j > 0; j--) {
     status_str += std::string("\nNeg ")
       + priv_align_right(bucket_table[j-1].name, 4, ' ')
       + "dB: ";
-    status_entry(neg_samples_db[j-1], status_str);
+    status_entry(snapshot.neg_samples_db[j-1], status_str);
   }
 
   status_str += std::string("\nTotal.....: ");
-  status_entry(num_of_samples, status_str);
+  status_entry(snapshot.num_of_samples, status_str);
   status_str += "\n";
 
-  status_str += "(audiofx) Peak amplitude: pos=" + kvu_numtostr(max_pos,5) + " neg=" + kvu_numtostr(max_neg,5) + ".\n";
+  status_str += "(audiofx) Peak amplitude: pos=" + kvu_numtostr(snapshot.max_pos,5) + " neg=" + kvu_numtostr(snapshot.max_neg,5) + ".\n";
   status_str += "(audiofx) Max gain without clipping: " + kvu_numtostr(max_multiplier(),5) + ".\n";
 
   status_str += "(audiofx) -- End of statistics --\n";
 
-  res = pthread_mutex_unlock(&lock_rep);
-  DBC_CHECK(res == 0);
-
   return status_str;
 }
 
@@ -219,8 +268,17 @@ CHAIN_OPERATOR::parameter_t EFFECT_VOLUME_BUCKETS::get_parameter(int param) cons
 CHAIN_OPERATOR::parameter_t EFFECT_VOLUME_BUCKETS::max_multiplier(void) const
 {
   parameter_t k;
-  SAMPLE_SPECS::sample_t max_peak = max_pos;
+  SAMPLE_SPECS::sample_t max_pos, max_neg;
+
+  unsigned int seq;
+  do {
+    seq = publish_lock_rep.read_begin();
+    max_pos = published_rep.max_pos;
+    max_neg = published_rep.max_neg;
+  }
+  while(publish_lock_rep.read_retry(seq) == true);
 
+  SAMPLE_SPECS::sample_t max_peak = max_pos;
   if (max_neg > max_pos) 
     max_peak = max_neg;
   if (max_peak != 0.0f) 
@@ -239,13 +297,18 @@ void EFFECT_VOLUME_BUCKETS::init(SAMPLE_BUFFER* insample)
   i.init(insample);
   set_channels(insample->number_of_channels());
   DBC_CHECK(channels() == insample->number_of_channels());
-  num_of_samples.resize(insample->number_of_channels(), 0);
+  work_rep.num_of_samples.resize(insample->number_of_channels(), 0);
 
   int entries = sizeof(bucket_table) / sizeof(struct bucket);
 
-  pos_samples_db.resize(entries, std::vector<unsigned long int> (channels()));
-  neg_samples_db.resize(entries, std::vector<unsigned long int> (channels()));
+  work_rep.pos_samples_db.resize(entries);
+  work_rep.neg_samples_db.resize(entries);
+  for(int n = 0; n < entries; n++) {
+    work_rep.pos_samples_db[n].resize(channels());
+    work_rep.neg_samples_db[n].resize(channels());
+  }
 
+  /* note: allocates the published set to match the working set */
   reset_all_stats();
   
   res = pthread_mutex_unlock(&lock_rep);
@@ -256,43 +319,38 @@ void EFFECT_VOLUME_BUCKETS::init(SAMPLE_BUFFER* insample)
 
 void EFFECT_VOLUME_BUCKETS::process(void)
 {
-  DBC_CHECK(static_cast<int>(num_of_samples.size()) == channels());
+  DBC_CHECK(static_cast<int>(work_rep.num_of_samples.size()) == channels());
 
-  int res = pthread_mutex_trylock(&lock_rep);
-  if (res == 0) {
-    i.begin();
-    while(!i.end()) {
+  i.begin();
+  while(!i.end()) {
 
-      DBC_CHECK(num_of_samples.size() > static_cast<unsigned>(i.channel()));
-      num_of_samples[i.channel()]++;
+    DBC_CHECK(work_rep.num_of_samples.size() > static_cast<unsigned>(i.channel()));
+    work_rep.num_of_samples[i.channel()]++;
 
-      if (*i.current() >= 0) {
-	if (*i.current() > max_pos) max_pos = *i.current();
+    if (*i.current() >= 0) {
+      if (*i.current() > work_rep.max_pos) work_rep.max_pos = *i.current();
 
-	for(unsigned j = 0; j < pos_samples_db.size(); j++) {
-	  if (*i.current() > bucket_table[j].threshold) {
-	    pos_samples_db[j][i.channel()]++;
-	    break;
-	  }
+      for(unsigned j = 0; j < work_rep.pos_samples_db.size(); j++) {
+	if (*i.current() > bucket_table[j].threshold) {
+	  work_rep.pos_samples_db[j][i.channel()]++;
+	  break;
 	}
       }
-      else {
-	if (-(*i.current()) > max_neg) max_neg = -(*i.current());
-
-	for(unsigned j = 0; j < neg_samples_db.size(); j++) {
-	  if (*i.current() < -bucket_table[j].threshold) {
-	    neg_samples_db[j][i.channel()]++;
-	    break;
-	  }
+    }
+    else {
+      if (-(*i.current()) > work_rep.max_neg) work_rep.max_neg = -(*i.current());
+
+      for(unsigned j = 0; j < work_rep.neg_samples_db.size(); j++) {
+	if (*i.current() < -bucket_table[j].threshold) {
+	  work_rep.neg_samples_db[j][i.channel()]++;
+	  break;
 	}
       }
-      i.next();
     }
-
-    res = pthread_mutex_unlock(&lock_rep);
-    DBC_CHECK(res == 0);
+    i.next();
   }
-  // else { std::cerr << "(audiofx_analysis) lock taken, skipping process().\n"; }
+
+  publish_stats();
 }
 
 EFFECT_VOLUME_PEAK::EFFECT_VOLUME_PEAK (void)
@@ -399,13 +457,23 @@ string EFFECT_DCFIND::parameter_names(void) const
 CHAIN_OPERATOR::parameter_t EFFECT_DCFIND::get_deltafix(int channel) const
 {
   SAMPLE_SPECS::sample_t deltafix;
+  parameter_t pos, neg, count;
 
   if (channel < 0 || 
-      channel >= static_cast<int>(pos_sum.size()) ||
-      channel >= static_cast<int>(neg_sum.size())) return 0.0;
+      channel >= static_cast<int>(published_pos_sum_rep.size()) ||
+      channel >= static_cast<int>(published_neg_sum_rep.size())) return 0.0;
+
+  unsigned int seq;
+  do {
+    seq = publish_lock_rep.read_begin();
+    pos = published_pos_sum_rep[channel];
+    neg = published_neg_sum_rep[channel];
+    count = published_num_of_samples_rep[channel];
+  }
+  while(publish_lock_rep.read_retry(seq) == true);
 
-  if (pos_sum[channel] > neg_sum[channel]) deltafix = -(pos_sum[channel] - neg_sum[channel]) / num_of_samples[channel];
-  else deltafix = (neg_sum[channel] - pos_sum[channel]) / num_of_samples[channel];
+  if (pos > neg) deltafix = -(pos - neg) / count;
+  else deltafix = (neg - pos) / count;
 
   return (CHAIN_OPERATOR::parameter_t)deltafix; 
 }
@@ -442,6 +510,10 @@ void EFFECT_DCFIND::init(SAMPLE_BUFFER *insample)
   pos_sum.resize(channels());
   neg_sum.resize(channels());
   num_of_samples.resize(channels());
+
+  published_pos_sum_rep = pos_sum;
+  published_neg_sum_rep = neg_sum;
+  published_num_of_samples_rep = num_of_samples;
 }
 
 void EFFECT_DCFIND::process(void)
@@ -456,4 +528,12 @@ void EFFECT_DCFIND::process(void)
     num_of_samples[i.channel()]++;
     i.next();
   }
+
+  publish_lock_rep.write_begin();
+  for(int n = 0; n < channels(); n++) {
+    published_pos_sum_rep[n] = pos_sum[n];
+    published_neg_sum_rep[n] = neg_sum[n];
+    published_num_of_samples_rep[n] = num_of_samples[n];
+  }
+  publish_lock_rep.write_end();
 }
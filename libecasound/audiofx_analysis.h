@@ -6,6 +6,8 @@
 
 #include <pthread.h>
 
+#include <kvu_locks.h>
+
 #include "samplebuffer_iterators.h"
 #include "audiofx.h"
 
@@ -31,22 +33,36 @@ class EFFECT_ANALYSIS : public EFFECT_BASE {
  * Analyzes the audio signal volume by using a set of 
  * amplitude range buckets.
  *
+ * Statistics are collected by process() into a private
+ * working set, and a copy is published after each 
+ * processed block. Readers (status() and get_parameter()) 
+ * only access the published copy, so process() never 
+ * blocks nor skips a block.
+ *
  * @author Kai Vehmanen
  */
 class EFFECT_VOLUME_BUCKETS : public EFFECT_ANALYSIS {
 
 private:
 
-  std::vector<unsigned long int> num_of_samples; // number of samples processed
-  std::vector<std::vector<unsigned long int> > pos_samples_db;
-  std::vector<std::vector<unsigned long int> > neg_samples_db;
-  SAMPLE_SPECS::sample_t max_pos, max_neg;
+  struct stats {
+    std::vector<unsigned long int> num_of_samples; // number of samples processed
+    std::vector<std::vector<unsigned long int> > pos_samples_db;
+    std::vector<std::vector<unsigned long int> > neg_samples_db;
+    SAMPLE_SPECS::sample_t max_pos, max_neg;
+  };
+
+  stats work_rep;
+  stats published_rep;
+  KVU_SEQLOCK publish_lock_rep;
 
   mutable pthread_mutex_t lock_rep;
   SAMPLE_ITERATOR_CHANNELS i;
 
   void reset_all_stats(void);
   void reset_period_stats(void);
+  void publish_stats(void);
+  void snapshot_stats(stats* dst) const;
   void status_entry(const std::vector<unsigned long int>& buckets, std::string& otemp) const;
 
  public:
@@ -108,6 +124,10 @@ class EFFECT_VOLUME_PEAK : public EFFECT_ANALYSIS {
 /**
  * Calculates DC-offset.
  *
+ * Like with EFFECT_VOLUME_BUCKETS, the sums are published
+ * after each processed block and readers only access
+ * the published copy.
+ *
  * @author Kai Vehmanen
  */
 class EFFECT_DCFIND : public EFFECT_ANALYSIS {
@@ -118,6 +138,11 @@ private:
   std::vector<parameter_t> neg_sum;
   std::vector<parameter_t> num_of_samples;
 
+  std::vector<parameter_t> published_pos_sum_rep;
+  std::vector<parameter_t> published_neg_sum_rep;
+  std::vector<parameter_t> published_num_of_samples_rep;
+  KVU_SEQLOCK publish_lock_rep;
+
   SAMPLE_SPECS::sample_t tempval;
   SAMPLE_ITERATOR_CHANNELS i;
 
@@ -20,6 +20,7 @@
 // Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
 // ------------------------------------------------------------------------
 
+#include <algorithm> /* max(), rotate() */
 #include <cmath>
 
 #include <kvu_utils.h>
@@ -36,6 +37,76 @@ static void priv_resize_buffer(std::vector<SAMPLE_SPECS::sample_t> *buffer, int
     (*buffer)[i] = 0.0;
 }
 
+/**
+ * Returns the length of a delay line for a delay of
+ * 'value' samples.
+ */
+static long int priv_delay_length(CHAIN_OPERATOR::parameter_t value)
+{
+  return (value > 0 ? static_cast<long int>(std::ceil(value)) : 0);
+}
+
+/**
+ * Delay lines are reserved in init() to hold at least this
+ * many seconds, so that the delay can be changed while
+ * running, e.g. by a controller, without reallocating.
+ */
+static const long int priv_delay_line_reserve_secs = 2;
+
+/**
+ * Sets up zeroed delay lines, one per channel, for a delay
+ * of 'len' samples, and marks them empty.
+ */
+static void priv_init_delay_lines(std::vector<std::vector<SAMPLE_SPECS::sample_t> > *lines,
+				  std::vector<long int> *index,
+				  std::vector<long int> *filled,
+				  int channels,
+				  long int len,
+				  long int srate)
+{
+  long int capacity = std::max(len, srate * priv_delay_line_reserve_secs);
+  lines->resize(channels);
+  index->resize(channels);
+  filled->resize(channels);
+  for(int n = 0; n < channels; n++) {
+    (*lines)[n].assign(capacity, 0.0);
+    (*index)[n] = 0;
+    (*filled)[n] = 0;
+  }
+}
+
+/**
+ * Makes the delay lines in 'lines' hold at least 'len' samples.
+ * Only allocates when 'len' exceeds the capacity reserved in
+ * init(). The history is kept: a line is unrolled so that the
+ * oldest sample comes first, and its index is moved after the
+ * newest one.
+ */
+static void priv_grow_delay_lines(std::vector<std::vector<SAMPLE_SPECS::sample_t> > *lines,
+				  std::vector<long int> *index,
+				  long int len)
+{
+  for(size_t n = 0; n < lines->size(); n++) {
+    std::vector<SAMPLE_SPECS::sample_t>& line = (*lines)[n];
+    if (static_cast<long int>(line.size()) < len) {
+      long int old_len = line.size();
+      std::rotate(line.begin(), line.begin() + (*index)[n], line.end());
+      line.resize(len, 0.0);
+      (*index)[n] = old_len;
+    }
+  }
+}
+
+/**
+ * Position of the sample written 'delay' samples before
+ * write position 'index' in a line of 'len' samples.
+ */
+static inline long int priv_delay_line_pos(long int index, long int delay, long int len)
+{
+  long int pos = index - delay;
+  return (pos < 0 ? pos + len : pos);
+}
+
 EFFECT_FILTER::~EFFECT_FILTER(void)
 {
 }
@@ -223,7 +294,8 @@ CHAIN_OPERATOR::parameter_t EFFECT_HIGHPASS::get_parameter(int param) const
 }
 
 EFFECT_ALLPASS_FILTER::EFFECT_ALLPASS_FILTER (void)
-  : feedback_gain(0.0),
+  : dlen(0),
+    feedback_gain(0.0),
     D(0.0)
 {
 
@@ -234,11 +306,8 @@ void EFFECT_ALLPASS_FILTER::set_parameter(int param, CHAIN_OPERATOR::parameter_t
   switch (param) {
   case 1: 
     D = value;
-//    assert(inbuf.size() == outbuf.size());
-    for(int n = 0; n < static_cast<int>(inbuf.size()); n++) {
-      if (inbuf[n].size() > D) inbuf[n].resize(static_cast<unsigned int>(D));
-//      if (outbuf[n].size() > D) inbuf[n].resize(D);
-    }
+    dlen = priv_delay_length(D);
+    priv_grow_delay_lines(&inbuf, &delay_index, dlen);
     break;
   case 2: 
     feedback_gain = value / 100.0;
@@ -263,43 +332,40 @@ void EFFECT_ALLPASS_FILTER::init(SAMPLE_BUFFER* insample)
 
   set_channels(insample->number_of_channels());
 
-  inbuf.resize(insample->number_of_channels());
-  for(size_t i = 0; i < inbuf.size(); i++)
-    inbuf[i].clear();
+  dlen = priv_delay_length(D);
+  priv_init_delay_lines(&inbuf, &delay_index, &filled,
+			insample->number_of_channels(), dlen, samples_per_second());
 }
 
 void EFFECT_ALLPASS_FILTER::process(void)
 {
   i.begin();
   while(!i.end()) {
-    if (inbuf[i.channel()].size() >= D) {
-      inbuf[i.channel()].push_back(*i.current());
+    int ch = i.channel();
+    SAMPLE_SPECS::sample_t input = *i.current();
 
-      //      *i.current() = -feedback_gain * (*i.current()) +
-      //	             inbuf[i.channel()].front() +
-      //	             feedback_gain * outbuf[i.channel()].front();
+    long int len = inbuf[ch].size();
 
-      *i.current() = ecaops_flush_to_zero(-feedback_gain * (*i.current()) +
-					  (feedback_gain * inbuf[i.channel()].front() +
-					   *i.current()) * 
+    if (filled[ch] >= dlen) {
+      SAMPLE_SPECS::sample_t delayed =
+	(dlen > 0 ? inbuf[ch][priv_delay_line_pos(delay_index[ch], dlen, len)] : input);
+      *i.current() = ecaops_flush_to_zero(-feedback_gain * input +
+					  (feedback_gain * delayed + input) * 
 					  (1.0 - feedback_gain * feedback_gain));
-
-      //      feedback_gain * outbuf[i.channel()].front();
-      //      outbuf[i.channel()].push_back(*i.current());
-
-      inbuf[i.channel()].pop_front();
-      // outbuf[i.channel()].pop_front();
     } 
     else {
-      inbuf[i.channel()].push_back(*i.current());
-      *i.current() = ecaops_flush_to_zero(*i.current() * (1.0 - feedback_gain));
-      // outbuf[i.channel()].push_back(*i.current());
+      *i.current() = ecaops_flush_to_zero(input * (1.0 - feedback_gain));
     }
+
+    inbuf[ch][delay_index[ch]] = input;
+    if (++delay_index[ch] == len) delay_index[ch] = 0;
+    if (filled[ch] < len) ++filled[ch];
     i.next();
   }
 }
 
 EFFECT_COMB_FILTER::EFFECT_COMB_FILTER (int delay_in_samples, CHAIN_OPERATOR::parameter_t radius)
+  : dlen(1)
 {
   set_parameter(1, (CHAIN_OPERATOR::parameter_t)delay_in_samples);
   set_parameter(2, radius);
@@ -311,13 +377,9 @@ void EFFECT_COMB_FILTER::set_parameter(int param, CHAIN_OPERATOR::parameter_t va
   case 1: 
     {
       C = value;
-      std::vector<std::deque<SAMPLE_SPECS::sample_t> >::iterator p = buffer.begin();
-      while(p != buffer.end()) {
-	if (p->size() > C) {
-	  p->resize(static_cast<unsigned int>(C));
-	}
-	++p;
-      }
+      /* note: feedback needs a delay of at least one sample */
+      dlen = std::max(priv_delay_length(C), 1L);
+      priv_grow_delay_lines(&buffer, &delay_index, dlen);
       break;
     }
 
@@ -344,30 +406,30 @@ void EFFECT_COMB_FILTER::init(SAMPLE_BUFFER* insample)
 
   set_channels(insample->number_of_channels());
 
-  buffer.resize(insample->number_of_channels());
-  for(size_t i = 0; i < buffer.size(); i++)
-    buffer[i].clear();
-
+  priv_init_delay_lines(&buffer, &delay_index, &filled,
+			insample->number_of_channels(), dlen, samples_per_second());
 }
 
 void EFFECT_COMB_FILTER::process(void)
 {
+  SAMPLE_SPECS::sample_t gain = pow(D, C);
+
   i.begin();
   while(!i.end()) {
-    if (buffer[i.channel()].size() >= C) {
-      *i.current() = (*i.current())  + (pow(D, C) *
-					buffer[i.channel()].front());
-      buffer[i.channel()].push_back(*i.current());
-      buffer[i.channel()].pop_front();
+    int ch = i.channel();
+    long int len = buffer[ch].size();
+    if (filled[ch] >= dlen) {
+      *i.current() = (*i.current()) + (gain * buffer[ch][priv_delay_line_pos(delay_index[ch], dlen, len)]);
     } 
-    else {
-      buffer[i.channel()].push_back(*i.current());
-    }
+    buffer[ch][delay_index[ch]] = *i.current();
+    if (++delay_index[ch] == len) delay_index[ch] = 0;
+    if (filled[ch] < len) ++filled[ch];
     i.next();
   }
 }
 
 EFFECT_INVERSE_COMB_FILTER::EFFECT_INVERSE_COMB_FILTER (int delay_in_samples, CHAIN_OPERATOR::parameter_t radius)
+  : dlen(0)
 {
   // 
   // delay in number of samples
@@ -382,6 +444,8 @@ void EFFECT_INVERSE_COMB_FILTER::set_parameter(int param, CHAIN_OPERATOR::parame
   switch (param) {
   case 1: 
     C = value;
+    dlen = priv_delay_length(C);
+    priv_grow_delay_lines(&buffer, &delay_index, dlen);
     break;
   case 2: 
     D = value;
@@ -406,27 +470,29 @@ void EFFECT_INVERSE_COMB_FILTER::init(SAMPLE_BUFFER* insample)
 
   set_channels(insample->number_of_channels());
 
-  buffer.resize(insample->number_of_channels());
-  for(size_t i = 0; i < buffer.size(); i++)
-    buffer[i].clear();
-
-  priv_resize_buffer(&laskuri, insample->number_of_channels());
+  priv_init_delay_lines(&buffer, &delay_index, &laskuri,
+			insample->number_of_channels(), dlen, samples_per_second());
 }
 
 void EFFECT_INVERSE_COMB_FILTER::process(void)
 {
+  SAMPLE_SPECS::sample_t gain = pow(D, C);
+
   i.begin();
   while(!i.end()) {
-    buffer[i.channel()].push_back(*i.current());
-    
-    if (laskuri[i.channel()] >= C) {
-      *i.current() = (*i.current())  - (pow(D, C) *
-					buffer[i.channel()].front());
-      buffer[i.channel()].pop_front();
+    int ch = i.channel();
+    SAMPLE_SPECS::sample_t input = *i.current();
+    long int len = buffer[ch].size();
+
+    if (laskuri[ch] >= dlen) {
+      SAMPLE_SPECS::sample_t delayed =
+	(dlen > 0 ? buffer[ch][priv_delay_line_pos(delay_index[ch], dlen, len)] : input);
+      *i.current() = input - (gain * delayed);
     } 
-    else {
-      laskuri[i.channel()]++;
-    }
+
+    buffer[ch][delay_index[ch]] = input;
+    if (++delay_index[ch] == len) delay_index[ch] = 0;
+    if (laskuri[ch] < len) ++laskuri[ch];
     i.next();
   }
 }
@@ -1,7 +1,6 @@
 #ifndef INCLUDED_AUDIOFX_FILTER_H
 #define INCLUDED_AUDIOFX_FILTER_H
 
-#include <deque>
 #include <string>
 #include <vector>
 
@@ -145,7 +144,10 @@ public:
  */
 class EFFECT_ALLPASS_FILTER : public EFFECT_FILTER {
 
-  std::vector<std::deque<SAMPLE_SPECS::sample_t> > inbuf, outbuf;
+  std::vector<std::vector<SAMPLE_SPECS::sample_t> > inbuf;
+  std::vector<long int> delay_index;
+  std::vector<long int> filled;
+  long int dlen;
   SAMPLE_ITERATOR_CHANNELS i;
 
   parameter_t feedback_gain;
@@ -176,8 +178,10 @@ public:
  */
 class EFFECT_COMB_FILTER : public EFFECT_FILTER {
 
-  std::vector<std::deque<SAMPLE_SPECS::sample_t> > buffer;
-  std::vector<SAMPLE_SPECS::sample_t> temp;
+  std::vector<std::vector<SAMPLE_SPECS::sample_t> > buffer;
+  std::vector<long int> delay_index;
+  std::vector<long int> filled;
+  long int dlen;
   SAMPLE_ITERATOR_CHANNELS i;
 
   parameter_t C;
@@ -207,9 +211,10 @@ public:
  */
 class EFFECT_INVERSE_COMB_FILTER : public EFFECT_FILTER {
 
-  std::vector<parameter_t> laskuri;
-  std::vector<std::deque<SAMPLE_SPECS::sample_t> > buffer;
-  std::vector<SAMPLE_SPECS::sample_t> temp;
+  std::vector<long int> laskuri;
+  std::vector<std::vector<SAMPLE_SPECS::sample_t> > buffer;
+  std::vector<long int> delay_index;
+  long int dlen;
   SAMPLE_ITERATOR_CHANNELS i;
 
   parameter_t C;
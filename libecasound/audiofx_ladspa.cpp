@@ -1,6 +1,7 @@
 // ------------------------------------------------------------------------
 // audiofx_ladspa.cpp: Wrapper class for LADSPA plugins
 // Copyright (C) 2000-2004,2011 Kai Vehmanen
+// Copyright (C) 2026 agent
 //
 // Attributes:
 //     eca-style-version: 3
@@ -27,6 +28,7 @@
 #include <config.h>
 #endif
 
+#include <cstring> /* memcpy() */
 #include <dlfcn.h>
 #include <kvu_utils.h>
 #include <kvu_dbc.h>
@@ -35,13 +37,14 @@
 #include "audiofx_ladspa.h"
 #include "eca-error.h"
 #include "eca-logger.h"
+#include "eca-scratch-pool.h"
 
 EFFECT_LADSPA::EFFECT_LADSPA (const LADSPA_Descriptor *pdesc) throw(ECA_ERROR&)
 {
   plugin_desc = pdesc;
-  if ((plugin_desc->Properties & LADSPA_PROPERTY_INPLACE_BROKEN) ==
-      LADSPA_PROPERTY_INPLACE_BROKEN)
-    throw(ECA_ERROR("AUDIOFX_LADSPA", "Inplace-broken plugins not supported."));
+  inplace_broken_rep = 
+    ((plugin_desc->Properties & LADSPA_PROPERTY_INPLACE_BROKEN) ==
+     LADSPA_PROPERTY_INPLACE_BROKEN);
 
   /* FIXME: strip linefeeds and other forbidden characters; write down to
    *        to ECA_OBJECT docs what chars are allowed and what are not... */
@@ -49,23 +52,50 @@ EFFECT_LADSPA::EFFECT_LADSPA (const LADSPA_Descriptor *pdesc) throw(ECA_ERROR&)
   unique_rep = string(plugin_desc->Label);
   maker_rep = string(plugin_desc->Maker);
   unique_number_rep = static_cast<long int>(plugin_desc->UniqueID);
+  plugin_index_rep = -1;
   buffer_repp = 0;
+  scratch_length_rep = 0;
+  workers_acquired_rep = false;
+  latency_param_rep = -1;
 
   init_ports();
 }
 
+/**
+ * Creates a plugin object from cached information, without
+ * loading the plugin file. The file is opened when 
+ * the first real instance is created with new_expr() 
+ * or clone().
+ *
+ * @see ECA_PLUGIN_CACHE
+ */
+EFFECT_LADSPA::EFFECT_LADSPA (const std::string& file, const ECA_PLUGIN_CACHE::PLUGIN_INFO& info)
+{
+  plugin_desc = 0;
+  plugin_file_rep = file;
+  plugin_index_rep = info.index;
+  name_rep = info.name;
+  unique_rep = info.unique;
+  maker_rep = info.maker;
+  unique_number_rep = info.unique_number;
+  buffer_repp = 0;
+  scratch_length_rep = 0;
+  inplace_broken_rep = false;
+  workers_acquired_rep = false;
+  latency_param_rep = -1;
+
+  port_count_rep = 0;
+  in_audio_ports = info.in_audio_ports;
+  out_audio_ports = info.out_audio_ports;
+  for(size_t n = 0; n < info.params.size(); n++) {
+    add_parameter(info.params[n]);
+  }
+}
+
 EFFECT_LADSPA::~EFFECT_LADSPA (void)
 {
   release();
-  
-  if (plugin_desc != 0) {
-    for(unsigned int n = 0; n < plugins_rep.size(); n++) {
-      if (plugin_desc->deactivate != 0) 
-	plugin_desc->deactivate(plugins_rep[n]);
-      if (plugin_desc->cleanup != 0)
-	plugin_desc->cleanup(plugins_rep[n]);
-    }
-  }
+  release_instances();
 }
 
 std::string EFFECT_LADSPA::description(void) const
@@ -73,15 +103,66 @@ std::string EFFECT_LADSPA::description(void) const
   return name_rep + " - Author: '" + maker_rep + "'";
 }
 
+EFFECT_LADSPA* EFFECT_LADSPA::new_expr(void) const
+{
+  return new EFFECT_LADSPA(descriptor());
+}
+
 EFFECT_LADSPA* EFFECT_LADSPA::clone(void) const
 { 
-  EFFECT_LADSPA* result = new EFFECT_LADSPA(plugin_desc);
+  EFFECT_LADSPA* result = new EFFECT_LADSPA(descriptor());
   for(int n = 0; n < number_of_params(); n++) {
     result->set_parameter(n + 1, get_parameter(n + 1));
   }
   return result;
 }
 
+/**
+ * Returns the plugin descriptor, opening the plugin
+ * file if the object was created from cached information.
+ */
+const LADSPA_Descriptor* EFFECT_LADSPA::descriptor(void) const throw(ECA_ERROR&)
+{
+  if (plugin_desc == 0 && plugin_file_rep.size() > 0) {
+    void *plugin_handle = dlopen(plugin_file_rep.c_str(), RTLD_NOW);
+    if (plugin_handle != 0) {
+      LADSPA_Descriptor_Function desc_func = 
+	(LADSPA_Descriptor_Function)dlsym(plugin_handle, "ladspa_descriptor");
+      const LADSPA_Descriptor *desc = 0;
+      if (desc_func != 0) 
+	desc = desc_func(plugin_index_rep);
+      if (desc != 0 &&
+	  static_cast<long int>(desc->UniqueID) == unique_number_rep &&
+	  unique_rep == desc->Label) {
+	plugin_desc = desc;
+	ECA_LOG_MSG(ECA_LOGGER::system_objects, 
+		    "Loaded LADSPA plugin \"" + unique_rep + "\" from \"" + plugin_file_rep + "\".");
+      }
+    }
+  }
+
+  if (plugin_desc == 0)
+    throw(ECA_ERROR("AUDIOFX_LADSPA", "Unable to load plugin \"" + unique_rep + "\" from \"" + plugin_file_rep + "\"."));
+
+  return plugin_desc;
+}
+
+/**
+ * Fills 'info' with information needed to recreate
+ * this plugin type from ECA_PLUGIN_CACHE.
+ */
+void EFFECT_LADSPA::plugin_info(ECA_PLUGIN_CACHE::PLUGIN_INFO* info) const
+{
+  info->index = plugin_index_rep;
+  info->unique_number = unique_number_rep;
+  info->unique = unique_rep;
+  info->name = name_rep;
+  info->maker = maker_rep;
+  info->in_audio_ports = in_audio_ports;
+  info->out_audio_ports = out_audio_ports;
+  info->params = param_descs_rep;
+}
+
 void EFFECT_LADSPA::init_ports(void)
 {
   // note: run from plugin constructor
@@ -102,16 +183,26 @@ void EFFECT_LADSPA::init_ports(void)
 
       struct PARAM_DESCRIPTION pd; 
       parse_parameter_hint_information(m, params.size() + 1, &pd);
-
-      params.push_back(pd.default_value);
-      param_descs_rep.push_back(pd);
-      if (params.size() > 1) param_names_rep += ",";
-      string tmp (kvu_string_search_and_replace(string(plugin_desc->PortNames[m]), ",", "\\,"));
-      param_names_rep += kvu_string_search_and_replace(tmp, ":", "\\:");
+      add_parameter(pd);
     }
   }
 }
 
+void EFFECT_LADSPA::add_parameter(const struct PARAM_DESCRIPTION& pd)
+{
+  /* note: by convention, plugins report their latency
+   *       through an output port named "latency" */
+  if (pd.output == true &&
+      kvu_convert_to_lowercase(pd.description) == "latency")
+    latency_param_rep = params.size();
+
+  params.push_back(pd.default_value, pd.output);
+  param_descs_rep.push_back(pd);
+  if (params.size() > 1) param_names_rep += ",";
+  string tmp (kvu_string_search_and_replace(pd.description, ",", "\\,"));
+  param_names_rep += kvu_string_search_and_replace(tmp, ":", "\\:");
+}
+
 void EFFECT_LADSPA::parse_parameter_hint_information(int portnum, int paramnum, struct PARAM_DESCRIPTION *pd)
 {
   LADSPA_PortRangeHintDescriptor hintdescriptor = plugin_desc->PortRangeHints[portnum].HintDescriptor;
@@ -261,7 +352,7 @@ void EFFECT_LADSPA::parse_parameter_hint_information(int portnum, int paramnum,
   else
     pd->logarithmic = false;
 
-  if ((plugin_desc->PortDescriptors[portnum] & LADSPA_PORT_OUTPUT) == LADSPA_PORT_CONTROL)
+  if ((plugin_desc->PortDescriptors[portnum] & LADSPA_PORT_OUTPUT) == LADSPA_PORT_OUTPUT)
     pd->output = true;
   else
     pd->output = false;
@@ -278,19 +369,30 @@ void EFFECT_LADSPA::set_parameter(int param, CHAIN_OPERATOR::parameter_t value)
 {
   if (param > 0 && (param - 1 < static_cast<int>(params.size()))) {
     //  cerr << "ladspa: setting param " << param << " to " << value << "." << endl;
-    params[param - 1] = value;
+    params.set(param - 1, value);
   }
 }
 
 CHAIN_OPERATOR::parameter_t EFFECT_LADSPA::get_parameter(int param) const 
 {
   if (param > 0 && (param - 1 < static_cast<int>(params.size()))) {
-    //  cerr << "ladspa: getting param " << param << " with value " << params[param - 1] << "." << endl;
-    return(params[param - 1]);
+    /* note: output ports are written by the plugin */
+    if (param_descs_rep[param - 1].output == true)
+      return(params.active(param - 1));
+    return(params.get(param - 1));
   }
   return(0.0);
 }
 
+long int EFFECT_LADSPA::latency(void) const
+{
+  if (latency_param_rep < 0)
+    return 0;
+
+  LADSPA_Data value = params.active(latency_param_rep);
+  return (value > 0) ? static_cast<long int>(value) : 0;
+}
+
 int EFFECT_LADSPA::output_channels(int i_channels) const
 {
   // note: We have two separate cases: either one plugin 
@@ -318,12 +420,17 @@ void EFFECT_LADSPA::init(SAMPLE_BUFFER *insample)
     buffer_repp->get_pointer_reflock();
   }
 
-  if (plugin_desc != 0) {
-    for(unsigned int n = 0; n < plugins_rep.size(); n++) {
-      if (plugin_desc->deactivate != 0) plugin_desc->deactivate(plugins_rep[n]);
-      plugin_desc->cleanup(plugins_rep[n]);
-    }
-  }
+  release_instances();
+
+  /* note: scratch buffers cover the whole reserved length,
+   *       so chain buffer length can change after init() */
+  scratch_length_rep = buffer_repp->reserved_length_in_samples();
+  if (scratch_length_rep < 1)
+    scratch_length_rep = 1;
+
+  /* note: LADSPA_Data is float, so ports are connected 
+   *       to the buffer's single precision plane */
+  buffer_repp->float_plane_reserve(channels());
 
   // NOTE: the fancy definition :)
   //       if ((in_audio_ports > 1 &&
@@ -336,19 +443,18 @@ void EFFECT_LADSPA::init(SAMPLE_BUFFER *insample)
   if (in_audio_ports > 1 ||
       out_audio_ports > 1) {
     plugins_rep.resize(1);
+    scratch_ports_rep.resize(1);
     plugins_rep[0] = reinterpret_cast<LADSPA_Handle*>(plugin_desc->instantiate(plugin_desc, samples_per_second()));
     int inport = 0;
     int outport = 0;
     for(unsigned long m = 0; m < port_count_rep; m++) {
       if ((plugin_desc->PortDescriptors[m] & LADSPA_PORT_AUDIO) == LADSPA_PORT_AUDIO) {
 	if ((plugin_desc->PortDescriptors[m] & LADSPA_PORT_INPUT) == LADSPA_PORT_INPUT) {
-	  if (inport < channels())
-	    plugin_desc->connect_port(plugins_rep[0], m, buffer_repp->buffer[inport]);
+	  connect_audio_port(0, m, inport, false);
 	  ++inport;
 	}
 	else {
-	  if (outport < channels())
-	    plugin_desc->connect_port(plugins_rep[0], m, buffer_repp->buffer[outport]);
+	  connect_audio_port(0, m, outport, true);
 	  ++outport;
 	}
       }
@@ -365,17 +471,28 @@ void EFFECT_LADSPA::init(SAMPLE_BUFFER *insample)
   } 
   else {
     plugins_rep.resize(channels());
+    scratch_ports_rep.resize(channels());
     for(unsigned int n = 0; n < plugins_rep.size(); n++) {
       plugins_rep[n] = reinterpret_cast<LADSPA_Handle*>(plugin_desc->instantiate(plugin_desc, samples_per_second()));
 
       for(unsigned long m = 0; m < port_count_rep; m++) {
 	if ((plugin_desc->PortDescriptors[m] & LADSPA_PORT_AUDIO) == LADSPA_PORT_AUDIO) {
-	  plugin_desc->connect_port(plugins_rep[n], m, buffer_repp->buffer[n]);
+	  connect_audio_port(n, m, n, 
+			     (plugin_desc->PortDescriptors[m] & LADSPA_PORT_OUTPUT) == LADSPA_PORT_OUTPUT);
 	}
       }
     }
+
+    if (plugins_rep.size() > 1) {
+      ECA_PLUGIN_WORKERS::acquire();
+      workers_acquired_rep = true;
+    }
   }
 
+  if (inplace_broken_rep == true)
+    ECA_LOG_MSG(ECA_LOGGER::system_objects, 
+		"Plugin " + name() + " is inplace-broken, using separate output buffers.");
+
   ECA_LOG_MSG(ECA_LOGGER::system_objects, 
 		"Instantiated " +
 		kvu_numtostr(plugins_rep.size()) + 
@@ -394,7 +511,7 @@ void EFFECT_LADSPA::init(SAMPLE_BUFFER *insample)
     if ((plugin_desc->PortDescriptors[m] & LADSPA_PORT_CONTROL) ==
 	LADSPA_PORT_CONTROL) {
       for(unsigned int n = 0; n < plugins_rep.size(); n++) {
-	plugin_desc->connect_port(plugins_rep[n], m, &(params[data_index]));
+	plugin_desc->connect_port(plugins_rep[n], m, params.port(data_index));
       }
       ++data_index;
     }
@@ -411,8 +528,88 @@ void EFFECT_LADSPA::release(void)
   buffer_repp = 0;
 }
 
+/**
+ * Connects audio 'port' of plugin 'instance' to chain 
+ * channel 'channel'. A scratch buffer is used instead
+ * if the channel does not exist, or if the port is an
+ * output of an inplace-broken plugin.
+ */
+void EFFECT_LADSPA::connect_audio_port(int instance, unsigned long port, int channel, bool output)
+{
+  if (channel < channels() &&
+      (output != true || inplace_broken_rep != true)) {
+    plugin_desc->connect_port(plugins_rep[instance], port, buffer_repp->float_plane_channel(channel));
+  }
+  else {
+    /* note: sample_t is at least as wide as LADSPA_Data */
+    SCRATCH_PORT sp;
+    sp.buffer = reinterpret_cast<LADSPA_Data*>(ECA_SCRATCH_POOL::acquire(scratch_length_rep));
+    sp.channel = (output == true && channel < channels()) ? channel : -1;
+    plugin_desc->connect_port(plugins_rep[instance], port, sp.buffer);
+    scratch_ports_rep[instance].push_back(sp);
+  }
+}
+
+/**
+ * Frees all plugin instances and returns their 
+ * scratch buffers to the pool.
+ */
+void EFFECT_LADSPA::release_instances(void)
+{
+  if (plugin_desc != 0) {
+    for(unsigned int n = 0; n < plugins_rep.size(); n++) {
+      if (plugin_desc->deactivate != 0) 
+	plugin_desc->deactivate(plugins_rep[n]);
+      if (plugin_desc->cleanup != 0)
+	plugin_desc->cleanup(plugins_rep[n]);
+    }
+  }
+  plugins_rep.clear();
+
+  for(size_t n = 0; n < scratch_ports_rep.size(); n++) {
+    for(size_t m = 0; m < scratch_ports_rep[n].size(); m++) {
+      ECA_SCRATCH_POOL::release(reinterpret_cast<SAMPLE_SPECS::sample_t*>(scratch_ports_rep[n][m].buffer), 
+				scratch_length_rep);
+    }
+  }
+  scratch_ports_rep.clear();
+
+  if (workers_acquired_rep == true) {
+    ECA_PLUGIN_WORKERS::release();
+    workers_acquired_rep = false;
+  }
+}
+
 void EFFECT_LADSPA::process(void)
 {
-  for(unsigned long m = 0; m < plugins_rep.size(); m++)
-    plugin_desc->run(plugins_rep[m], buffer_repp->length_in_samples());
+  /* note: control values set since the previous block */
+  params.update();
+
+  buffer_repp->float_plane_acquire();
+
+  ECA_PLUGIN_WORKERS::run_instances(EFFECT_LADSPA::run_instance, 
+				    static_cast<void*>(this), 
+				    static_cast<int>(plugins_rep.size()), 
+				    &load_rep);
+}
+
+/**
+ * Runs one plugin instance and copies its scratch
+ * outputs to the chain buffer. May be called from
+ * plugin worker threads.
+ */
+void EFFECT_LADSPA::run_instance(void* arg, int instance)
+{
+  EFFECT_LADSPA* self = static_cast<EFFECT_LADSPA*>(arg);
+  SAMPLE_BUFFER::buf_size_t len = self->buffer_repp->length_in_samples();
+
+  self->plugin_desc->run(self->plugins_rep[instance], len);
+
+  const std::vector<SCRATCH_PORT>& ports = self->scratch_ports_rep[instance];
+  for(size_t n = 0; n < ports.size(); n++) {
+    if (ports[n].channel >= 0)
+      std::memcpy(self->buffer_repp->float_plane_channel(ports[n].channel), 
+		  ports[n].buffer, 
+		  len * sizeof(LADSPA_Data));
+  }
 }
@@ -5,6 +5,9 @@
 #include <string>
 
 #include "audiofx.h"
+#include "eca-parameter-block.h"
+#include "eca-plugin-cache.h"
+#include "eca-plugin-workers.h"
 
 /* prefer already installed LADSPA header over the 
  * version shipped with ecasound */
@@ -25,10 +28,11 @@ class EFFECT_LADSPA : public EFFECT_BASE {
 public:
 
   EFFECT_LADSPA (const LADSPA_Descriptor *plugin_desc = 0) throw(ECA_ERROR&);
+  EFFECT_LADSPA (const std::string& file, const ECA_PLUGIN_CACHE::PLUGIN_INFO& info);
   virtual ~EFFECT_LADSPA (void);
 
   EFFECT_LADSPA* clone(void) const;
-  EFFECT_LADSPA* new_expr(void) const { return new EFFECT_LADSPA(plugin_desc); }
+  EFFECT_LADSPA* new_expr(void) const;
 
   virtual std::string name(void) const { return(name_rep); }
   virtual std::string description(void) const;
@@ -49,11 +53,16 @@ public:
    */
   long int unique_number(void) const { return(unique_number_rep); }
 
+  void plugin_info(ECA_PLUGIN_CACHE::PLUGIN_INFO* info) const;
+
   virtual int output_channels(int i_channels) const;
 
   virtual void parameter_description(int param, struct PARAM_DESCRIPTION *pd) const;
   virtual void set_parameter(int param, parameter_t value);
   virtual parameter_t get_parameter(int param) const;
+  virtual bool thread_safe_parameters(void) const { return(true); }
+  virtual long int latency(void) const;
+  virtual bool float_plane_processing(void) const { return(true); }
 
   virtual void init(SAMPLE_BUFFER *insample);
   virtual void release(void);
@@ -66,20 +75,45 @@ public:
 
 private:
 
+  /**
+   * Audio port connected to a scratch buffer instead 
+   * of a chain buffer. Outputs with a valid 'channel' 
+   * are copied to the chain buffer after run().
+   */
+  struct SCRATCH_PORT {
+    LADSPA_Data* buffer;
+    int channel;
+  };
+
   SAMPLE_BUFFER* buffer_repp;
   
-  const LADSPA_Descriptor *plugin_desc;
+  /* note: resolved on first use for objects created 
+   *       from ECA_PLUGIN_CACHE information */
+  mutable const LADSPA_Descriptor *plugin_desc;
+  std::string plugin_file_rep;
+  int plugin_index_rep;
   std::vector<LADSPA_Handle> plugins_rep;
+  std::vector<std::vector<SCRATCH_PORT> > scratch_ports_rep;
+  long int scratch_length_rep;
+  bool inplace_broken_rep;
+  bool workers_acquired_rep;
+  ECA_PLUGIN_WORKERS::LOAD_ESTIMATE load_rep;
 
   unsigned long port_count_rep;
   int in_audio_ports;
   int out_audio_ports;
   long unique_number_rep;
   std::string name_rep, maker_rep, unique_rep, param_names_rep;
-  std::vector<LADSPA_Data> params;
+  ECA_PARAMETER_BLOCK<LADSPA_Data> params;
   std::vector<struct PARAM_DESCRIPTION> param_descs_rep;
+  int latency_param_rep;
 
+  const LADSPA_Descriptor* descriptor(void) const throw(ECA_ERROR&);
   void init_ports(void);
+  void connect_audio_port(int instance, unsigned long port, int channel, bool output);
+  void release_instances(void);
+  static void run_instance(void* arg, int instance);
+  void add_parameter(const struct PARAM_DESCRIPTION& pd);
   void parse_parameter_hint_information(int portnum, int paramnum, struct PARAM_DESCRIPTION *pd);
 };
 
@@ -0,0 +1,298 @@
+// ------------------------------------------------------------------------
+// audiofx_ladspa_test.h: Unit test for EFFECT_LADSPA
+// Copyright (C) 2026 agent
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
+// ------------------------------------------------------------------------
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include <pthread.h>
+
+#include "audiofx_ladspa.h"
+#include "eca-parameter-block.h"
+#include "eca-plugin-workers.h"
+#include "eca-scratch-pool.h"
+#include "samplebuffer.h"
+#include "eca-test-case.h"
+
+using namespace std;
+
+/**
+ * Minimal inplace-broken LADSPA plugin: clears its
+ * output before reading the input, so processing
+ * in-place would produce silence.
+ */
+struct AUDIOFX_LADSPA_TEST_PLUGIN {
+  LADSPA_Data* ports[3];
+};
+
+static LADSPA_Handle audiofx_ladspa_test_instantiate(const LADSPA_Descriptor*, unsigned long)
+{
+  return new AUDIOFX_LADSPA_TEST_PLUGIN;
+}
+
+static void audiofx_ladspa_test_connect(LADSPA_Handle h, unsigned long port, LADSPA_Data* data)
+{
+  static_cast<AUDIOFX_LADSPA_TEST_PLUGIN*>(h)->ports[port] = data;
+}
+
+static void audiofx_ladspa_test_run(LADSPA_Handle h, unsigned long samples)
+{
+  AUDIOFX_LADSPA_TEST_PLUGIN* p = static_cast<AUDIOFX_LADSPA_TEST_PLUGIN*>(h);
+  for(unsigned long n = 0; n < samples; n++)
+    p->ports[1][n] = 0.0;
+  for(unsigned long n = 0; n < samples; n++)
+    p->ports[1][n] += p->ports[0][n] * *p->ports[2];
+}
+
+/**
+ * Writer thread for the parameter block test.
+ */
+static void* audiofx_ladspa_test_block_writer(void* arg)
+{
+  ECA_PARAMETER_BLOCK<LADSPA_Data>* block = 
+    static_cast<ECA_PARAMETER_BLOCK<LADSPA_Data>*>(arg);
+  for(int n = 1; n <= 100000; n++) {
+    block->set(0, n);
+    block->set(1, -n);
+  }
+  return 0;
+}
+
+static void audiofx_ladspa_test_cleanup(LADSPA_Handle h)
+{
+  delete static_cast<AUDIOFX_LADSPA_TEST_PLUGIN*>(h);
+}
+
+static const LADSPA_PortDescriptor audiofx_ladspa_test_port_descs[] = {
+  LADSPA_PORT_INPUT | LADSPA_PORT_AUDIO,
+  LADSPA_PORT_OUTPUT | LADSPA_PORT_AUDIO,
+  LADSPA_PORT_INPUT | LADSPA_PORT_CONTROL
+};
+
+static const char* const audiofx_ladspa_test_port_names[] = {
+  "Input", "Output", "Gain"
+};
+
+static const LADSPA_PortRangeHint audiofx_ladspa_test_port_hints[] = {
+  { 0, 0, 0 },
+  { 0, 0, 0 },
+  { LADSPA_HINT_DEFAULT_1, 0, 0 }
+};
+
+static void audiofx_ladspa_test_count(void* arg, int item)
+{
+  __sync_fetch_and_add(&static_cast<int*>(arg)[item], 1);
+}
+
+/**
+ * Unit test for EFFECT_LADSPA
+ */
+class EFFECT_LADSPA_TEST : public ECA_TEST_CASE {
+
+protected:
+
+  virtual string do_name(void) const { return("EFFECT_LADSPA"); }
+  virtual void do_run(void);
+
+public:
+
+  virtual ~EFFECT_LADSPA_TEST(void) { }
+
+private:
+
+};
+
+void EFFECT_LADSPA_TEST::do_run(void)
+{
+  const int bufsize = 256;
+  const int channels = 4;
+
+  std::fprintf(stdout, "%s: tests for %s class\n",
+	       name().c_str(), __FILE__);
+
+  LADSPA_Descriptor desc;
+  desc.UniqueID = 1;
+  desc.Label = "ecatest_inplace_broken";
+  desc.Properties = LADSPA_PROPERTY_INPLACE_BROKEN;
+  desc.Name = "Inplace-broken test plugin";
+  desc.Maker = "ecasound";
+  desc.Copyright = "GPL";
+  desc.PortCount = 3;
+  desc.PortDescriptors = audiofx_ladspa_test_port_descs;
+  desc.PortNames = audiofx_ladspa_test_port_names;
+  desc.PortRangeHints = audiofx_ladspa_test_port_hints;
+  desc.ImplementationData = 0;
+  desc.instantiate = audiofx_ladspa_test_instantiate;
+  desc.connect_port = audiofx_ladspa_test_connect;
+  desc.activate = 0;
+  desc.run = audiofx_ladspa_test_run;
+  desc.run_adding = 0;
+  desc.set_run_adding_gain = 0;
+  desc.deactivate = 0;
+  desc.cleanup = audiofx_ladspa_test_cleanup;
+
+  ECA_PLUGIN_WORKERS::set_thread_count(2);
+
+  /* case: inplace-broken plugin, one instance per channel */
+  {
+    std::fprintf(stdout, "%s: inplace-broken plugin\n", __FILE__);
+
+    SAMPLE_BUFFER sbuf (bufsize, channels);
+    EFFECT_LADSPA plugin (&desc);
+    plugin.set_samples_per_second(44100);
+    plugin.init(&sbuf);
+    plugin.set_parameter(1, 2.0);
+
+    for(int round = 0; round < 3; round++) {
+      for(int ch = 0; ch < channels; ch++)
+	for(int n = 0; n < bufsize; n++)
+	  sbuf.buffer[ch][n] = 0.01 * (ch + 1);
+
+      plugin.process();
+      sbuf.float_plane_sync();
+
+      for(int ch = 0; ch < channels; ch++) {
+	SAMPLE_BUFFER::sample_t expected = static_cast<LADSPA_Data>(0.01 * (ch + 1)) * 2.0f;
+	if (sbuf.buffer[ch][0] != expected ||
+	    sbuf.buffer[ch][bufsize - 1] != expected) {
+	  ECA_TEST_FAILURE("inplace-broken plugin output");
+	  break;
+	}
+      }
+    }
+  }
+
+  /* case: parameter changes applied at block boundaries */
+  {
+    std::fprintf(stdout, "%s: parameter block\n", __FILE__);
+
+    ECA_PARAMETER_BLOCK<LADSPA_Data> block;
+    block.push_back(1.0);
+    block.push_back(5.0, true);
+
+    block.set(0, 2.0);
+    block.set(1, 7.0);
+    if (block.get(0) != 2.0 || block.active(0) != 1.0)
+      ECA_TEST_FAILURE("staged value applied too early");
+
+    if (block.update() != true ||
+	block.active(0) != 2.0 ||
+	block.active(1) != 5.0)
+      ECA_TEST_FAILURE("staged value not applied");
+
+    if (block.update() == true)
+      ECA_TEST_FAILURE("unchanged block applied");
+
+    /* note: writes racing with update() must not be lost */
+    ECA_PARAMETER_BLOCK<LADSPA_Data> shared;
+    shared.push_back(0.0);
+    shared.push_back(0.0);
+    pthread_t writer;
+    pthread_create(&writer, 0, audiofx_ladspa_test_block_writer, &shared);
+    for(int n = 0; n < 10000; n++) 
+      shared.update();
+    pthread_join(writer, 0);
+    shared.update();
+    if (shared.active(0) != 100000.0 || shared.active(1) != -100000.0)
+      ECA_TEST_FAILURE("concurrent parameter write lost");
+
+    SAMPLE_BUFFER sbuf (bufsize, channels);
+    EFFECT_LADSPA plugin (&desc);
+    plugin.set_samples_per_second(44100);
+    plugin.init(&sbuf);
+
+    for(int n = 0; n < bufsize; n++) sbuf.buffer[0][n] = 0.5;
+    plugin.set_parameter(1, 3.0);
+    if (plugin.get_parameter(1) != 3.0)
+      ECA_TEST_FAILURE("staged plugin parameter");
+    plugin.process();
+    sbuf.float_plane_sync();
+    if (sbuf.buffer[0][0] != 1.5)
+      ECA_TEST_FAILURE("plugin parameter not applied");
+  }
+
+  /* case: consecutive plugins share the float conversion */
+  {
+    std::fprintf(stdout, "%s: shared float plane\n", __FILE__);
+
+    SAMPLE_BUFFER sbuf (bufsize, 1);
+    EFFECT_LADSPA first (&desc), second (&desc);
+    first.set_samples_per_second(44100);
+    second.set_samples_per_second(44100);
+    first.init(&sbuf);
+    second.init(&sbuf);
+    first.set_parameter(1, 2.0);
+    second.set_parameter(1, 3.0);
+
+    for(int n = 0; n < bufsize; n++) sbuf.buffer[0][n] = 0.25;
+    first.process();
+    second.process();
+    if (sbuf.float_plane_current() == true &&
+	sbuf.buffer[0][0] != 0.25)
+      ECA_TEST_FAILURE("float plane converted between plugins");
+
+    sbuf.float_plane_sync();
+    if (sbuf.buffer[0][0] != 1.5 || sbuf.buffer[0][bufsize - 1] != 1.5)
+      ECA_TEST_FAILURE("shared float plane output");
+  }
+
+  /* case: scratch buffers are returned to the pool */
+  {
+    size_t before = ECA_SCRATCH_POOL::free_count();
+    {
+      SAMPLE_BUFFER sbuf (bufsize, channels);
+      EFFECT_LADSPA plugin (&desc);
+      plugin.set_samples_per_second(44100);
+      plugin.init(&sbuf);
+    }
+    if (ECA_SCRATCH_POOL::free_count() != before)
+      ECA_TEST_FAILURE("scratch buffers not reused");
+  }
+
+  /* case: running instances on worker threads */
+  {
+    std::fprintf(stdout, "%s: plugin worker threads\n", __FILE__);
+
+    ECA_PLUGIN_WORKERS::acquire();
+
+    const int items = 16;
+    int counts[items];
+    for(int round = 0; round < 10; round++) {
+      for(int n = 0; n < items; n++) counts[n] = 0;
+
+      if (ECA_PLUGIN_WORKERS::run(audiofx_ladspa_test_count, counts, items) != true) {
+	ECA_TEST_FAILURE("worker threads not available");
+	break;
+      }
+      for(int n = 0; n < items; n++) {
+	if (counts[n] != 1) {
+	  ECA_TEST_FAILURE("instance not run exactly once");
+	  break;
+	}
+      }
+    }
+
+    ECA_PLUGIN_WORKERS::release();
+
+    if (ECA_PLUGIN_WORKERS::run(audiofx_ladspa_test_count, counts, items) == true)
+      ECA_TEST_FAILURE("worker threads not stopped");
+  }
+
+  ECA_PLUGIN_WORKERS::set_thread_count(0);
+}
@@ -2,6 +2,7 @@
 // audiofx_lv2.cpp: Wrapper class for LV2 plugins
 // Copyright (C) 2011 Jeremy Salwen
 // Copyright (C) 2000-2004, 2011,2014 Kai Vehmanen
+// Copyright (C) 2026 agent
 //
 // Attributes:
 //     eca-style-version: 3
@@ -27,22 +28,23 @@
 
 #if ECA_USE_LIBLILV
 
+#include <cstring> /* memcpy() */
 #include <dlfcn.h>
+#include <lv2/lv2plug.in/ns/ext/state/state.h>
 #include <kvu_utils.h>
 #include <kvu_dbc.h>
+#include <kvu_locks.h>
 #include <kvu_numtostr.h>
 #include "samplebuffer.h"
 #include "audiofx_lv2.h"
 #include "audiofx_lv2_world.h"
 #include "eca-error.h"
 #include "eca-logger.h"
+#include "eca-scratch-pool.h"
 
 EFFECT_LV2::EFFECT_LV2 (Lilv::Plugin pdesc) throw(ECA_ERROR&) :plugin_desc(pdesc) 
 {
-  bool inplacebroken=plugin_desc.has_feature(ECA_LV2_WORLD::InPlaceBrokenNode());
-  if (inplacebroken) {
-    throw(ECA_ERROR("AUDIOFX_LV2", "Inplace-broken plugins not supported."));
-  }
+  inplace_broken_rep = plugin_desc.has_feature(ECA_LV2_WORLD::InPlaceBrokenNode());
   /* FIXME: strip linefeeds and other forbidden characters; write down to
    *        to ECA_OBJECT docs what chars are allowed and what are not... */
   Lilv::Node name(plugin_desc.get_name());
@@ -55,20 +57,51 @@ EFFECT_LV2::EFFECT_LV2 (Lilv::Plugin pdesc) throw(ECA_ERROR&) :plugin_desc(pdesc
     maker_rep = string();
   }
   buffer_repp = 0;
+  state_repp = 0;
+  scratch_length_rep = 0;
+  workers_acquired_rep = false;
+  latency_param_rep = -1;
+  pthread_mutex_init(&run_lock_rep, 0);
   init_ports();
 }
 
+/**
+ * Creates a plugin object from cached information, without
+ * loading LV2 bundle data. The bundles are loaded when 
+ * the first real instance is created with new_expr() 
+ * or clone().
+ *
+ * @see ECA_PLUGIN_CACHE
+ */
+EFFECT_LV2::EFFECT_LV2 (const ECA_PLUGIN_CACHE::PLUGIN_INFO& info)
+  : plugin_desc(static_cast<const LilvPlugin*>(0))
+{
+  name_rep = info.name;
+  unique_rep = info.unique;
+  maker_rep = info.maker;
+  buffer_repp = 0;
+  state_repp = 0;
+  scratch_length_rep = 0;
+  inplace_broken_rep = false;
+  workers_acquired_rep = false;
+  latency_param_rep = -1;
+  pthread_mutex_init(&run_lock_rep, 0);
+
+  port_count_rep = 0;
+  in_audio_ports = info.in_audio_ports;
+  out_audio_ports = info.out_audio_ports;
+  for(size_t n = 0; n < info.params.size(); n++) {
+    add_parameter(info.params[n]);
+  }
+}
+
 EFFECT_LV2::~EFFECT_LV2 (void)
 {
   release();
-
-  if (plugin_desc != 0) {
-    for(unsigned int n = 0; n < plugins_rep.size(); n++) {
-      lilv_instance_deactivate(plugins_rep[n]->me);
-      lilv_instance_free(plugins_rep[n]->me);
-      delete plugins_rep[n];
-    }
-  }
+  release_instances();
+  if (state_repp != 0)
+    lilv_state_free(state_repp);
+  pthread_mutex_destroy(&run_lock_rep);
 }
 
 std::string EFFECT_LV2::description(void) const
@@ -83,15 +116,76 @@ void EFFECT_LV2::parameter_description(int param, struct PARAM_DESCRIPTION *pd)
   *pd = param_descs_rep[param - 1];
 }
 
+EFFECT_LV2* EFFECT_LV2::new_expr(void) const
+{
+  return new EFFECT_LV2(descriptor());
+}
+
+/**
+ * Creates a copy with the same parameters and plugin
+ * state. May be called while the engine is running 
+ * the original object.
+ *
+ * Not realtime-safe.
+ */
 EFFECT_LV2* EFFECT_LV2::clone(void) const
 {
-  EFFECT_LV2* result = new EFFECT_LV2(plugin_desc);
+  EFFECT_LV2* result = new EFFECT_LV2(descriptor());
   for(int n = 0; n < number_of_params(); n++) {
     result->set_parameter(n + 1, get_parameter(n + 1));
   }
+
+  /* note: LV2 state must not be saved while run() is in
+   *       progress; process() skips blocks while the 
+   *       lock is held, so waiting here is bounded by
+   *       one run() */
+  {
+    KVU_GUARD_LOCK guard(&run_lock_rep);
+    result->state_repp = save_state();
+  }
   return result;
 }
 
+/**
+ * Returns the plugin, loading LV2 bundle data if the
+ * object was created from cached information.
+ */
+Lilv::Plugin EFFECT_LV2::descriptor(void) const throw(ECA_ERROR&)
+{
+  if (plugin_desc == 0) {
+    const LilvPlugin* p = ECA_LV2_WORLD::PluginByURI(unique_rep);
+    if (p == 0)
+      throw(ECA_ERROR("AUDIOFX_LV2", "Unable to load plugin \"" + unique_rep + "\"."));
+    plugin_desc = Lilv::Plugin(p);
+  }
+  return plugin_desc;
+}
+
+/**
+ * Fills 'info' with information needed to recreate
+ * this plugin type from ECA_PLUGIN_CACHE.
+ */
+void EFFECT_LV2::plugin_info(ECA_PLUGIN_CACHE::PLUGIN_INFO* info) const
+{
+  info->index = -1;
+  info->unique_number = 0;
+  info->unique = unique_rep;
+  info->name = name_rep;
+  info->maker = maker_rep;
+  info->in_audio_ports = in_audio_ports;
+  info->out_audio_ports = out_audio_ports;
+  info->params = param_descs_rep;
+}
+
+void EFFECT_LV2::add_parameter(const struct PARAM_DESCRIPTION& pd)
+{
+  params.push_back(pd.default_value, pd.output);
+  param_descs_rep.push_back(pd);
+  if (params.size() > 1) param_names_rep += ",";
+  string tmp (kvu_string_search_and_replace(pd.description, ",", "\\,"));
+  param_names_rep += kvu_string_search_and_replace(tmp, ":", "\\:");
+}
+
 void EFFECT_LV2::init_ports(void) throw(ECA_ERROR&)
 {
   // note: run from plugin constructor
@@ -111,11 +205,10 @@ void EFFECT_LV2::init_ports(void) throw(ECA_ERROR&)
     } else if (port.is_a(ECA_LV2_WORLD::ControlClassNode())) {
       struct PARAM_DESCRIPTION pd;
       parse_parameter_hint_information(plugin_desc,port, &pd);
-      params.push_back(pd.default_value);
-      param_descs_rep.push_back(pd);
-      if (params.size() > 1) param_names_rep += ",";
-      string tmp (kvu_string_search_and_replace(string(pd.description), ",", "\\,"));
-      param_names_rep += kvu_string_search_and_replace(tmp, ":", "\\:");
+      if (pd.output == true &&
+          port.has_property(ECA_LV2_WORLD::PortReportsLatencyNode()))
+        latency_param_rep = params.size();
+      add_parameter(pd);
     } else if(!port.has_property(ECA_LV2_WORLD::PortConnectionOptionalNode())){
       throw(ECA_ERROR("AUDIOFX_LV2", "Plugin has required ports which are not audio or control ports."));
     }
@@ -231,19 +324,34 @@ void EFFECT_LV2::set_parameter(int param, CHAIN_OPERATOR::parameter_t value)
 {
   if (param > 0 && (param - 1 < static_cast<int>(params.size()))) {
     //  cerr << "lv2: setting param " << param << " to " << value << "." << endl;
-    params[param - 1] = value;
+    params.set(param - 1, value);
   }
 }
 
 CHAIN_OPERATOR::parameter_t EFFECT_LV2::get_parameter(int param) const
 {
   if (param > 0 && (param - 1 < static_cast<int>(params.size()))) {
-    //  cerr << "lv2: getting param " << param << " with value " << params[param - 1] << "." << endl;
-    return(params[param - 1]);
+    /* note: output ports are written by the plugin */
+    if (param_descs_rep[param - 1].output == true)
+      return(params.active(param - 1));
+    return(params.get(param - 1));
   }
   return(0.0);
 }
 
+/**
+ * Plugins report their latency through an output
+ * control port with the lv2:reportsLatency property.
+ */
+long int EFFECT_LV2::latency(void) const
+{
+  if (latency_param_rep < 0)
+    return 0;
+
+  float value = params.active(latency_param_rep);
+  return (value > 0) ? static_cast<long int>(value) : 0;
+}
+
 int EFFECT_LV2::output_channels(int i_channels) const
 {
   // note: We have two separate cases: either one plugin
@@ -271,34 +379,43 @@ void EFFECT_LV2::init(SAMPLE_BUFFER *insample)
     buffer_repp->get_pointer_reflock();
   }
 
-  if (plugin_desc != 0) {
-    for(unsigned int n = 0; n < plugins_rep.size(); n++) {
-      lilv_instance_deactivate(plugins_rep[n]->me);
-      lilv_instance_free(plugins_rep[n]->me);
-      delete plugins_rep[n];
-    }
-    plugins_rep.clear();
+  /* note: keep state of the old instances */
+  LilvState* state = save_state();
+  if (state != 0) {
+    if (state_repp != 0)
+      lilv_state_free(state_repp);
+    state_repp = state;
   }
+
+  release_instances();
   DBC_CHECK(plugins_rep.size() == 0);
 
+  /* note: scratch buffers cover the whole reserved length,
+   *       so chain buffer length can change after init() */
+  scratch_length_rep = buffer_repp->reserved_length_in_samples();
+  if (scratch_length_rep < 1)
+    scratch_length_rep = 1;
+
+  /* note: LV2 audio ports are float, so they are connected 
+   *       to the buffer's single precision plane */
+  buffer_repp->float_plane_reserve(channels());
+
   if (in_audio_ports > 1 ||
       out_audio_ports > 1) {
     //Just insert into the first location
-    plugins_rep.push_back(Lilv::Instance::create(plugin_desc,samples_per_second(),NULL));
+    if (instantiate() != true)
+      return;
+    scratch_ports_rep.resize(1);
     int inport = 0;
     int outport = 0;
     for(unsigned long m = 0; m < port_count_rep; m++) {
       Lilv::Port p= plugin_desc.get_port_by_index(m);
       if (p.is_a(ECA_LV2_WORLD::AudioClassNode())) {
         if (p.is_a(ECA_LV2_WORLD::InputClassNode())) {
-          if (inport < channels()) {
-            plugins_rep[0]->connect_port(m, buffer_repp->buffer[inport]);
-          }
+          connect_audio_port(0, m, inport, false);
           ++inport;
         } else if(p.is_a(ECA_LV2_WORLD::OutputClassNode())) {
-          if (outport < channels()) {
-            plugins_rep[0]->connect_port(m, buffer_repp->buffer[outport]);
-          }
+          connect_audio_port(0, m, outport, true);
           ++outport;
         }
       }
@@ -313,17 +430,30 @@ void EFFECT_LV2::init(SAMPLE_BUFFER *insample)
                   "WARNING: chain has less channels than plugin has output ports ("
                   + name() + ").");
   } else {
+    scratch_ports_rep.resize(channels());
     for(int n = 0; n < channels(); n++) {
-      plugins_rep.push_back(Lilv::Instance::create(plugin_desc,samples_per_second(),NULL));
+      if (instantiate() != true) {
+        release_instances();
+        return;
+      }
       for(unsigned long m = 0; m < port_count_rep; m++) {
         Lilv::Port p= plugin_desc.get_port_by_index(m);
         if (p.is_a(ECA_LV2_WORLD::AudioClassNode())) {
-          plugins_rep[n]->connect_port(m,buffer_repp->buffer[n]);
+          connect_audio_port(n, m, n, p.is_a(ECA_LV2_WORLD::OutputClassNode()));
         }
       }
     }
+
+    if (plugins_rep.size() > 1) {
+      ECA_PLUGIN_WORKERS::acquire();
+      workers_acquired_rep = true;
+    }
   }
 
+  if (inplace_broken_rep == true)
+    ECA_LOG_MSG(ECA_LOGGER::system_objects,
+                "Plugin " + name() + " is inplace-broken, using separate output buffers.");
+
   ECA_LOG_MSG(ECA_LOGGER::system_objects,
               "Instantiated " +
               kvu_numtostr(plugins_rep.size()) +
@@ -342,11 +472,14 @@ void EFFECT_LV2::init(SAMPLE_BUFFER *insample)
     Lilv::Port p=plugin_desc.get_port_by_index(m);
     if (p.is_a(ECA_LV2_WORLD::ControlClassNode())) {
       for(unsigned int n = 0; n < plugins_rep.size(); n++) {
-        plugins_rep[n]->connect_port(m,&(params[data_index]));
+        plugins_rep[n]->connect_port(m,params.port(data_index));
       }
       ++data_index;
     }
   }
+
+  restore_state();
+
   for(unsigned long m = 0; m < plugins_rep.size(); m++)
     plugins_rep[m]->activate();
 
@@ -360,10 +493,197 @@ void EFFECT_LV2::release(void)
   buffer_repp = 0;
 }
 
+/**
+ * Creates a new plugin instance and a worker for it.
+ * Returns false if the plugin could not be instantiated.
+ */
+bool EFFECT_LV2::instantiate(void)
+{
+  ECA_LV2_WORKER* worker = new ECA_LV2_WORKER();
+
+  std::vector<LV2_Feature*> features;
+  features.push_back(ECA_LV2_WORLD::URIDMapFeature());
+  features.push_back(ECA_LV2_WORLD::URIDUnmapFeature());
+  features.push_back(worker->schedule_feature());
+  features.push_back(0);
+
+  Lilv::Instance* instance = Lilv::Instance::create(plugin_desc, samples_per_second(), &features[0]);
+  if (instance == 0) {
+    ECA_LOG_MSG(ECA_LOGGER::info,
+                "ERROR: Unable to instantiate LV2 plugin " + name() + ".");
+    delete worker;
+    return false;
+  }
+
+  worker->attach(instance->me);
+  plugins_rep.push_back(instance);
+  workers_rep.push_back(worker);
+  return true;
+}
+
+/**
+ * Returns a copy of the state of the first plugin
+ * instance, or 0 if the plugin does not implement 
+ * the state extension. Control port values are not
+ * included, as they are stored as parameters.
+ *
+ * Not realtime-safe.
+ */
+LilvState* EFFECT_LV2::save_state(void) const
+{
+  if (plugins_rep.size() == 0 ||
+      lilv_instance_get_extension_data(plugins_rep[0]->me, LV2_STATE__interface) == 0)
+    return 0;
+
+  const LV2_Feature* features[] = {
+    ECA_LV2_WORLD::URIDMapFeature(),
+    ECA_LV2_WORLD::URIDUnmapFeature(),
+    0
+  };
+
+  return lilv_state_new_from_instance(plugin_desc.me, 
+                                      plugins_rep[0]->me,
+                                      ECA_LV2_WORLD::URIDMap(),
+                                      0, 0, 0, 0,
+                                      0, 0,
+                                      LV2_STATE_IS_POD | LV2_STATE_IS_PORTABLE,
+                                      features);
+}
+
+/**
+ * Restores saved state to all plugin instances. If no
+ * state has been saved, the plugin's default state, if
+ * any, is loaded. Work scheduled by the plugin while 
+ * restoring is done synchronously, so that resources 
+ * are loaded before processing starts.
+ *
+ * Not realtime-safe. Must be called before the 
+ * instances are activated.
+ */
+void EFFECT_LV2::restore_state(void)
+{
+  if (plugins_rep.size() == 0 ||
+      lilv_instance_get_extension_data(plugins_rep[0]->me, LV2_STATE__interface) == 0)
+    return;
+
+  if (state_repp == 0)
+    state_repp = lilv_state_new_from_world(ECA_LV2_WORLD::World(),
+                                           ECA_LV2_WORLD::URIDMap(),
+                                           lilv_plugin_get_uri(plugin_desc.me));
+  if (state_repp == 0)
+    return;
+
+  for(size_t n = 0; n < plugins_rep.size(); n++) {
+    const LV2_Feature* features[] = {
+      ECA_LV2_WORLD::URIDMapFeature(),
+      ECA_LV2_WORLD::URIDUnmapFeature(),
+      workers_rep[n]->schedule_feature(),
+      0
+    };
+
+    workers_rep[n]->set_synchronous(true);
+    lilv_state_restore(state_repp, plugins_rep[n]->me, 0, 0, 0, features);
+    workers_rep[n]->set_synchronous(false);
+  }
+
+  ECA_LOG_MSG(ECA_LOGGER::system_objects,
+              "Restored state of LV2 plugin " + name() + ".");
+}
+
+/**
+ * Connects audio 'port' of plugin 'instance' to chain 
+ * channel 'channel'. A scratch buffer is used instead
+ * if the channel does not exist, or if the port is an
+ * output of an inplace-broken plugin.
+ */
+void EFFECT_LV2::connect_audio_port(int instance, unsigned long port, int channel, bool output)
+{
+  if (channel < channels() &&
+      (output != true || inplace_broken_rep != true)) {
+    plugins_rep[instance]->connect_port(port, buffer_repp->float_plane_channel(channel));
+  }
+  else {
+    /* note: sample_t is at least as wide as float */
+    SCRATCH_PORT sp;
+    sp.buffer = reinterpret_cast<float*>(ECA_SCRATCH_POOL::acquire(scratch_length_rep));
+    sp.channel = (output == true && channel < channels()) ? channel : -1;
+    plugins_rep[instance]->connect_port(port, sp.buffer);
+    scratch_ports_rep[instance].push_back(sp);
+  }
+}
+
+/**
+ * Frees all plugin instances and returns their 
+ * scratch buffers to the pool.
+ */
+void EFFECT_LV2::release_instances(void)
+{
+  if (plugin_desc != 0) {
+    for(unsigned int n = 0; n < plugins_rep.size(); n++) {
+      /* note: waits for pending work() calls to finish */
+      delete workers_rep[n];
+      lilv_instance_deactivate(plugins_rep[n]->me);
+      lilv_instance_free(plugins_rep[n]->me);
+      delete plugins_rep[n];
+    }
+  }
+  plugins_rep.clear();
+  workers_rep.clear();
+
+  for(size_t n = 0; n < scratch_ports_rep.size(); n++) {
+    for(size_t m = 0; m < scratch_ports_rep[n].size(); m++) {
+      ECA_SCRATCH_POOL::release(reinterpret_cast<SAMPLE_SPECS::sample_t*>(scratch_ports_rep[n][m].buffer), 
+                                scratch_length_rep);
+    }
+  }
+  scratch_ports_rep.clear();
+
+  if (workers_acquired_rep == true) {
+    ECA_PLUGIN_WORKERS::release();
+    workers_acquired_rep = false;
+  }
+}
+
 void EFFECT_LV2::process(void)
 {
-  for(unsigned long m = 0; m < plugins_rep.size(); m++)
-    lilv_instance_run(plugins_rep[m]->me, buffer_repp->length_in_samples());
+  /* note: clone() is saving plugin state; rather than 
+   *       wait, the block is passed through unprocessed */
+  if (pthread_mutex_trylock(&run_lock_rep) != 0)
+    return;
+
+  /* note: control values set since the previous block */
+  params.update();
+
+  buffer_repp->float_plane_acquire();
+
+  ECA_PLUGIN_WORKERS::run_instances(EFFECT_LV2::run_instance, 
+                                    static_cast<void*>(this), 
+                                    static_cast<int>(plugins_rep.size()), 
+                                    &load_rep);
+
+  pthread_mutex_unlock(&run_lock_rep);
+}
+
+/**
+ * Runs one plugin instance and copies its scratch
+ * outputs to the chain buffer. May be called from
+ * plugin worker threads.
+ */
+void EFFECT_LV2::run_instance(void* arg, int instance)
+{
+  EFFECT_LV2* self = static_cast<EFFECT_LV2*>(arg);
+  SAMPLE_BUFFER::buf_size_t len = self->buffer_repp->length_in_samples();
+
+  lilv_instance_run(self->plugins_rep[instance]->me, len);
+  self->workers_rep[instance]->deliver_responses();
+
+  const std::vector<SCRATCH_PORT>& ports = self->scratch_ports_rep[instance];
+  for(size_t n = 0; n < ports.size(); n++) {
+    if (ports[n].channel >= 0)
+      std::memcpy(self->buffer_repp->float_plane_channel(ports[n].channel), 
+                  ports[n].buffer, 
+                  len * sizeof(float));
+  }
 }
 
 #endif /* ECA_USE_LIBLILV */
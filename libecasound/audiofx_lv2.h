@@ -3,17 +3,29 @@
 
 #include <vector>
 #include <string>
+#include <pthread.h>
 
 #include "audiofx.h"
+#include "eca-parameter-block.h"
+#include "eca-plugin-cache.h"
+#include "eca-plugin-workers.h"
 
 #if ECA_USE_LIBLILV
 
 #include <lilv/lilvmm.hpp>
 
+#include "audiofx_lv2_worker.h"
+
 class SAMPLE_BUFFER;
 
 /**
  * Wrapper class for LV2 plugins
+ *
+ * Plugins are given the urid:map, urid:unmap and 
+ * work:schedule features. Plugins implementing the
+ * state extension keep their state, such as loaded 
+ * files, when the object is cloned or reinitialized.
+ *
  * @author Jeremy Salwen
  */
 class EFFECT_LV2 : public EFFECT_BASE {
@@ -21,10 +33,11 @@ class EFFECT_LV2 : public EFFECT_BASE {
 public:
 
   EFFECT_LV2 (Lilv::Plugin plugin_d) throw(ECA_ERROR&);
+  EFFECT_LV2 (const ECA_PLUGIN_CACHE::PLUGIN_INFO& info);
   virtual ~EFFECT_LV2(void);
 
   EFFECT_LV2* clone(void) const;
-  EFFECT_LV2* new_expr(void) const { return new EFFECT_LV2(plugin_desc); }
+  EFFECT_LV2* new_expr(void) const;
 
   virtual std::string name(void) const { return(name_rep); }
   virtual std::string description(void) const;
@@ -37,11 +50,16 @@ public:
    */
   std::string unique(void) const { return(unique_rep); }
 
+  void plugin_info(ECA_PLUGIN_CACHE::PLUGIN_INFO* info) const;
+
   virtual int output_channels(int i_channels) const;
 
   virtual void parameter_description(int param, struct PARAM_DESCRIPTION *pd) const;
   virtual void set_parameter(int param, parameter_t value);
   virtual parameter_t get_parameter(int param) const;
+  virtual bool thread_safe_parameters(void) const { return(true); }
+  virtual long int latency(void) const;
+  virtual bool float_plane_processing(void) const { return(true); }
 
   virtual void init(SAMPLE_BUFFER *insample);
   virtual void release(void);
@@ -54,19 +72,48 @@ public:
 
 private:
 
+  /**
+   * Audio port connected to a scratch buffer instead 
+   * of a chain buffer. Outputs with a valid 'channel' 
+   * are copied to the chain buffer after run().
+   */
+  struct SCRATCH_PORT {
+    float* buffer;
+    int channel;
+  };
+
   SAMPLE_BUFFER* buffer_repp;
   
-  Lilv::Plugin plugin_desc;
+  /* note: resolved on first use for objects created 
+   *       from ECA_PLUGIN_CACHE information */
+  mutable Lilv::Plugin plugin_desc;
   std::vector<Lilv::Instance*> plugins_rep;
+  std::vector<ECA_LV2_WORKER*> workers_rep;
+  LilvState* state_repp;
+  std::vector<std::vector<SCRATCH_PORT> > scratch_ports_rep;
+  long int scratch_length_rep;
+  bool inplace_broken_rep;
+  bool workers_acquired_rep;
+  ECA_PLUGIN_WORKERS::LOAD_ESTIMATE load_rep;
+  mutable pthread_mutex_t run_lock_rep;
 
   unsigned long port_count_rep;
   int in_audio_ports;
   int out_audio_ports;
   std::string name_rep, maker_rep, unique_rep, param_names_rep;
-  std::vector<float> params;
+  ECA_PARAMETER_BLOCK<float> params;
   std::vector<struct PARAM_DESCRIPTION> param_descs_rep;
+  int latency_param_rep;
 
+  Lilv::Plugin descriptor(void) const throw(ECA_ERROR&);
   void init_ports(void) throw(ECA_ERROR&);
+  bool instantiate(void);
+  LilvState* save_state(void) const;
+  void restore_state(void);
+  void connect_audio_port(int instance, unsigned long port, int channel, bool output);
+  void release_instances(void);
+  static void run_instance(void* arg, int instance);
+  void add_parameter(const struct PARAM_DESCRIPTION& pd);
   void parse_parameter_hint_information(const Lilv::Plugin  plugin, Lilv::Port p, struct PARAM_DESCRIPTION *pd);
 };
 
@@ -0,0 +1,357 @@
+// ------------------------------------------------------------------------
+// audiofx_lv2_worker.cpp: Host for the LV2 worker extension
+// Copyright (C) 2026 agent
+//
+// Attributes:
+//     eca-style-version: 3
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
+// ------------------------------------------------------------------------
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#if ECA_USE_LIBLILV
+
+#include <algorithm> /* find() */
+#include <cstdlib> /* atoi() */
+#include <sched.h>
+
+#include <kvu_dbc.h>
+#include <kvu_locks.h>
+#include <kvu_numtostr.h>
+#include <kvu_utils.h>
+
+#include "audiofx_lv2_worker.h"
+#include "eca-resources.h"
+#include "eca-logger.h"
+#include "eca-thread-affinity.h"
+
+const size_t ECA_LV2_WORKER::fifo_size = 8192;
+
+pthread_mutex_t ECA_LV2_WORKER::users_lock_rep = PTHREAD_MUTEX_INITIALIZER;
+pthread_mutex_t ECA_LV2_WORKER::list_lock_rep = PTHREAD_MUTEX_INITIALIZER;
+std::vector<ECA_LV2_WORKER*> ECA_LV2_WORKER::users_rep;
+std::vector<pthread_t> ECA_LV2_WORKER::threads_rep;
+sem_t ECA_LV2_WORKER::wakeup_sem_rep;
+volatile bool ECA_LV2_WORKER::exit_rep = false;
+int ECA_LV2_WORKER::thread_count_rep = 1;
+bool ECA_LV2_WORKER::thread_count_set_rep = false;
+
+ECA_LV2_WORKER::ECA_LV2_WORKER(void)
+  : requests_rep(fifo_size),
+    responses_rep(fifo_size),
+    request_buffer_rep(fifo_size),
+    response_buffer_rep(fifo_size),
+    handle_rep(0),
+    iface_repp(0),
+    synchronous_rep(false),
+    busy_rep(0)
+{
+  schedule_rep.handle = static_cast<LV2_Worker_Schedule_Handle>(this);
+  schedule_rep.schedule_work = ECA_LV2_WORKER::schedule_work;
+  schedule_feature_rep.URI = LV2_WORKER__schedule;
+  schedule_feature_rep.data = &schedule_rep;
+}
+
+/**
+ * Waits until pending work of this instance is done.
+ * Must be called before the plugin instance is freed.
+ */
+ECA_LV2_WORKER::~ECA_LV2_WORKER(void)
+{
+  if (iface_repp == 0)
+    return;
+
+  KVU_GUARD_LOCK guard(&ECA_LV2_WORKER::users_lock_rep);
+
+  pthread_mutex_lock(&list_lock_rep);
+  users_rep.erase(std::find(users_rep.begin(), users_rep.end(), this));
+  pthread_mutex_unlock(&list_lock_rep);
+
+  /* note: no new work can be started once removed
+   *       from the list, but work() may be running */
+  while(__sync_fetch_and_add(&busy_rep, 0) != 0)
+    kvu_sleep(0, 1000000);
+
+  if (users_rep.size() == 0)
+    stop_threads();
+}
+
+/**
+ * Connects the worker to a plugin instance created with
+ * schedule_feature(). Does nothing if the plugin does
+ * not implement the worker interface.
+ *
+ * Not realtime-safe.
+ */
+void ECA_LV2_WORKER::attach(LilvInstance* instance)
+{
+  DBC_REQUIRE(iface_repp == 0);
+
+  const LV2_Worker_Interface* iface =
+    static_cast<const LV2_Worker_Interface*>(lilv_instance_get_extension_data(instance, LV2_WORKER__interface));
+  if (iface == 0 || iface->work == 0)
+    return;
+
+  KVU_GUARD_LOCK guard(&ECA_LV2_WORKER::users_lock_rep);
+
+  if (users_rep.size() == 0)
+    start_threads();
+  if (threads_rep.size() == 0)
+    return;
+
+  handle_rep = lilv_instance_get_handle(instance);
+  iface_repp = iface;
+
+  pthread_mutex_lock(&list_lock_rep);
+  users_rep.push_back(this);
+  pthread_mutex_unlock(&list_lock_rep);
+}
+
+/**
+ * Delivers responses from finished work to the plugin,
+ * and notifies the plugin that the cycle is complete.
+ * To be called after each run() of the instance.
+ *
+ * Realtime-safe.
+ */
+void ECA_LV2_WORKER::deliver_responses(void)
+{
+  if (iface_repp == 0)
+    return;
+
+  uint32_t size;
+  while(read_message(&responses_rep, &response_buffer_rep, &size) == true) {
+    if (iface_repp->work_response != 0)
+      iface_repp->work_response(handle_rep, size, &response_buffer_rep[0]);
+  }
+
+  if (iface_repp->end_run != 0)
+    iface_repp->end_run(handle_rep);
+}
+
+/**
+ * Number of pool threads used when the pool is
+ * started. Unless set with set_thread_count(), the
+ * value is read from ecasoundrc.
+ */
+int ECA_LV2_WORKER::thread_count(void)
+{
+  if (thread_count_set_rep != true) {
+    ECA_RESOURCES ecarc;
+    set_thread_count(std::atoi(ecarc.resource("lv2-worker-threads").c_str()));
+  }
+  return thread_count_rep;
+}
+
+/**
+ * Sets the number of pool threads. At least one
+ * thread is always used. Takes effect the next time
+ * the pool is started.
+ */
+void ECA_LV2_WORKER::set_thread_count(int threads)
+{
+  thread_count_rep = (threads > 0) ? threads : 1;
+  thread_count_set_rep = true;
+}
+
+/**
+ * Called by the plugin, normally from run(), to
+ * request work.
+ *
+ * Realtime-safe, except in synchronous mode, where
+ * the work is done before returning.
+ */
+LV2_Worker_Status ECA_LV2_WORKER::schedule_work(LV2_Worker_Schedule_Handle handle, uint32_t size, const void* data)
+{
+  ECA_LV2_WORKER* self = static_cast<ECA_LV2_WORKER*>(handle);
+
+  if (self->iface_repp == 0)
+    return LV2_WORKER_ERR_UNKNOWN;
+
+  if (self->synchronous_rep == true)
+    return self->iface_repp->work(self->handle_rep,
+				  ECA_LV2_WORKER::respond,
+				  static_cast<LV2_Worker_Respond_Handle>(self),
+				  size, data);
+
+  if (write_message(&self->requests_rep, size, data) != true)
+    return LV2_WORKER_ERR_NO_SPACE;
+
+  sem_post(&wakeup_sem_rep);
+  return LV2_WORKER_SUCCESS;
+}
+
+/**
+ * Called by the plugin from work() to pass a response
+ * back to the instance.
+ */
+LV2_Worker_Status ECA_LV2_WORKER::respond(LV2_Worker_Respond_Handle handle, uint32_t size, const void* data)
+{
+  ECA_LV2_WORKER* self = static_cast<ECA_LV2_WORKER*>(handle);
+
+  if (write_message(&self->responses_rep, size, data) != true)
+    return LV2_WORKER_ERR_NO_SPACE;
+
+  return LV2_WORKER_SUCCESS;
+}
+
+/**
+ * Writes a message as a size header followed by the
+ * payload. Either all of it is written, or nothing.
+ */
+bool ECA_LV2_WORKER::write_message(KVU_RINGBUFFER* fifo, uint32_t size, const void* data)
+{
+  if (fifo->write_space() < sizeof(size) + size)
+    return false;
+
+  /* note: only one writer, so the payload always fits
+   *       after the header */
+  fifo->write(&size, sizeof(size));
+  fifo->write(data, size);
+  return true;
+}
+
+/**
+ * Reads one complete message to 'buffer'. Returns false
+ * if no complete message is available.
+ */
+bool ECA_LV2_WORKER::read_message(KVU_RINGBUFFER* fifo, std::vector<char>* buffer, uint32_t* size)
+{
+  if (fifo->peek(size, sizeof(*size)) != true ||
+      fifo->read_space() < sizeof(*size) + *size)
+    return false;
+
+  DBC_CHECK(*size <= buffer->size());
+
+  fifo->read(0, sizeof(*size));
+  fifo->read(&(*buffer)[0], *size);
+  return true;
+}
+
+/**
+ * Handles all queued requests. Run in pool threads.
+ */
+void ECA_LV2_WORKER::do_work(void)
+{
+  uint32_t size;
+  while(read_message(&requests_rep, &request_buffer_rep, &size) == true) {
+    iface_repp->work(handle_rep,
+		     ECA_LV2_WORKER::respond,
+		     static_cast<LV2_Worker_Respond_Handle>(this),
+		     size, &request_buffer_rep[0]);
+  }
+}
+
+/**
+ * Claims one instance with queued requests and
+ * handles them. Returns false if there was nothing
+ * to do.
+ */
+bool ECA_LV2_WORKER::run_pending(void)
+{
+  ECA_LV2_WORKER* worker = 0;
+
+  pthread_mutex_lock(&list_lock_rep);
+  for(size_t n = 0; n < users_rep.size(); n++) {
+    if (users_rep[n]->requests_rep.read_space() > 0 &&
+	__sync_bool_compare_and_swap(&users_rep[n]->busy_rep, 0, 1) == true) {
+      worker = users_rep[n];
+      break;
+    }
+  }
+  pthread_mutex_unlock(&list_lock_rep);
+
+  if (worker == 0)
+    return false;
+
+  worker->do_work();
+  __sync_bool_compare_and_swap(&worker->busy_rep, 1, 0);
+  return true;
+}
+
+/**
+ * Main loop of pool threads.
+ */
+void* ECA_LV2_WORKER::pool_thread(void* arg)
+{
+  /* note: threads are created from the engine setup
+   *       code, which may be running with realtime
+   *       priority */
+  struct sched_param param;
+  param.sched_priority = 0;
+  pthread_setschedparam(pthread_self(), SCHED_OTHER, &param);
+  ECA_THREAD_AFFINITY::apply("worker");
+
+  while(true) {
+    if (sem_wait(&wakeup_sem_rep) != 0) continue; /* EINTR */
+    if (exit_rep == true) break;
+
+    while(run_pending() == true)
+      ;
+  }
+
+  return 0;
+}
+
+void ECA_LV2_WORKER::start_threads(void)
+{
+  DBC_CHECK(threads_rep.size() == 0);
+
+  int threads = thread_count();
+
+  sem_init(&wakeup_sem_rep, 0, 0);
+  exit_rep = false;
+  for(int n = 0; n < threads; n++) {
+    pthread_t thread;
+    if (pthread_create(&thread, 0, pool_thread, 0) != 0) {
+      ECA_LOG_MSG(ECA_LOGGER::info,
+		  "WARNING: Unable to create LV2 worker thread, using " +
+		  kvu_numtostr(n) + " threads.");
+      break;
+    }
+    threads_rep.push_back(thread);
+  }
+
+  if (threads_rep.size() == 0) {
+    sem_destroy(&wakeup_sem_rep);
+    return;
+  }
+
+  ECA_LOG_MSG(ECA_LOGGER::system_objects,
+	      "started " + kvu_numtostr(threads_rep.size()) + " LV2 worker threads");
+}
+
+void ECA_LV2_WORKER::stop_threads(void)
+{
+  if (threads_rep.size() == 0)
+    return;
+
+  exit_rep = true;
+  __sync_synchronize();
+
+  for(size_t n = 0; n < threads_rep.size(); n++) {
+    sem_post(&wakeup_sem_rep);
+  }
+  for(size_t n = 0; n < threads_rep.size(); n++) {
+    pthread_join(threads_rep[n], 0);
+  }
+  sem_destroy(&wakeup_sem_rep);
+  threads_rep.clear();
+}
+
+#endif /* ECA_USE_LIBLILV */
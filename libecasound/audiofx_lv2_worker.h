@@ -0,0 +1,105 @@
+#ifndef INCLUDED_AUDIOFX_LV2_WORKER_H
+#define INCLUDED_AUDIOFX_LV2_WORKER_H
+
+#if ECA_USE_LIBLILV
+
+#include <vector>
+#include <pthread.h>
+#include <semaphore.h>
+
+#include <lilv/lilv.h>
+#include <lv2/lv2plug.in/ns/ext/worker/worker.h>
+
+#include <kvu_ringbuffer.h>
+
+/**
+ * Host side of the LV2 worker extension (work:schedule)
+ * for one plugin instance.
+ *
+ * Work requested by the plugin in run() is passed to
+ * a process-wide pool of non-realtime threads through
+ * a lock-free request FIFO. Responses are passed back
+ * through a second FIFO, and delivered to the plugin
+ * by deliver_responses() after the next run().
+ *
+ * The pool threads are started when the first worker
+ * is attached to a plugin instance, and stopped when
+ * the last one is destroyed. The number of threads is
+ * set with the 'lv2-worker-threads' ecasoundrc option
+ * (default: 1). Requests of one instance are always
+ * handled in order, by one thread at a time.
+ *
+ * @author agent
+ */
+class ECA_LV2_WORKER {
+
+ public:
+
+  /**
+   * Size of the request and response FIFOs in bytes.
+   * Limits the size of a single message.
+   */
+  static const size_t fifo_size;
+
+  ECA_LV2_WORKER(void);
+  ~ECA_LV2_WORKER(void);
+
+  /**
+   * Feature to be passed to the plugin when it is
+   * instantiated.
+   */
+  LV2_Feature* schedule_feature(void) { return &schedule_feature_rep; }
+
+  void attach(LilvInstance* instance);
+  void set_synchronous(bool v) { synchronous_rep = v; }
+
+  /**
+   * Whether the plugin provides the worker interface.
+   */
+  bool is_attached(void) const { return iface_repp != 0; }
+
+  void deliver_responses(void);
+
+  static int thread_count(void);
+  static void set_thread_count(int threads);
+
+ private:
+
+  static LV2_Worker_Status schedule_work(LV2_Worker_Schedule_Handle handle, uint32_t size, const void* data);
+  static LV2_Worker_Status respond(LV2_Worker_Respond_Handle handle, uint32_t size, const void* data);
+  static bool write_message(KVU_RINGBUFFER* fifo, uint32_t size, const void* data);
+  static bool read_message(KVU_RINGBUFFER* fifo, std::vector<char>* buffer, uint32_t* size);
+
+  void do_work(void);
+
+  static void* pool_thread(void* arg);
+  static bool run_pending(void);
+  static void start_threads(void);
+  static void stop_threads(void);
+
+  static pthread_mutex_t users_lock_rep;
+  static pthread_mutex_t list_lock_rep;
+  static std::vector<ECA_LV2_WORKER*> users_rep;
+  static std::vector<pthread_t> threads_rep;
+  static sem_t wakeup_sem_rep;
+  static volatile bool exit_rep;
+  static int thread_count_rep;
+  static bool thread_count_set_rep;
+
+  KVU_RINGBUFFER requests_rep;
+  KVU_RINGBUFFER responses_rep;
+  std::vector<char> request_buffer_rep;
+  std::vector<char> response_buffer_rep;
+  LV2_Worker_Schedule schedule_rep;
+  LV2_Feature schedule_feature_rep;
+  LV2_Handle handle_rep;
+  const LV2_Worker_Interface* iface_repp;
+  bool synchronous_rep;
+  int busy_rep;
+
+  ECA_LV2_WORKER(const ECA_LV2_WORKER&);
+  ECA_LV2_WORKER& operator=(const ECA_LV2_WORKER&);
+};
+
+#endif /* ECA_USE_LIBLILV */
+#endif
@@ -0,0 +1,254 @@
+// ------------------------------------------------------------------------
+// audiofx_lv2_worker_test.h: Unit test for ECA_LV2_WORKER
+// Copyright (C) 2026 agent
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
+// ------------------------------------------------------------------------
+
+#include <cstdio>
+#include <cstring> /* memcpy(), memset(), strcmp() */
+#include <string>
+
+#include <pthread.h>
+
+#include <kvu_utils.h> /* kvu_sleep() */
+
+#include "audiofx_lv2_worker.h"
+#include "eca-test-case.h"
+
+using namespace std;
+
+/**
+ * Minimal plugin using the worker extension: each
+ * request carries an int, work() responds with the
+ * value doubled.
+ */
+struct ECA_LV2_WORKER_TEST_PLUGIN {
+  volatile int work_calls;
+  pthread_t work_thread;
+  int responses;
+  int last_response;
+  bool in_order;
+  int end_runs;
+};
+
+static LV2_Worker_Status eca_lv2_worker_test_work(LV2_Handle h,
+						  LV2_Worker_Respond_Function respond,
+						  LV2_Worker_Respond_Handle rh,
+						  uint32_t size,
+						  const void* data)
+{
+  ECA_LV2_WORKER_TEST_PLUGIN* p = static_cast<ECA_LV2_WORKER_TEST_PLUGIN*>(h);
+  int value;
+  std::memcpy(&value, data, sizeof(value));
+  value *= 2;
+  p->work_thread = pthread_self();
+  LV2_Worker_Status ret = respond(rh, sizeof(value), &value);
+  __sync_fetch_and_add(&p->work_calls, 1);
+  return ret;
+}
+
+static LV2_Worker_Status eca_lv2_worker_test_response(LV2_Handle h, uint32_t size, const void* data)
+{
+  ECA_LV2_WORKER_TEST_PLUGIN* p = static_cast<ECA_LV2_WORKER_TEST_PLUGIN*>(h);
+  int value;
+  std::memcpy(&value, data, sizeof(value));
+  if (value <= p->last_response) p->in_order = false;
+  p->last_response = value;
+  ++p->responses;
+  return LV2_WORKER_SUCCESS;
+}
+
+static LV2_Worker_Status eca_lv2_worker_test_end_run(LV2_Handle h)
+{
+  ++static_cast<ECA_LV2_WORKER_TEST_PLUGIN*>(h)->end_runs;
+  return LV2_WORKER_SUCCESS;
+}
+
+static const LV2_Worker_Interface eca_lv2_worker_test_iface = {
+  eca_lv2_worker_test_work,
+  eca_lv2_worker_test_response,
+  eca_lv2_worker_test_end_run
+};
+
+static const void* eca_lv2_worker_test_extension_data(const char* uri)
+{
+  if (std::strcmp(uri, LV2_WORKER__interface) == 0)
+    return &eca_lv2_worker_test_iface;
+  return 0;
+}
+
+static const void* eca_lv2_worker_test_no_extension_data(const char* uri)
+{
+  return 0;
+}
+
+/**
+ * Unit test for ECA_LV2_WORKER
+ */
+class ECA_LV2_WORKER_TEST : public ECA_TEST_CASE {
+
+protected:
+
+  virtual string do_name(void) const { return("ECA_LV2_WORKER"); }
+  virtual void do_run(void);
+
+public:
+
+  virtual ~ECA_LV2_WORKER_TEST(void) { }
+
+private:
+
+  static LV2_Worker_Status schedule(ECA_LV2_WORKER* worker, int value);
+  static void reset(ECA_LV2_WORKER_TEST_PLUGIN* plugin);
+};
+
+LV2_Worker_Status ECA_LV2_WORKER_TEST::schedule(ECA_LV2_WORKER* worker, int value)
+{
+  LV2_Worker_Schedule* s =
+    static_cast<LV2_Worker_Schedule*>(worker->schedule_feature()->data);
+  return s->schedule_work(s->handle, sizeof(value), &value);
+}
+
+void ECA_LV2_WORKER_TEST::reset(ECA_LV2_WORKER_TEST_PLUGIN* plugin)
+{
+  plugin->work_calls = 0;
+  plugin->work_thread = pthread_self();
+  plugin->responses = 0;
+  plugin->last_response = 0;
+  plugin->in_order = true;
+  plugin->end_runs = 0;
+}
+
+void ECA_LV2_WORKER_TEST::do_run(void)
+{
+  std::fprintf(stdout, "%s: tests for %s class\n",
+	       name().c_str(), __FILE__);
+
+  int old_threads = ECA_LV2_WORKER::thread_count();
+  ECA_LV2_WORKER::set_thread_count(2);
+
+  ECA_LV2_WORKER_TEST_PLUGIN plugin;
+  reset(&plugin);
+
+  LV2_Descriptor desc;
+  std::memset(&desc, 0, sizeof(desc));
+  desc.extension_data = eca_lv2_worker_test_extension_data;
+
+  LilvInstance instance;
+  std::memset(&instance, 0, sizeof(instance));
+  instance.lv2_descriptor = &desc;
+  instance.lv2_handle = static_cast<LV2_Handle>(&plugin);
+
+  /* case: plugin without the worker interface */
+  {
+    std::fprintf(stdout, "%s: no worker interface\n", __FILE__);
+
+    LV2_Descriptor nodesc;
+    std::memset(&nodesc, 0, sizeof(nodesc));
+    nodesc.extension_data = eca_lv2_worker_test_no_extension_data;
+    LilvInstance noinstance = instance;
+    noinstance.lv2_descriptor = &nodesc;
+
+    ECA_LV2_WORKER worker;
+    worker.attach(&noinstance);
+    if (worker.is_attached() == true)
+      ECA_TEST_FAILURE("attached without worker interface");
+    if (schedule(&worker, 1) != LV2_WORKER_ERR_UNKNOWN)
+      ECA_TEST_FAILURE("work scheduled without worker interface");
+  }
+
+  /* case: requests handled in order on a pool thread,
+   *       responses delivered after run */
+  {
+    std::fprintf(stdout, "%s: asynchronous work\n", __FILE__);
+
+    const int requests = 20;
+    ECA_LV2_WORKER worker;
+    worker.attach(&instance);
+    if (worker.is_attached() != true)
+      ECA_TEST_FAILURE("worker not attached");
+
+    for(int n = 1; n <= requests; n++) {
+      if (schedule(&worker, n) != LV2_WORKER_SUCCESS)
+	ECA_TEST_FAILURE("schedule_work failed");
+    }
+
+    for(int n = 0; n < 1000 && plugin.work_calls < requests; n++)
+      kvu_sleep(0, 1000000);
+    if (plugin.work_calls != requests)
+      ECA_TEST_FAILURE("requests not handled");
+    if (pthread_equal(plugin.work_thread, pthread_self()) != 0)
+      ECA_TEST_FAILURE("work done in the scheduling thread");
+    if (plugin.responses != 0)
+      ECA_TEST_FAILURE("response delivered before end of run");
+
+    worker.deliver_responses();
+    if (plugin.responses != requests ||
+	plugin.last_response != 2 * requests ||
+	plugin.in_order != true)
+      ECA_TEST_FAILURE("responses not delivered in order");
+    if (plugin.end_runs != 1)
+      ECA_TEST_FAILURE("end_run not called");
+  }
+
+  /* case: message larger than the FIFO */
+  {
+    std::fprintf(stdout, "%s: oversized request\n", __FILE__);
+
+    ECA_LV2_WORKER worker;
+    worker.attach(&instance);
+    std::string big (ECA_LV2_WORKER::fifo_size, 'x');
+    LV2_Worker_Schedule* s =
+      static_cast<LV2_Worker_Schedule*>(worker.schedule_feature()->data);
+    if (s->schedule_work(s->handle, big.size(), big.data()) != LV2_WORKER_ERR_NO_SPACE)
+      ECA_TEST_FAILURE("oversized request accepted");
+  }
+
+  /* case: synchronous mode, used when restoring state */
+  {
+    std::fprintf(stdout, "%s: synchronous work\n", __FILE__);
+
+    reset(&plugin);
+    ECA_LV2_WORKER worker;
+    worker.attach(&instance);
+    worker.set_synchronous(true);
+    if (schedule(&worker, 21) != LV2_WORKER_SUCCESS ||
+	plugin.work_calls != 1 ||
+	pthread_equal(plugin.work_thread, pthread_self()) == 0)
+      ECA_TEST_FAILURE("synchronous work not done in caller");
+    worker.deliver_responses();
+    if (plugin.responses != 1 || plugin.last_response != 42)
+      ECA_TEST_FAILURE("synchronous response");
+  }
+
+  /* case: destroying a worker with pending requests */
+  {
+    std::fprintf(stdout, "%s: destroy with pending work\n", __FILE__);
+
+    reset(&plugin);
+    ECA_LV2_WORKER* worker = new ECA_LV2_WORKER();
+    worker->attach(&instance);
+    for(int n = 1; n <= 100; n++)
+      schedule(worker, n);
+    delete worker;
+    int calls = plugin.work_calls;
+    kvu_sleep(0, 20000000);
+    if (plugin.work_calls != calls)
+      ECA_TEST_FAILURE("work done after worker was destroyed");
+  }
+
+  ECA_LV2_WORKER::set_thread_count(old_threads);
+}
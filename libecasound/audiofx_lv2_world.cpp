@@ -1,6 +1,7 @@
 // ------------------------------------------------------------------------
 // audiofx_lv2_world.cpp: Utility class for LV2 plugin loading
 // Copyright (C) 2000-2004, 2011 Kai Vehmanen
+// Copyright (C) 2026 agent
 //
 // Attributes:
 //     eca-style-version: 3
@@ -36,12 +37,14 @@
 #define INTEGER_URI LV2PREFIX "integer"
 #define LOGARITHMIC_URI "http://lv2plug.in/ns/dev/extportinfo#"
 #define CONNECTION_OPTIONAL_URI LV2PREFIX "connectionOptional"
+#define REPORTS_LATENCY_URI LV2PREFIX "reportsLatency"
 
 ECA_LV2_WORLD ECA_LV2_WORLD::i=ECA_LV2_WORLD();
 
 ECA_LV2_WORLD::ECA_LV2_WORLD()
 {
 	lilvworld =0;
+	loaded=false;
 	audioclassnode=0;
 	controlclassnode=0;
 	inputclassnode=0;
@@ -52,11 +55,23 @@ ECA_LV2_WORLD::ECA_LV2_WORLD()
 	portlogarithmicnode=0;
 	portsampleratedependentnode=0;
 	portconnectionoptionalnode=0;
+	portreportslatencynode=0;
+
+	pthread_mutex_init(&uridlock, 0);
+	uridmapdata.handle=0;
+	uridmapdata.map=MapURI;
+	uridunmapdata.handle=0;
+	uridunmapdata.unmap=UnmapURI;
+	uridmapfeature.URI=LV2_URID__map;
+	uridmapfeature.data=&uridmapdata;
+	uridunmapfeature.URI=LV2_URID__unmap;
+	uridunmapfeature.data=&uridunmapdata;
 }
 
 ECA_LV2_WORLD::~ECA_LV2_WORLD()
 {
 	lilv_world_free(lilvworld);
+	pthread_mutex_destroy(&uridlock);
 }
 
 #define DECLARE_ACESSOR(TYPE,METHODNAME,VARIABLENAME,VALUE) \
@@ -78,5 +93,91 @@ DECLARE_ACESSOR(LilvNode, PortIntegerNode,portintegernode,lilv_new_uri(World(),I
 DECLARE_ACESSOR(LilvNode, PortLogarithmicNode,portlogarithmicnode,lilv_new_uri(World(),LOGARITHMIC_URI))
 DECLARE_ACESSOR(LilvNode, PortSamplerateDependentNode,portsampleratedependentnode,lilv_new_uri(World(),SAMPLERATE_URI))
 DECLARE_ACESSOR(LilvNode, PortConnectionOptionalNode,portconnectionoptionalnode,lilv_new_uri(World(),CONNECTION_OPTIONAL_URI))
+DECLARE_ACESSOR(LilvNode, PortReportsLatencyNode,portreportslatencynode,lilv_new_uri(World(),REPORTS_LATENCY_URI))
+
+/**
+ * URI map shared by all plugin instances. Used 
+ * when loading and saving plugin state.
+ */
+LV2_URID_Map* ECA_LV2_WORLD::URIDMap()
+{
+	return &i.uridmapdata;
+}
+
+/**
+ * Feature for mapping URIs to integers (urid:map).
+ */
+LV2_Feature* ECA_LV2_WORLD::URIDMapFeature()
+{
+	return &i.uridmapfeature;
+}
+
+/**
+ * Feature for mapping integers back to URIs (urid:unmap).
+ */
+LV2_Feature* ECA_LV2_WORLD::URIDUnmapFeature()
+{
+	return &i.uridunmapfeature;
+}
+
+/**
+ * Maps 'uri' to an integer. IDs start from 1, 0 is 
+ * reserved for errors. Not realtime-safe; plugins are
+ * expected to map URIs when instantiated.
+ */
+LV2_URID ECA_LV2_WORLD::MapURI(LV2_URID_Map_Handle handle, const char* uri)
+{
+	if (uri == 0)
+		return 0;
+
+	pthread_mutex_lock(&i.uridlock);
+	std::map<std::string, LV2_URID>::const_iterator p = i.uridmap.find(uri);
+	LV2_URID id;
+	if (p != i.uridmap.end()) {
+		id = p->second;
+	}
+	else {
+		i.uridstrings.push_back(uri);
+		id = static_cast<LV2_URID>(i.uridstrings.size());
+		i.uridmap[uri] = id;
+	}
+	pthread_mutex_unlock(&i.uridlock);
+	return id;
+}
+
+const char* ECA_LV2_WORLD::UnmapURI(LV2_URID_Unmap_Handle handle, LV2_URID urid)
+{
+	const char* uri = 0;
+	pthread_mutex_lock(&i.uridlock);
+	if (urid > 0 && urid <= i.uridstrings.size())
+		uri = i.uridstrings[urid - 1].c_str();
+	pthread_mutex_unlock(&i.uridlock);
+	return uri;
+}
+
+/**
+ * Loads data for all installed plugins. Only the
+ * first call does any work.
+ */
+void ECA_LV2_WORLD::LoadAll()
+{
+	if (i.loaded == false) {
+		lilv_world_load_all(World());
+		i.loaded = true;
+	}
+}
+
+/**
+ * Returns the installed plugin with URI 'uri', or 0
+ * if not found. Loads plugin data if needed.
+ */
+const LilvPlugin* ECA_LV2_WORLD::PluginByURI(const std::string& uri)
+{
+	LoadAll();
+	LilvNode* node = lilv_new_uri(World(), uri.c_str());
+	const LilvPlugin* plugin = lilv_plugins_get_by_uri(lilv_world_get_all_plugins(World()), node);
+	lilv_node_free(node);
+	return plugin;
+}
 
 #endif /* ECA_USE_LIBLILV */
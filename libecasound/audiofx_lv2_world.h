@@ -3,8 +3,12 @@
 
 #if ECA_USE_LIBLILV
 
+#include <deque>
+#include <map>
+#include <string>
+#include <pthread.h>
 #include <lilv/lilvmm.hpp>
-
+#include <lv2/lv2plug.in/ns/ext/urid/urid.h>
 
 
 class ECA_LV2_WORLD {
@@ -13,6 +17,8 @@ class ECA_LV2_WORLD {
 
 public:
 	static LilvWorld* World();
+	static void LoadAll();
+	static const LilvPlugin* PluginByURI(const std::string& uri);
 	static LilvNode* AudioClassNode();
 	static LilvNode* ControlClassNode();
 	static LilvNode* InputClassNode();
@@ -23,11 +29,19 @@ public:
 	static LilvNode* PortLogarithmicNode();
 	static LilvNode* PortSamplerateDependentNode();
 	static LilvNode* PortConnectionOptionalNode();
+	static LilvNode* PortReportsLatencyNode();
+
+	static LV2_URID_Map* URIDMap();
+	static LV2_Feature* URIDMapFeature();
+	static LV2_Feature* URIDUnmapFeature();
 
 private:
 	ECA_LV2_WORLD();
 	~ECA_LV2_WORLD();
+	static LV2_URID MapURI(LV2_URID_Map_Handle handle, const char* uri);
+	static const char* UnmapURI(LV2_URID_Unmap_Handle handle, LV2_URID urid);
 	LilvWorld* lilvworld;
+	bool loaded;
 	LilvNode* audioclassnode;
 	LilvNode* controlclassnode;
 	LilvNode* inputclassnode;
@@ -38,6 +52,17 @@ private:
 	LilvNode* portlogarithmicnode;
 	LilvNode* portsampleratedependentnode;
 	LilvNode* portconnectionoptionalnode;
+	LilvNode* portreportslatencynode;
+
+	/* note: URIs are never removed; a deque keeps the
+	 *       strings returned by UnmapURI() valid */
+	pthread_mutex_t uridlock;
+	std::map<std::string, LV2_URID> uridmap;
+	std::deque<std::string> uridstrings;
+	LV2_URID_Map uridmapdata;
+	LV2_URID_Unmap uridunmapdata;
+	LV2_Feature uridmapfeature;
+	LV2_Feature uridunmapfeature;
 };
 
 #endif /* ECA_USE_LIBLILV */
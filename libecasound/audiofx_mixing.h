@@ -92,6 +92,9 @@ public:
   virtual void parameter_description(int param, struct PARAM_DESCRIPTION *pd) const;
   virtual void set_parameter(int param, parameter_t value);
   virtual parameter_t get_parameter(int param) const;
+  /* note: parameter 1 is the channel, not the amp-% ramped by
+   *       EFFECT_AMPLIFY_CHANNEL, so ramping is not inherited */
+  virtual bool parameter_ramp_supported(int param) const { return false; }
 
   EFFECT_CHANNEL_MUTE* clone(void) const { return new EFFECT_CHANNEL_MUTE(*this); }
   EFFECT_CHANNEL_MUTE* new_expr(void) const { return new EFFECT_CHANNEL_MUTE(); }
@@ -0,0 +1,763 @@
+// ------------------------------------------------------------------------
+// audiofx_sandbox.cpp: Runs a chain operator in a separate process
+// Copyright (C) 2026 agent
+//
+// Attributes:
+//     eca-style-version: 3
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
+// ------------------------------------------------------------------------
+
+#include <climits> /* INT_MAX */
+#include <cstdio> /* fprintf() */
+#include <cstdlib> /* atof(), atoi() */
+#include <cstring> /* memcpy(), memset() */
+#include <vector>
+#include <fcntl.h>
+#include <pthread.h>
+#include <sched.h>
+#include <signal.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+
+#ifdef __linux__
+#include <linux/futex.h>
+#include <sys/prctl.h>
+#include <sys/syscall.h>
+#endif
+
+#include <kvu_dbc.h>
+#include <kvu_message_item.h>
+#include <kvu_numtostr.h>
+#include <kvu_timestamp.h>
+#include <kvu_utils.h>
+
+#include "samplebuffer.h"
+#include "audiofx_sandbox.h"
+#include "eca-object-factory.h"
+#include "eca-resources.h"
+#include "eca-logger.h"
+
+#ifndef ECA_PKGLIBEXECDIR
+#define ECA_PKGLIBEXECDIR "/usr/local/libexec/ecasound"
+#endif
+
+#ifndef MFD_CLOEXEC
+#define MFD_CLOEXEC 0x0001U
+#endif
+
+const int EFFECT_SANDBOX::max_missed_deadlines = 4;
+
+double EFFECT_SANDBOX::deadline_percent_rep = 50.0;
+bool EFFECT_SANDBOX::enabled_rep = false;
+bool EFFECT_SANDBOX::enabled_set_rep = false;
+std::string EFFECT_SANDBOX::host_path_rep = ECA_PKGLIBEXECDIR "/ecasound-plugin-host";
+volatile int EFFECT_SANDBOX::running_rep = 0;
+
+#ifdef __linux__
+static void audiofx_sandbox_wait(volatile int* addr, int value, const struct timespec* timeout)
+{
+  syscall(SYS_futex, addr, FUTEX_WAIT, value, timeout, 0, 0);
+}
+
+static void audiofx_sandbox_wake(volatile int* addr)
+{
+  syscall(SYS_futex, addr, FUTEX_WAKE, INT_MAX, 0, 0, 0);
+}
+
+/**
+ * Creates an anonymous shared memory file of 'size' bytes,
+ * to be mapped by both processes. Returns -1 on error.
+ */
+static int audiofx_sandbox_shared_file(size_t size)
+{
+#ifdef SYS_memfd_create
+  int fd = syscall(SYS_memfd_create, "ecasound-sandbox", MFD_CLOEXEC);
+  if (fd < 0)
+    return -1;
+  if (ftruncate(fd, size) != 0) {
+    close(fd);
+    return -1;
+  }
+  return fd;
+#else
+  return -1;
+#endif
+}
+#else
+static void audiofx_sandbox_wait(volatile int* addr, int value, const struct timespec* timeout)
+{
+  sched_yield();
+}
+
+static void audiofx_sandbox_wake(volatile int* addr)
+{
+}
+
+static int audiofx_sandbox_shared_file(size_t size)
+{
+  return -1;
+}
+#endif
+
+/**
+ * Whether LADSPA and LV2 plugins should be sandboxed.
+ * Unless set with set_enabled(), the values are read
+ * from ecasoundrc.
+ */
+bool EFFECT_SANDBOX::enabled(void)
+{
+  if (enabled_set_rep != true) {
+    ECA_RESOURCES ecarc;
+    enabled_rep = ecarc.boolean_resource("plugin-sandbox");
+    if (ecarc.has("plugin-sandbox-deadline") == true)
+      set_deadline_percent(std::atof(ecarc.resource("plugin-sandbox-deadline").c_str()));
+    if (ecarc.has("plugin-sandbox-host") == true)
+      set_host_path(ecarc.resource("plugin-sandbox-host"));
+    enabled_set_rep = true;
+  }
+#ifdef __linux__
+  return enabled_rep;
+#else
+  return false;
+#endif
+}
+
+void EFFECT_SANDBOX::set_enabled(bool v)
+{
+  enabled_rep = v;
+  enabled_set_rep = true;
+}
+
+/**
+ * Sets the time all running host processes together
+ * have to process a block, as a percentage of the 
+ * block length.
+ */
+void EFFECT_SANDBOX::set_deadline_percent(double v)
+{
+  if (v > 0.0)
+    deadline_percent_rep = v;
+}
+
+/**
+ * Share of the deadline each running host process 
+ * gets, as a percentage of the block length.
+ */
+double EFFECT_SANDBOX::instance_deadline_percent(void)
+{
+  int running = running_rep;
+  return (running > 1) ? deadline_percent_rep / running : deadline_percent_rep;
+}
+
+/**
+ * Path of the host program, by default installed
+ * to the ecasound libexec directory.
+ */
+std::string EFFECT_SANDBOX::host_path(void)
+{
+  return host_path_rep;
+}
+
+void EFFECT_SANDBOX::set_host_path(const std::string& v)
+{
+  host_path_rep = v;
+}
+
+/**
+ * Creates a sandbox for 'op'. The sandbox takes
+ * ownership of 'op'.
+ */
+EFFECT_SANDBOX::EFFECT_SANDBOX(CHAIN_OPERATOR* op)
+  : op_repp(op),
+    buffer_repp(0),
+    shm_repp(0),
+    shm_size_rep(0),
+    header_repp(0),
+    params_in_repp(0),
+    params_out_repp(0),
+    audio_repp(0),
+    audio_length_rep(0),
+    audio_channels_rep(0),
+    child_rep(0),
+    host_exited_rep(0),
+    kill_request_rep(0),
+    stopping_rep(0),
+    counted_rep(false),
+    bypassed_rep(false),
+    failure_rep(failure_none),
+    missed_rep(0),
+    total_missed_rep(0)
+{
+  DBC_REQUIRE(op != 0);
+}
+
+EFFECT_SANDBOX::~EFFECT_SANDBOX(void)
+{
+  release();
+  delete op_repp;
+}
+
+EFFECT_SANDBOX* EFFECT_SANDBOX::clone(void) const
+{
+  return new EFFECT_SANDBOX(dynamic_cast<CHAIN_OPERATOR*>(op_repp->clone()));
+}
+
+EFFECT_SANDBOX* EFFECT_SANDBOX::new_expr(void) const
+{
+  return new EFFECT_SANDBOX(dynamic_cast<CHAIN_OPERATOR*>(op_repp->new_expr()));
+}
+
+std::string EFFECT_SANDBOX::status(void) const
+{
+  MESSAGE_ITEM mitem;
+  if (bypassed_rep == true)
+    mitem << "(audiofx) Bypassed";
+  else
+    mitem << "(audiofx) Running in process " << kvu_numtostr(child_rep);
+  mitem << ", missed deadlines " << kvu_numtostr(total_missed_rep) << ".";
+  return mitem.to_string();
+}
+
+void EFFECT_SANDBOX::parameter_description(int param, struct PARAM_DESCRIPTION *pd) const
+{
+  op_repp->parameter_description(param, pd);
+}
+
+void EFFECT_SANDBOX::set_parameter(int param, parameter_t value)
+{
+  op_repp->set_parameter(param, value);
+
+  if (header_repp != 0 && param > 0 && param <= number_of_params()) {
+    params_in_repp[param - 1] = value;
+    /* note: value must be visible before the new sequence */
+    __sync_synchronize();
+    __sync_fetch_and_add(&header_repp->params_seq, 1);
+  }
+}
+
+CHAIN_OPERATOR::parameter_t EFFECT_SANDBOX::get_parameter(int param) const
+{
+  if (header_repp != 0 && param > 0 && param <= number_of_params()) {
+    /* note: output ports are written by the host process */
+    struct PARAM_DESCRIPTION pd;
+    op_repp->parameter_description(param, &pd);
+    if (pd.output == true)
+      return params_out_repp[param - 1];
+  }
+  return op_repp->get_parameter(param);
+}
+
+/**
+ * Latency reported by the operator after the most
+ * recent block processed in the host process.
+ */
+long int EFFECT_SANDBOX::latency(void) const
+{
+  if (header_repp == 0 || bypassed_rep == true)
+    return 0;
+  return header_repp->latency;
+}
+
+void EFFECT_SANDBOX::set_samples_per_second(SAMPLE_SPECS::sample_rate_t v)
+{
+  ECA_SAMPLERATE_AWARE* srateobj = dynamic_cast<ECA_SAMPLERATE_AWARE*>(op_repp);
+  if (srateobj != 0)
+    srateobj->set_samples_per_second(v);
+  EFFECT_BASE::set_samples_per_second(v);
+}
+
+void EFFECT_SANDBOX::init(SAMPLE_BUFFER *insample)
+{
+  EFFECT_BASE::init(insample);
+
+  stop_child();
+  release_shared_memory();
+
+  if (buffer_repp != insample) {
+    release();
+    buffer_repp = insample;
+    buffer_repp->get_pointer_reflock();
+  }
+
+  bypassed_rep = false;
+  failure_rep = failure_none;
+  missed_rep = 0;
+  total_missed_rep = 0;
+
+  /* note: shared buffers cover the whole reserved length,
+   *       so chain buffer length can change after init() */
+  long int length = insample->reserved_length_in_samples();
+  if (length < 1)
+    length = 1;
+
+  int params = number_of_params();
+  size_t header_size = (sizeof(SHARED_HEADER) + 63) & ~static_cast<size_t>(63);
+  size_t size =
+    header_size +
+    2 * params * sizeof(parameter_t) +
+    insample->number_of_channels() * length * sizeof(SAMPLE_SPECS::sample_t);
+
+  void* shm = MAP_FAILED;
+  int fd = audiofx_sandbox_shared_file(size);
+  if (fd >= 0)
+    shm = mmap(0, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  if (shm == MAP_FAILED) {
+    if (fd >= 0) close(fd);
+    bypassed_rep = true;
+    ECA_LOG_MSG(ECA_LOGGER::info,
+		"WARNING: Bypassing sandboxed plugin " + name() + 
+		": unable to allocate shared memory.");
+    return;
+  }
+
+  SHARED_HEADER* hdr = static_cast<SHARED_HEADER*>(shm);
+  std::memset(hdr, 0, header_size);
+  hdr->params = params;
+  hdr->channels = insample->number_of_channels();
+  hdr->buffer_length = length;
+  hdr->srate = samples_per_second();
+  map_shared_memory(shm, size);
+
+  for(int n = 0; n < params; n++) {
+    params_in_repp[n] = op_repp->get_parameter(n + 1);
+    params_out_repp[n] = params_in_repp[n];
+  }
+
+  bool started = start_child(fd);
+  close(fd);
+  if (started != true) {
+    stop_child();
+    bypassed_rep = true;
+    ECA_LOG_MSG(ECA_LOGGER::info,
+		"WARNING: Bypassing sandboxed plugin " + name() + 
+		": unable to start host process " + host_path() + ".");
+  }
+}
+
+void EFFECT_SANDBOX::release(void)
+{
+  stop_child();
+  release_shared_memory();
+
+  if (buffer_repp != 0) {
+    buffer_repp->release_pointer_reflock();
+  }
+  buffer_repp = 0;
+}
+
+/**
+ * Sets up pointers to a shared memory area, whose 
+ * header has been filled.
+ */
+void EFFECT_SANDBOX::map_shared_memory(void* shm, size_t size)
+{
+  size_t header_size = (sizeof(SHARED_HEADER) + 63) & ~static_cast<size_t>(63);
+
+  shm_repp = shm;
+  shm_size_rep = size;
+  header_repp = static_cast<SHARED_HEADER*>(shm_repp);
+  audio_channels_rep = header_repp->channels;
+  audio_length_rep = header_repp->buffer_length;
+  params_in_repp = reinterpret_cast<parameter_t*>(static_cast<char*>(shm_repp) + header_size);
+  params_out_repp = params_in_repp + header_repp->params;
+  audio_repp = reinterpret_cast<SAMPLE_SPECS::sample_t*>(params_out_repp + header_repp->params);
+}
+
+void EFFECT_SANDBOX::release_shared_memory(void)
+{
+  if (shm_repp != 0) {
+    munmap(shm_repp, shm_size_rep);
+    shm_repp = 0;
+    shm_size_rep = 0;
+    header_repp = 0;
+    params_in_repp = 0;
+    params_out_repp = 0;
+    audio_repp = 0;
+  }
+}
+
+/**
+ * Passes the current block to the host process and
+ * waits until it is processed, or until the deadline
+ * expires. On a missed deadline, the block is left
+ * unprocessed.
+ *
+ * Realtime-safe.
+ */
+void EFFECT_SANDBOX::process(void)
+{
+  if (bypassed_rep == true)
+    return;
+
+  SHARED_HEADER* hdr = header_repp;
+  int seq = hdr->request_seq;
+
+  if (host_exited_rep != 0) {
+    bypass(failure_host_exited);
+    return;
+  }
+
+  /* note: host process is still working on a block
+   *       that missed its deadline */
+  if (__sync_fetch_and_add(&hdr->done_seq, 0) != seq) {
+    ++total_missed_rep;
+    if (++missed_rep >= max_missed_deadlines)
+      bypass(failure_deadlines);
+    return;
+  }
+
+  long int len = buffer_repp->length_in_samples();
+  if (len > audio_length_rep) len = audio_length_rep;
+  int chs = buffer_repp->number_of_channels();
+  if (chs > audio_channels_rep) chs = audio_channels_rep;
+
+  for(int ch = 0; ch < chs; ch++)
+    std::memcpy(shared_channel(ch), buffer_repp->buffer[ch], len * sizeof(SAMPLE_SPECS::sample_t));
+
+  struct sched_param param;
+  pthread_getschedparam(pthread_self(), &hdr->sched_policy, &param);
+  hdr->sched_priority = param.sched_priority;
+  hdr->length = len;
+
+  /* note: data must be visible before the new request */
+  __sync_synchronize();
+  ++seq;
+  hdr->request_seq = seq;
+  audiofx_sandbox_wake(&hdr->request_seq);
+
+  struct timespec now;
+  kvu_clock_gettime(&now);
+  double deadline =
+    kvu_timespec_seconds(&now) +
+    static_cast<double>(len) / samples_per_second() * instance_deadline_percent() / 100.0;
+
+  /* note: the reaper thread wakes us up if the host exits */
+  while(__sync_fetch_and_add(&hdr->done_seq, 0) != seq &&
+	host_exited_rep == 0) {
+    kvu_clock_gettime(&now);
+    double remaining = deadline - kvu_timespec_seconds(&now);
+    if (remaining <= 0.0)
+      break;
+    struct timespec timeout;
+    timeout.tv_sec = static_cast<time_t>(remaining);
+    timeout.tv_nsec = static_cast<long>((remaining - timeout.tv_sec) * 1000000000.0);
+    audiofx_sandbox_wait(&hdr->done_seq, seq - 1, &timeout);
+  }
+
+  if (__sync_fetch_and_add(&hdr->done_seq, 0) != seq) {
+    ++total_missed_rep;
+    if (host_exited_rep != 0)
+      bypass(failure_host_exited);
+    else if (++missed_rep >= max_missed_deadlines)
+      bypass(failure_deadlines);
+    return;
+  }
+
+  missed_rep = 0;
+  __sync_synchronize();
+  for(int ch = 0; ch < chs; ch++)
+    std::memcpy(buffer_repp->buffer[ch], shared_channel(ch), len * sizeof(SAMPLE_SPECS::sample_t));
+}
+
+/**
+ * Stops processing until the next init(). The reaper
+ * thread is asked to kill the host process and to log
+ * the failure.
+ *
+ * Realtime-safe.
+ */
+void EFFECT_SANDBOX::bypass(failure_t reason)
+{
+  failure_rep = reason;
+  bypassed_rep = true;
+  __sync_synchronize();
+  kill_request_rep = 1;
+  audiofx_sandbox_wake(&kill_request_rep);
+}
+
+/**
+ * Starts the host process, passing it the shared 
+ * memory file 'fd', and waits until the operator
+ * has been initialized.
+ *
+ * Not realtime-safe.
+ */
+bool EFFECT_SANDBOX::start_child(int fd)
+{
+  DBC_CHECK(child_rep == 0);
+
+#ifdef __linux__
+  /* note: all memory needed by the child is allocated 
+   *       before fork(), as only async-signal-safe calls 
+   *       may be made in the child of a threaded process */
+  std::vector<std::string> args;
+  args.push_back(host_path());
+  args.push_back(kvu_numtostr(fd));
+  args.push_back(kvu_numtostr(getpid()));
+  args.push_back(ECA_OBJECT_FACTORY::chain_operator_to_eos(op_repp));
+  std::vector<char*> argv;
+  for(size_t n = 0; n < args.size(); n++)
+    argv.push_back(const_cast<char*>(args[n].c_str()));
+  argv.push_back(0);
+
+  pid_t pid = fork();
+  if (pid < 0)
+    return false;
+
+  if (pid == 0) {
+    fcntl(fd, F_SETFD, 0);
+    execv(argv[0], &argv[0]);
+    _exit(127);
+  }
+
+  child_rep = pid;
+  host_exited_rep = 0;
+  kill_request_rep = 0;
+  stopping_rep = 0;
+  if (pthread_create(&reaper_rep, 0, reaper_thread, static_cast<void*>(this)) != 0) {
+    kill(pid, SIGKILL);
+    waitpid(pid, 0, 0);
+    child_rep = 0;
+    return false;
+  }
+
+  /* note: loading plugins in the host process may take
+   *       a while, wait at most 10 seconds */
+  for(int n = 0; n < 10000; n++) {
+    if (header_repp->ready != 0 || host_exited_rep != 0)
+      break;
+    kvu_sleep(0, 1000000);
+  }
+  if (header_repp->ready <= 0)
+    return false;
+
+  __sync_fetch_and_add(&running_rep, 1);
+  counted_rep = true;
+  ECA_LOG_MSG(ECA_LOGGER::system_objects,
+	      "Started host process " + kvu_numtostr(pid) +
+	      " for plugin " + name() + ".");
+  return true;
+#else
+  return false;
+#endif
+}
+
+/**
+ * Asks the host process to exit. If it does not exit
+ * within 100ms, it is killed.
+ *
+ * Not realtime-safe.
+ */
+void EFFECT_SANDBOX::stop_child(void)
+{
+  if (child_rep <= 0)
+    return;
+
+  if (counted_rep == true) {
+    __sync_fetch_and_sub(&running_rep, 1);
+    counted_rep = false;
+  }
+
+  stopping_rep = 1;
+  if (header_repp != 0) {
+    header_repp->exit_request = 1;
+    __sync_synchronize();
+    __sync_fetch_and_add(&header_repp->request_seq, 1);
+    audiofx_sandbox_wake(&header_repp->request_seq);
+  }
+
+  for(int n = 0; n < 100 && host_exited_rep == 0; n++)
+    kvu_sleep(0, 1000000);
+
+  kill_request_rep = 1;
+  audiofx_sandbox_wake(&kill_request_rep);
+  pthread_join(reaper_rep, 0);
+  child_rep = 0;
+}
+
+/**
+ * Waits for the host process to exit, kills it when
+ * requested, and logs failures.
+ */
+void* EFFECT_SANDBOX::reaper_thread(void* arg)
+{
+  EFFECT_SANDBOX* self = static_cast<EFFECT_SANDBOX*>(arg);
+
+  while(waitpid(self->child_rep, 0, WNOHANG) != self->child_rep) {
+    if (self->kill_request_rep != 0) {
+      kill(self->child_rep, SIGKILL);
+      waitpid(self->child_rep, 0, 0);
+      break;
+    }
+    struct timespec timeout;
+    timeout.tv_sec = 0;
+    timeout.tv_nsec = 10000000;
+    audiofx_sandbox_wait(&self->kill_request_rep, 0, &timeout);
+  }
+
+  self->host_exited_rep = 1;
+  __sync_synchronize();
+  if (self->header_repp != 0)
+    audiofx_sandbox_wake(&self->header_repp->done_seq);
+
+  /* note: start-up failures are logged by init() */
+  bool started = (self->header_repp != 0 && self->header_repp->ready > 0);
+  if (started == true &&
+      (self->stopping_rep == 0 || self->failure_rep != failure_none)) {
+    if (self->failure_rep == failure_deadlines)
+      ECA_LOG_MSG(ECA_LOGGER::info,
+		  "WARNING: Bypassing sandboxed plugin " + self->name() + 
+		  ": missed " + kvu_numtostr(max_missed_deadlines) + " deadlines.");
+    else
+      ECA_LOG_MSG(ECA_LOGGER::info,
+		  "WARNING: Bypassing sandboxed plugin " + self->name() + 
+		  ": host process terminated.");
+  }
+
+  return 0;
+}
+
+/**
+ * Main function of the host program. Arguments are 
+ * the shared memory file descriptor, the parent
+ * process id, and the option string of the operator.
+ */
+int EFFECT_SANDBOX::host_main(int argc, char* argv[])
+{
+#ifdef __linux__
+  if (argc != 4) {
+    std::fprintf(stderr, "usage: %s fd parent-pid operator\n", argv[0]);
+    return 1;
+  }
+
+  prctl(PR_SET_PDEATHSIG, SIGKILL);
+  if (getppid() != std::atoi(argv[2]))
+    return 1;
+
+  int fd = std::atoi(argv[1]);
+  struct stat statbuf;
+  if (fstat(fd, &statbuf) != 0)
+    return 1;
+  size_t size = statbuf.st_size;
+  void* shm = mmap(0, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  close(fd);
+  if (shm == MAP_FAILED)
+    return 1;
+  SHARED_HEADER* hdr = static_cast<SHARED_HEADER*>(shm);
+
+  /* note: errors are reported to the parent */
+  ECA_LOGGER::instance().set_log_level_bitmask(0);
+  set_enabled(false);
+
+  std::string eos (argv[3]);
+  CHAIN_OPERATOR* op = ECA_OBJECT_FACTORY::create_chain_operator(eos);
+  if (op == 0)
+    op = ECA_OBJECT_FACTORY::create_ladspa_plugin(eos);
+  if (op == 0)
+    op = ECA_OBJECT_FACTORY::create_lv2_plugin(eos);
+  if (op == 0) {
+    hdr->ready = -1;
+    return 1;
+  }
+
+  EFFECT_SANDBOX host (op);
+  host.map_shared_memory(shm, size);
+  host.set_samples_per_second(hdr->srate);
+  host.run_child();
+  return 0;
+#else
+  return 1;
+#endif
+}
+
+/**
+ * Main loop of the host process. Returns when the
+ * parent asks the host to exit.
+ */
+void EFFECT_SANDBOX::run_child(void)
+{
+  SHARED_HEADER* hdr = header_repp;
+  int params = number_of_params();
+
+  int params_seen = hdr->params_seq;
+  __sync_synchronize();
+  for(int n = 0; n < params; n++)
+    op_repp->set_parameter(n + 1, params_in_repp[n]);
+
+  SAMPLE_BUFFER sbuf (audio_length_rep, audio_channels_rep);
+  op_repp->init(&sbuf);
+
+  /* note: header is cleared before the process is
+   *       started, so requests sent while initializing
+   *       are not missed */
+  int seen = 0;
+  int policy = SCHED_OTHER;
+  struct sched_param param;
+  param.sched_priority = 0;
+
+  hdr->ready = 1;
+  __sync_synchronize();
+
+  while(true) {
+    audiofx_sandbox_wait(&hdr->request_seq, seen, 0);
+    int seq = __sync_fetch_and_add(&hdr->request_seq, 0);
+    if (seq == seen)
+      continue;
+    seen = seq;
+    __sync_synchronize();
+
+    if (hdr->exit_request != 0)
+      break;
+
+    if (hdr->sched_policy != policy ||
+	hdr->sched_priority != param.sched_priority) {
+      policy = hdr->sched_policy;
+      param.sched_priority = hdr->sched_priority;
+      sched_setscheduler(0, policy, &param);
+    }
+
+    int params_seq = __sync_fetch_and_add(&hdr->params_seq, 0);
+    if (params_seq != params_seen) {
+      params_seen = params_seq;
+      __sync_synchronize();
+      for(int n = 0; n < params; n++)
+	op_repp->set_parameter(n + 1, params_in_repp[n]);
+    }
+
+    long int len = hdr->length;
+    sbuf.length_in_samples(len);
+    for(int ch = 0; ch < audio_channels_rep; ch++)
+      std::memcpy(sbuf.buffer[ch], shared_channel(ch), len * sizeof(SAMPLE_SPECS::sample_t));
+
+    op_repp->process();
+    sbuf.float_plane_sync();
+
+    for(int ch = 0; ch < audio_channels_rep; ch++)
+      std::memcpy(shared_channel(ch), sbuf.buffer[ch], len * sizeof(SAMPLE_SPECS::sample_t));
+    for(int n = 0; n < params; n++)
+      params_out_repp[n] = op_repp->get_parameter(n + 1);
+    hdr->latency = op_repp->latency();
+
+    /* note: results must be visible before completion */
+    __sync_synchronize();
+    hdr->done_seq = seq;
+    audiofx_sandbox_wake(&hdr->done_seq);
+  }
+
+  op_repp->release();
+}
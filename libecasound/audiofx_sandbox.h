@@ -0,0 +1,167 @@
+#ifndef INCLUDED_AUDIOFX_SANDBOX_H
+#define INCLUDED_AUDIOFX_SANDBOX_H
+
+#include <string>
+#include <pthread.h>
+#include <sys/types.h>
+
+#include "audiofx.h"
+
+class SAMPLE_BUFFER;
+
+/**
+ * Runs a chain operator in a separate host process.
+ *
+ * The host process is started by executing the
+ * 'ecasound-plugin-host' program, which recreates the
+ * wrapped operator from its option string, and runs it
+ * with host_main(). Audio and parameter values are 
+ * passed through shared memory, and the processes 
+ * signal each other with futexes. If the host does not 
+ * finish a block within its deadline, the block passes 
+ * through unprocessed. After 'max_missed_deadlines' 
+ * consecutive misses, or if the host process dies, the 
+ * operator is bypassed until it is reinitialized.
+ *
+ * process() only sets a flag when the operator is
+ * bypassed. The host process is killed, reaped and the
+ * failure logged by a helper thread.
+ *
+ * Enabled for LADSPA and LV2 plugins with the
+ * 'plugin-sandbox' ecasoundrc option. The deadline
+ * is set with 'plugin-sandbox-deadline', as a
+ * percentage of the block length. The deadline is
+ * shared by all running sandboxes, so that plugins in
+ * series cannot together exceed it.
+ *
+ * Only available on Linux.
+ *
+ * @author agent
+ */
+class EFFECT_SANDBOX : public EFFECT_BASE {
+
+ public:
+
+  /**
+   * Number of consecutive missed deadlines after which
+   * the operator is bypassed.
+   */
+  static const int max_missed_deadlines;
+
+  static bool enabled(void);
+  static void set_enabled(bool v);
+  static double deadline_percent(void) { return deadline_percent_rep; }
+  static void set_deadline_percent(double v);
+  static double instance_deadline_percent(void);
+  static std::string host_path(void);
+  static void set_host_path(const std::string& v);
+
+  static int host_main(int argc, char* argv[]);
+
+  EFFECT_SANDBOX(CHAIN_OPERATOR* op);
+  virtual ~EFFECT_SANDBOX(void);
+
+  EFFECT_SANDBOX* clone(void) const;
+  EFFECT_SANDBOX* new_expr(void) const;
+
+  /**
+   * Returns the operator run in the host process.
+   */
+  const CHAIN_OPERATOR* wrapped_operator(void) const { return op_repp; }
+
+  /**
+   * Whether the operator has been bypassed because
+   * of missed deadlines or a crash.
+   */
+  bool is_bypassed(void) const { return bypassed_rep; }
+
+  /**
+   * Process id of the host process, or 0 if not running.
+   */
+  pid_t host_pid(void) const { return child_rep; }
+
+  virtual std::string name(void) const { return op_repp->name(); }
+  virtual std::string description(void) const { return op_repp->description(); }
+  virtual std::string parameter_names(void) const { return op_repp->parameter_names(); }
+  virtual std::string status(void) const;
+
+  virtual void parameter_description(int param, struct PARAM_DESCRIPTION *pd) const;
+  virtual void set_parameter(int param, parameter_t value);
+  virtual parameter_t get_parameter(int param) const;
+  virtual bool thread_safe_parameters(void) const { return(true); }
+  virtual long int latency(void) const;
+
+  virtual int output_channels(int i_channels) const { return op_repp->output_channels(i_channels); }
+  virtual void set_samples_per_second(SAMPLE_SPECS::sample_rate_t v);
+
+  virtual void init(SAMPLE_BUFFER *insample);
+  virtual void release(void);
+  virtual void process(void);
+
+ private:
+
+  /**
+   * Control block at the start of the shared memory area.
+   * Followed by parameter values and audio channels.
+   */
+  struct SHARED_HEADER {
+    int request_seq;
+    int done_seq;
+    int params_seq;
+    int exit_request;
+    int ready;
+    int params;
+    int channels;
+    long int buffer_length;
+    long int srate;
+    long int length;
+    long int latency;
+    int sched_policy;
+    int sched_priority;
+  };
+
+  enum failure_t { failure_none = 0, failure_deadlines, failure_host_exited };
+
+  static double deadline_percent_rep;
+  static bool enabled_rep;
+  static bool enabled_set_rep;
+  static std::string host_path_rep;
+  static volatile int running_rep;
+
+  CHAIN_OPERATOR* op_repp;
+  SAMPLE_BUFFER* buffer_repp;
+
+  void* shm_repp;
+  size_t shm_size_rep;
+  SHARED_HEADER* header_repp;
+  parameter_t* params_in_repp;
+  parameter_t* params_out_repp;
+  SAMPLE_SPECS::sample_t* audio_repp;
+  long int audio_length_rep;
+  int audio_channels_rep;
+
+  pid_t child_rep;
+  pthread_t reaper_rep;
+  volatile int host_exited_rep;
+  volatile int kill_request_rep;
+  volatile int stopping_rep;
+  bool counted_rep;
+  volatile bool bypassed_rep;
+  volatile int failure_rep;
+  int missed_rep;
+  long int total_missed_rep;
+
+  bool start_child(int fd);
+  void stop_child(void);
+  void run_child(void);
+  void map_shared_memory(void* shm, size_t size);
+  void release_shared_memory(void);
+  void bypass(failure_t reason);
+  static void* reaper_thread(void* arg);
+  SAMPLE_SPECS::sample_t* shared_channel(int ch) { return audio_repp + ch * audio_length_rep; }
+
+  EFFECT_SANDBOX(const EFFECT_SANDBOX&);
+  EFFECT_SANDBOX& operator=(const EFFECT_SANDBOX&);
+};
+
+#endif
@@ -0,0 +1,190 @@
+// ------------------------------------------------------------------------
+// audiofx_sandbox_test.h: Unit test for EFFECT_SANDBOX
+// Copyright (C) 2026 agent
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
+// ------------------------------------------------------------------------
+
+#include <cstdio>
+#include <string>
+#include <signal.h>
+
+#include <kvu_utils.h>
+
+#include "audiofx_amplitude.h"
+#include "audiofx_sandbox.h"
+#include "samplebuffer.h"
+#include "eca-test-case.h"
+
+using namespace std;
+
+/**
+ * Unit test for EFFECT_SANDBOX
+ */
+class EFFECT_SANDBOX_TEST : public ECA_TEST_CASE {
+
+protected:
+
+  virtual string do_name(void) const { return("EFFECT_SANDBOX"); }
+  virtual void do_run(void);
+
+public:
+
+  virtual ~EFFECT_SANDBOX_TEST(void) { }
+
+private:
+
+  void fill(SAMPLE_BUFFER* sbuf, SAMPLE_BUFFER::sample_t value);
+  bool check(SAMPLE_BUFFER* sbuf, SAMPLE_BUFFER::sample_t value);
+};
+
+void EFFECT_SANDBOX_TEST::fill(SAMPLE_BUFFER* sbuf, SAMPLE_BUFFER::sample_t value)
+{
+  for(int ch = 0; ch < sbuf->number_of_channels(); ch++)
+    for(long int n = 0; n < sbuf->length_in_samples(); n++)
+      sbuf->buffer[ch][n] = value;
+}
+
+bool EFFECT_SANDBOX_TEST::check(SAMPLE_BUFFER* sbuf, SAMPLE_BUFFER::sample_t value)
+{
+  for(int ch = 0; ch < sbuf->number_of_channels(); ch++)
+    for(long int n = 0; n < sbuf->length_in_samples(); n++)
+      if (sbuf->buffer[ch][n] != value)
+	return false;
+  return true;
+}
+
+void EFFECT_SANDBOX_TEST::do_run(void)
+{
+  const int bufsize = 256;
+  const int channels = 2;
+
+  std::fprintf(stdout, "%s: tests for %s class\n",
+	       name().c_str(), __FILE__);
+
+#ifdef __linux__
+  /* note: generous deadline, so that a loaded test
+   *       machine does not cause missed deadlines */
+  double old_deadline = EFFECT_SANDBOX::deadline_percent();
+  string old_host = EFFECT_SANDBOX::host_path();
+  EFFECT_SANDBOX::set_deadline_percent(2000.0);
+
+  /* note: tests are run in the build directory */
+  EFFECT_SANDBOX::set_host_path("./ecasound-plugin-host");
+
+  SAMPLE_BUFFER sbuf (bufsize, channels);
+  EFFECT_SANDBOX sandbox (new EFFECT_AMPLIFY(200.0));
+  sandbox.set_samples_per_second(44100);
+  sandbox.init(&sbuf);
+
+  /* case: processing in the host process */
+  {
+    std::fprintf(stdout, "%s: processing\n", __FILE__);
+
+    for(int round = 0; round < 10; round++) {
+      fill(&sbuf, 0.25);
+      sandbox.process();
+      if (check(&sbuf, 0.5) != true) {
+	ECA_TEST_FAILURE("sandboxed processing");
+	break;
+      }
+    }
+    if (sandbox.is_bypassed() == true)
+      ECA_TEST_FAILURE("bypassed without errors");
+
+    sandbox.set_parameter(1, 300.0);
+    fill(&sbuf, 0.25);
+    sandbox.process();
+    if (check(&sbuf, 0.75) != true)
+      ECA_TEST_FAILURE("parameter not passed to host process");
+  }
+
+  /* case: deadline is shared by running sandboxes */
+  {
+    std::fprintf(stdout, "%s: shared deadline\n", __FILE__);
+
+    if (EFFECT_SANDBOX::instance_deadline_percent() != 2000.0)
+      ECA_TEST_FAILURE("single sandbox deadline");
+
+    SAMPLE_BUFFER sbuf2 (bufsize, channels);
+    EFFECT_SANDBOX second (new EFFECT_AMPLIFY(100.0));
+    second.set_samples_per_second(44100);
+    second.init(&sbuf2);
+    if (EFFECT_SANDBOX::instance_deadline_percent() != 1000.0)
+      ECA_TEST_FAILURE("deadline not shared by two sandboxes");
+    second.release();
+    if (EFFECT_SANDBOX::instance_deadline_percent() != 2000.0)
+      ECA_TEST_FAILURE("deadline not returned on release");
+  }
+
+  /* case: hanging plugin is bypassed */
+  {
+    std::fprintf(stdout, "%s: missed deadlines\n", __FILE__);
+
+    kill(sandbox.host_pid(), SIGSTOP);
+    for(int n = 0; n < EFFECT_SANDBOX::max_missed_deadlines; n++) {
+      fill(&sbuf, 0.25);
+      sandbox.process();
+      if (check(&sbuf, 0.25) != true)
+	ECA_TEST_FAILURE("late block not passed through");
+    }
+    if (sandbox.is_bypassed() != true)
+      ECA_TEST_FAILURE("hanging plugin not bypassed");
+  }
+
+  /* case: reinitialization restarts the host process */
+  {
+    sandbox.set_parameter(1, 200.0);
+    sandbox.init(&sbuf);
+    fill(&sbuf, 0.25);
+    sandbox.process();
+    if (sandbox.is_bypassed() == true ||
+	check(&sbuf, 0.5) != true)
+      ECA_TEST_FAILURE("host process not restarted");
+  }
+
+  /* case: crashing plugin is bypassed */
+  {
+    std::fprintf(stdout, "%s: crashing plugin\n", __FILE__);
+
+    kill(sandbox.host_pid(), SIGKILL);
+    fill(&sbuf, 0.25);
+    sandbox.process();
+    if (sandbox.is_bypassed() != true ||
+	check(&sbuf, 0.25) != true)
+      ECA_TEST_FAILURE("crashing plugin not bypassed");
+  }
+
+  sandbox.release();
+
+  /* case: missing host program */
+  {
+    std::fprintf(stdout, "%s: missing host program\n", __FILE__);
+
+    EFFECT_SANDBOX::set_host_path("./nonexistent-plugin-host");
+    EFFECT_SANDBOX missing (new EFFECT_AMPLIFY(200.0));
+    missing.set_samples_per_second(44100);
+    missing.init(&sbuf);
+    fill(&sbuf, 0.25);
+    missing.process();
+    if (missing.is_bypassed() != true ||
+	check(&sbuf, 0.25) != true)
+      ECA_TEST_FAILURE("sandbox without host program not bypassed");
+  }
+
+  EFFECT_SANDBOX::set_deadline_percent(old_deadline);
+  EFFECT_SANDBOX::set_host_path(old_host);
+#endif
+}
@@ -20,7 +20,9 @@
 // Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
 // ------------------------------------------------------------------------
 
+#include <algorithm> /* std::max(), std::rotate() */
 #include <assert.h>
+#include <cmath>
 #include <string>
 
 #include <kvu_dbc.h>
@@ -42,11 +44,67 @@ static void priv_check_for_zerodelay(long int *dtime, OPERATOR::parameter_t *dti
   }
 }
 
+/**
+ * Delay lines are reserved in init() to hold at least this
+ * many seconds, so that the delay time can be changed while
+ * running, e.g. by a controller, without reallocating.
+ */
+static const long int priv_delay_line_reserve_secs = 2;
+
+static long int priv_delay_line_capacity(long int len, long int srate)
+{
+  return std::max(len, srate * priv_delay_line_reserve_secs);
+}
+
+/**
+ * Sets up 'count' zeroed delay lines of 'capacity' samples.
+ */
+static void priv_init_delay_lines(std::vector<std::vector<SAMPLE_SPECS::sample_t> > *lines, size_t count, long int capacity)
+{
+  lines->resize(count);
+  for(size_t n = 0; n < lines->size(); n++)
+    (*lines)[n].assign(capacity, 0.0);
+}
+
+/**
+ * Makes the delay lines in 'lines' hold at least 'len' samples.
+ * Only allocates when 'len' exceeds the capacity reserved in
+ * init(). The history is kept: lines are unrolled so that the
+ * oldest sample comes first, and '*index' is moved after the
+ * newest one.
+ */
+static void priv_grow_delay_lines(std::vector<std::vector<SAMPLE_SPECS::sample_t> > *lines, long int *index, long int len)
+{
+  if (lines->size() == 0 ||
+      static_cast<long int>((*lines)[0].size()) >= len)
+    return;
+
+  long int old_len = (*lines)[0].size();
+  for(size_t n = 0; n < lines->size(); n++) {
+    std::rotate((*lines)[n].begin(), (*lines)[n].begin() + *index, (*lines)[n].end());
+    (*lines)[n].resize(len, 0.0);
+  }
+  *index = old_len;
+}
+
+/**
+ * Position of the sample written 'delay' samples before
+ * write position 'index' in a line of 'len' samples.
+ */
+static inline long int priv_delay_line_pos(long int index, long int delay, long int len)
+{
+  long int pos = index - delay;
+  return (pos < 0 ? pos + len : pos);
+}
+
 EFFECT_DELAY::EFFECT_DELAY (CHAIN_OPERATOR::parameter_t delay_time, int surround_mode, 
 			    int num_of_delays, CHAIN_OPERATOR::parameter_t mix_percent,
 			    CHAIN_OPERATOR::parameter_t feedback_percent) 
 {
-  laskuri = 0.0;
+  laskuri = 0;
+  delay_index = 0;
+  dtime = 0;
+  dnum = 1;
 
   set_parameter(1, delay_time);
   set_parameter(2, surround_mode);
@@ -146,18 +204,8 @@ void EFFECT_DELAY::set_parameter(int param, CHAIN_OPERATOR::parameter_t value)
       dtime_msec = value;
       dtime = dtime_msec * (CHAIN_OPERATOR::parameter_t)samples_per_second() / 1000;
       priv_check_for_zerodelay(&dtime, &dtime_msec, samples_per_second());
-      std::vector<std::vector<SINGLE_BUFFER> >::iterator p = buffer.begin();
-      while(p != buffer.end()) {
-	std::vector<SINGLE_BUFFER>::iterator q = p->begin();
-	while(q != p->end()) {
-	  if (q->size() > static_cast<size_t>(dtime)) {
-	    q->resize(static_cast<size_t>(dtime));
-	    laskuri = dtime;
-	  }
-	  ++q;
-	}
-	++p;
-      }
+      /* note: history is kept, only the tap positions move */
+      priv_grow_delay_lines(&buffer, &delay_index, dtime * static_cast<long int>(dnum));
       break;
     }
 
@@ -169,12 +217,7 @@ void EFFECT_DELAY::set_parameter(int param, CHAIN_OPERATOR::parameter_t value)
     {
       if (value != 0.0) dnum = static_cast<long int>(value);
       else dnum = 1.0;
-      std::vector<std::vector<SINGLE_BUFFER> >::iterator p = buffer.begin();
-      while(p != buffer.end()) {
-	p->resize(static_cast<unsigned int>(dnum));
-	++p;
-      }
-      laskuri = 0;
+      priv_grow_delay_lines(&buffer, &delay_index, dtime * static_cast<long int>(dnum));
       break;
     }
 
@@ -201,16 +244,17 @@ void EFFECT_DELAY::init(SAMPLE_BUFFER* insample)
 
   set_parameter(1, dtime_msec);
 
-  buffer.resize(2, std::vector<SINGLE_BUFFER> (static_cast<unsigned int>(dnum)));
-  for(size_t i = 0; i < buffer.size(); i++) {
-    for(size_t j = 0; j < buffer[i].size(); j++) {
-      buffer[i].clear();
-    }
-  }
+  priv_init_delay_lines(&buffer, 2,
+			priv_delay_line_capacity(dtime * static_cast<long int>(dnum),
+						 samples_per_second()));
+  laskuri = 0;
+  delay_index = 0;
 }
 
 void EFFECT_DELAY::process(void)
 {
+  long int len = buffer[SAMPLE_SPECS::ch_left].size();
+
   l.begin(SAMPLE_SPECS::ch_left);
   r.begin(SAMPLE_SPECS::ch_right);
 
@@ -229,14 +273,18 @@ void EFFECT_DELAY::process(void)
       feedfact *= feedback;
 
       if (laskuri >= dtime * (nm2 + 1)) {
+	/* note: tap 'nm2' was written dtime * (nm2 + 1) samples ago */
+	long int pos = priv_delay_line_pos(delay_index, dtime * (nm2 + 1), len);
+	SAMPLE_SPECS::sample_t tap_left = buffer[SAMPLE_SPECS::ch_left][pos];
+	SAMPLE_SPECS::sample_t tap_right = buffer[SAMPLE_SPECS::ch_right][pos];
 
 	switch ((int)surround) {
 	case 0: 
 	  {
 	    // ---
 	    // surround
-	    temp_left = buffer[SAMPLE_SPECS::ch_left][nm2].front();
-	    temp_right = buffer[SAMPLE_SPECS::ch_right][nm2].front();
+	    temp_left = tap_left;
+	    temp_right = tap_right;
 	    break;
 	  }
 
@@ -244,22 +292,18 @@ void EFFECT_DELAY::process(void)
 	  {
 	    // ---
 	    // surround
-	    temp_left = buffer[SAMPLE_SPECS::ch_right][nm2].front();
-	    temp_right = buffer[SAMPLE_SPECS::ch_left][nm2].front();
+	    temp_left = tap_right;
+	    temp_right = tap_left;
 	    break;
 	  }
 	case 2: 
 	  {
 	    if (nm2 % 2 == 0) {
-	      temp_left = (buffer[SAMPLE_SPECS::ch_left][nm2].front()
-			   + 
-			   buffer[SAMPLE_SPECS::ch_right][nm2].front()) / 2.0;
+	      temp_left = (tap_left + tap_right) / 2.0;
 	      temp_right = 0.0;
 	    }
 	    else {
-	      temp_right = (buffer[SAMPLE_SPECS::ch_left][nm2].front()
-			   + 
-			   buffer[SAMPLE_SPECS::ch_right][nm2].front()) / 2.0;
+	      temp_right = (tap_left + tap_right) / 2.0;
 	      temp_left = 0.0;
 	    }
 	    break;
@@ -269,24 +313,23 @@ void EFFECT_DELAY::process(void)
 	// Applying the reduction.
 	temp_left *= feedfact;
 	temp_right *= feedfact;
-
-	buffer[SAMPLE_SPECS::ch_left][nm2].pop_front();
-	buffer[SAMPLE_SPECS::ch_right][nm2].pop_front();
       }
-      buffer[SAMPLE_SPECS::ch_left][nm2].push_back(*l.current());
-      buffer[SAMPLE_SPECS::ch_right][nm2].push_back(*r.current());
 
       temp2_left += temp_left / dnum;
       temp2_right += temp_right / dnum;
 
     }
+    buffer[SAMPLE_SPECS::ch_left][delay_index] = *l.current();
+    buffer[SAMPLE_SPECS::ch_right][delay_index] = *r.current();
+    if (++delay_index == len) delay_index = 0;
+
     *l.current() = (*l.current() * (1.0 - mix)) + (temp2_left * mix);
     *r.current() = (*r.current() * (1.0 - mix)) + (temp2_right * mix);
 
     l.next();
     r.next();
 
-    if (laskuri < dtime * dnum) laskuri++;
+    if (laskuri < len) laskuri++;
   }
 }
 
@@ -453,6 +496,9 @@ void EFFECT_MULTITAP_DELAY::process(void)
 }
 
 EFFECT_FAKE_STEREO::EFFECT_FAKE_STEREO (CHAIN_OPERATOR::parameter_t delay_time)
+  : delay_index(0),
+    filled(0),
+    dtime(0)
 {
    set_parameter(1, delay_time);
 }
@@ -488,17 +534,13 @@ void EFFECT_FAKE_STEREO::set_parameter(int param, CHAIN_OPERATOR::parameter_t va
 {
   switch (param) {
   case 1:
-    dtime_msec = value;
-    dtime = dtime_msec * (CHAIN_OPERATOR::parameter_t)samples_per_second() / 1000;
-    priv_check_for_zerodelay(&dtime, &dtime_msec, samples_per_second());
-    std::vector<std::deque<SAMPLE_SPECS::sample_t> >::iterator p = buffer.begin();
-    while(p != buffer.end()) {
-      if (p->size() > static_cast<size_t>(dtime)) {
-	p->resize(static_cast<size_t>(dtime));
-      }
-      ++p;
+    {
+      dtime_msec = value;
+      dtime = dtime_msec * (CHAIN_OPERATOR::parameter_t)samples_per_second() / 1000;
+      priv_check_for_zerodelay(&dtime, &dtime_msec, samples_per_second());
+      priv_grow_delay_lines(&buffer, &delay_index, dtime);
+      break;
     }
-    break;
   }
 }
 
@@ -510,37 +552,36 @@ void EFFECT_FAKE_STEREO::init(SAMPLE_BUFFER* insample)
   EFFECT_BASE::init(insample);
 
   set_parameter(1, dtime_msec);
-  buffer.resize(2);
-  for(size_t i = 0; i < buffer.size(); i++) {
-    for(size_t j = 0; j < buffer[i].size(); j++) {
-      buffer[i].clear();
-    }
-  }
+  priv_init_delay_lines(&buffer, 2, priv_delay_line_capacity(dtime, samples_per_second()));
+  delay_index = 0;
+  filled = 0;
 }
 
 void EFFECT_FAKE_STEREO::process(void)
 {
   l.begin(SAMPLE_SPECS::ch_left);
   r.begin(SAMPLE_SPECS::ch_right);
+  long int len = buffer[SAMPLE_SPECS::ch_left].size();
+  long int pos = priv_delay_line_pos(delay_index, dtime, len);
   while(!l.end() && !r.end()) {
     SAMPLE_SPECS::sample_t temp_left = 0;
     SAMPLE_SPECS::sample_t temp_right = 0;
-    if (buffer[SAMPLE_SPECS::ch_left].size() >= static_cast<size_t>(dtime)) {
-      temp_left = buffer[SAMPLE_SPECS::ch_left].front();
-      temp_right = buffer[SAMPLE_SPECS::ch_right].front();
+    if (filled >= dtime) {
+      temp_left = buffer[SAMPLE_SPECS::ch_left][pos];
+      temp_right = buffer[SAMPLE_SPECS::ch_right][pos];
 
       temp_right = (temp_left + temp_right) / 2.0;
       temp_left = (*l.current() + *r.current()) / 2.0;
-
-      buffer[SAMPLE_SPECS::ch_left].pop_front();
-      buffer[SAMPLE_SPECS::ch_right].pop_front();
     }
     else {
       temp_left = (*l.current() + *r.current()) / 2.0;
       temp_right = 0.0;
     }
-    buffer[SAMPLE_SPECS::ch_left].push_back(*l.current());
-    buffer[SAMPLE_SPECS::ch_right].push_back(*r.current());
+    buffer[SAMPLE_SPECS::ch_left][delay_index] = *l.current();
+    buffer[SAMPLE_SPECS::ch_right][delay_index] = *r.current();
+    if (++delay_index == len) delay_index = 0;
+    if (++pos == len) pos = 0;
+    if (filled < len) ++filled;
 
     *l.current() = temp_left;
     *r.current() = temp_right;
@@ -552,6 +593,9 @@ void EFFECT_FAKE_STEREO::process(void)
 
 EFFECT_REVERB::EFFECT_REVERB (CHAIN_OPERATOR::parameter_t delay_time, int surround_mode, 
 			      CHAIN_OPERATOR::parameter_t feedback_percent) 
+  : delay_index(0),
+    filled(0),
+    dtime(0)
 {
   set_parameter(1, delay_time);
   set_parameter(2, surround_mode);
@@ -622,13 +666,7 @@ void EFFECT_REVERB::set_parameter(int param, CHAIN_OPERATOR::parameter_t value)
       dtime_msec = value;
       dtime = dtime_msec * (CHAIN_OPERATOR::parameter_t)samples_per_second() / 1000;
       priv_check_for_zerodelay(&dtime, &dtime_msec, samples_per_second());
-      std::vector<std::deque<SAMPLE_SPECS::sample_t> >::iterator p = buffer.begin();
-      while(p != buffer.end()) {
-        if (p->size() > static_cast<size_t>(dtime)) {
-          p->resize(static_cast<size_t>(dtime));
-        }
-        ++p;
-      }
+      priv_grow_delay_lines(&buffer, &delay_index, dtime);
       break;
     }
 
@@ -651,24 +689,23 @@ void EFFECT_REVERB::init(SAMPLE_BUFFER* insample)
 
   set_parameter(1, dtime_msec);
 
-  buffer.resize(2);
-  for(size_t i = 0; i < buffer.size(); i++) {
-    for(size_t j = 0; j < buffer[i].size(); j++) {
-      buffer[i].clear();
-    }
-  }
+  priv_init_delay_lines(&buffer, 2, priv_delay_line_capacity(dtime, samples_per_second()));
+  delay_index = 0;
+  filled = 0;
 }
 
 void EFFECT_REVERB::process(void)
 {
   l.begin(SAMPLE_SPECS::ch_left);
   r.begin(SAMPLE_SPECS::ch_right);
+  long int len = buffer[SAMPLE_SPECS::ch_left].size();
+  long int pos = priv_delay_line_pos(delay_index, dtime, len);
   while(!l.end() && !r.end()) {
     SAMPLE_SPECS::sample_t temp_left = 0.0;
     SAMPLE_SPECS::sample_t temp_right = 0.0;
-    if (buffer[SAMPLE_SPECS::ch_left].size() >= static_cast<size_t>(dtime)) {
-      temp_left = buffer[SAMPLE_SPECS::ch_left].front();
-      temp_right = buffer[SAMPLE_SPECS::ch_right].front();
+    if (filled >= dtime) {
+      temp_left = buffer[SAMPLE_SPECS::ch_left][pos];
+      temp_right = buffer[SAMPLE_SPECS::ch_right][pos];
       
       if (surround == 0) {
 	*l.current() = (*l.current() * (1 - feedback)) + (temp_left *  feedback);
@@ -678,8 +715,6 @@ void EFFECT_REVERB::process(void)
 	*l.current() = (*l.current() * (1 - feedback)) + (temp_right *  feedback);
 	*r.current() = (*r.current() * (1 - feedback)) + (temp_left * feedback);
       }
-      buffer[SAMPLE_SPECS::ch_left].pop_front();
-      buffer[SAMPLE_SPECS::ch_right].pop_front();
     }
     else {
 	*l.current() = (*l.current() * (1 - feedback));
@@ -687,8 +722,11 @@ void EFFECT_REVERB::process(void)
     }
     *l.current() = ecaops_flush_to_zero(*l.current());
     *r.current() = ecaops_flush_to_zero(*r.current());
-    buffer[SAMPLE_SPECS::ch_left].push_back(*l.current());
-    buffer[SAMPLE_SPECS::ch_right].push_back(*r.current());
+    buffer[SAMPLE_SPECS::ch_left][delay_index] = *l.current();
+    buffer[SAMPLE_SPECS::ch_right][delay_index] = *r.current();
+    if (++delay_index == len) delay_index = 0;
+    if (++pos == len) pos = 0;
+    if (filled < len) ++filled;
     l.next();
     r.next();
   }
@@ -828,7 +866,7 @@ void EFFECT_MODULATING_DELAY::init(SAMPLE_BUFFER* insample)
   EFFECT_BASE::init(insample);
 
   filled.resize(channels(), false);
-  delay_index.resize(channels(), 2 * dtime);
+  delay_index.resize(channels(), 0);
   buffer.resize(channels(), std::vector<SAMPLE_SPECS::sample_t> (2 * dtime));
   for(size_t i = 0; i < buffer.size(); i++) {
     for(size_t j = 0; j < buffer[i].size(); j++) {
@@ -919,3 +957,361 @@ void EFFECT_PHASER::process(void)
     i.next();
   }
 }
+
+/* note: grain window is read from a fixed-size table, so 
+ *       that the window length can change without 
+ *       reallocating; for any even grain length, gains of
+ *       two grains half a window apart sum to one */
+static const long int priv_wsola_fade_size = 4096;
+
+/* note: longest window and largest ratio accepted by 
+ *       EFFECT_PITCH_SHIFT_WSOLA, used for sizing buffers */
+static const double priv_wsola_max_window_msec = 200.0;
+static const double priv_wsola_max_ratio = 4.0;
+
+EFFECT_PITCH_SHIFT_WSOLA::EFFECT_PITCH_SHIFT_WSOLA (parameter_t change_percent, 
+						    parameter_t window_msec)
+  : window_rep(0),
+    search_rep(0),
+    overlap_rep(0),
+    buflen_mask_rep(0),
+    write_pos_rep(0),
+    newest_rep(0),
+    sbuf_repp(0)
+{
+  for(int k = 0; k < 2; k++) {
+    grains_rep[k].delay = 0.0;
+    grains_rep[k].pos = 0;
+    grains_rep[k].len = 0;
+  }
+
+  set_parameter(1, change_percent);
+  set_parameter(2, window_msec);
+}
+
+void EFFECT_PITCH_SHIFT_WSOLA::parameter_description(int param, struct PARAM_DESCRIPTION *pd) const
+{
+  OPERATOR::parameter_description(param, pd);
+
+  switch(param) 
+    {
+    case 1: 
+      pd->default_value = 100.0f;
+      pd->bounded_above = true;
+      pd->upper_bound = 400.0f; 
+      pd->bounded_below = true;
+      pd->lower_bound = 25.0f;
+      break;
+
+    case 2: 
+      pd->default_value = 40.0f;
+      pd->bounded_above = true;
+      pd->upper_bound = priv_wsola_max_window_msec; 
+      pd->bounded_below = true;
+      pd->lower_bound = 5.0f;
+      break;
+    }
+}
+
+void EFFECT_PITCH_SHIFT_WSOLA::set_parameter(int param, CHAIN_OPERATOR::parameter_t value)
+{
+  switch (param) {
+  case 1: 
+    pmod_rep = value;
+    if (pmod_rep < 25.0) pmod_rep = 25.0;
+    if (pmod_rep > 100.0 * priv_wsola_max_ratio) pmod_rep = 100.0 * priv_wsola_max_ratio;
+    pmod_start_rep = pmod_rep;
+    break;
+
+  case 2: 
+    window_msec_rep = value;
+    if (window_msec_rep < 5.0) window_msec_rep = 5.0;
+    if (window_msec_rep > priv_wsola_max_window_msec) window_msec_rep = priv_wsola_max_window_msec;
+    /* note: grains already started keep their length */
+    update_window();
+    break;
+  }
+}
+
+void EFFECT_PITCH_SHIFT_WSOLA::set_parameter_ramp(int param, CHAIN_OPERATOR::parameter_t value)
+{
+  switch (param) {
+  case 1: 
+    pmod_rep = value;
+    if (pmod_rep < 25.0) pmod_rep = 25.0;
+    if (pmod_rep > 100.0 * priv_wsola_max_ratio) pmod_rep = 100.0 * priv_wsola_max_ratio;
+    break;
+
+  default:
+    set_parameter(param, value);
+  }
+}
+
+CHAIN_OPERATOR::parameter_t EFFECT_PITCH_SHIFT_WSOLA::get_parameter(int param) const
+{
+  switch (param) {
+  case 1: 
+    return pmod_rep;
+  case 2: 
+    return window_msec_rep;
+  }
+  return 0.0;
+}
+
+/**
+ * Returns the average delay of the output, which is the 
+ * delay at the middle of a grain.
+ */
+long int EFFECT_PITCH_SHIFT_WSOLA::latency(void) const
+{
+  double ratio = pmod_rep / 100.0;
+  return static_cast<long int>(nominal_delay(ratio) + 
+			       window_rep / 2 * (1.0 - ratio) + 0.5);
+}
+
+/**
+ * Computes grain, search range and similarity window 
+ * lengths from the window length parameter.
+ */
+void EFFECT_PITCH_SHIFT_WSOLA::update_window(void)
+{
+  window_rep = static_cast<long int>(window_msec_rep * samples_per_second() / 1000.0);
+  window_rep &= ~1L;
+  if (window_rep < 16) window_rep = 16;
+
+  search_rep = window_rep / 4;
+  overlap_rep = (window_rep / 4) & ~1L;
+}
+
+/**
+ * Returns the delay at which a new grain would start if 
+ * there was no similarity search. Leaves room for the 
+ * search range, for comparing waveforms that end at the 
+ * newest sample, and for grains that read ahead faster
+ * than realtime when shifting up.
+ */
+double EFFECT_PITCH_SHIFT_WSOLA::nominal_delay(double ratio) const
+{
+  double readahead = (ratio > 1.0 ? window_rep * (ratio - 1.0) : 0.0);
+  return search_rep + overlap_rep + 2 + readahead;
+}
+
+/**
+ * Returns the delay at which the next grain should start.
+ *
+ * 'natural' is the delay of the newest grain's current
+ * read position, i.e. where the audio would continue
+ * without a splice. If it is within the search range 
+ * around 'nominal', it is used as is. Otherwise the 
+ * candidate whose waveform has the highest normalized
+ * correlation with the natural continuation is chosen.
+ * Candidates are first compared at every other delay, 
+ * and the best one refined to the nearest sample.
+ */
+double EFFECT_PITCH_SHIFT_WSOLA::find_splice(double natural, double nominal) const
+{
+  long int lo = static_cast<long int>(nominal) - search_rep;
+  long int hi = static_cast<long int>(nominal) + search_rep;
+  long int target = static_cast<long int>(natural + 0.5);
+
+  if (natural >= lo && natural <= hi)
+    return natural;
+
+  /* note: waveforms are compared over 'overlap_rep' samples 
+   *       after the splice point, at every other sample */
+  long int count = overlap_rep / 2;
+  if (target < 2 * count)
+    return nominal;
+
+  const SAMPLE_SPECS::sample_t* mono = &mono_rep[0];
+  long int mask = buflen_mask_rep;
+  long int tpos = write_pos_rep - target;
+
+  /* step: coarse search, energy of the candidate is updated 
+   *       incrementally as the candidate moves forward */
+  long int best = hi;
+  double best_score = 0.0;
+  double energy = 0.0;
+  long int cpos = write_pos_rep - hi;
+  for(long int i = 0; i < count; i++) {
+    double v = mono[(cpos + 2 * i) & mask];
+    energy += v * v;
+  }
+  for(long int c = hi; c >= lo; c -= 2) {
+    cpos = write_pos_rep - c;
+    double corr = 0.0;
+    for(long int i = 0; i < count; i++)
+      corr += static_cast<double>(mono[(cpos + 2 * i) & mask]) * mono[(tpos + 2 * i) & mask];
+    double score = corr / std::sqrt(energy + 1e-20);
+    if (c == hi || score > best_score) {
+      best = c;
+      best_score = score;
+    }
+    double out = mono[cpos & mask];
+    double in = mono[(cpos + 2 * count) & mask];
+    energy += in * in - out * out;
+    if (energy < 0.0) energy = 0.0;
+  }
+
+  /* step: refine to the neighbouring delays */
+  long int coarse = best;
+  for(long int c = coarse - 1; c <= coarse + 1; c += 2) {
+    if (c < lo || c > hi) 
+      continue;
+    cpos = write_pos_rep - c;
+    double corr = 0.0, e = 0.0;
+    for(long int i = 0; i < count; i++) {
+      double v = mono[(cpos + 2 * i) & mask];
+      corr += v * mono[(tpos + 2 * i) & mask];
+      e += v * v;
+    }
+    double score = corr / std::sqrt(e + 1e-20);
+    if (score > best_score) {
+      best = c;
+      best_score = score;
+    }
+  }
+
+  return static_cast<double>(best);
+}
+
+/**
+ * Starts a new grain, replacing the older of the two.
+ */
+void EFFECT_PITCH_SHIFT_WSOLA::start_grain(double ratio)
+{
+  double delay = find_splice(grains_rep[newest_rep].delay, nominal_delay(ratio));
+
+  newest_rep ^= 1;
+  grains_rep[newest_rep].delay = delay;
+  grains_rep[newest_rep].pos = 0;
+  grains_rep[newest_rep].len = window_rep;
+}
+
+void EFFECT_PITCH_SHIFT_WSOLA::init(SAMPLE_BUFFER *insample)
+{
+  sbuf_repp = insample;
+
+  EFFECT_BASE::init(insample);
+
+  update_window();
+
+  /* note: allocate for the longest window and largest ratio,
+   *       so that parameter changes do not reallocate; 
+   *       buffer length is a power of two */
+  long int max_window = static_cast<long int>(priv_wsola_max_window_msec * samples_per_second() / 1000.0) + 16;
+  long int max_delay = static_cast<long int>(max_window * (priv_wsola_max_ratio + 0.75)) + 16;
+  long int buflen = 1;
+  while(buflen < max_delay)
+    buflen <<= 1;
+  buflen_mask_rep = buflen - 1;
+
+  buffer_rep.resize(channels());
+  for(size_t ch = 0; ch < buffer_rep.size(); ch++) {
+    buffer_rep[ch].resize(buflen);
+    for(long int n = 0; n < buflen; n++)
+      buffer_rep[ch][n] = 0.0f;
+  }
+  mono_rep.resize(buflen);
+  for(long int n = 0; n < buflen; n++)
+    mono_rep[n] = 0.0f;
+
+  /* note: sin^2 window */
+  fade_table_rep.resize(priv_wsola_fade_size);
+  for(long int n = 0; n < priv_wsola_fade_size; n++) {
+    double s = std::sin(M_PI * n / priv_wsola_fade_size);
+    fade_table_rep[n] = s * s;
+  }
+
+  /* note: start with two grains half a window apart, as 
+   *       in steady state */
+  pmod_start_rep = pmod_rep;
+  write_pos_rep = 0;
+  newest_rep = 0;
+  for(int k = 0; k < 2; k++) {
+    grains_rep[k].delay = nominal_delay(pmod_rep / 100.0);
+    grains_rep[k].len = window_rep;
+  }
+  grains_rep[0].pos = 0;
+  grains_rep[1].pos = window_rep / 2;
+}
+
+void EFFECT_PITCH_SHIFT_WSOLA::release(void)
+{
+  sbuf_repp = 0;
+}
+
+void EFFECT_PITCH_SHIFT_WSOLA::process(void)
+{
+  long int len = sbuf_repp->length_in_samples();
+  int chcount = static_cast<int>(buffer_rep.size());
+  if (sbuf_repp->number_of_channels() < chcount)
+    chcount = sbuf_repp->number_of_channels();
+
+  /* note: ratio is ramped across the block if changed 
+   *       with set_parameter_ramp() */
+  double ratio = pmod_start_rep / 100.0;
+  double ratio_delta = 0.0;
+  if (pmod_start_rep != pmod_rep && len > 0)
+    ratio_delta = (pmod_rep - pmod_start_rep) / 100.0 / len;
+
+  for(long int n = 0; n < len; n++) {
+    SAMPLE_SPECS::sample_t mono = 0.0f;
+    for(int ch = 0; ch < chcount; ch++) {
+      buffer_rep[ch][write_pos_rep] = sbuf_repp->buffer[ch][n];
+      mono += sbuf_repp->buffer[ch][n];
+    }
+    mono_rep[write_pos_rep] = mono;
+
+    if (grains_rep[newest_rep].pos >= grains_rep[newest_rep].len / 2)
+      start_grain(ratio);
+
+    /* step: read positions and gains, shared by all channels */
+    long int idx[2];
+    SAMPLE_SPECS::sample_t frac[2], gain[2];
+    SAMPLE_SPECS::sample_t gainsum = 0.0f;
+    for(int k = 0; k < 2; k++) {
+      const GRAIN& g = grains_rep[k];
+      if (g.pos < g.len) {
+	/* note: a grain can only reach the newest sample if 
+	 *       the ratio jumps up while it is being read */
+	double delay = (g.delay > 0.0 ? g.delay : 0.0);
+	long int idelay = static_cast<long int>(delay);
+	frac[k] = delay - idelay;
+	/* note: interpolate between 'idelay' and 'idelay + 1' */
+	idx[k] = write_pos_rep - idelay;
+	gain[k] = fade_table_rep[g.pos * priv_wsola_fade_size / g.len];
+      }
+      else {
+	frac[k] = 0.0f;
+	idx[k] = write_pos_rep;
+	gain[k] = 0.0f;
+      }
+      gainsum += gain[k];
+    }
+
+    /* note: gains sum to one, except after window length 
+     *       changes */
+    SAMPLE_SPECS::sample_t norm = (gainsum > 0.001f ? 1.0f / gainsum : 1.0f);
+
+    for(int ch = 0; ch < chcount; ch++) {
+      const SAMPLE_SPECS::sample_t* dline = &buffer_rep[ch][0];
+      SAMPLE_SPECS::sample_t out = 0.0f;
+      for(int k = 0; k < 2; k++) {
+	SAMPLE_SPECS::sample_t a = dline[idx[k] & buflen_mask_rep];
+	SAMPLE_SPECS::sample_t b = dline[(idx[k] - 1) & buflen_mask_rep];
+	out += gain[k] * (a + frac[k] * (b - a));
+      }
+      sbuf_repp->buffer[ch][n] = ecaops_flush_to_zero(out * norm);
+    }
+
+    write_pos_rep = (write_pos_rep + 1) & buflen_mask_rep;
+    for(int k = 0; k < 2; k++) {
+      grains_rep[k].delay += 1.0 - ratio;
+      ++grains_rep[k].pos;
+    }
+    ratio += ratio_delta;
+  }
+
+  pmod_start_rep = pmod_rep;
+}
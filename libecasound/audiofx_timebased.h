@@ -2,15 +2,12 @@
 #define INCLUDED_AUDIOFX_TIMEBASED_H
 
 #include <vector>
-#include <deque>
 #include <string>
 
 #include "audiofx.h"
 #include "audiofx_filter.h"
 #include "osc-sine.h"
 
-typedef std::deque<SAMPLE_SPECS::sample_t> SINGLE_BUFFER;
-
 /**
  * Base class for time-based effects (delays, reverbs, etc).
  */
@@ -37,8 +34,9 @@ class EFFECT_DELAY : public EFFECT_TIME_BASED {
   parameter_t mix;
   parameter_t feedback;
 
-  parameter_t laskuri;
-  std::vector<std::vector<SINGLE_BUFFER> > buffer;
+  long int laskuri;
+  long int delay_index;
+  std::vector<std::vector<SAMPLE_SPECS::sample_t> > buffer;
 
  public:
 
@@ -102,7 +100,9 @@ class EFFECT_MULTITAP_DELAY : public EFFECT_TIME_BASED {
  */
 class EFFECT_FAKE_STEREO : public EFFECT_TIME_BASED {
 
-  std::vector<std::deque<SAMPLE_SPECS::sample_t> > buffer;
+  std::vector<std::vector<SAMPLE_SPECS::sample_t> > buffer;
+  long int delay_index;
+  long int filled;
   SAMPLE_ITERATOR_CHANNEL l,r;
   long int dtime;
   parameter_t dtime_msec;
@@ -132,7 +132,9 @@ class EFFECT_REVERB : public EFFECT_TIME_BASED {
 
  private:
     
-  std::vector<std::deque<SAMPLE_SPECS::sample_t>  > buffer;
+  std::vector<std::vector<SAMPLE_SPECS::sample_t> > buffer;
+  long int delay_index;
+  long int filled;
   SAMPLE_ITERATOR_CHANNEL l,r;
 
   parameter_t surround;
@@ -241,4 +243,80 @@ class EFFECT_PHASER : public EFFECT_MODULATING_DELAY {
   EFFECT_PHASER* new_expr(void) const { return new EFFECT_PHASER(); }
 };
 
+/**
+ * Pitch shifter that keeps the buffer length constant. 
+ *
+ * Based on WSOLA (waveform similarity overlap-add). Output
+ * is built from overlapping grains of one window, read
+ * from a delay line at the shifted rate and crossfaded
+ * with a raised-cosine window at half-window hops. Each
+ * new grain starts at the position, within a search range
+ * around the nominal delay, whose waveform is most similar
+ * to the natural continuation of the previous grain, so
+ * grains are spliced in phase. The similarity search runs
+ * once on a mono sum of the input, and grain positions and
+ * gains are shared by all channels.
+ *
+ * Unlike EFFECT_PITCH_SHIFT, the output is not resampled, 
+ * so buffer length stays fixed and the operator can be used
+ * in realtime chains without oversized buffers. Delay 
+ * lines are allocated by init() for the longest window, 
+ * so parameter changes do not allocate.
+ */
+class EFFECT_PITCH_SHIFT_WSOLA : public EFFECT_TIME_BASED {
+
+ private:
+
+  /**
+   * One grain being read from the delay lines.
+   */
+  struct GRAIN {
+    double delay;
+    long int pos;
+    long int len;
+  };
+
+  parameter_t pmod_rep;
+  parameter_t pmod_start_rep;
+  parameter_t window_msec_rep;
+  long int window_rep;
+  long int search_rep;
+  long int overlap_rep;
+  long int buflen_mask_rep;
+  long int write_pos_rep;
+  GRAIN grains_rep[2];
+  int newest_rep;
+  std::vector<SAMPLE_SPECS::sample_t> fade_table_rep;
+  std::vector<SAMPLE_SPECS::sample_t> mono_rep;
+  std::vector<std::vector<SAMPLE_SPECS::sample_t> > buffer_rep;
+  SAMPLE_BUFFER* sbuf_repp;
+
+  void update_window(void);
+  double nominal_delay(double ratio) const;
+  double find_splice(double natural, double nominal) const;
+  void start_grain(double ratio);
+
+ public:
+
+  virtual std::string name(void) const { return("Pitch shifter (fixed length)"); }
+  virtual std::string description(void) const { return("Modify audio pitch without altering its length."); }
+  virtual std::string parameter_names(void) const { return("change-%,window-msec"); }
+  virtual void parameter_description(int param, struct PARAM_DESCRIPTION *pd) const;
+
+  virtual void set_parameter(int param, parameter_t value);
+  virtual parameter_t get_parameter(int param) const;
+  virtual bool parameter_ramp_supported(int param) const { return param == 1; }
+  virtual void set_parameter_ramp(int param, parameter_t value);
+
+  virtual void init(SAMPLE_BUFFER *insample);
+  virtual void release(void);
+  virtual void process(void);
+
+  virtual long int latency(void) const;
+
+  EFFECT_PITCH_SHIFT_WSOLA* clone(void) const { return new EFFECT_PITCH_SHIFT_WSOLA(*this); }
+  EFFECT_PITCH_SHIFT_WSOLA* new_expr(void) const { return new EFFECT_PITCH_SHIFT_WSOLA(); }
+  EFFECT_PITCH_SHIFT_WSOLA (parameter_t change_percent = 100.0, parameter_t window_msec = 40.0);
+};
+
 #endif
@@ -0,0 +1,258 @@
+// ------------------------------------------------------------------------
+// audiofx_timebased_test.h: Unit tests for time-based effects
+// Copyright (C) 2026 agent
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+// 
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+// 
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
+// ------------------------------------------------------------------------
+
+#include <string>
+#include <cmath>
+#include <cstdio>
+
+#include "kvu_dbc.h"
+
+#include "audiofx_timebased.h"
+#include "samplebuffer_functions.h"
+#include "eca-test-case.h"
+
+using namespace std;
+
+/**
+ * Unit test for EFFECT_DELAY
+ */
+class EFFECT_DELAY_TEST : public ECA_TEST_CASE {
+
+protected:
+
+  virtual string do_name(void) const { return("EFFECT_DELAY"); }
+  virtual void do_run(void);
+
+public:
+
+  virtual ~EFFECT_DELAY_TEST(void) { }
+};
+
+void EFFECT_DELAY_TEST::do_run(void)
+{
+  const int bufsize = 8;
+  const int channels = 2;
+
+  std::fprintf(stdout, "%s: tests for %s class\n",
+	       name().c_str(), __FILE__);
+
+  /* case: changing the delay time keeps the history, so an
+   *       impulse already in the line comes out at the new 
+   *       delay */
+  {
+    std::fprintf(stdout, "%s: delay time change\n", __FILE__);
+
+    /* note: at 1kHz, delay of 1ms is one sample */
+    SAMPLE_BUFFER sbuf (bufsize, channels);
+    EFFECT_DELAY delay (10.0, 0, 1, 100.0, 100.0);
+    delay.set_samples_per_second(1000);
+    delay.init(&sbuf);
+
+    long int impulse_at = -1;
+    for(int b = 0; b < 4; b++) {
+      for(int ch = 0; ch < channels; ch++)
+	for(int n = 0; n < bufsize; n++)
+	  sbuf.buffer[ch][n] = (b == 0 && n == 0 ? 1.0f : 0.0f);
+
+      if (b == 1)
+	delay.set_parameter(1, 20.0);
+
+      delay.process();
+
+      for(int n = 0; n < bufsize; n++) {
+	if (std::fabs(sbuf.buffer[0][n]) > 0.5f) {
+	  if (impulse_at >= 0)
+	    ECA_TEST_FAILURE("impulse repeated");
+	  impulse_at = b * bufsize + n;
+	}
+      }
+    }
+
+    if (impulse_at != 20)
+      ECA_TEST_FAILURE("impulse not delayed by the new delay time");
+  }
+}
+
+/**
+ * Unit test for EFFECT_PITCH_SHIFT_WSOLA
+ */
+class EFFECT_PITCH_SHIFT_WSOLA_TEST : public ECA_TEST_CASE {
+
+protected:
+
+  virtual string do_name(void) const { return("EFFECT_PITCH_SHIFT_WSOLA"); }
+  virtual void do_run(void);
+
+public:
+
+  virtual ~EFFECT_PITCH_SHIFT_WSOLA_TEST(void) { }
+
+private:
+
+  long int zero_crossings(EFFECT_PITCH_SHIFT_WSOLA* ps, SAMPLE_BUFFER* sbuf, int blocks, int skip, double* rms = 0);
+};
+
+/**
+ * Runs a sine through 'ps' and returns the number of zero 
+ * crossings in the output of the first channel, skipping 
+ * the first 'skip' blocks. Also checks that buffer length
+ * is preserved and that the level does not grow. If 'rms'
+ * is given, it is set to the RMS level of the output.
+ */
+long int EFFECT_PITCH_SHIFT_WSOLA_TEST::zero_crossings(EFFECT_PITCH_SHIFT_WSOLA* ps, SAMPLE_BUFFER* sbuf, int blocks, int skip, double* rms)
+{
+  const int bufsize = sbuf->length_in_samples();
+  long int crossings = 0;
+  double sum = 0.0;
+  SAMPLE_BUFFER::sample_t prev = 0.0f;
+
+  for(int b = 0; b < blocks; b++) {
+    for(int ch = 0; ch < sbuf->number_of_channels(); ch++)
+      for(int n = 0; n < bufsize; n++)
+	sbuf->buffer[ch][n] = std::sin((b * bufsize + n) * 0.05) * 0.5f;
+
+    ps->process();
+
+    if (sbuf->length_in_samples() != bufsize)
+      ECA_TEST_FAILURE("buffer length changed");
+
+    for(int n = 0; n < bufsize; n++) {
+      SAMPLE_BUFFER::sample_t cur = sbuf->buffer[0][n];
+      if (std::fabs(cur) > 0.5001f) {
+	ECA_TEST_FAILURE("output level exceeds input level");
+	break;
+      }
+      if (b >= skip && ((prev < 0.0f && cur >= 0.0f) || (prev >= 0.0f && cur < 0.0f)))
+	++crossings;
+      if (b >= skip)
+	sum += cur * cur;
+      prev = cur;
+    }
+  }
+
+  if (rms != 0)
+    *rms = std::sqrt(sum / ((blocks - skip) * bufsize));
+
+  return crossings;
+}
+
+void EFFECT_PITCH_SHIFT_WSOLA_TEST::do_run(void)
+{
+  const int bufsize = 256;
+  const int channels = 2;
+  const int blocks = 16;
+
+  std::fprintf(stdout, "%s: tests for %s class\n",
+	       name().c_str(), __FILE__);
+
+  /* case: no shift, output is the input delayed by latency */
+  {
+    std::fprintf(stdout, "%s: pure delay at 100%%\n", __FILE__);
+
+    SAMPLE_BUFFER sbuf (bufsize, channels);
+    EFFECT_PITCH_SHIFT_WSOLA ps (100.0, 10.0);
+    ps.set_samples_per_second(44100);
+    ps.init(&sbuf);
+
+    long int latency = ps.latency();
+    if (latency <= 0)
+      ECA_TEST_FAILURE("latency not reported");
+
+    std::vector<SAMPLE_BUFFER::sample_t> input (bufsize * blocks);
+    for(size_t n = 0; n < input.size(); n++)
+      input[n] = std::sin(n * 0.05);
+
+    for(int b = 0; b < blocks; b++) {
+      for(int ch = 0; ch < channels; ch++)
+	for(int n = 0; n < bufsize; n++)
+	  sbuf.buffer[ch][n] = input[b * bufsize + n];
+
+      ps.process();
+
+      if (sbuf.length_in_samples() != bufsize)
+	ECA_TEST_FAILURE("buffer length changed");
+
+      for(int ch = 0; ch < channels; ch++) {
+	for(int n = 0; n < bufsize; n++) {
+	  long int src = b * bufsize + n - latency;
+	  SAMPLE_BUFFER::sample_t expected = (src >= 0 ? input[src] : 0.0f);
+	  if (std::fabs(sbuf.buffer[ch][n] - expected) > 0.0001f) {
+	    ECA_TEST_FAILURE("output not equal to delayed input");
+	    b = blocks;
+	    ch = channels;
+	    break;
+	  }
+	}
+      }
+    }
+  }
+
+  /* case: pitch of a sine moves by the shift ratio, and
+   *       grains are spliced in phase, so the level of 
+   *       the sine is kept */
+  {
+    std::fprintf(stdout, "%s: shift up and down\n", __FILE__);
+
+    const int zc_blocks = 64;
+    const int zc_skip = 8;
+    const double shifts[] = { 150.0, 75.0, 200.0 };
+
+    SAMPLE_BUFFER sbuf (bufsize, channels);
+    EFFECT_PITCH_SHIFT_WSOLA ref (100.0, 20.0);
+    ref.set_samples_per_second(44100);
+    ref.init(&sbuf);
+    long int ref_crossings = zero_crossings(&ref, &sbuf, zc_blocks, zc_skip);
+
+    for(int p = 0; p < 3; p++) {
+      EFFECT_PITCH_SHIFT_WSOLA ps (shifts[p], 20.0);
+      ps.set_samples_per_second(44100);
+      ps.init(&sbuf);
+      double rms;
+      long int crossings = zero_crossings(&ps, &sbuf, zc_blocks, zc_skip, &rms);
+
+      double ratio = static_cast<double>(crossings) / ref_crossings;
+      std::fprintf(stdout, "%s: shift %.0f%%, zero crossing ratio %.3f, rms %.3f\n", 
+		   __FILE__, shifts[p], ratio, rms);
+      if (std::fabs(ratio - shifts[p] / 100.0) > 0.03 * shifts[p] / 100.0)
+	ECA_TEST_FAILURE("pitch not shifted by the requested ratio");
+      /* note: RMS of the input sine is 0.5 / sqrt(2) */
+      if (rms < 0.95 * 0.5 / std::sqrt(2.0))
+	ECA_TEST_FAILURE("level lost at grain splices");
+    }
+  }
+
+  /* case: window length changes while running */
+  {
+    std::fprintf(stdout, "%s: window length change\n", __FILE__);
+
+    SAMPLE_BUFFER sbuf (bufsize, channels);
+    EFFECT_PITCH_SHIFT_WSOLA ps (150.0, 20.0);
+    ps.set_samples_per_second(44100);
+    ps.init(&sbuf);
+    long int latency = ps.latency();
+
+    zero_crossings(&ps, &sbuf, 4, 0);
+    ps.set_parameter(2, 80.0);
+    if (ps.latency() <= latency)
+      ECA_TEST_FAILURE("latency not updated");
+    zero_crossings(&ps, &sbuf, 8, 0);
+    ps.set_parameter(2, 5.0);
+    zero_crossings(&ps, &sbuf, 8, 0);
+  }
+}
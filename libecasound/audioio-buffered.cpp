@@ -84,8 +84,8 @@ void AUDIO_IO_BUFFERED::read_buffer(SAMPLE_BUFFER* sbuf)
   }
 
   if (sbuf->length_in_samples() < buffersize_rep) {
-    ECA_LOG_MSG(ECA_LOGGER::user_objects, "end-of-stream tag detected for '"
-		+ description() + "'");
+    ECA_LOG_RT_MSG(ECA_LOGGER::user_objects, 
+		   "end-of-stream tag detected for '%s'", label());
     sbuf->event_tag_set(SAMPLE_BUFFER::tag_end_of_stream);
   }
 
@@ -1,6 +1,7 @@
 // ------------------------------------------------------------------------
 // audioio-db-server.cpp: Audio i/o engine serving db clients.
 // Copyright (C) 2000-2005,2009,2011 Kai Vehmanen
+// Copyright (C) 2026 agent
 //
 // Attributes:
 //     eca-style-version: 3
@@ -41,6 +42,8 @@
 #include "sample-specs.h"
 #include "samplebuffer.h"
 #include "eca-logger.h"
+#include "eca-thread-affinity.h"
+#include "eca-trace-recorder.h"
 #include "audioio-db-server.h"
 #include "audioio-db-server_impl.h"
 
@@ -84,6 +87,8 @@ void* start_db_server_io_thread(void *ptr)
 
   AUDIO_IO_DB_SERVER* pserver =
     static_cast<AUDIO_IO_DB_SERVER*>(ptr);
+  ECA_THREAD_AFFINITY::apply("io", pserver->affinity_rep);
+  ECA_TRACE_RECORDER::set_thread_name("io");
   pserver->io_thread();
 
   return 0;
@@ -524,6 +529,7 @@ void AUDIO_IO_DB_SERVER::io_thread(void)
 	  /* room available, so we can read at least one buffer of data */
 
 	  if (clients_rep[p]->finished() != true) {
+	    ECA_TRACE_SCOPE trace_scope ("io", "read", clients_rep[p]->label().c_str());
 	    clients_rep[p]->read_buffer(buffers_rep[p]->sbufs_rep[buffers_rep[p]->writeptr_rep.get()]);
 	    if (clients_rep[p]->finished() == true) buffers_rep[p]->finished_rep.set(1);
 	    buffers_rep[p]->advance_write_pointer();
@@ -544,6 +550,7 @@ void AUDIO_IO_DB_SERVER::io_thread(void)
 	  /* room available, so we can write at least one buffer of data */
 
 	  if (clients_rep[p]->finished() != true) {
+	    ECA_TRACE_SCOPE trace_scope ("io", "write", clients_rep[p]->label().c_str());
 	    clients_rep[p]->write_buffer(buffers_rep[p]->sbufs_rep[buffers_rep[p]->readptr_rep.get()]);
 	    if (clients_rep[p]->finished() == true) buffers_rep[p]->finished_rep.set(1);
 	    buffers_rep[p]->advance_read_pointer();
@@ -2,6 +2,7 @@
 #define INCLUDED_AUDIOIO_DB_SERVER_H
 
 #include <map>
+#include <string>
 #include "audioio.h"
 #include "audioio-db-buffer.h"
 
@@ -64,6 +65,7 @@ class AUDIO_IO_DB_SERVER {
   /*@{*/
 
   void set_buffer_defaults(int buffers, long int buffersize);
+  void set_affinity(const std::string& cpus) { affinity_rep = cpus; }
   void register_client(AUDIO_IO* abject);
   void unregister_client(AUDIO_IO* abject);
   AUDIO_IO_DB_BUFFER* get_client_buffer(AUDIO_IO* abject);
@@ -93,6 +95,7 @@ class AUDIO_IO_DB_SERVER {
   int buffercount_rep;
   long int buffersize_rep;
   int schedpriority_rep;
+  std::string affinity_rep;
 
   AUDIO_IO_DB_SERVER& operator=(const AUDIO_IO_DB_SERVER& x) { return *this; }
   AUDIO_IO_DB_SERVER (const AUDIO_IO_DB_SERVER& x) { }
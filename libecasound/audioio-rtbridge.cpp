@@ -0,0 +1,379 @@
+// ------------------------------------------------------------------------
+// audioio-rtbridge.cpp: Runs a realtime device at its own sample rate
+//                       and clock.
+// Copyright (C) 2026 agent
+//
+// Attributes:
+//     eca-style-version: 3
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
+// ------------------------------------------------------------------------
+
+#include <cstdlib> /* atoi() */
+
+#include <kvu_dbc.h>
+#include <kvu_message_item.h>
+#include <kvu_numtostr.h>
+
+#include "audioio-rtbridge.h"
+#include "audioio-manager.h"
+#include "eca-logger.h"
+#include "eca-thread-affinity.h"
+#include "eca-object-factory.h"
+
+AUDIO_IO_RT_BRIDGE::AUDIO_IO_RT_BRIDGE(void)
+  : child_repp(0),
+    child_srate_rep(0),
+    device_buffer_rep(buffersize(), 0),
+    thread_running_rep(false),
+    exit_rep(false)
+{
+}
+
+AUDIO_IO_RT_BRIDGE::~AUDIO_IO_RT_BRIDGE(void)
+{
+  if (is_open() == true)
+    close();
+
+  delete child_repp;
+}
+
+AUDIO_IO_RT_BRIDGE* AUDIO_IO_RT_BRIDGE::clone(void) const
+{
+  AUDIO_IO_RT_BRIDGE* target = new AUDIO_IO_RT_BRIDGE();
+  for(int n = 0; n < number_of_params(); n++) {
+    target->set_parameter(n + 1, get_parameter(n + 1));
+  }
+  return target;
+}
+
+/**
+ * Joins child parameters to a single string. Parameters
+ * containing commas are quoted.
+ */
+static std::string audioio_rtbridge_join_params(const std::vector<std::string>& params, int first)
+{
+  std::string res;
+  for(int n = first; n <= static_cast<int>(params.size()); n++) {
+    std::string v = params[n - 1];
+    if (v.find(",") != std::string::npos)
+      v = "\"" + v + "\"";
+    res += v;
+    if (n != static_cast<int>(params.size()))
+      res += ",";
+  }
+  return res;
+}
+
+void AUDIO_IO_RT_BRIDGE::open(void) throw(AUDIO_IO::SETUP_ERROR&)
+{
+  if (child_repp == 0) {
+    const std::string objname =
+      audioio_rtbridge_join_params(params_rep, 1 + AUDIO_IO_RT_BRIDGE::child_parameter_offset);
+
+    AUDIO_IO* tmp = 0;
+    if (objname.size() > 0)
+      tmp = ECA_OBJECT_FACTORY::create_audio_object(objname);
+
+    AUDIO_IO_DEVICE* dev = dynamic_cast<AUDIO_IO_DEVICE*>(tmp);
+    if (dev == 0) {
+      delete tmp;
+      throw(SETUP_ERROR(SETUP_ERROR::dynamic_params, "AUDIOIO-RTBRIDGE: '" + objname + "' is not a realtime device"));
+    }
+
+    AUDIO_IO_MANAGER* mgr = dev->create_object_manager();
+    if (mgr != 0) {
+      delete mgr;
+      delete dev;
+      throw(SETUP_ERROR(SETUP_ERROR::dynamic_params, "AUDIOIO-RTBRIDGE: devices that use an object manager, such as '" + objname + "', cannot be bridged"));
+    }
+
+    int numparams = dev->number_of_params();
+    for(int n = 0; n < numparams; n++) {
+      dev->set_parameter(n + 1, get_parameter(n + 1 + AUDIO_IO_RT_BRIDGE::child_parameter_offset));
+      if (dev->variable_params())
+	numparams = dev->number_of_params();
+    }
+
+    child_repp = dev;
+  }
+
+  if (child_srate_rep <= 0)
+    throw(SETUP_ERROR(SETUP_ERROR::sample_rate, "AUDIOIO-RTBRIDGE: device sample rate not set"));
+
+  child_repp->set_io_mode((io_mode() == io_read) ? io_read : io_write);
+  child_repp->set_audio_format(audio_format());
+  child_repp->set_samples_per_second(child_srate_rep);
+  child_repp->set_buffersize(buffersize());
+  child_repp->toggle_ignore_xruns(ignore_xruns());
+  child_repp->toggle_max_buffers(max_buffers());
+
+  child_repp->open();
+
+  if (child_repp->samples_per_second() != child_srate_rep) {
+    ECA_LOG_MSG(ECA_LOGGER::info,
+		"Device '" + child_repp->label() + "' uses sample rate " +
+		kvu_numtostr(child_repp->samples_per_second()) + " instead of " +
+		kvu_numtostr(child_srate_rep) + ".");
+  }
+  if (child_repp->locked_audio_format() == true)
+    set_channels(child_repp->channels());
+
+  SAMPLE_SPECS::sample_rate_t dev_srate = child_repp->samples_per_second();
+  long int dev_bsize = child_repp->buffersize();
+
+  device_buffer_rep.number_of_channels(channels());
+  device_buffer_rep.length_in_samples(dev_bsize);
+
+  if (io_mode() == io_read)
+    resampler_rep.init(channels(), dev_srate, samples_per_second(), dev_bsize, buffersize());
+  else
+    resampler_rep.init(channels(), samples_per_second(), dev_srate, buffersize(), dev_bsize);
+
+  ECA_LOG_MSG(ECA_LOGGER::user_objects,
+	      "open; device " + child_repp->label() +
+	      " at " + kvu_numtostr(dev_srate) +
+	      "Hz, bsize " + kvu_numtostr(dev_bsize) +
+	      ", fifo target " + kvu_numtostr(resampler_rep.target_fill()) + " frames.");
+
+  set_label("rtbridge:" + child_repp->label());
+
+  AUDIO_IO_DEVICE::open();
+}
+
+void AUDIO_IO_RT_BRIDGE::close(void)
+{
+  if (is_running() == true)
+    stop();
+
+  if (child_repp != 0 && child_repp->is_open() == true)
+    child_repp->close();
+
+  AUDIO_IO_DEVICE::close();
+}
+
+void AUDIO_IO_RT_BRIDGE::prepare(void)
+{
+  child_repp->prepare();
+  resampler_rep.reset();
+
+  AUDIO_IO_DEVICE::prepare();
+}
+
+void AUDIO_IO_RT_BRIDGE::start(void)
+{
+  DBC_REQUIRE(thread_running_rep != true);
+
+  if (io_mode() != io_read && child_repp->prefill_space() > 0) {
+    /* note: output devices must be given data before start(); the
+     *       device buffer is filled completely, as otherwise the
+     *       device thread would drain the FIFO right after start */
+    device_buffer_rep.make_silent();
+    long int blocks = child_repp->prefill_space() / child_repp->buffersize();
+    if (blocks < 1) blocks = 1;
+    for(long int n = 0; n < blocks; n++)
+      child_repp->write_buffer(&device_buffer_rep);
+  }
+
+  child_repp->start();
+
+  /* note: the device thread inherits the scheduling
+   *       policy of the engine thread calling start() */
+  pthread_attr_t attr;
+  pthread_attr_init(&attr);
+  pthread_attr_setinheritsched(&attr, PTHREAD_INHERIT_SCHED);
+
+  exit_rep = false;
+  if (pthread_create(&thread_rep, &attr, AUDIO_IO_RT_BRIDGE::device_thread, this) == 0)
+    thread_running_rep = true;
+  else
+    ECA_LOG_MSG(ECA_LOGGER::errors,
+		"Unable to create device thread for '" + child_repp->label() + "'.");
+
+  pthread_attr_destroy(&attr);
+
+  AUDIO_IO_DEVICE::start();
+}
+
+void AUDIO_IO_RT_BRIDGE::stop(bool drain)
+{
+  if (thread_running_rep == true) {
+    exit_rep = true;
+    pthread_join(thread_rep, 0);
+    thread_running_rep = false;
+  }
+
+  if (child_repp->is_running() == true)
+    child_repp->stop(drain);
+
+  if (resampler_rep.xruns() > 0 || resampler_rep.dropped() > 0) {
+    ECA_LOG_MSG(ECA_LOGGER::info,
+		"WARNING: " + kvu_numtostr(resampler_rep.xruns()) +
+		" xruns and " + kvu_numtostr(resampler_rep.dropped()) +
+		" dropped frames in bridge to '" + child_repp->label() + "'.");
+  }
+
+  AUDIO_IO_DEVICE::stop(drain);
+}
+
+void* AUDIO_IO_RT_BRIDGE::device_thread(void* arg)
+{
+  ECA_THREAD_AFFINITY::apply("io");
+  static_cast<AUDIO_IO_RT_BRIDGE*>(arg)->run_device();
+  return 0;
+}
+
+/**
+ * Main loop of the device thread. The timing is set
+ * by the blocking I/O calls of the child device.
+ */
+void AUDIO_IO_RT_BRIDGE::run_device(void)
+{
+  while(exit_rep != true) {
+    if (io_mode() == io_read) {
+      child_repp->read_buffer(&device_buffer_rep);
+      resampler_rep.write(&device_buffer_rep);
+    }
+    else {
+      resampler_rep.read(&device_buffer_rep, child_repp->buffersize());
+      child_repp->write_buffer(&device_buffer_rep);
+    }
+  }
+}
+
+void AUDIO_IO_RT_BRIDGE::read_buffer(SAMPLE_BUFFER* sbuf)
+{
+  resampler_rep.read(sbuf, buffersize());
+  change_position_in_samples(sbuf->length_in_samples());
+}
+
+void AUDIO_IO_RT_BRIDGE::write_buffer(SAMPLE_BUFFER* sbuf)
+{
+  if (sbuf->length_in_samples() != buffersize() &&
+      sbuf->event_tag_test(SAMPLE_BUFFER::tag_var_length) != true) {
+    sbuf->length_in_samples(buffersize());
+  }
+
+  if (is_running() == true)
+    resampler_rep.write(sbuf);
+
+  change_position_in_samples(sbuf->length_in_samples());
+}
+
+long int AUDIO_IO_RT_BRIDGE::read_samples(void* target_buffer, long int sample_frames)
+{
+  /* note: read_buffer() is reimplemented */
+  DBC_NEVER_REACHED();
+  return 0;
+}
+
+void AUDIO_IO_RT_BRIDGE::write_samples(void* target_buffer, long int sample_frames)
+{
+  /* note: write_buffer() is reimplemented */
+  DBC_NEVER_REACHED();
+}
+
+/**
+ * Converts 'frames' at sample rate 'srate' to
+ * frames at the chainsetup rate.
+ */
+long int AUDIO_IO_RT_BRIDGE::to_engine_frames(long int frames, SAMPLE_SPECS::sample_rate_t srate) const
+{
+  if (srate <= 0)
+    return frames;
+
+  return static_cast<long int>(static_cast<double>(frames) * samples_per_second() / srate);
+}
+
+long int AUDIO_IO_RT_BRIDGE::latency(void) const
+{
+  if (child_repp == 0 || child_repp->is_open() != true)
+    return 0;
+
+  SAMPLE_SPECS::sample_rate_t fifo_srate =
+    (io_mode() == io_read) ? child_repp->samples_per_second() : samples_per_second();
+
+  return to_engine_frames(resampler_rep.target_fill(), fifo_srate) +
+    to_engine_frames(child_repp->latency(), child_repp->samples_per_second());
+}
+
+long int AUDIO_IO_RT_BRIDGE::delay(void) const
+{
+  if (child_repp == 0 || child_repp->is_running() != true)
+    return 0;
+
+  SAMPLE_SPECS::sample_rate_t fifo_srate =
+    (io_mode() == io_read) ? child_repp->samples_per_second() : samples_per_second();
+
+  return to_engine_frames(resampler_rep.fill(), fifo_srate) +
+    to_engine_frames(child_repp->delay(), child_repp->samples_per_second());
+}
+
+std::string AUDIO_IO_RT_BRIDGE::status(void) const
+{
+  MESSAGE_ITEM mitem;
+
+  mitem << AUDIO_IO_DEVICE::status();
+  if (child_repp != 0 && is_open() == true) {
+    mitem << "\n -> device " << child_repp->samples_per_second() << "Hz";
+    mitem << ", ratio correction " << kvu_numtostr(resampler_rep.correction() * 1000000.0, 1) << "ppm";
+    mitem << ", fifo " << resampler_rep.fill() << "/" << resampler_rep.target_fill();
+    mitem << ", xruns " << resampler_rep.xruns() << ".";
+  }
+
+  return mitem.to_string();
+}
+
+std::string AUDIO_IO_RT_BRIDGE::parameter_names(void) const
+{
+  std::string names ("rtbridge,srate");
+  if (child_repp != 0)
+    names += "," + child_repp->parameter_names();
+  return names;
+}
+
+void AUDIO_IO_RT_BRIDGE::set_parameter(int param, std::string value)
+{
+  ECA_LOG_MSG(ECA_LOGGER::user_objects,
+	      AUDIO_IO::parameter_set_to_string(param, value));
+
+  if (param > static_cast<int>(params_rep.size())) params_rep.resize(param);
+
+  if (param > 0) {
+    params_rep[param - 1] = value;
+
+    if (param == 2)
+      child_srate_rep = std::atoi(value.c_str());
+  }
+
+  if (param > AUDIO_IO_RT_BRIDGE::child_parameter_offset &&
+      child_repp != 0) {
+    child_repp->set_parameter(param - AUDIO_IO_RT_BRIDGE::child_parameter_offset, value);
+  }
+}
+
+std::string AUDIO_IO_RT_BRIDGE::get_parameter(int param) const
+{
+  if (param > 0 && param < static_cast<int>(params_rep.size()) + 1) {
+    if (param > AUDIO_IO_RT_BRIDGE::child_parameter_offset &&
+	child_repp != 0) {
+      params_rep[param - 1] =
+	child_repp->get_parameter(param - AUDIO_IO_RT_BRIDGE::child_parameter_offset);
+    }
+    return params_rep[param - 1];
+  }
+
+  return "";
+}
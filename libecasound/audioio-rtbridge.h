@@ -0,0 +1,134 @@
+#ifndef INCLUDED_AUDIOIO_RTBRIDGE_H
+#define INCLUDED_AUDIOIO_RTBRIDGE_H
+
+#include <string>
+#include <vector>
+#include <pthread.h>
+
+#include "audioio-device.h"
+#include "eca-async-resampler.h"
+#include "samplebuffer.h"
+
+/**
+ * Connects a realtime device running at its own sample
+ * rate and clock to the chainsetup.
+ *
+ * The child device is run in a separate thread, which
+ * exchanges audio with the engine through an
+ * ECA_ASYNC_RESAMPLER. The resampling ratio follows the
+ * clock drift between the device and the engine, so
+ * the device can run from a different clock than the
+ * other realtime objects of the chainsetup, such as
+ * JACK. The engine must be driven by some other
+ * realtime object; the bridge itself never blocks.
+ *
+ * Devices that need an object manager, such as JACK
+ * clients, cannot be bridged.
+ *
+ * Syntax: rtbridge,srate,child-params
+ *
+ * @author agent
+ */
+class AUDIO_IO_RT_BRIDGE : public AUDIO_IO_DEVICE {
+
+ public:
+
+  /** @name Public functions */
+  /*@{*/
+
+  AUDIO_IO_RT_BRIDGE(void);
+  virtual ~AUDIO_IO_RT_BRIDGE(void);
+
+  /*@}*/
+
+  /** @name Reimplemented functions from ECA_OBJECT */
+  /*@{*/
+
+  virtual std::string name(void) const { return("Realtime resampling bridge"); }
+  virtual std::string description(void) const { return("Runs a realtime device at its own sample rate and clock."); }
+
+  /*@}*/
+
+  /** @name Reimplemented functions from DYNAMIC_PARAMETERS<string> */
+  /*@{*/
+
+  virtual bool variable_params(void) const { return true; }
+  virtual std::string parameter_names(void) const;
+  virtual void set_parameter(int param, std::string value);
+  virtual std::string get_parameter(int param) const;
+
+  /*@}*/
+
+  /** @name Reimplemented functions from DYNAMIC_OBJECT<string> */
+  /*@{*/
+
+  virtual AUDIO_IO_RT_BRIDGE* clone(void) const;
+  virtual AUDIO_IO_RT_BRIDGE* new_expr(void) const { return(new AUDIO_IO_RT_BRIDGE()); }
+
+  /*@}*/
+
+  /** @name Reimplemented functions from AUDIO_IO */
+  /*@{*/
+
+  virtual int supported_io_modes(void) const { return(io_read | io_write); }
+
+  virtual void read_buffer(SAMPLE_BUFFER* sbuf);
+  virtual void write_buffer(SAMPLE_BUFFER* sbuf);
+
+  virtual void open(void) throw(AUDIO_IO::SETUP_ERROR&);
+  virtual void close(void);
+
+  virtual std::string status(void) const;
+
+  /*@}*/
+
+  /** @name Reimplemented functions from AUDIO_IO_BUFFERED */
+  /*@{*/
+
+  virtual long int read_samples(void* target_buffer, long int sample_frames);
+  virtual void write_samples(void* target_buffer, long int sample_frames);
+
+  /*@}*/
+
+  /** @name Reimplemented functions from AUDIO_IO_DEVICE */
+  /*@{*/
+
+  virtual void prepare(void);
+  virtual void start(void);
+  virtual void stop(bool drain = false);
+
+  virtual long int latency(void) const;
+  virtual long int delay(void) const;
+
+  /*@}*/
+
+  /**
+   * Current relative correction to the nominal
+   * resampling ratio.
+   */
+  double correction(void) const { return resampler_rep.correction(); }
+
+ private:
+
+  static void* device_thread(void* arg);
+  void run_device(void);
+  long int to_engine_frames(long int frames, SAMPLE_SPECS::sample_rate_t srate) const;
+
+  mutable std::vector<std::string> params_rep;
+  AUDIO_IO_DEVICE* child_repp;
+  SAMPLE_SPECS::sample_rate_t child_srate_rep;
+
+  ECA_ASYNC_RESAMPLER resampler_rep;
+  SAMPLE_BUFFER device_buffer_rep;
+
+  pthread_t thread_rep;
+  bool thread_running_rep;
+  volatile bool exit_rep;
+
+  static const int child_parameter_offset = 2;
+
+  AUDIO_IO_RT_BRIDGE(const AUDIO_IO_RT_BRIDGE&);
+  AUDIO_IO_RT_BRIDGE& operator=(const AUDIO_IO_RT_BRIDGE&);
+};
+
+#endif
@@ -0,0 +1,346 @@
+// ------------------------------------------------------------------------
+// eca-async-resampler.cpp: Asynchronous sample rate converter
+// Copyright (C) 2026 agent
+//
+// Attributes:
+//     eca-style-version: 3
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
+// ------------------------------------------------------------------------
+
+#include <cmath> /* ceil() */
+
+#include <kvu_dbc.h>
+
+#include "eca-async-resampler.h"
+#include "samplebuffer.h"
+
+const double ECA_ASYNC_RESAMPLER::max_correction = 0.01;
+
+/**
+ * Gains of the ratio controller. The error is the
+ * deviation of the fill level from the target, in
+ * seconds, so the proportional gain is in 1/s and the
+ * integral gain in 1/s^2. The loop is critically damped
+ * with a time constant of ten seconds, so that jitter
+ * in the fill level does not modulate the pitch.
+ */
+static const double async_resampler_kp = 0.2;
+static const double async_resampler_ki = 0.01;
+
+/**
+ * Time constant for smoothing the fill level, in
+ * seconds. Hides the jitter caused by differing block
+ * sizes of the producer and the consumer.
+ */
+static const double async_resampler_fill_filter = 0.5;
+
+/**
+ * Resampling quality passed to ECA_RESAMPLER. Same as 
+ * the default of SAMPLE_BUFFER.
+ */
+static const int async_resampler_quality = 50;
+
+ECA_ASYNC_RESAMPLER::ECA_ASYNC_RESAMPLER(void)
+  : fifo_repp(0),
+    frame_bytes_rep(0),
+    chunk_frames_rep(0),
+    read_chunk_frames_rep(0),
+    channels_rep(0),
+    in_rate_rep(0.0),
+    out_rate_rep(0.0),
+    target_fill_rep(0),
+    step_rep(1.0),
+    filtered_fill_rep(0.0),
+    integral_rep(0.0),
+    correction_rep(0.0),
+    starved_rep(false),
+    xruns_rep(0),
+    dropped_rep(0)
+{
+}
+
+ECA_ASYNC_RESAMPLER::~ECA_ASYNC_RESAMPLER(void)
+{
+  delete fifo_repp;
+}
+
+/**
+ * Allocates the FIFO and scratch buffers. 'in_block'
+ * is the largest block passed to write() and 'out_block'
+ * the largest block requested with read().
+ *
+ * Not realtime-safe.
+ *
+ * @post target_fill() > 0
+ */
+void ECA_ASYNC_RESAMPLER::init(int channels,
+			       SAMPLE_SPECS::sample_rate_t in_rate,
+			       SAMPLE_SPECS::sample_rate_t out_rate,
+			       long int in_block,
+			       long int out_block)
+{
+  // --------
+  DBC_REQUIRE(channels > 0);
+  DBC_REQUIRE(in_rate > 0 && out_rate > 0);
+  DBC_REQUIRE(in_block > 0 && out_block > 0);
+  // --------
+
+  channels_rep = channels;
+  in_rate_rep = in_rate;
+  out_rate_rep = out_rate;
+  frame_bytes_rep = channels * sizeof(SAMPLE_SPECS::sample_t);
+  chunk_frames_rep = in_block;
+
+  /* note: enough data for one block of both ends; the 
+   *       frames held for filtering are kept by the 
+   *       resampler */
+  long int out_block_in_frames =
+    static_cast<long int>(std::ceil(out_block * in_rate_rep / out_rate_rep * (1.0 + max_correction)));
+  target_fill_rep = in_block + out_block_in_frames + 4;
+  read_chunk_frames_rep = out_block_in_frames + 4;
+
+  delete fifo_repp;
+  fifo_repp = new KVU_RINGBUFFER(4 * target_fill_rep * frame_bytes_rep);
+
+  /* note: read() leaves at most a few input frames in the
+   *       resampler, see the margin given to init() */
+  double ratio = out_rate_rep / in_rate_rep;
+  resampler_rep.release();
+  resampler_rep.init(channels_rep, read_chunk_frames_rep + 16, ratio, async_resampler_quality);
+  resampler_rep.prepare_ratio(ratio / (1.0 + max_correction));
+  resampler_rep.prepare_ratio(ratio / (1.0 - max_correction));
+
+  write_frames_rep.resize(chunk_frames_rep * channels_rep);
+  read_frames_rep.resize(read_chunk_frames_rep * channels_rep);
+  long int read_channel_len = 
+    (read_chunk_frames_rep > out_block) ? read_chunk_frames_rep : out_block;
+  read_channels_rep.resize(channels_rep);
+  read_buffers_rep.resize(channels_rep);
+  for(int ch = 0; ch < channels_rep; ch++) {
+    read_channels_rep[ch].resize(read_channel_len);
+    read_buffers_rep[ch] = &read_channels_rep[ch][0];
+  }
+
+  xruns_rep = 0;
+  dropped_rep = 0;
+
+  reset();
+
+  // --------
+  DBC_ENSURE(target_fill() > 0);
+  // --------
+}
+
+/**
+ * Discards all data, resets the ratio controller
+ * and fills the FIFO with silence up to the target
+ * level. Must not be called while either end is in use.
+ */
+void ECA_ASYNC_RESAMPLER::reset(void)
+{
+  DBC_REQUIRE(fifo_repp != 0);
+
+  fifo_repp->reset();
+
+  for(size_t n = 0; n < write_frames_rep.size(); n++)
+    write_frames_rep[n] = 0.0;
+  resampler_rep.reset();
+
+  long int left = target_fill_rep;
+  while(left > 0) {
+    long int count = (left < chunk_frames_rep) ? left : chunk_frames_rep;
+    fifo_repp->write(&write_frames_rep[0], count * frame_bytes_rep);
+    left -= count;
+  }
+
+  step_rep = in_rate_rep / out_rate_rep;
+  filtered_fill_rep = target_fill_rep;
+  integral_rep = 0.0;
+  correction_rep = 0.0;
+  starved_rep = false;
+}
+
+/**
+ * Number of input frames in the FIFO.
+ */
+long int ECA_ASYNC_RESAMPLER::fill(void) const
+{
+  if (fifo_repp == 0)
+    return 0;
+
+  return fifo_repp->read_space() / frame_bytes_rep;
+}
+
+/**
+ * Nominal delay through the converter, in output frames.
+ */
+long int ECA_ASYNC_RESAMPLER::latency(void) const
+{
+  if (in_rate_rep <= 0.0)
+    return 0;
+
+  return static_cast<long int>((target_fill_rep + resampler_rep.latency()) * out_rate_rep / in_rate_rep);
+}
+
+/**
+ * Adds the contents of 'sbuf' to the FIFO. Missing
+ * channels are written as silence, and extra channels
+ * ignored.
+ *
+ * @return number of frames written; less than the
+ *         buffer length if the FIFO was full
+ */
+long int ECA_ASYNC_RESAMPLER::write(const SAMPLE_BUFFER* sbuf)
+{
+  DBC_REQUIRE(fifo_repp != 0);
+
+  long int frames = sbuf->length_in_samples();
+  int sbuf_channels = sbuf->number_of_channels();
+  long int written = 0;
+
+  while(written < frames) {
+    long int count = frames - written;
+    if (count > chunk_frames_rep)
+      count = chunk_frames_rep;
+
+    for(long int n = 0; n < count; n++) {
+      for(int ch = 0; ch < channels_rep; ch++) {
+	write_frames_rep[n * channels_rep + ch] =
+	  (ch < sbuf_channels) ? sbuf->buffer[ch][written + n] : 0.0;
+      }
+    }
+
+    if (fifo_repp->write(&write_frames_rep[0], count * frame_bytes_rep) != true) {
+      dropped_rep += frames - written;
+      break;
+    }
+    written += count;
+  }
+
+  return written;
+}
+
+/**
+ * Updates the rate ratio for the next block of
+ * 'frames' output frames.
+ */
+void ECA_ASYNC_RESAMPLER::update_ratio(long int frames)
+{
+  double dt = frames / out_rate_rep;
+  double alpha = dt / async_resampler_fill_filter;
+  if (alpha > 1.0)
+    alpha = 1.0;
+
+  filtered_fill_rep += alpha * (fill() - filtered_fill_rep);
+
+  double error = (filtered_fill_rep - target_fill_rep) / in_rate_rep;
+  integral_rep += error * dt;
+
+  /* note: limit the integral term to avoid windup */
+  double limit = max_correction / async_resampler_ki;
+  if (integral_rep > limit)
+    integral_rep = limit;
+  else if (integral_rep < -limit)
+    integral_rep = -limit;
+
+  correction_rep = async_resampler_kp * error + async_resampler_ki * integral_rep;
+  if (correction_rep > max_correction)
+    correction_rep = max_correction;
+  else if (correction_rep < -max_correction)
+    correction_rep = -max_correction;
+
+  step_rep = in_rate_rep / out_rate_rep * (1.0 + correction_rep);
+}
+
+/**
+ * Reads 'frames' frames of resampled audio to 'sbuf'.
+ * The buffer is filled with silence if the FIFO runs
+ * empty.
+ */
+void ECA_ASYNC_RESAMPLER::read(SAMPLE_BUFFER* sbuf, long int frames)
+{
+  DBC_REQUIRE(fifo_repp != 0);
+
+  sbuf->number_of_channels(channels_rep);
+  sbuf->length_in_samples(frames);
+
+  long int avail = fill();
+  if (starved_rep == true) {
+    if (avail < target_fill_rep) {
+      sbuf->make_silent();
+      return;
+    }
+    starved_rep = false;
+    filtered_fill_rep = avail;
+    resampler_rep.reset();
+  }
+  else if (avail > 3 * target_fill_rep) {
+    /* note: the producer is far ahead, drop the excess */
+    fifo_repp->read(0, (avail - target_fill_rep) * frame_bytes_rep);
+    filtered_fill_rep = target_fill_rep;
+    ++xruns_rep;
+  }
+
+  update_ratio(frames);
+
+  /* note: each round feeds the resampler about as many
+   *       input frames as the remaining output needs; 
+   *       input left over when the output is full is 
+   *       kept by the resampler for the next round */
+  const double ratio = 1.0 / step_rep;
+  long int n = 0;
+  while(n < frames) {
+    long int count = static_cast<long int>((frames - n) * step_rep);
+    if (count < 1)
+      count = 1;
+    if (count > read_chunk_frames_rep)
+      count = read_chunk_frames_rep;
+    avail = fill();
+    if (count > avail)
+      count = avail;
+    if (count == 0) {
+      starved_rep = true;
+      break;
+    }
+
+    fifo_repp->read(&read_frames_rep[0], count * frame_bytes_rep);
+    for(int ch = 0; ch < channels_rep; ch++) {
+      SAMPLE_SPECS::sample_t* dst = read_buffers_rep[ch];
+      for(long int m = 0; m < count; m++)
+	dst[m] = read_frames_rep[m * channels_rep + ch];
+    }
+
+    long int space = static_cast<long int>(read_channels_rep[0].size());
+    long int out = resampler_rep.process(&read_buffers_rep[0],
+					 channels_rep,
+					 count,
+					 (frames - n < space) ? frames - n : space,
+					 ratio);
+    for(int ch = 0; ch < channels_rep; ch++) {
+      const SAMPLE_SPECS::sample_t* src = read_buffers_rep[ch];
+      for(long int m = 0; m < out; m++)
+	sbuf->buffer[ch][n + m] = src[m];
+    }
+    n += out;
+  }
+
+  if (starved_rep == true) {
+    for(int ch = 0; ch < channels_rep; ch++)
+      for(long int m = n; m < frames; m++)
+	sbuf->buffer[ch][m] = 0.0;
+    ++xruns_rep;
+  }
+}
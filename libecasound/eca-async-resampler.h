@@ -0,0 +1,122 @@
+#ifndef INCLUDED_ECA_ASYNC_RESAMPLER_H
+#define INCLUDED_ECA_ASYNC_RESAMPLER_H
+
+#include <vector>
+
+#include <kvu_ringbuffer.h>
+
+#include "eca-resampler.h"
+#include "sample-specs.h"
+
+class SAMPLE_BUFFER;
+
+/**
+ * Asynchronous sample rate converter for passing audio
+ * between two threads that run on different clocks.
+ *
+ * The producer writes audio at the input rate with
+ * write(). The consumer reads a fixed number of frames
+ * at the output rate with read(), which resamples the
+ * data with the polyphase windowed-sinc filter of 
+ * ECA_RESAMPLER. The two ends are connected with a 
+ * lock-free FIFO.
+ *
+ * Because the clocks of the producer and the consumer
+ * drift against each other, the nominal rate ratio is
+ * not used as such. Instead, read() adjusts the ratio
+ * with a proportional-integral controller that keeps
+ * the FIFO fill level close to target_fill(). The
+ * controlled ratio sets the step of the resampler's
+ * fractional phase. The applied correction is limited 
+ * to 'max_correction'.
+ *
+ * If the FIFO runs empty, read() outputs silence
+ * until the FIFO has again been filled to the target
+ * level. If the fill level grows far above the target,
+ * the excess frames are dropped.
+ *
+ * Memory is allocated by init(). All other functions
+ * are realtime-safe. Only one thread may call write(),
+ * and one thread read().
+ *
+ * @author agent
+ */
+class ECA_ASYNC_RESAMPLER {
+
+ public:
+
+  /**
+   * Maximum relative correction of the rate ratio.
+   */
+  static const double max_correction;
+
+  ECA_ASYNC_RESAMPLER(void);
+  ~ECA_ASYNC_RESAMPLER(void);
+
+  void init(int channels,
+	    SAMPLE_SPECS::sample_rate_t in_rate,
+	    SAMPLE_SPECS::sample_rate_t out_rate,
+	    long int in_block,
+	    long int out_block);
+  void reset(void);
+
+  long int write(const SAMPLE_BUFFER* sbuf);
+  void read(SAMPLE_BUFFER* sbuf, long int frames);
+
+  int channels(void) const { return channels_rep; }
+  long int fill(void) const;
+  long int target_fill(void) const { return target_fill_rep; }
+  long int latency(void) const;
+
+  /**
+   * Current relative correction to the nominal
+   * rate ratio. Positive if the producer is running
+   * faster than the consumer.
+   */
+  double correction(void) const { return correction_rep; }
+
+  /**
+   * Number of times read() has run out of data,
+   * or dropped excess data.
+   */
+  long int xruns(void) const { return xruns_rep; }
+
+  /**
+   * Number of frames write() has dropped because
+   * the FIFO was full.
+   */
+  long int dropped(void) const { return dropped_rep; }
+
+ private:
+
+  void update_ratio(long int frames);
+
+  KVU_RINGBUFFER* fifo_repp;
+  ECA_RESAMPLER resampler_rep;
+  std::vector<SAMPLE_SPECS::sample_t> write_frames_rep;
+  std::vector<SAMPLE_SPECS::sample_t> read_frames_rep;
+  std::vector<std::vector<SAMPLE_SPECS::sample_t> > read_channels_rep;
+  std::vector<SAMPLE_SPECS::sample_t*> read_buffers_rep;
+  size_t frame_bytes_rep;
+  long int chunk_frames_rep;
+  long int read_chunk_frames_rep;
+
+  int channels_rep;
+  double in_rate_rep;
+  double out_rate_rep;
+  long int target_fill_rep;
+
+  double step_rep;
+  double filtered_fill_rep;
+  double integral_rep;
+  double correction_rep;
+  bool starved_rep;
+
+  long int xruns_rep;
+  long int dropped_rep;
+
+  ECA_ASYNC_RESAMPLER(const ECA_ASYNC_RESAMPLER&);
+  ECA_ASYNC_RESAMPLER& operator=(const ECA_ASYNC_RESAMPLER&);
+};
+
+#endif
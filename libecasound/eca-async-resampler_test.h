@@ -0,0 +1,187 @@
+// ------------------------------------------------------------------------
+// eca-async-resampler_test.h: Unit test for ECA_ASYNC_RESAMPLER
+// Copyright (C) 2026 agent
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
+// ------------------------------------------------------------------------
+
+#include <cmath>
+#include <cstdio>
+#include <string>
+
+#include <kvu_numtostr.h>
+
+#include "eca-async-resampler.h"
+#include "samplebuffer.h"
+#include "eca-test-case.h"
+
+using namespace std;
+
+/**
+ * Unit test for ECA_ASYNC_RESAMPLER
+ */
+class ECA_ASYNC_RESAMPLER_TEST : public ECA_TEST_CASE {
+
+protected:
+
+  virtual string do_name(void) const { return("ECA_ASYNC_RESAMPLER"); }
+  virtual void do_run(void);
+
+public:
+
+  virtual ~ECA_ASYNC_RESAMPLER_TEST(void) { }
+
+private:
+
+  void run_drift(double in_rate, double out_rate, double drift);
+};
+
+/**
+ * Runs a producer whose clock is off by 'drift' against
+ * a consumer, for two minutes of simulated time.
+ */
+void ECA_ASYNC_RESAMPLER_TEST::run_drift(double in_rate, double out_rate, double drift)
+{
+  const long int in_block = 256;
+  const long int out_block = 128;
+  const int channels = 2;
+  const double seconds = 120.0;
+
+  ECA_ASYNC_RESAMPLER rs;
+  rs.init(channels,
+	  static_cast<SAMPLE_SPECS::sample_rate_t>(in_rate),
+	  static_cast<SAMPLE_SPECS::sample_rate_t>(out_rate),
+	  in_block, out_block);
+
+  SAMPLE_BUFFER in (in_block, channels);
+  SAMPLE_BUFFER out (out_block, channels);
+  for(int ch = 0; ch < channels; ch++)
+    for(long int n = 0; n < in_block; n++)
+      in.buffer[ch][n] = 0.5;
+
+  const double in_period = in_block / (in_rate * (1.0 + drift));
+  const double out_period = out_block / out_rate;
+  double in_time = 0.0, out_time = 0.0;
+  long int xruns_at_settle = -1;
+  bool signal_ok = true;
+  double correction_sum = 0.0;
+  long int correction_count = 0;
+
+  while(out_time < seconds) {
+    if (in_time <= out_time) {
+      rs.write(&in);
+      in_time += in_period;
+    }
+    else {
+      rs.read(&out, out_block);
+      out_time += out_period;
+
+      if (out_time > seconds - 10.0) {
+	correction_sum += rs.correction();
+	++correction_count;
+      }
+      if (out_time > seconds - 1.0) {
+	if (xruns_at_settle < 0)
+	  xruns_at_settle = rs.xruns();
+	for(long int n = 0; n < out_block; n++)
+	  if (std::fabs(out.buffer[0][n] - 0.5) > 1e-9)
+	    signal_ok = false;
+      }
+    }
+  }
+
+  std::string desc = kvu_numtostr(in_rate) + " -> " + kvu_numtostr(out_rate) +
+    ", drift " + kvu_numtostr(drift * 1e6) + "ppm";
+
+  if (rs.dropped() != 0 || rs.xruns() != xruns_at_settle)
+    ECA_TEST_FAILURE("xruns after settling, " + desc);
+  if (signal_ok != true)
+    ECA_TEST_FAILURE("constant signal not preserved, " + desc);
+  double correction = correction_sum / correction_count;
+  if (std::fabs(correction - drift) > 20e-6)
+    ECA_TEST_FAILURE("correction " + kvu_numtostr(correction * 1e6) +
+		     "ppm does not match drift, " + desc);
+  if (std::labs(rs.fill() - rs.target_fill()) > in_block + out_block)
+    ECA_TEST_FAILURE("fill level " + kvu_numtostr(rs.fill()) +
+		     " not near target " + kvu_numtostr(rs.target_fill()) + ", " + desc);
+}
+
+void ECA_ASYNC_RESAMPLER_TEST::do_run(void)
+{
+  std::fprintf(stdout, "%s: tests for %s class\n",
+	       name().c_str(), __FILE__);
+
+  /* case: ratio follows clock drift */
+  {
+    run_drift(48000, 48000, 0.0);
+    run_drift(48000, 44100, 200e-6);
+    run_drift(44100, 48000, -300e-6);
+  }
+
+  /* case: starved consumer outputs silence and recovers */
+  {
+    ECA_ASYNC_RESAMPLER rs;
+    rs.init(1, 44100, 44100, 64, 64);
+    SAMPLE_BUFFER in (64, 1);
+    SAMPLE_BUFFER out (64, 1);
+    for(long int n = 0; n < 64; n++)
+      in.buffer[0][n] = 0.5;
+
+    for(int n = 0; n < 10; n++)
+      rs.read(&out, 64);
+    if (rs.xruns() != 1)
+      ECA_TEST_FAILURE("underrun not detected");
+    if (out.buffer[0][63] != 0.0)
+      ECA_TEST_FAILURE("underrun not silent");
+
+    while(rs.fill() < rs.target_fill())
+      rs.write(&in);
+    for(int n = 0; n < 3; n++) {
+      rs.read(&out, 64);
+      rs.write(&in);
+    }
+    if (std::fabs(out.buffer[0][63] - 0.5) > 1e-9)
+      ECA_TEST_FAILURE("no recovery after underrun");
+  }
+
+  /* case: downsampling filters out content above the 
+   *       output Nyquist frequency */
+  {
+    const double freqs[2] = { 1000.0, 18000.0 };
+    double peaks[2] = { 0.0, 0.0 };
+    for(int f = 0; f < 2; f++) {
+      ECA_ASYNC_RESAMPLER rs;
+      rs.init(1, 48000, 24000, 256, 128);
+      SAMPLE_BUFFER in (256, 1);
+      SAMPLE_BUFFER out (128, 1);
+      long int t = 0;
+      for(int block = 0; block < 100; block++) {
+	for(long int n = 0; n < 256; n++, t++)
+	  in.buffer[0][n] = 0.5 * std::sin(2.0 * M_PI * freqs[f] * t / 48000.0);
+	rs.write(&in);
+	rs.read(&out, 128);
+	if (block < 50)
+	  continue;
+	for(long int n = 0; n < 128; n++)
+	  if (std::fabs(out.buffer[0][n]) > peaks[f])
+	    peaks[f] = std::fabs(out.buffer[0][n]);
+      }
+    }
+    if (std::fabs(peaks[0] - 0.5) > 0.01)
+      ECA_TEST_FAILURE("passband level " + kvu_numtostr(peaks[0]));
+    if (peaks[1] > 0.005)
+      ECA_TEST_FAILURE("aliased level " + kvu_numtostr(peaks[1]));
+  }
+}
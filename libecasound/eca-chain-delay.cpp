@@ -0,0 +1,117 @@
+// ------------------------------------------------------------------------
+// eca-chain-delay.cpp: Delay line for chain latency compensation
+// Copyright (C) 2026 agent
+//
+// Attributes:
+//     eca-style-version: 3
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
+// ------------------------------------------------------------------------
+
+#include <kvu_dbc.h>
+
+#include "samplebuffer.h"
+#include "eca-chain-delay.h"
+
+static long int eca_chain_delay_ring_size(long int max_delay)
+{
+  /* note: one extra slot, as the current input is written 
+   *       before the delayed sample is read */
+  long int size = 1;
+  while(size < max_delay + 1) size <<= 1;
+  return size;
+}
+
+ECA_CHAIN_DELAY::ECA_CHAIN_DELAY(int channels, long int max_delay)
+  : ring_rep(channels, RING(eca_chain_delay_ring_size(max_delay > 0 ? max_delay : 1))),
+    mask_rep(eca_chain_delay_ring_size(max_delay > 0 ? max_delay : 1) - 1),
+    max_delay_rep(max_delay > 0 ? max_delay : 1),
+    delay_rep(0),
+    fade_from_rep(0),
+    fade_pos_rep(fade_length_constant),
+    pos_rep(0),
+    processed_rep(false)
+{
+}
+
+/**
+ * Sets the delay in samples. Delays longer than 
+ * max_delay() are truncated. Once audio has been 
+ * processed, changes are crossfaded.
+ */
+void ECA_CHAIN_DELAY::set_delay(long int samples)
+{
+  if (samples < 0) samples = 0;
+  if (samples > max_delay_rep) samples = max_delay_rep;
+
+  if (samples != delay_rep) {
+    /* note: if a fade is still in progress, the new fade 
+     *       starts from its target */
+    fade_from_rep = delay_rep;
+    fade_pos_rep = (processed_rep == true) ? 0 : fade_length_constant;
+    delay_rep = samples;
+  }
+}
+
+/**
+ * Delays the contents of 'sbuf' by delay() samples.
+ */
+void ECA_CHAIN_DELAY::process(SAMPLE_BUFFER* sbuf)
+{
+  int channels = sbuf->number_of_channels();
+  if (channels > static_cast<int>(ring_rep.size()))
+    channels = ring_rep.size();
+  long int len = sbuf->length_in_samples();
+
+  long int fadelen = fade_length_constant - fade_pos_rep;
+  if (fadelen > len) fadelen = len;
+  if (fadelen < 0) fadelen = 0;
+
+  /* note: the ring is written even when there is no delay, 
+   *       so that history is available when the delay grows */
+  for(int ch = 0; ch < channels; ch++) {
+    SAMPLE_SPECS::sample_t* ring = &ring_rep[ch][0];
+    SAMPLE_SPECS::sample_t* buf = sbuf->buffer[ch];
+    long int pos = pos_rep;
+    long int n = 0;
+
+    for(; n < fadelen; n++) {
+      ring[pos] = buf[n];
+      SAMPLE_SPECS::sample_t gain = 
+	static_cast<SAMPLE_SPECS::sample_t>(fade_pos_rep + n + 1) / fade_length_constant;
+      buf[n] = ring[(pos - fade_from_rep) & mask_rep] * (1.0f - gain) +
+	       ring[(pos - delay_rep) & mask_rep] * gain;
+      pos = (pos + 1) & mask_rep;
+    }
+
+    if (delay_rep == 0) {
+      for(; n < len; n++) {
+	ring[pos] = buf[n];
+	pos = (pos + 1) & mask_rep;
+      }
+    }
+    else {
+      for(; n < len; n++) {
+	ring[pos] = buf[n];
+	buf[n] = ring[(pos - delay_rep) & mask_rep];
+	pos = (pos + 1) & mask_rep;
+      }
+    }
+  }
+
+  fade_pos_rep += fadelen;
+  pos_rep = (pos_rep + len) & mask_rep;
+  processed_rep = true;
+}
@@ -0,0 +1,52 @@
+#ifndef INCLUDED_ECA_CHAIN_DELAY_H
+#define INCLUDED_ECA_CHAIN_DELAY_H
+
+#include <vector>
+
+#include "eca-rt-memory.h"
+#include "sample-specs.h"
+
+class SAMPLE_BUFFER;
+
+/**
+ * Delay line for aligning the output of a chain with
+ * other chains that have more processing latency.
+ *
+ * When the delay is changed, output is crossfaded from
+ * the old delay to the new one over fade_length_constant
+ * samples.
+ *
+ * Memory for the longest delay is allocated by the
+ * constructor. All other functions are realtime-safe.
+ *
+ * @author agent
+ */
+class ECA_CHAIN_DELAY {
+
+ public:
+
+  static const long int fade_length_constant = 512;
+
+  ECA_CHAIN_DELAY(int channels, long int max_delay);
+
+  void set_delay(long int samples);
+  long int delay(void) const { return delay_rep; }
+  long int max_delay(void) const { return max_delay_rep; }
+
+  void process(SAMPLE_BUFFER* sbuf);
+
+ private:
+
+  typedef std::vector<SAMPLE_SPECS::sample_t, ECA_RT_ALLOCATOR<SAMPLE_SPECS::sample_t> > RING;
+
+  std::vector<RING> ring_rep;
+  long int mask_rep;
+  long int max_delay_rep;
+  long int delay_rep;
+  long int fade_from_rep;
+  long int fade_pos_rep;
+  long int pos_rep;
+  bool processed_rep;
+};
+
+#endif
@@ -0,0 +1,141 @@
+// ------------------------------------------------------------------------
+// eca-chain-delay_test.h: Unit test for ECA_CHAIN_DELAY
+// Copyright (C) 2026 agent
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
+// ------------------------------------------------------------------------
+
+#include <cstdio>
+#include <string>
+
+#include <kvu_numtostr.h>
+
+#include "eca-chain-delay.h"
+#include "samplebuffer.h"
+#include "eca-test-case.h"
+
+using namespace std;
+
+/**
+ * Unit test for ECA_CHAIN_DELAY
+ */
+class ECA_CHAIN_DELAY_TEST : public ECA_TEST_CASE {
+
+protected:
+
+  virtual string do_name(void) const { return("ECA_CHAIN_DELAY"); }
+  virtual void do_run(void);
+
+public:
+
+  virtual ~ECA_CHAIN_DELAY_TEST(void) { }
+
+private:
+
+};
+
+void ECA_CHAIN_DELAY_TEST::do_run(void)
+{
+  const int bufsize = 64;
+  const int channels = 2;
+
+  std::fprintf(stdout, "%s: tests for %s class\n",
+	       name().c_str(), __FILE__);
+
+  /* case: counter signal delayed across block boundaries */
+  {
+    const long int delays[] = { 1, 10, 64, 100, 256 };
+
+    for(size_t d = 0; d < sizeof(delays) / sizeof(delays[0]); d++) {
+      ECA_CHAIN_DELAY delay (channels, 256);
+      SAMPLE_BUFFER sbuf (bufsize, channels);
+      delay.set_delay(delays[d]);
+
+      long int pos = 0;
+      for(int block = 0; block < 10; block++) {
+	for(int ch = 0; ch < channels; ch++)
+	  for(int n = 0; n < bufsize; n++)
+	    sbuf.buffer[ch][n] = (pos + n + 1) * (ch + 1);
+
+	delay.process(&sbuf);
+
+	for(int ch = 0; ch < channels; ch++) {
+	  for(int n = 0; n < bufsize; n++) {
+	    long int src = pos + n - delays[d];
+	    SAMPLE_BUFFER::sample_t expected = (src < 0) ? 0 : (src + 1) * (ch + 1);
+	    if (sbuf.buffer[ch][n] != expected) {
+	      ECA_TEST_FAILURE("delayed signal, delay " + kvu_numtostr(delays[d]));
+	      ch = channels;
+	      block = 10;
+	      break;
+	    }
+	  }
+	}
+	pos += bufsize;
+      }
+    }
+  }
+
+  /* case: changing the delay while running is crossfaded, 
+   *       and history is kept */
+  {
+    ECA_CHAIN_DELAY delay (channels, 256);
+    SAMPLE_BUFFER sbuf (bufsize, channels);
+    delay.set_delay(10);
+
+    long int pos = 0;
+    bool dropout = false, aligned = true;
+    int blocks = 2 * ECA_CHAIN_DELAY::fade_length_constant / bufsize;
+    for(int block = 0; block < blocks; block++) {
+      if (block == 4) delay.set_delay(100);
+      for(int n = 0; n < bufsize; n++)
+	sbuf.buffer[0][n] = 0.5;
+      for(int n = 0; n < bufsize; n++)
+	sbuf.buffer[1][n] = pos + n + 1;
+
+      delay.process(&sbuf);
+
+      for(int n = 0; n < bufsize; n++) {
+	if (pos + n >= 100 && sbuf.buffer[0][n] != 0.5)
+	  dropout = true;
+      }
+      if (block == blocks - 1 &&
+	  sbuf.buffer[1][bufsize - 1] != pos + bufsize - 100)
+	aligned = false;
+      pos += bufsize;
+    }
+    if (dropout == true)
+      ECA_TEST_FAILURE("dropout when delay changed");
+    if (aligned != true)
+      ECA_TEST_FAILURE("new delay not reached after crossfade");
+  }
+
+  /* case: delay limits */
+  {
+    ECA_CHAIN_DELAY delay (channels, 100);
+    delay.set_delay(1000);
+    if (delay.delay() != 100)
+      ECA_TEST_FAILURE("delay not limited to maximum");
+    delay.set_delay(-5);
+    if (delay.delay() != 0)
+      ECA_TEST_FAILURE("negative delay");
+
+    SAMPLE_BUFFER sbuf (bufsize, channels);
+    for(int n = 0; n < bufsize; n++) sbuf.buffer[0][n] = 0.5;
+    delay.process(&sbuf);
+    if (sbuf.buffer[0][0] != 0.5)
+      ECA_TEST_FAILURE("zero delay modified signal");
+  }
+}
@@ -2,6 +2,7 @@
 // eca-chain.cpp: Class representing an abstract audio signal chain.
 // Copyright (C) 1999-2009 Kai Vehmanen
 // Copyright (C) 2005 Stuart Allie
+// Copyright (C) 2026 agent
 //
 // Attributes:
 //     eca-style-version: 3 (see Ecasound Programmer's Guide)
@@ -24,6 +25,7 @@
 #include <config.h>
 #endif
 
+#include <algorithm>
 #include <cassert>
 #include <cctype>
 #include <string>
@@ -67,6 +69,9 @@ CHAIN::CHAIN (void)
   bypass_rep = false;
   initialized_rep = false;
   input_id_rep = output_id_rep = -1;
+  in_channels_rep = out_channels_rep = 0;
+  audioslot_repp = 0;
+  shared_controllers_rep = 0;
 
   /* FIXME: remove these and only store the index */
   selected_controller_repp = 0;
@@ -88,6 +93,11 @@ CHAIN::~CHAIN (void)
   for(std::vector<CHAIN::COP_CONTAINER>::iterator p = chainops_rep.begin(); p !=
 	chainops_rep.end(); p++) {
 
+    /* note: operators shared with the chain this is a copy 
+     *       of are owned by that chain, see copy_for_edit() */
+    if ((*p).shared == true)
+      continue;
+
     string tmp = (*p).cop->status();
     if (tmp.size() > 0) {
       ECA_LOG_MSG(ECA_LOGGER::info, tmp);
@@ -96,9 +106,10 @@ CHAIN::~CHAIN (void)
     delete (*p).cop;
   }
 
-  for(std::vector<GENERIC_CONTROLLER*>::iterator p = gcontrollers_rep.begin(); p !=
-	gcontrollers_rep.end(); p++) {
-    delete *p;
+  /* note: controllers shared with the chain this is a copy 
+   *       of are owned by that chain, see copy_for_edit() */
+  for(size_t p = shared_controllers_rep; p < gcontrollers_rep.size(); p++) {
+    delete gcontrollers_rep[p];
   }
 }
 
@@ -189,6 +200,8 @@ void CHAIN::add_chain_operator(CHAIN_OPERATOR* chainop)
   CHAIN::COP_CONTAINER container;
   container.cop = chainop;
   container.bypassed = false;
+  container.shared = false;
+  container.in_channels = 0;
   chainops_rep.push_back(container);
   selected_chainop_number_rep = chainops_rep.size();
   initialized_rep = false;
@@ -224,27 +237,23 @@ void CHAIN::remove_chain_operator(int op_index)
 	p++) {
       
       if ((*p).cop == to_remove) {
-	for(std::vector<GENERIC_CONTROLLER*>::iterator q = gcontrollers_rep.begin(); 
-	    q != gcontrollers_rep.end();) {
-	  if ((*p).cop == (*q)->target_pointer()) {
+	for(size_t q = 0; q < gcontrollers_rep.size();) {
+	  if ((*p).cop == controller_target(q)) {
 	    
 	    /* step: if the deleted controller is selected, unselect it */ 
-	    if (selected_controller_repp == *q)
+	    if (selected_controller_repp == gcontrollers_rep[q])
 	      selected_controller_repp = 0;
 	    
 	    /* step: remove the related controller */
-	    delete *q;
-	    gcontrollers_rep.erase(q);
-
-	    /* step: in case there are multiple controllers per chainop */
-	    q = gcontrollers_rep.begin();
+	    erase_controller(q);
 	  }
 	  else
 	    ++q;
 	}
 
 	/* step: delete and remove from the list */
-	delete (*p).cop;
+	if ((*p).shared != true)
+	  delete (*p).cop;
 	chainops_rep.erase(p);
 
 	/* step: invalidate selection if the selected cop
@@ -461,6 +470,27 @@ void CHAIN::set_bypass(int state)
     bypass_rep = false;
 }
 
+/**
+ * Returns the total processing latency of the chain
+ * operators in samples.
+ *
+ * Realtime-safe.
+ *
+ * @see CHAIN_OPERATOR::latency()
+ */
+long int CHAIN::latency(void) const
+{
+  if (bypass_rep == true)
+    return 0;
+
+  long int result = 0;
+  for(size_t p = 0; p < chainops_rep.size(); p++) {
+    if (chainops_rep[p].bypassed != true)
+      result += chainops_rep[p].cop->latency();
+  }
+  return result;
+}
+
 bool CHAIN::is_operator_bypassed(int op_index) const
 {
   if (is_valid_op_index(op_index)) {
@@ -536,18 +566,38 @@ void CHAIN::remove_controller(void)
   DBC_REQUIRE(selected_controller() <= number_of_controllers());
   // --------
 
-  int n = 0;
-  for(std::vector<GENERIC_CONTROLLER*>::iterator q = gcontrollers_rep.begin(); 
-      q != gcontrollers_rep.end(); 
-      q++) {
-    if ((n + 1) == selected_controller()) {
-      delete *q;
-      gcontrollers_rep.erase(q);
-      select_controller(-1);
-      break;
-    }
-    ++n;
+  erase_controller(selected_controller() - 1);
+  select_controller(-1);
+}
+
+/**
+ * Removes controller at 'index' (0...N-1). The controller
+ * is deleted, unless it is shared with the chain this is 
+ * a copy of (see copy_for_edit()).
+ */
+void CHAIN::erase_controller(size_t index)
+{
+  if (index < shared_controllers_rep) {
+    shared_targets_rep.erase(shared_targets_rep.begin() + index);
+    --shared_controllers_rep;
   }
+  else
+    delete gcontrollers_rep[index];
+
+  gcontrollers_rep.erase(gcontrollers_rep.begin() + index);
+}
+
+/**
+ * Returns the target of controller at 'index' (0...N-1).
+ * For shared controllers, this is the target they will 
+ * have once the copy is committed.
+ */
+OPERATOR* CHAIN::controller_target(size_t index) const
+{
+  if (index < shared_controllers_rep)
+    return shared_targets_rep[index];
+
+  return gcontrollers_rep[index]->target_pointer();
 }
 
 /**
@@ -556,16 +606,17 @@ void CHAIN::remove_controller(void)
 void CHAIN::clear(void)
 {
   for(std::vector<CHAIN::COP_CONTAINER>::iterator p = chainops_rep.begin(); p != chainops_rep.end(); p++) {
-    delete (*p).cop;
+    if ((*p).shared != true)
+      delete (*p).cop;
     (*p).cop = 0;
   }
   chainops_rep.resize(0);
-  for(std::vector<GENERIC_CONTROLLER*>::iterator p = gcontrollers_rep.begin(); p !=
-	gcontrollers_rep.end(); p++) {
-    delete *p;
-    *p = 0;
+  for(size_t p = shared_controllers_rep; p < gcontrollers_rep.size(); p++) {
+    delete gcontrollers_rep[p];
   }
   gcontrollers_rep.resize(0);
+  shared_controllers_rep = 0;
+  shared_targets_rep.resize(0);
 
   initialized_rep = false;
 }
@@ -761,27 +812,47 @@ void CHAIN::init(SAMPLE_BUFFER* sbuf, int in_channels, int out_channels)
 
   DBC_CHECK(samples_per_second() > 0);
 
+  SAMPLE_BUFFER* shared_slot = audioslot_repp;
   if (sbuf != 0) audioslot_repp = sbuf;
   if (in_channels != 0) in_channels_rep = in_channels;
   if (out_channels != 0) out_channels_rep = out_channels;
 
   int channels_next = in_channels_rep;
   for(size_t p = 0; p != chainops_rep.size(); p++) {
+    /* note: shared operators keep running in the original 
+     *       chain, with their state, until commit_edit(); 
+     *       they are only reinitialized, as a copy, if 
+     *       their channel count has changed */
+    if (chainops_rep[p].shared == true &&
+	(chainops_rep[p].in_channels != channels_next ||
+	 audioslot_repp != shared_slot))
+      unshare_chain_operator(p);
+    chainops_rep[p].in_channels = channels_next;
+
     /* note: buffer must have room to store both input and 
      *       output channels (processing in-place) */
     int out_ch = chainops_rep[p].cop->output_channels(channels_next);
     if (out_ch > channels_next)
       channels_next = out_ch;
-    audioslot_repp->number_of_channels(channels_next);
 
-    chainops_rep[p].cop->init(audioslot_repp);
+    /* note: a copy's buffer may be in use by the chain it
+     *       replaces, so the channel count is only written
+     *       when it differs; the engine reserves the buffer 
+     *       for max_channels(), so this does not allocate */
+    if (chainops_rep[p].shared != true) {
+      if (audioslot_repp->number_of_channels() != channels_next)
+	audioslot_repp->number_of_channels(channels_next);
+      chainops_rep[p].cop->init(audioslot_repp);
+    }
 
     /* note: for the next plugin, only 'out_ch' channels contain 
      *        valid audio */
     channels_next = out_ch;
   }
 
-  for(size_t p = 0; p != gcontrollers_rep.size(); p++) {
+  /* note: shared controllers are still in use by the 
+   *       original chain, see copy_for_edit() */
+  for(size_t p = shared_controllers_rep; p != gcontrollers_rep.size(); p++) {
     gcontrollers_rep[p]->init();
   }
 
@@ -809,7 +880,8 @@ void CHAIN::init(SAMPLE_BUFFER* sbuf, int in_channels, int out_channels)
 void CHAIN::release(void)
 {
   for(size_t p = 0; p != chainops_rep.size(); p++) {
-    chainops_rep[p].cop->release();
+    if (chainops_rep[p].shared != true)
+      chainops_rep[p].cop->release();
   }
   initialized_rep = false;
 
@@ -847,9 +919,15 @@ void CHAIN::process(void)
 	int out_ch = chainops_rep[p].cop->output_channels(audioslot_repp->number_of_channels());
 	if (out_ch > audioslot_repp->number_of_channels())
 	  audioslot_repp->number_of_channels(out_ch);
+
+	/* note: float plane is converted back only when
+	 *       a run of float-only operators ends */
+	if (chainops_rep[p].cop->float_plane_processing() != true)
+	  audioslot_repp->float_plane_sync();
 	
 	chainops_rep[p].cop->process();
       }
+      audioslot_repp->float_plane_sync();
     }
   }
   else {
@@ -865,10 +943,15 @@ void CHAIN::process(void)
  */
 void CHAIN::controller_update(void)
 {
+  /* note: operators that support parameter ramping interpolate
+   *       the controller values across the block */
+  double block_secs = 
+    static_cast<double>(audioslot_repp->length_in_samples()) / samples_per_second();
+
   for(size_t n = 0; n < gcontrollers_rep.size(); n++) {
     DEBUG_CTRL_STATEMENT(GENERIC_CONTROLLER* ptr = gcontrollers_rep[n]);
 
-    gcontrollers_rep[n]->value(position_in_seconds_exact());
+    gcontrollers_rep[n]->value_for_block(position_in_seconds_exact(), block_secs);
 
     DEBUG_CTRL_STATEMENT(std::cerr << "trace: " << ptr->name());
     DEBUG_CTRL_STATEMENT(std::cerr << "; value " << ptr->source_pointer()->value() << "." << std::endl);
@@ -876,11 +959,15 @@ void CHAIN::controller_update(void)
 }
 
 /**
- * Re-initializes all effect parameters.
+ * Re-initializes all effect parameters. Operators shared
+ * with the chain this is a copy of are skipped, as they 
+ * are in use by that chain.
  */
 void CHAIN::refresh_parameters(void)
 {
   for(int chainop_sizet = 0; chainop_sizet != static_cast<int>(chainops_rep.size()); chainop_sizet++) {
+    if (chainops_rep[chainop_sizet].shared == true)
+      continue;
     for(int n = 0; n < chainops_rep[chainop_sizet].cop->number_of_params(); n++) {
       chainops_rep[chainop_sizet].cop->set_parameter(n + 1, 
 						 chainops_rep[chainop_sizet].cop->get_parameter(n + 1));
@@ -948,6 +1035,158 @@ string CHAIN::to_string(void) const
   return t.to_string();
 }
 
+/**
+ * Creates a copy of the chain, which can be modified 
+ * and initialized while this chain is being processed.
+ * The copy then replaces this chain with commit_edit().
+ *
+ * Chain operators and controllers are shared with this 
+ * chain, so that operators keep their internal state 
+ * (e.g. contents of delay lines, plugin state) across
+ * the edit. Shared objects are not initialized or 
+ * deleted by the copy, and keep being processed by this
+ * chain until commit_edit() is called. Objects added to 
+ * the copy are owned by the copy.
+ *
+ * Input and output connections, channel counts, bypass 
+ * states and selections are preserved. The copy must be
+ * initialized with init() before it is committed, using 
+ * the same sample buffer as this chain. If the channel 
+ * count of a shared operator changes, it is replaced 
+ * with a clone in init().
+ *
+ * @return new object
+ */
+CHAIN* CHAIN::copy_for_edit(void) const
+{
+  CHAIN* copy = new CHAIN();
+
+  copy->chainname_rep = chainname_rep;
+  copy->muted_rep = muted_rep;
+  copy->bypass_rep = bypass_rep;
+  copy->input_id_rep = input_id_rep;
+  copy->output_id_rep = output_id_rep;
+  copy->in_channels_rep = in_channels_rep;
+  copy->out_channels_rep = out_channels_rep;
+  copy->audioslot_repp = audioslot_repp;
+  copy->set_samples_per_second(samples_per_second());
+  copy->set_position_in_samples(position_in_samples());
+
+  copy->chainops_rep = chainops_rep;
+  for(size_t p = 0; p != copy->chainops_rep.size(); p++) {
+    copy->chainops_rep[p].shared = true;
+  }
+
+  copy->gcontrollers_rep = gcontrollers_rep;
+  copy->shared_controllers_rep = gcontrollers_rep.size();
+  copy->shared_targets_rep.resize(gcontrollers_rep.size());
+  for(size_t p = 0; p != gcontrollers_rep.size(); p++) {
+    copy->shared_targets_rep[p] = gcontrollers_rep[p]->target_pointer();
+  }
+
+  copy->selected_chainop_number_rep = selected_chainop_number_rep;
+  copy->selected_chainop_parameter_rep = selected_chainop_parameter_rep;
+  copy->selected_controller_number_rep = selected_controller_number_rep;
+  copy->selected_controller_parameter_rep = selected_controller_parameter_rep;
+  copy->selected_controller_repp = selected_controller_repp;
+  copy->selected_dynobj_repp = selected_dynobj_repp;
+
+  return copy;
+}
+
+/**
+ * Replaces the shared chain operator at 'index' (0...N-1)
+ * with a clone owned by this chain. Controllers and 
+ * selections of the operator are moved to the clone.
+ */
+void CHAIN::unshare_chain_operator(size_t index)
+{
+  CHAIN_OPERATOR* orig = chainops_rep[index].cop;
+  CHAIN_OPERATOR* op = dynamic_cast<CHAIN_OPERATOR*>(orig->clone());
+  if (op == 0) {
+    op = dynamic_cast<CHAIN_OPERATOR*>(orig->new_expr());
+    for(int n = 0; n < orig->number_of_params(); n++) {
+      op->set_parameter(n + 1, orig->get_parameter(n + 1));
+    }
+  }
+
+  ECA_LOG_MSG(ECA_LOGGER::system_objects, 
+	      "Channel count of chain operator " + orig->name() + 
+	      " changed, reinitializing a copy of it.");
+
+  chainops_rep[index].cop = op;
+  chainops_rep[index].shared = false;
+
+  for(size_t p = 0; p != gcontrollers_rep.size(); p++) {
+    if (p < shared_controllers_rep) {
+      if (shared_targets_rep[p] == orig)
+	shared_targets_rep[p] = op;
+    }
+    else if (gcontrollers_rep[p]->target_pointer() == orig)
+      gcontrollers_rep[p]->assign_target(op);
+  }
+  if (selected_dynobj_repp == orig)
+    selected_dynobj_repp = op;
+}
+
+/**
+ * Takes over from chain 'old', which this chain is a 
+ * copy of (see copy_for_edit()). Shared controllers are
+ * retargeted to the chain operators of this chain, and 
+ * ownership of shared operators and controllers is moved
+ * from 'old' to this chain. Operators and controllers 
+ * removed from the copy stay with 'old', and are deleted
+ * with it.
+ *
+ * Realtime-safe. 'old' can be deleted afterwards.
+ *
+ * require:
+ *  is_initialized() == true
+ */
+void CHAIN::commit_edit(CHAIN* old)
+{
+  // --------
+  DBC_REQUIRE(is_initialized() == true);
+  DBC_REQUIRE(old != 0);
+  // --------
+
+  for(size_t p = 0; p != shared_controllers_rep; p++) {
+    gcontrollers_rep[p]->assign_target(shared_targets_rep[p]);
+  }
+  shared_controllers_rep = 0;
+
+  /* note: erasing does not release the vector storage */
+  size_t kept = 0;
+  for(size_t p = 0; p != old->gcontrollers_rep.size(); p++) {
+    if (std::find(gcontrollers_rep.begin(), 
+		  gcontrollers_rep.end(), 
+		  old->gcontrollers_rep[p]) == gcontrollers_rep.end())
+      old->gcontrollers_rep[kept++] = old->gcontrollers_rep[p];
+  }
+  old->gcontrollers_rep.erase(old->gcontrollers_rep.begin() + kept, 
+			      old->gcontrollers_rep.end());
+
+  kept = 0;
+  for(size_t p = 0; p != old->chainops_rep.size(); p++) {
+    bool moved = false;
+    for(size_t q = 0; q != chainops_rep.size(); q++) {
+      if (chainops_rep[q].cop == old->chainops_rep[p].cop) {
+	chainops_rep[q].shared = false;
+	moved = true;
+      }
+    }
+    if (moved != true)
+      old->chainops_rep[kept++] = old->chainops_rep[p];
+  }
+  old->chainops_rep.erase(old->chainops_rep.begin() + kept, 
+			  old->chainops_rep.end());
+
+  old->selected_controller_repp = 0;
+  old->selected_dynobj_repp = 0;
+
+  set_position_in_samples(old->position_in_samples());
+}
+
 /**
  * Reimplemented from ECA_SAMPLERATE_AWARE
  */
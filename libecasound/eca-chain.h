@@ -2,6 +2,7 @@
 // eca-chain.cpp: Class representing an abstract audio signal chain.
 // Copyright (C) 1999-2009,2012,2013 Kai Vehmanen
 // Copyright (C) 2005 Stuart Allie
+// Copyright (C) 2026 agent
 //
 // Attributes:
 //     eca-style-version: 3
@@ -73,6 +74,8 @@ class CHAIN : public ECA_AUDIO_POSITION {
    */
   bool is_bypassed(void) const { return bypass_rep; }
 
+  long int latency(void) const;
+
   void set_mute(int muted);
   void set_bypass(int state);
 
@@ -194,6 +197,16 @@ class CHAIN : public ECA_AUDIO_POSITION {
 
   // -------------------------------------------------------------------
 
+  /** @name Editing while processing */
+  /*@{*/
+
+  CHAIN* copy_for_edit(void) const;
+  void commit_edit(CHAIN* old);
+
+  /*@}*/
+
+  // -------------------------------------------------------------------
+
   /** @name Functions implemented from ECA_SAMPLERATE_AWARE */
   /*@{*/
 
@@ -215,11 +228,18 @@ class CHAIN : public ECA_AUDIO_POSITION {
  private:
 
   bool is_valid_op_index(int op_index) const;
+  void erase_controller(size_t index);
+  OPERATOR* controller_target(size_t index) const;
+  void unshare_chain_operator(size_t index);
 
   class COP_CONTAINER {
   public:
     CHAIN_OPERATOR* cop;
     bool bypassed;
+    /** owned by the chain this is a copy of */
+    bool shared;
+    /** channel count at init() */
+    int in_channels;
   };
 
   bool initialized_rep;
@@ -231,6 +251,8 @@ class CHAIN : public ECA_AUDIO_POSITION {
 
   std::vector<struct COP_CONTAINER> chainops_rep;
   std::vector<GENERIC_CONTROLLER*> gcontrollers_rep;
+  size_t shared_controllers_rep;
+  std::vector<OPERATOR*> shared_targets_rep;
 
   GENERIC_CONTROLLER* selected_controller_repp;
   OPERATOR* selected_dynobj_repp;
@@ -96,6 +96,31 @@ class CHAIN_OPERATOR : public OPERATOR {
    * @see process()
    */
   virtual int output_channels(int i_channels) const { return(i_channels); }
+
+  /**
+   * Returns the processing latency in samples, i.e. 
+   * how much the output lags behind the input. Used
+   * for aligning chains that are mixed together.
+   *
+   * This function should be reimplemented by chain
+   * operator types that delay the signal, for instance
+   * look-ahead and FFT-based operators. The value may
+   * change during processing. Must be realtime-safe.
+   */
+  virtual long int latency(void) const { return(0); }
+
+  /**
+   * Whether process() works on the single precision
+   * plane of the sample buffer (see 
+   * SAMPLE_BUFFER::float_plane_acquire()) instead of 
+   * 'buffer'. The chain converts the data back 
+   * before running other operators, so consecutive
+   * operators of this kind share one conversion.
+   *
+   * This function should be reimplemented by hosts
+   * of plugin APIs that only support 32bit floats.
+   */
+  virtual bool float_plane_processing(void) const { return(false); }
 };
 
 #endif
@@ -2,6 +2,7 @@
 // eca-chainsetup-parser.cpp: Functionality for parsing chainsetup 
 //                            option syntax.
 // Copyright (C) 2001-2006 Kai Vehmanen
+// Copyright (C) 2026 agent
 //
 // Attributes:
 //     eca-style-version: 3
@@ -447,6 +448,24 @@ void ECA_CHAINSETUP_PARSER::interpret_general_option (const string& argu)
 	  csetup_repp->set_mix_mode(ECA_CHAINSETUP::cs_mmode_avg);
 	}
       }
+      else if (first_arg == "affinity") {
+	/* -z:affinity,class,cpus (cpu list may contain commas) */
+	std::vector<string> args = kvu_get_arguments(argu);
+	string thread_class = kvu_get_argument_number(2, argu);
+	string cpus;
+	if (args.size() > 2)
+	  cpus = kvu_vector_to_string(std::vector<string> (args.begin() + 2, args.end()), ",");
+	if (csetup_repp->set_thread_affinity(thread_class, cpus) == true) {
+	  if (cpus.size() > 0)
+	    ECA_LOG_MSG(ECA_LOGGER::info, "Restricting " + thread_class + 
+			" thread to CPUs " + csetup_repp->thread_affinity(thread_class) + ".");
+	  else
+	    ECA_LOG_MSG(ECA_LOGGER::info, "Using default CPU affinity for " + 
+			thread_class + " thread.");
+	}
+	else
+	  ECA_LOG_MSG(ECA_LOGGER::info, "Invalid thread class or CPU list given to '-z:affinity'. Only engine, io and midi threads can be set per chainsetup.");
+      }
       break;
     }
   default: { match = false; }
@@ -1134,6 +1153,12 @@ string ECA_CHAINSETUP_PARSER::general_options_to_string(void) const
   else
     t << " -z:mixmode,sum";
 
+  for(std::map<string,string>::const_iterator p = csetup_repp->thread_affinity_rep.begin();
+      p != csetup_repp->thread_affinity_rep.end();
+      p++) {
+    t << " -z:affinity," << p->first << "," << p->second;
+  }
+
   t.setprecision(3);
   if (csetup_repp->max_length_set()) {
     t << " -t:" << csetup_repp->max_length_in_seconds_exact();
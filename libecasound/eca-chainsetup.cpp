@@ -2,6 +2,7 @@
 // eca-chainsetup.cpp: Class representing an ecasound chainsetup object.
 // Copyright (C) 1999-2006,2008,2009,2011-2013 Kai Vehmanen
 // Copyright (C) 2005 Stuart Allie
+// Copyright (C) 2026 agent
 //
 // Attributes:
 //     eca-style-version: 3 (see Ecasound Programmer's Guide)
@@ -44,6 +45,7 @@
 #endif
 
 #include <kvu_dbc.h>
+#include <kvu_locks.h>
 #include <kvu_message_item.h>
 #include <kvu_numtostr.h>
 #include <kvu_rtcaps.h>
@@ -67,6 +69,7 @@
 #include "eca-engine-driver.h"
 #include "eca-object-factory.h"
 #include "eca-object-map.h"
+#include "eca-thread-affinity.h"
 
 #include "midiio.h"
 #include "midi-client.h"
@@ -77,6 +80,7 @@
 
 #include "eca-error.h"
 #include "eca-logger.h"
+#include "eca-trace-recorder.h"
 
 #include "eca-chainsetup.h"
 #include "eca-chainsetup_impl.h"
@@ -269,6 +273,7 @@ void ECA_CHAINSETUP::set_defaults(void)
   /* note: defaults are set as specified in ecasoundrc(5) */
 
   precise_sample_rates_rep = false;
+  hot_swap_crossfade_rep = true;
   ignore_xruns_rep = true;
 
   pserver_repp = &impl_repp->pserver_rep;
@@ -288,6 +293,7 @@ void ECA_CHAINSETUP::set_defaults(void)
   memory_locked_rep = false;
   midi_server_needed_rep = false;
   is_locked_rep = false;
+  edit_chain_repp = 0;
   selected_chain_index_rep = 0;
   selected_ctrl_index_rep = 0;
   selected_ctrl_param_index_rep = 0;
@@ -311,6 +317,7 @@ void ECA_CHAINSETUP::set_defaults(void)
   cparser_rep.interpret_object_option("-f:" + rc_temp);
   set_samples_per_second(default_audio_format().samples_per_second());
   toggle_precise_sample_rates(ecaresources.boolean_resource("default-to-precise-sample-rates"));
+  toggle_hot_swap_crossfade(ecaresources.resource("hot-swap-crossfade") != "false");
   rc_temp = set_resource_helper(ecaresources, 
 				"default-mix-mode", 
 				"avg");
@@ -598,6 +605,7 @@ void ECA_CHAINSETUP::enable_active_buffering_mode(void)
       switch_to_db_mode();
     }
 
+    impl_repp->pserver_rep.set_affinity(thread_affinity("io"));
     if (buffersize() != 0) {
       impl_repp->pserver_rep.set_buffer_defaults(double_buffer_size() / buffersize(), 
 						 buffersize());
@@ -1778,6 +1786,7 @@ void ECA_CHAINSETUP::enable_audio_object_helper(AUDIO_IO* aobj) const
     dev->toggle_ignore_xruns(ignore_xruns());
   }
   if (aobj->is_open() == false) {
+    ECA_TRACE_SCOPE trace_scope ("object", "open", aobj->label().c_str());
     const std::string req_format = ECA_OBJECT_FACTORY::audio_object_format_to_eos(aobj);
     aobj->open();
     const std::string act_format =
@@ -1882,6 +1891,7 @@ void ECA_CHAINSETUP::enable(void) throw(ECA_ERROR&)
 	  midi_devices.size() > 0) {
 	impl_repp->midi_server_rep.set_schedrealtime(raised_priority());
 	impl_repp->midi_server_rep.set_schedpriority(get_sched_priority());
+	impl_repp->midi_server_rep.set_affinity(thread_affinity("midi"));
 	impl_repp->midi_server_rep.enable();
       }
 
@@ -1948,11 +1958,13 @@ void ECA_CHAINSETUP::disable(void)
     ECA_LOG_MSG(ECA_LOGGER::system_objects, "Closing chainsetup \"" + name() + "\"");
     for(vector<AUDIO_IO*>::iterator q = inputs.begin(); q != inputs.end(); q++) {
       ECA_LOG_MSG(ECA_LOGGER::system_objects, "Closing audio device/file \"" + (*q)->label() + "\".");
+      ECA_TRACE_SCOPE trace_scope ("object", "close", (*q)->label().c_str());
       if ((*q)->is_open() == true) (*q)->close();
     }
     
     for(vector<AUDIO_IO*>::iterator q = outputs.begin(); q != outputs.end(); q++) {
       ECA_LOG_MSG(ECA_LOGGER::system_objects, "Closing audio device/file \"" + (*q)->label() + "\".");
+      ECA_TRACE_SCOPE trace_scope ("object", "close", (*q)->label().c_str());
       if ((*q)->is_open() == true) (*q)->close();
     }
 
@@ -2030,20 +2042,7 @@ bool ECA_CHAINSETUP::execute_edit(const chainsetup_edit_t& edit)
           retval = false;
           break;
         }
-        bool locked = is_locked_rep;
-        is_locked_rep = false;
-        const string& params = edit.param;
-        if (params.size() > 0 && params[0] == '-')
-          cparser_rep.interpret_object_option(params);
-        else
-          cparser_rep.interpret_object_option(string("-") + edit.param);
-        if (interpret_result() != true) {
-          ECA_LOG_MSG(ECA_LOGGER::errors,
-                      "cop-add error " + 
-                      interpret_result_verbose());
-          retval = false;
-        }
-        is_locked_rep = locked;
+        retval = interpret_edit_option(edit);
         break;
       }
 
@@ -2101,6 +2100,217 @@ bool ECA_CHAINSETUP::execute_edit(const chainsetup_edit_t& edit)
   return retval;
 }
 
+/**
+ * Executes chainsetup edit 'edit', unless an edit is 
+ * being prepared at the same time (see prepare_edit()).
+ * Does not block.
+ *
+ * @return false if the edit was not executed
+ */
+bool ECA_CHAINSETUP::try_execute_edit(const chainsetup_edit_t& edit)
+{
+  if (pthread_mutex_trylock(&impl_repp->edit_lock_rep) != 0)
+    return false;
+
+  execute_edit(edit);
+
+  pthread_mutex_unlock(&impl_repp->edit_lock_rep);
+  return true;
+}
+
+/**
+ * Sets a chain operator parameter directly, without 
+ * going via the engine, if 'edit' is a 'cop-set' on an 
+ * operator with thread-safe parameters (see 
+ * OPERATOR::thread_safe_parameters()). The operator is
+ * looked up under the edit lock, so the engine cannot 
+ * swap in new chains at the same time.
+ *
+ * Can be run at the same time as the engine is 
+ * processing the chainsetup.
+ *
+ * @return false if the edit was not executed
+ */
+bool ECA_CHAINSETUP::set_thread_safe_parameter(const chainsetup_edit_t& edit)
+{
+  if (edit.type != edit_cop_set_param)
+    return false;
+
+  KVU_GUARD_LOCK guard(&impl_repp->edit_lock_rep);
+
+  int c = edit.m.cop_set_param.chain;
+  int op = edit.m.cop_set_param.op;
+  if (c < 1 || c > static_cast<int>(chains.size()) ||
+      op < 1 || op > chains[c - 1]->number_of_chain_operators() ||
+      edit.m.cop_set_param.param < 1 ||
+      chains[c - 1]->get_chain_operator(op - 1)->thread_safe_parameters() != true)
+    return false;
+
+  chains[c - 1]->set_parameter(op, 
+			       edit.m.cop_set_param.param,
+			       edit.m.cop_set_param.value);
+  return true;
+}
+
+/**
+ * Takes the edit lock, unless an edit is being prepared
+ * or a parameter set at the same time. Used by the engine
+ * to swap in new chains (see set_thread_safe_parameter()).
+ * Does not block.
+ *
+ * @return false if the lock was not taken
+ */
+bool ECA_CHAINSETUP::try_lock_edit(void)
+{
+  return pthread_mutex_trylock(&impl_repp->edit_lock_rep) == 0;
+}
+
+/**
+ * Releases the edit lock taken with try_lock_edit().
+ */
+void ECA_CHAINSETUP::unlock_edit(void)
+{
+  pthread_mutex_unlock(&impl_repp->edit_lock_rep);
+}
+
+/**
+ * Prepares an edit of a chain that is being processed 
+ * by the engine. Instead of modifying the chain, a copy
+ * of it is created with CHAIN::copy_for_edit() and 
+ * the edit is applied to the copy. The caller then 
+ * initializes the copy, and has it replace the chain 
+ * at index 'edit.m.c_generic_param.chain'.
+ *
+ * Only edits that add chain operators or controllers
+ * are supported. For other edits, and for chains with
+ * objects that cannot be copied, 'replacement' is set 
+ * to 0, and the edit should be run with execute_edit().
+ *
+ * Can be run at the same time as the engine is 
+ * processing the chainsetup. Edits queued to the 
+ * engine are held back until this returns.
+ *
+ * @return true if succesful, false if edit cannot
+ *         be performed
+ */
+bool ECA_CHAINSETUP::prepare_edit(const chainsetup_edit_t& edit, CHAIN** replacement)
+{
+  // --------
+  DBC_REQUIRE(replacement != 0);
+  // --------
+
+  *replacement = 0;
+
+  if (edit.cs_ptr != this) {
+    ECA_LOG_MSG(ECA_LOGGER::errors, 
+		"ERROR: chainsetup edit prepared on wrong object");
+    return false;
+  }
+
+  if ((edit.type != edit_cop_add && 
+       edit.type != edit_ctrl_add) ||
+      edit.m.c_generic_param.chain < 1 ||
+      edit.m.c_generic_param.chain > static_cast<int>(chains.size()))
+    return true;
+
+#ifndef ECA_DISABLE_EFFECTS
+  /* note: see copy_chain_for_edit() */
+  string option = edit.param;
+  if (option.size() == 0 || option[0] != '-')
+    option = "-" + option;
+  if (kvu_get_argument_prefix(option) == "eS")
+    return true;
+#endif
+
+  /* note: the engine executes queued edits with 
+   *       try_execute_edit() */
+  KVU_GUARD_LOCK guard(&impl_repp->edit_lock_rep);
+
+  CHAIN* copy = copy_chain_for_edit(edit.m.c_generic_param.chain - 1);
+  if (copy == 0)
+    return true;
+
+  edit_chain_repp = copy;
+  bool retval = interpret_edit_option(edit);
+  edit_chain_repp = 0;
+
+  if (retval == true)
+    *replacement = copy;
+  else
+    delete copy;
+
+  return retval;
+}
+
+/**
+ * Returns a copy of the chain at 'index' (0...N-1), which
+ * can be edited while the chainsetup is being processed, 
+ * or 0 if the chain cannot be copied.
+ *
+ * @see CHAIN::copy_for_edit()
+ */
+CHAIN* ECA_CHAINSETUP::copy_chain_for_edit(int index) const
+{
+  // --------
+  DBC_REQUIRE(index >= 0 && index < static_cast<int>(chains.size()));
+  // --------
+
+  const CHAIN* orig = chains[index];
+
+#ifndef ECA_DISABLE_EFFECTS
+  /* note: audio stamps are registered to the stamp server 
+   *       by address, which is not safe to change while 
+   *       processing */
+  for(int n = 0; n < orig->number_of_chain_operators(); n++) {
+    if (dynamic_cast<const AUDIO_STAMP*>(orig->get_chain_operator(n)) != 0)
+      return 0;
+  }
+#endif
+
+  return orig->copy_for_edit();
+}
+
+/**
+ * Interprets the option string of a edit that adds a
+ * chain operator or a controller.
+ */
+bool ECA_CHAINSETUP::interpret_edit_option(const chainsetup_edit_t& edit)
+{
+  bool retval = true;
+  bool locked = is_locked_rep;
+  is_locked_rep = false;
+  const string& params = edit.param;
+  if (params.size() > 0 && params[0] == '-')
+    cparser_rep.interpret_object_option(params);
+  else
+    cparser_rep.interpret_object_option(string("-") + edit.param);
+  if (interpret_result() != true) {
+    ECA_LOG_MSG(ECA_LOGGER::errors,
+		"cop-add error " + 
+		interpret_result_verbose());
+    retval = false;
+  }
+  is_locked_rep = locked;
+  return retval;
+}
+
+/**
+ * Returns the chain named 'name' that edits are applied 
+ * to, or 0 if not found. While an edit is prepared, this
+ * is the copy of the chain (see prepare_edit()).
+ */
+CHAIN* ECA_CHAINSETUP::edit_target_chain(const string& name) const
+{
+  if (edit_chain_repp != 0)
+    return (edit_chain_repp->name() == name) ? edit_chain_repp : 0;
+
+  for(vector<CHAIN*>::const_iterator q = chains.begin(); q != chains.end(); q++) {
+    if (name == (*q)->name()) 
+      return *q;
+  }
+  return 0;
+}
+
 /**
  * Updates the chainsetup processing length based on 
  * 1) requested length, 2) lengths of individual 
@@ -2351,6 +2561,49 @@ void ECA_CHAINSETUP::toggle_raised_priority(bool value) {
   impl_repp->bmode_override_rep.toggle_raised_priority(value); 
 }
 
+/**
+ * Restricts threads of class 'thread_class' to 'cpus'
+ * while this chainsetup is connected. Overrides the
+ * process-wide setting (see ECA_THREAD_AFFINITY). An 
+ * empty 'cpus' removes the override.
+ *
+ * Only the engine, io and midi threads are started
+ * per chainsetup, so only these can be overridden.
+ *
+ * @return false if 'thread_class' can't be overridden, 
+ *         or 'cpus' is not a valid CPU list
+ */
+bool ECA_CHAINSETUP::set_thread_affinity(const string& thread_class, const string& cpus)
+{
+  std::vector<int> cpuset;
+  if ((thread_class != "engine" && 
+       thread_class != "io" && 
+       thread_class != "midi") ||
+      (cpus.size() > 0 && kvu_parse_cpu_list(cpus, &cpuset) != true))
+    return false;
+
+  if (cpus.size() > 0)
+    thread_affinity_rep[thread_class] = kvu_cpu_list_to_string(cpuset);
+  else
+    thread_affinity_rep.erase(thread_class);
+
+  return true;
+}
+
+/**
+ * Returns the CPUs threads of class 'thread_class' are
+ * restricted to when this chainsetup is connected, or 
+ * an empty string if not restricted.
+ */
+string ECA_CHAINSETUP::thread_affinity(const string& thread_class) const
+{
+  std::map<string,string>::const_iterator p = thread_affinity_rep.find(thread_class);
+  if (p != thread_affinity_rep.end())
+    return p->second;
+
+  return ECA_THREAD_AFFINITY::cpus(thread_class);
+}
+
 void ECA_CHAINSETUP::set_sched_priority(int value)
 {
   ECA_LOG_MSG(ECA_LOGGER::system_objects, "sched_priority.");
@@ -2435,11 +2688,10 @@ const ECA_AUDIO_FORMAT& ECA_CHAINSETUP::default_audio_format(void) const
 void ECA_CHAINSETUP::set_target_to_controller(void) {
   vector<string> schains = selected_chains();
   for(vector<string>::const_iterator a = schains.begin(); a != schains.end(); a++) {
-    for(vector<CHAIN*>::iterator q = chains.begin(); q != chains.end(); q++) {
-      if (*a == (*q)->name()) {
-	(*q)->selected_controller_as_target();
-	return;
-      }
+    CHAIN* ch = edit_target_chain(*a);
+    if (ch != 0) {
+      ch->selected_controller_as_target();
+      return;
     }
   }
 }
@@ -2471,12 +2723,11 @@ void ECA_CHAINSETUP::add_controller(GENERIC_CONTROLLER* csrc)
 
   vector<string> schains = selected_chains();
   for(vector<string>::const_iterator a = schains.begin(); a != schains.end(); a++) {
-    for(vector<CHAIN*>::iterator q = chains.begin(); q != chains.end(); q++) {
-      if (*a == (*q)->name()) {
-	if ((*q)->selected_target() == 0) return;
-	(*q)->add_controller(csrc);
-	return;
-      }
+    CHAIN* ch = edit_target_chain(*a);
+    if (ch != 0) {
+      if (ch->selected_target() == 0) return;
+      ch->add_controller(csrc);
+      return;
     }
   }
 }
@@ -2505,13 +2756,12 @@ void ECA_CHAINSETUP::add_chain_operator(CHAIN_OPERATOR* cotmp)
 
   vector<string> schains = selected_chains();
   for(vector<string>::const_iterator p = schains.begin(); p != schains.end(); p++) {
-    for(vector<CHAIN*>::iterator q = chains.begin(); q != chains.end(); q++) {
-      if (*p == (*q)->name()) {
-	ECA_LOG_MSG(ECA_LOGGER::system_objects, "Adding chainop to chain " + (*q)->name() + ".");
-	(*q)->add_chain_operator(cotmp);
-	(*q)->selected_chain_operator_as_target();
-	return;
-      }
+    CHAIN* ch = edit_target_chain(*p);
+    if (ch != 0) {
+      ECA_LOG_MSG(ECA_LOGGER::system_objects, "Adding chainop to chain " + ch->name() + ".");
+      ch->add_chain_operator(cotmp);
+      ch->selected_chain_operator_as_target();
+      return;
     }
   }
 }
@@ -1,6 +1,7 @@
 // ------------------------------------------------------------------------
 // eca-chainsetup.h: Class representing an ecasound chainsetup object.
 // Copyright (C) 1999-2004,2006,2013 Kai Vehmanen
+// Copyright (C) 2026 agent
 //
 // Attributes:
 //     eca-style-version: 3
@@ -182,6 +183,7 @@ class ECA_CHAINSETUP : public ECA_CHAINSETUP_POSITION {
   /*@{*/
 
   void toggle_precise_sample_rates(bool value) { precise_sample_rates_rep = value; }
+  void toggle_hot_swap_crossfade(bool value) { hot_swap_crossfade_rep = value; }
   void toggle_ignore_xruns(bool v) { ignore_xruns_rep = v; }
   void set_output_openmode(int value) { output_openmode_rep = value; }
   void set_default_audio_format(ECA_AUDIO_FORMAT& value);
@@ -189,11 +191,14 @@ class ECA_CHAINSETUP : public ECA_CHAINSETUP_POSITION {
   void set_buffering_mode(Buffering_mode_t value);
   void set_audio_io_manager_option(const string& mgrname, const string& optionstr);
   void set_mix_mode(Mix_mode_t value) { mix_mode_rep = value; }
+  bool set_thread_affinity(const string& thread_class, const string& cpus);
 
   bool precise_sample_rates(void) const { return precise_sample_rates_rep; }
+  bool hot_swap_crossfade(void) const { return hot_swap_crossfade_rep; }
   bool ignore_xruns(void) const { return ignore_xruns_rep; }
   const ECA_AUDIO_FORMAT& default_audio_format(void) const;
   const string& default_midi_device(void) const { return default_midi_device_rep; }
+  string thread_affinity(const string& thread_class) const;
   int output_openmode(void) const { return output_openmode_rep; }
   Buffering_mode_t buffering_mode(void) const { return buffering_mode_rep; }
   bool is_valid_for_connection(bool verbose) const;
@@ -238,6 +243,12 @@ class ECA_CHAINSETUP : public ECA_CHAINSETUP_POSITION {
   const string& filename(void) const { return setup_filename_rep; }
 
   bool execute_edit(const ECA::chainsetup_edit_t& edit);
+  bool try_execute_edit(const ECA::chainsetup_edit_t& edit);
+  bool set_thread_safe_parameter(const ECA::chainsetup_edit_t& edit);
+  bool try_lock_edit(void);
+  void unlock_edit(void);
+  bool prepare_edit(const ECA::chainsetup_edit_t& edit, CHAIN** replacement);
+  CHAIN* copy_chain_for_edit(int index) const;
 
   /*@}*/
 
@@ -325,11 +336,13 @@ class ECA_CHAINSETUP : public ECA_CHAINSETUP_POSITION {
   ECA_CHAINSETUP_PARSER cparser_rep;
 
   bool precise_sample_rates_rep;
+  bool hot_swap_crossfade_rep;
   bool ignore_xruns_rep;
   bool rtcaps_rep;
   int output_openmode_rep;
   long int double_buffer_size_rep;
   string default_midi_device_rep;
+  std::map<string,string> thread_affinity_rep;
 
   /*@}*/
 
@@ -374,6 +387,7 @@ class ECA_CHAINSETUP : public ECA_CHAINSETUP_POSITION {
   vector<AUDIO_IO_MANAGER*> aio_managers_rep;
   map<string,string> aio_manager_option_map_rep;
   vector<CHAIN*> chains;
+  CHAIN* edit_chain_repp;
   vector<MIDI_IO*> midi_devices;
 
   AUDIO_IO_DB_SERVER* pserver_repp;
@@ -442,6 +456,8 @@ class ECA_CHAINSETUP : public ECA_CHAINSETUP_POSITION {
   int number_of_attached_chains_to_input(AUDIO_IO* aiod) const;
   int number_of_attached_chains_to_output(AUDIO_IO* aiod) const;
   void add_chain_helper(const string& name);
+  CHAIN* edit_target_chain(const string& name) const;
+  bool interpret_edit_option(const ECA::chainsetup_edit_t& edit);
   void enable_audio_object_helper(AUDIO_IO* aobj) const;
   void calculate_processing_length(void);
 
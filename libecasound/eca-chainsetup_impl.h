@@ -1,6 +1,8 @@
 #ifndef INCLUDED_ECA_CHAINSETUP_IMPL_H
 #define INCLUDED_ECA_CHAINSETUP_IMPL_H
 
+#include <pthread.h>
+
 #include "eca-chainsetup-bufparams.h"
 #include "audio-stamp.h"
 #include "midi-server.h"
@@ -12,8 +14,18 @@ class ECA_CHAINSETUP_impl {
 
   friend class ECA_CHAINSETUP;
 
+  ECA_CHAINSETUP_impl(void) { pthread_mutex_init(&edit_lock_rep, NULL); }
+  ~ECA_CHAINSETUP_impl(void) { pthread_mutex_destroy(&edit_lock_rep); }
+
  private:
 
+  /** 
+   * Held while an edit is prepared or executed, as both 
+   * use the option parser and selection state, and while
+   * the engine swaps in new chains
+   */
+  pthread_mutex_t edit_lock_rep;
+
   /** @name Aggregate objects */
   /*@{*/
 
@@ -2,6 +2,7 @@
 // eca-control-base.cpp: Base class providing basic functionality
 //                       for controlling the ecasound library
 // Copyright (C) 1999-2004,2006,2008,2009,2012 Kai Vehmanen
+// Copyright (C) 2026 agent
 //
 // Attributes:
 //     eca-style-version: 3 (see Ecasound Programmer's Guide)
@@ -42,6 +43,7 @@
 
 #include "eca-error.h"
 #include "eca-logger.h"
+#include "eca-trace-recorder.h"
 
 /**
  * Import namespaces
@@ -60,6 +62,7 @@ using std::vector;
 void* ECA_CONTROL::start_normal_thread(void *ptr)
 {
   ECA_CONTROL* ctrl_base = static_cast<ECA_CONTROL*>(ptr);
+  ECA_TRACE_RECORDER::set_thread_name("engine");
   ctrl_base->engine_pid_rep = getpid();
   DBC_CHECK(ctrl_base->engine_pid_rep >= 0);
 
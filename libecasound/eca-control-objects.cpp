@@ -2,6 +2,7 @@
 // eca-control-objects.cpp: Class for configuring libecasound objects
 // Copyright (C) 2000-2004,2006,2008,2009,2012-2014 Kai Vehmanen
 // Copyright (C) 2005 Stuart Allie
+// Copyright (C) 2026 agent
 //
 // Attributes:
 //     eca-style-version: 3 (see Ecasound Programmer's Guide)
@@ -784,23 +785,18 @@ void ECA_CONTROL::set_chainsetup_sample_format(const string& name)
  *
  * require:
  *  is_selected() == true
- *  connected_chainsetup() != selected_chainsetup()
- *  
- * ensure:
- *   selected_chains().size() > 0
+ *  connected_chainsetup() != selected_chainsetup() ||
+ *  is_engine_ready_for_commands() == true
  */
 void ECA_CONTROL::add_chain(const string& name)
 {
   // --------
   DBC_REQUIRE(is_selected() == true);
-  DBC_REQUIRE(selected_chainsetup() != connected_chainsetup());
+  DBC_REQUIRE(selected_chainsetup() != connected_chainsetup() ||
+	      is_engine_ready_for_commands() == true);
   // --------
 
   add_chains(std::vector<string> (1, name));
-
-  // --------
-  DBC_ENSURE(selected_chains().size() > 0);
-  // --------
 }
 
 /**
@@ -811,50 +807,100 @@ void ECA_CONTROL::add_chain(const string& name)
  *
  * require:
  *  is_selected() == true
- *  connected_chainsetup() != selected_chainsetup()
- *  
- * ensure:
- *   selected_chains().size() > 0
+ *  connected_chainsetup() != selected_chainsetup() ||
+ *  is_engine_ready_for_commands() == true
  */
 void ECA_CONTROL::add_chains(const string& names)
 { 
   // --------
-  DBC_REQUIRE(is_selected() == true &&
-	      (session_repp->connected_chainsetup_repp !=
-	       session_repp->selected_chainsetup_repp));
+  DBC_REQUIRE(is_selected() == true);
+  DBC_REQUIRE(selected_chainsetup() != connected_chainsetup() ||
+	      is_engine_ready_for_commands() == true);
   // --------
 
   add_chains(kvu_string_to_vector(names, ','));
-  
-  // --------
-  DBC_ENSURE(selected_chains().size() > 0);
-  // --------
 }
 
 /**
  * Adds new chains (selected chainsetup). Added chains are automatically
- * selected.
+ * selected. Chains that already exist are not added, but 
+ * are selected.
+ *
+ * If the selected chainsetup is connected, the chains are 
+ * added while the engine is running. As chains of a 
+ * connected chainsetup must have an input and an output,
+ * the added chains are attached to the selected audio 
+ * input and output.
  *
  * @param namess vector of chain names
  *
  * require:
  *  is_selected() == true
- *  connected_chainsetup() != selected_chainsetup()
+ *  connected_chainsetup() != selected_chainsetup() ||
+ *  is_engine_ready_for_commands() == true
  *  
  * ensure:
- *   selected_chains().size() == names.size()
+ *   selected_chains().size() == names.size() || 
+ *   last_error().size() > 0
  */
 void ECA_CONTROL::add_chains(const std::vector<string>& new_chains)
 {
   // --------
   DBC_REQUIRE(is_selected() == true);
-  DBC_REQUIRE(connected_chainsetup() != selected_chainsetup());
+  DBC_REQUIRE(connected_chainsetup() != selected_chainsetup() ||
+	      is_engine_ready_for_commands() == true);
   // --------
 
-  selected_chainsetup_repp->add_new_chains(new_chains);
+  std::vector<string> added_names, existing_names;
+  for(size_t n = 0; n < new_chains.size(); n++) {
+    if (selected_chainsetup_repp->get_chain_with_name(new_chains[n]) != 0)
+      existing_names.push_back(new_chains[n]);
+    else if (std::find(added_names.begin(), added_names.end(), new_chains[n]) == added_names.end())
+      added_names.push_back(new_chains[n]);
+  }
+
+  if (connected_chainsetup() == selected_chainsetup()) {
+    ECA_CHAINSETUP* csetup = selected_chainsetup_repp;
+    int input = std::find(csetup->inputs.begin(), csetup->inputs.end(), 
+			  selected_audio_input_repp) - csetup->inputs.begin();
+    int output = std::find(csetup->outputs.begin(), csetup->outputs.end(), 
+			   selected_audio_output_repp) - csetup->outputs.begin();
+    if (added_names.size() > 0 &&
+	(input == static_cast<int>(csetup->inputs.size()) ||
+	 output == static_cast<int>(csetup->outputs.size()))) {
+      set_last_error("Chains added while running are attached to the selected audio input and output, but none selected.");
+      return;
+    }
+
+    std::vector<CHAIN*> chains (csetup->chains);
+    std::vector<CHAIN*> added;
+    for(size_t n = 0; n < added_names.size(); n++) {
+      CHAIN* chain = new CHAIN();
+      chain->name(added_names[n]);
+      chain->set_samples_per_second(csetup->samples_per_second());
+      chain->connect_input(input);
+      chain->connect_output(output);
+      chains.push_back(chain);
+      added.push_back(chain);
+    }
+
+    if (added.size() > 0 &&
+	hot_swap_chains(chains, std::vector<int> (chains.size(), -1)) != true) {
+      for(size_t n = 0; n < added.size(); n++) {
+	delete added[n];
+      }
+      return;
+    }
+  }
+  else
+    selected_chainsetup_repp->add_new_chains(new_chains);
+
   selected_chainsetup_repp->select_chains(new_chains);
 
-  ECA_LOG_MSG(ECA_LOGGER::info, "Added chains: " + kvu_vector_to_string(new_chains, ", ") + ".");
+  if (added_names.size() > 0)
+    ECA_LOG_MSG(ECA_LOGGER::info, "Added chains: " + kvu_vector_to_string(added_names, ", ") + ".");
+  if (existing_names.size() > 0)
+    ECA_LOG_MSG(ECA_LOGGER::info, "Selected existing chains: " + kvu_vector_to_string(existing_names, ", ") + ".");
 
   // --------
   DBC_ENSURE(selected_chains().size() == new_chains.size());
@@ -864,24 +910,47 @@ void ECA_CONTROL::add_chains(const std::vector<string>& new_chains)
 /**
  * Removes currently selected chain (selected chainsetup)
  *
+ * If the selected chainsetup is connected, the chains are
+ * removed while the engine is running.
+ *
  * require:
  *  is_selected() == true
- *  connected_chainsetup() != selected_chainsetup()
+ *  connected_chainsetup() != selected_chainsetup() ||
+ *  is_engine_ready_for_commands() == true
  *  selected_chains().size() > 0 &&
  *
  * ensure:
- *  selected_chains().size() == 0
+ *  selected_chains().size() == 0 || last_error().size() > 0
  */
 void ECA_CONTROL::remove_chains(void)
 {
   // --------
-  DBC_REQUIRE(is_selected() == true &&
-	      selected_chains().size() > 0 &&
-	      (session_repp->connected_chainsetup_repp !=
-	       session_repp->selected_chainsetup_repp));
+  DBC_REQUIRE(is_selected() == true);
+  DBC_REQUIRE(selected_chains().size() > 0);
+  DBC_REQUIRE(connected_chainsetup() != selected_chainsetup() ||
+	      is_engine_ready_for_commands() == true);
   // --------
 
-  selected_chainsetup_repp->remove_chains();
+  if (connected_chainsetup() == selected_chainsetup()) {
+    const std::vector<string>& schains = selected_chains();
+    std::vector<CHAIN*> chains;
+    for(size_t n = 0; n < selected_chainsetup_repp->chains.size(); n++) {
+      CHAIN* chain = selected_chainsetup_repp->chains[n];
+      if (std::find(schains.begin(), schains.end(), chain->name()) == schains.end())
+	chains.push_back(chain);
+    }
+
+    if (chains.size() == 0) {
+      set_last_error("Unable to remove all chains while running.");
+      return;
+    }
+    if (hot_swap_chains(chains, std::vector<int> (chains.size(), -1)) != true)
+      return;
+
+    selected_chainsetup_repp->select_chains(std::vector<string> ());
+  }
+  else
+    selected_chainsetup_repp->remove_chains();
 
   ECA_LOG_MSG(ECA_LOGGER::info, "(eca-controlled) Removed selected chains.");
 
@@ -1092,17 +1161,115 @@ CHAIN* ECA_CONTROL::get_chain_priv(void) const
  *
  * @param name chain name 
  *
+ * If the selected chainsetup is connected, the chains are
+ * cleared while the engine is running.
+ *
  * require:
  *  is_selected() == true
- *  is_running() != true
+ *  is_running() != true || 
+ *  connected_chainsetup() == selected_chainsetup()
  */
 void ECA_CONTROL::clear_chains(void)
 {
   // --------
   DBC_REQUIRE(is_selected() == true);
-  DBC_REQUIRE(is_running() != true);
+  DBC_REQUIRE(is_running() != true || 
+	      connected_chainsetup() == selected_chainsetup());
   // --------
-  selected_chainsetup_repp->clear_chains();
+
+  if (connected_chainsetup() == selected_chainsetup() &&
+      is_engine_ready_for_commands() == true) {
+    const std::vector<string>& schains = selected_chains();
+    std::vector<CHAIN*> chains (selected_chainsetup_repp->chains);
+    std::vector<int> replaces (chains.size(), -1);
+    std::vector<CHAIN*> copies;
+    for(size_t n = 0; n < chains.size(); n++) {
+      if (std::find(schains.begin(), schains.end(), chains[n]->name()) == schains.end())
+	continue;
+      CHAIN* copy = selected_chainsetup_repp->copy_chain_for_edit(n);
+      if (copy == 0) {
+	set_last_error("Unable to clear chain \"" + chains[n]->name() + "\" while running.");
+	continue;
+      }
+      copy->clear();
+      chains[n] = copy;
+      replaces[n] = n;
+      copies.push_back(copy);
+    }
+
+    if (copies.size() > 0 &&
+	hot_swap_chains(chains, replaces) != true) {
+      for(size_t n = 0; n < copies.size(); n++) {
+	delete copies[n];
+      }
+    }
+  }
+  else
+    selected_chainsetup_repp->clear_chains();
+}
+
+/**
+ * Replaces the chains of the connected chainsetup with 
+ * 'chains', while the engine is running. Chains not in 
+ * 'chains' are removed. If 'replaces[n]' is not -1, 
+ * 'chains[n]' is a copy of the chain at index 'replaces[n]'
+ * and replaces it. On success, ownership of added chains
+ * is transferred.
+ *
+ * @see ECA_ENGINE::replace_chains()
+ *
+ * @pre is_engine_ready_for_commands() == true
+ */
+bool ECA_CONTROL::hot_swap_chains(const std::vector<CHAIN*>& chains, const std::vector<int>& replaces)
+{
+  // --------
+  DBC_REQUIRE(is_engine_ready_for_commands() == true);
+  // --------
+
+  const ECA_CHAINSETUP* csetup = session_repp->connected_chainsetup_repp;
+
+  /* note: inputs and outputs that no chain reads from or
+   *       writes to would not be serviced by the engine */
+  std::vector<int> inputs (csetup->inputs.size(), 0);
+  std::vector<int> outputs (csetup->outputs.size(), 0);
+  for(size_t n = 0; n < chains.size(); n++) {
+    ++inputs[chains[n]->connected_input()];
+    ++outputs[chains[n]->connected_output()];
+  }
+  if (std::find(inputs.begin(), inputs.end(), 0) != inputs.end() ||
+      std::find(outputs.begin(), outputs.end(), 0) != outputs.end()) {
+    set_last_error("Unable to change chains while running, all inputs and outputs must stay attached to some chain.");
+    return false;
+  }
+
+  if (engine_repp->replace_chains(chains, replaces) != true) {
+    set_last_error("Unable to change chains while running, engine did not adopt the change.");
+    return false;
+  }
+
+  return true;
+}
+
+/**
+ * Replaces chain at 'index' (0...N-1) of the connected 
+ * chainsetup with 'copy' while the engine is running, 
+ * or deletes 'copy' if this fails.
+ *
+ * @see hot_swap_chains()
+ */
+bool ECA_CONTROL::hot_swap_chain(int index, CHAIN* copy)
+{
+  std::vector<CHAIN*> chains (session_repp->connected_chainsetup_repp->chains);
+  std::vector<int> replaces (chains.size(), -1);
+  chains[index] = copy;
+  replaces[index] = index;
+
+  if (hot_swap_chains(chains, replaces) != true) {
+    delete copy;
+    return false;
+  }
+
+  return true;
 }
 
 /**
@@ -1905,22 +2072,38 @@ int ECA_CONTROL::selected_chain_operator(void) const
 /**
  * Removes the selected chain operator
  *
+ * If the selected chainsetup is connected, the chain 
+ * operator is removed while the engine is running.
+ *
  * require:
  *  is_selected() == true
- *  connected_chainsetup() != selected_chainsetup()
+ *  connected_chainsetup() != selected_chainsetup() ||
+ *  is_engine_ready_for_commands() == true
  *  selected_chains().size() == 1
  */
 void ECA_CONTROL::remove_chain_operator(void)
 {
   // --------
   DBC_REQUIRE(is_selected() == true);
-  DBC_REQUIRE(selected_chainsetup() != connected_chainsetup());
+  DBC_REQUIRE(selected_chainsetup() != connected_chainsetup() ||
+	      is_engine_ready_for_commands() == true);
   DBC_REQUIRE(selected_chains().size() == 1);
   // --------
 
   unsigned int p = selected_chainsetup_repp->first_selected_chain();
-  if (p < selected_chainsetup_repp->chains.size())
-    selected_chainsetup_repp->chains[p]->remove_chain_operator(-1);
+  if (p < selected_chainsetup_repp->chains.size()) {
+    if (selected_chainsetup() == connected_chainsetup()) {
+      CHAIN* copy = selected_chainsetup_repp->copy_chain_for_edit(p);
+      if (copy == 0) {
+	set_last_error("Unable to remove chain operator while running.");
+	return;
+      }
+      copy->remove_chain_operator(-1);
+      hot_swap_chain(p, copy);
+    }
+    else
+      selected_chainsetup_repp->chains[p]->remove_chain_operator(-1);
+  }
 }
 
 /**
@@ -2325,9 +2508,13 @@ void ECA_CONTROL::select_controller(int controller_id)
 /**
  * Removes the selected controller.
  *
+ * If the selected chainsetup is connected, the controller
+ * is removed while the engine is running.
+ *
  * require:
  *  is_selected() == true
- *  connected_chainsetup() != selected_chainsetup()
+ *  connected_chainsetup() != selected_chainsetup() ||
+ *  is_engine_ready_for_commands() == true
  *  selected_chains().size() == 1
  *  get_controller() != 0
  */
@@ -2335,14 +2522,25 @@ void ECA_CONTROL::remove_controller(void)
 {
   // --------
   DBC_REQUIRE(is_selected() == true);
-  DBC_REQUIRE(selected_chainsetup() != connected_chainsetup());
+  DBC_REQUIRE(selected_chainsetup() != connected_chainsetup() ||
+	      is_engine_ready_for_commands() == true);
   DBC_REQUIRE(selected_chains().size() == 1);
   DBC_REQUIRE(get_controller() != 0);
   // --------
 
   unsigned int p = selected_chainsetup_repp->first_selected_chain();
   if (p < selected_chainsetup_repp->chains.size()) {
-    selected_chainsetup_repp->chains[p]->remove_controller();
+    if (selected_chainsetup() == connected_chainsetup()) {
+      CHAIN* copy = selected_chainsetup_repp->copy_chain_for_edit(p);
+      if (copy == 0) {
+	set_last_error("Unable to remove controller while running.");
+	return;
+      }
+      copy->remove_controller();
+      hot_swap_chain(p, copy);
+    }
+    else
+      selected_chainsetup_repp->chains[p]->remove_controller();
   }
 }
 
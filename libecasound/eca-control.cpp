@@ -3,6 +3,7 @@
 // Copyright (C) 1999-2005,2008,2009,2012 Kai Vehmanen
 // Copyright (C) 2005 Stuart Allie
 // Copyright (C) 2009 Adam Linson
+// Copyright (C) 2026 agent
 //
 // Attributes:
 //     eca-style-version: 3 (see Ecasound Programmer's Guide)
@@ -54,7 +55,11 @@
 #include "eca-object-factory.h"
 #include "eca-object-map.h"
 #include "eca-preset-map.h"
+#include "eca-rt-memory.h"
 #include "eca-session.h"
+#include "eca-thread-affinity.h"
+#include "eca-engine-trace.h"
+#include "eca-trace-recorder.h"
 
 #include "generic-controller.h"
 #include "eca-chainop.h"
@@ -124,6 +129,8 @@ void ECA_CONTROL::fill_command_retval(struct eci_return_value *retval) const
 
 void ECA_CONTROL::command(const string& cmd_and_args, struct eci_return_value *retval)
 {
+  ECA_TRACE_SCOPE trace_scope ("control", cmd_and_args.c_str());
+
   clear_last_values();
   clear_action_arguments();
 
@@ -361,7 +368,14 @@ void ECA_CONTROL::check_action_preconditions(int action_id)
       }
     }
   }
-  /* case 6: action can't be performed on a connected setup, 
+  /* case 6: action changes chains of a connected setup, which
+   *         is done while the engine is running */
+  else if (selected_chainsetup() == connected_chainsetup() &&
+	   action_supports_hot_swap(action_id) &&
+	   is_engine_ready_for_commands() == true) {
+    /* no-op, see hot_swap_chains() */
+  }
+  /* case 7: action can't be performed on a connected setup, 
    *         but selected chainsetup is also connected */
   else if (selected_chainsetup() == connected_chainsetup() &&
 	   action_requires_selected_not_connected(action_id)) {
@@ -805,6 +819,35 @@ void ECA_CONTROL::action(int action_id)
     break; 
   }
   case ec_engine_status: { set_last_string(engine_status()); break; }
+  case ec_engine_memory_status: { set_last_string(ECA_RT_MEMORY::status()); break; }
+  case ec_engine_set_affinity: 
+    {
+      /* note: CPU list may contain commas */
+      std::vector<string> args = kvu_string_to_vector(first_action_argument_as_string(), ',');
+      string cpus;
+      if (args.size() > 1)
+	cpus = kvu_vector_to_string(std::vector<string> (args.begin() + 1, args.end()), ",");
+      if (args.size() == 0 ||
+	  ECA_THREAD_AFFINITY::set_cpus(args[0], cpus) != true)
+	set_last_error("Invalid thread class or CPU list.");
+      break;
+    }
+  case ec_engine_affinity_status: { set_last_string(ECA_THREAD_AFFINITY::status()); break; }
+  case ec_engine_trace_get: { set_last_string_list(ECA_ENGINE_TRACE::raw_trace()); break; }
+  case ec_engine_trace_histogram: { set_last_string(ECA_ENGINE_TRACE::histogram()); break; }
+  case ec_trace_start: 
+    { 
+      ECA_TRACE_RECORDER::clear();
+      ECA_TRACE_RECORDER::set_enabled(true); 
+      break; 
+    }
+  case ec_trace_stop: { ECA_TRACE_RECORDER::set_enabled(false); break; }
+  case ec_trace_export: 
+    {
+      if (ECA_TRACE_RECORDER::export_file(first_action_argument_as_string()) != true)
+	set_last_error("Unable to write trace to \"" + first_action_argument_as_string() + "\".");
+      break;
+    }
 
   // ---
   // Internal commands
@@ -914,6 +957,27 @@ bool ECA_CONTROL::execute_edit_on_connected(const chainsetup_edit_t& edit)
   bool retval = false;
   
   if (is_engine_ready_for_commands() == true) {
+    /* note: operators with thread-safe parameters pick
+     *       up new values at the next block, so there is
+     *       no need to go via the engine command queue, 
+     *       unless earlier edits are still queued */
+    if (edit.type == ECA::edit_cop_set_param &&
+	engine_repp->has_queued_edits() != true &&
+	session_repp->connected_chainsetup_repp->set_thread_safe_parameter(edit) == true)
+      return true;
+
+    /* note: operators and controllers are added to a copy 
+     *       of the chain, which is created and initialized 
+     *       here, and then swapped in by the engine */
+    if (edit.type == ECA::edit_cop_add ||
+	edit.type == ECA::edit_ctrl_add) {
+      CHAIN* replacement = 0;
+      if (session_repp->connected_chainsetup_repp->prepare_edit(edit, &replacement) != true)
+	return false;
+      if (replacement != 0)
+	return hot_swap_chain(edit.m.c_generic_param.chain - 1, replacement);
+    }
+
     ECA_ENGINE::complex_command_t engine_cmd;
     engine_cmd.type = ECA_ENGINE::ep_exec_edit;
     engine_cmd.cs = edit;
@@ -1,6 +1,7 @@
 // ------------------------------------------------------------------------
 // eca-control.h: ECA_CONTROL class
 // Copyright (C) 2009,2012 Kai Vehmanen
+// Copyright (C) 2026 agent
 //
 // Attributes:
 //     eca-style-version: 3
@@ -397,6 +398,8 @@ class ECA_CONTROL : public ECA_IAMODE_PARSER,
   void wave_edit_audio_object(void);
 
   CHAIN* get_chain_priv(void) const;
+  bool hot_swap_chains(const std::vector<CHAIN*>& chains, const std::vector<int>& replaces);
+  bool hot_swap_chain(int index, CHAIN* copy);
 
   void action(int action_id);
   void check_action_preconditions(int action_id);
@@ -1,6 +1,7 @@
 // ------------------------------------------------------------------------
 // eca-control_test.h: Unit test for ECA_CONTROL
 // Copyright (C) 2002 Kai Vehmanen
+// Copyright (C) 2026 agent
 //
 // This program is free software; you can redistribute it and/or modify
 // it under the terms of the GNU General Public License as published by
@@ -46,6 +47,7 @@ public:
 private:
 
   void do_run_chainsetup_creation(void);
+  void do_run_live_edit(void);
 
 };
 
@@ -53,6 +55,8 @@ void ECA_CONTROL_TEST::do_run(void)
 {
   cout << "libecasound_tester: eca-control - chainsetup creation stress test" << endl;
   do_run_chainsetup_creation();
+  cout << "libecasound_tester: eca-control - adding objects while running" << endl;
+  do_run_live_edit();
 }
 
 void ECA_CONTROL_TEST::do_run_chainsetup_creation(void)
@@ -92,3 +96,87 @@ void ECA_CONTROL_TEST::do_run_chainsetup_creation(void)
   delete ectrl;
   delete esession;
 }
+
+void ECA_CONTROL_TEST::do_run_live_edit(void)
+{
+  ECA_SESSION *esession = new ECA_SESSION();
+  ECA_CONTROL *ectrl = new ECA_CONTROL(esession);
+
+  ectrl->add_chainsetup("default");
+  ectrl->add_chain("default");
+  ectrl->add_audio_input("null");
+  ectrl->add_audio_output("null");
+  ectrl->add_chain_operator("-ea:100");
+  ectrl->connect_chainsetup(0);
+  if (ectrl->is_connected() != true) ECA_TEST_FAILURE("Chainsetup connection failed.");
+  ectrl->start();
+  kvu_sleep(0, 50000000); /* 50ms */
+
+  for(int i = 0; i < 5; i++) {
+    ectrl->add_chain_operator("-efl:1000");
+    if (ectrl->chain_operator_names().size() != static_cast<size_t>(i + 2))
+      ECA_TEST_FAILURE("Chain operator not added while running.");
+    if (ectrl->selected_chain_operator() != i + 2) 
+      ECA_TEST_FAILURE("Added chain operator not selected.");
+
+    ectrl->add_controller("-kos:1,100,1000,1,0");
+    if (ectrl->controller_names().size() != static_cast<size_t>(i + 1))
+      ECA_TEST_FAILURE("Controller not added while running.");
+
+    kvu_sleep(0, 20000000); /* 20ms */
+    if (ectrl->is_running() != true) ECA_TEST_FAILURE("Engine stopped after edit.");
+  }
+
+  ectrl->select_controller(1);
+  ectrl->remove_controller();
+  if (ectrl->controller_names().size() != 4)
+    ECA_TEST_FAILURE("Controller not removed while running.");
+
+  ectrl->select_chain_operator(6);
+  ectrl->remove_chain_operator();
+  if (ectrl->chain_operator_names().size() != 5)
+    ECA_TEST_FAILURE("Chain operator not removed while running.");
+
+  /* note: 'cop-set' on operators without thread-safe
+   *       parameters is executed by the engine, in order */
+  ectrl->select_chain_operator(1);
+  ectrl->select_chain_operator_parameter(1);
+  ectrl->set_chain_operator_parameter(70);
+  ectrl->set_chain_operator_parameter(80);
+  kvu_sleep(0, 20000000); /* 20ms */
+  if (ectrl->get_chain_operator_parameter() != 80)
+    ECA_TEST_FAILURE("Chain operator parameter not set while running.");
+
+  ectrl->select_audio_input("null");
+  ectrl->select_audio_output("null");
+  ectrl->add_chain("second");
+  if (ectrl->chain_names().size() != 2)
+    ECA_TEST_FAILURE("Chain not added while running.");
+  ectrl->add_chain_operator("-ea:50");
+  kvu_sleep(0, 20000000); /* 20ms */
+
+  ectrl->select_chain("default");
+  ectrl->clear_chains();
+  if (ectrl->chain_operator_names().size() != 0)
+    ECA_TEST_FAILURE("Chain not cleared while running.");
+
+  ectrl->remove_chains();
+  if (ectrl->chain_names().size() != 1 ||
+      ectrl->chain_names()[0] != "second")
+    ECA_TEST_FAILURE("Chain not removed while running.");
+
+  ectrl->select_chain("second");
+  ectrl->remove_chains();
+  if (ectrl->chain_names().size() != 1)
+    ECA_TEST_FAILURE("Last chain removed while running.");
+
+  kvu_sleep(0, 20000000); /* 20ms */
+  if (ectrl->is_running() != true) ECA_TEST_FAILURE("Engine stopped after graph change.");
+
+  ectrl->stop_on_condition();
+  ectrl->disconnect_chainsetup();
+  ectrl->remove_chainsetup();
+
+  delete ectrl;
+  delete esession;
+}
@@ -66,6 +66,24 @@ class ECA_ENGINE_DRIVER {
 
   /*@}*/
 
+  /** @name Public API for engine callbacks */
+  /*@{*/
+
+  /**
+   * Called by the engine once per iteration to process
+   * all chains. Drivers that are able to distribute chain 
+   * processing to multiple threads can reimplement this
+   * function and use ECA_ENGINE::process_chain() to 
+   * process individual chains. The call must not return 
+   * before all chains have been processed.
+   *
+   * @return true if chains were processed; false if 
+   *         the engine should process them itself
+   */
+  virtual bool process_chains(ECA_ENGINE* engine) { return false; }
+
+  /*@}*/
+
   virtual ~ECA_ENGINE_DRIVER(void) {}
 
 };
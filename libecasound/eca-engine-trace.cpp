@@ -0,0 +1,411 @@
+// ------------------------------------------------------------------------
+// eca-engine-trace.cpp: Per-cycle timing telemetry of the engine loop
+// Copyright (C) 2026 agent
+//
+// Attributes:
+//     eca-style-version: 3
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
+// ------------------------------------------------------------------------
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <string>
+#include <vector>
+#include <pthread.h>
+
+#include <kvu_dbc.h>
+#include <kvu_locks.h>
+#include <kvu_numtostr.h>
+#include <kvu_timestamp.h>
+
+#include "eca-engine-trace.h"
+
+using std::string;
+
+/**
+ * Timing of one engine cycle. Durations are in
+ * nanoseconds.
+ */
+struct ECA_ENGINE_TRACE_RECORD {
+  long int cycle;
+  struct timespec start;
+  struct timespec end;
+  long int stage_ns[ECA_ENGINE_TRACE::stage_count];
+  long int wait_ns;
+  long int period_ns;
+};
+
+/**
+ * Ring slot. 'index' is the position of the record in
+ * the stream of all records written, which tells the
+ * reader whether the slot has been overwritten.
+ */
+struct ECA_ENGINE_TRACE_SLOT {
+  KVU_SEQLOCK lock;
+  long int index;
+  ECA_ENGINE_TRACE_RECORD record;
+};
+
+/**
+ * Load histogram bins: ten 10% bins up to the period,
+ * then 100-150%, 150-200% and over 200%.
+ */
+static const int eca_engine_trace_bins = 13;
+
+struct ECA_ENGINE_TRACE_STATS {
+  long int period_ns;
+  long int cycles;
+  long int overruns;
+  long int bins[eca_engine_trace_bins];
+  double stage_total_ns[ECA_ENGINE_TRACE::stage_count];
+  long int stage_max_ns[ECA_ENGINE_TRACE::stage_count];
+  double wait_total_ns;
+  long int wait_max_ns;
+  long int busy_max_ns;
+};
+
+static const long int eca_engine_trace_ring_size = 1024;
+static const char* eca_engine_trace_stage_names[] =
+  { "control", "inputs", "chains", "mix", "writes" };
+static const char* eca_engine_trace_bin_names[] =
+  { "0-10%", "10-20%", "20-30%", "30-40%", "40-50%", "50-60%", "60-70%",
+    "70-80%", "80-90%", "90-100%", "100-150%", "150-200%", ">200%" };
+
+/* note: written by the engine thread only */
+static ECA_ENGINE_TRACE_SLOT eca_engine_trace_ring[eca_engine_trace_ring_size];
+static volatile long int eca_engine_trace_write_index = 0;
+static ECA_ENGINE_TRACE_RECORD eca_engine_trace_current;
+static struct timespec eca_engine_trace_last_mark;
+static struct timespec eca_engine_trace_wait_begin;
+static long int eca_engine_trace_unmarked_wait_ns;
+static ECA_ENGINE_TRACE_STATS eca_engine_trace_stats;
+static KVU_SEQLOCK eca_engine_trace_stats_lock;
+
+/* note: protected by 'eca_engine_trace_read_lock' */
+static long int eca_engine_trace_read_index = 0;
+static long int eca_engine_trace_lost = 0;
+static pthread_mutex_t eca_engine_trace_read_lock = PTHREAD_MUTEX_INITIALIZER;
+
+bool ECA_ENGINE_TRACE::enabled_rep = true;
+
+/**
+ * Returns the time from 'from' to 'to' in nanoseconds.
+ */
+static long int eca_engine_trace_ns(const struct timespec& from, const struct timespec& to)
+{
+  return (to.tv_sec - from.tv_sec) * 1000000000L + (to.tv_nsec - from.tv_nsec);
+}
+
+static string eca_engine_trace_usecs(double ns)
+{
+  return kvu_numtostr(ns / 1000.0, 1);
+}
+
+void ECA_ENGINE_TRACE::set_enabled(bool value)
+{
+  enabled_rep = value;
+}
+
+/**
+ * Clears the histogram and sets the period cycles
+ * are compared against. Called when an engine is
+ * created, before it starts iterating.
+ */
+void ECA_ENGINE_TRACE::reset(long int period_ns)
+{
+  // --
+  DBC_REQUIRE(period_ns > 0);
+  // --
+
+  KVU_GUARD_LOCK guard(&eca_engine_trace_read_lock);
+
+  eca_engine_trace_stats_lock.write_begin();
+  eca_engine_trace_stats.period_ns = period_ns;
+  eca_engine_trace_stats.cycles = 0;
+  eca_engine_trace_stats.overruns = 0;
+  for(int n = 0; n < eca_engine_trace_bins; n++)
+    eca_engine_trace_stats.bins[n] = 0;
+  for(int n = 0; n < stage_count; n++) {
+    eca_engine_trace_stats.stage_total_ns[n] = 0.0;
+    eca_engine_trace_stats.stage_max_ns[n] = 0;
+  }
+  eca_engine_trace_stats.wait_total_ns = 0.0;
+  eca_engine_trace_stats.wait_max_ns = 0;
+  eca_engine_trace_stats.busy_max_ns = 0;
+  eca_engine_trace_stats_lock.write_end();
+}
+
+const char* ECA_ENGINE_TRACE::stage_name(int stage)
+{
+  // --
+  DBC_REQUIRE(stage >= 0 && stage < stage_count);
+  // --
+
+  return eca_engine_trace_stage_names[stage];
+}
+
+/**
+ * Marks the start of an engine cycle.
+ *
+ * context: engine thread, realtime-safe
+ */
+void ECA_ENGINE_TRACE::cycle_start(void)
+{
+  ECA_ENGINE_TRACE_RECORD& cur = eca_engine_trace_current;
+
+  kvu_clock_gettime(&cur.start);
+  eca_engine_trace_last_mark = cur.start;
+  for(int n = 0; n < stage_count; n++)
+    cur.stage_ns[n] = 0;
+  cur.wait_ns = 0;
+  eca_engine_trace_unmarked_wait_ns = 0;
+}
+
+/**
+ * Adds the time elapsed since the previous mark, or
+ * since the start of the cycle, to 'stage'. Time spent
+ * waiting for realtime devices in between is left out,
+ * as it is recorded separately.
+ *
+ * context: engine thread, realtime-safe
+ */
+void ECA_ENGINE_TRACE::mark(Stage stage)
+{
+  struct timespec now;
+  kvu_clock_gettime(&now);
+  eca_engine_trace_current.stage_ns[stage] +=
+    eca_engine_trace_ns(eca_engine_trace_last_mark, now) -
+    eca_engine_trace_unmarked_wait_ns;
+  eca_engine_trace_unmarked_wait_ns = 0;
+  eca_engine_trace_last_mark = now;
+}
+
+/**
+ * Marks the start of a blocking call to a realtime
+ * device.
+ *
+ * context: engine thread, realtime-safe
+ */
+void ECA_ENGINE_TRACE::wait_start(void)
+{
+  kvu_clock_gettime(&eca_engine_trace_wait_begin);
+}
+
+/**
+ * Marks the end of a blocking call to a realtime
+ * device.
+ *
+ * context: engine thread, realtime-safe
+ */
+void ECA_ENGINE_TRACE::wait_stop(void)
+{
+  struct timespec now;
+  kvu_clock_gettime(&now);
+  long int wait = eca_engine_trace_ns(eca_engine_trace_wait_begin, now);
+  eca_engine_trace_current.wait_ns += wait;
+  eca_engine_trace_unmarked_wait_ns += wait;
+}
+
+/**
+ * Marks the end of an engine cycle. Time since the
+ * last mark is added to the control stage. The cycle
+ * is stored to the ring and added to the histogram.
+ *
+ * context: engine thread, realtime-safe
+ */
+void ECA_ENGINE_TRACE::cycle_end(void)
+{
+  mark(stage_control);
+
+  ECA_ENGINE_TRACE_RECORD& cur = eca_engine_trace_current;
+  ECA_ENGINE_TRACE_STATS& stats = eca_engine_trace_stats;
+
+  cur.end = eca_engine_trace_last_mark;
+  cur.cycle = stats.cycles;
+  cur.period_ns = stats.period_ns;
+
+  long int busy = eca_engine_trace_ns(cur.start, cur.end) - cur.wait_ns;
+  double load = (stats.period_ns > 0 ? static_cast<double>(busy) / stats.period_ns : 0.0);
+  int bin = static_cast<int>(load * 10.0);
+  if (load >= 2.0)
+    bin = 12;
+  else if (load >= 1.5)
+    bin = 11;
+  else if (load >= 1.0)
+    bin = 10;
+  else if (bin < 0)
+    bin = 0;
+
+  long int index = eca_engine_trace_write_index;
+  ECA_ENGINE_TRACE_SLOT& slot = eca_engine_trace_ring[index % eca_engine_trace_ring_size];
+  slot.lock.write_begin();
+  slot.index = index;
+  slot.record = cur;
+  slot.lock.write_end();
+  __sync_synchronize();
+  eca_engine_trace_write_index = index + 1;
+
+  eca_engine_trace_stats_lock.write_begin();
+  stats.cycles++;
+  if (load > 1.0)
+    stats.overruns++;
+  stats.bins[bin]++;
+  for(int n = 0; n < stage_count; n++) {
+    stats.stage_total_ns[n] += cur.stage_ns[n];
+    if (cur.stage_ns[n] > stats.stage_max_ns[n])
+      stats.stage_max_ns[n] = cur.stage_ns[n];
+  }
+  stats.wait_total_ns += cur.wait_ns;
+  if (cur.wait_ns > stats.wait_max_ns)
+    stats.wait_max_ns = cur.wait_ns;
+  if (busy > stats.busy_max_ns)
+    stats.busy_max_ns = busy;
+  eca_engine_trace_stats_lock.write_end();
+}
+
+/**
+ * Returns cycles recorded since the previous call, one
+ * line per cycle. Start and end times are in seconds
+ * of the monotonic clock, durations in microseconds.
+ * 'busy' is the cycle duration without time spent
+ * waiting for realtime devices ('wait'), and equals
+ * the sum of the stage times.
+ */
+std::vector<std::string> ECA_ENGINE_TRACE::raw_trace(void)
+{
+  std::vector<std::string> result;
+  KVU_GUARD_LOCK guard(&eca_engine_trace_read_lock);
+
+  long int end = eca_engine_trace_write_index;
+  __sync_synchronize();
+
+  if (end - eca_engine_trace_read_index > eca_engine_trace_ring_size) {
+    eca_engine_trace_lost += end - eca_engine_trace_ring_size - eca_engine_trace_read_index;
+    eca_engine_trace_read_index = end - eca_engine_trace_ring_size;
+  }
+
+  for(long int i = eca_engine_trace_read_index; i < end; i++) {
+    const ECA_ENGINE_TRACE_SLOT& slot = eca_engine_trace_ring[i % eca_engine_trace_ring_size];
+    ECA_ENGINE_TRACE_RECORD rec;
+    long int index;
+    unsigned int seq;
+    do {
+      seq = slot.lock.read_begin();
+      index = slot.index;
+      rec = slot.record;
+    }
+    while(slot.lock.read_retry(seq) == true);
+
+    if (index != i) {
+      /* note: overwritten while reading */
+      eca_engine_trace_lost++;
+      continue;
+    }
+
+    long int busy = eca_engine_trace_ns(rec.start, rec.end) - rec.wait_ns;
+    string line = "cycle=" + kvu_numtostr(rec.cycle) +
+      " start=" + kvu_numtostr(kvu_timespec_seconds(&rec.start), 6) +
+      " end=" + kvu_numtostr(kvu_timespec_seconds(&rec.end), 6) +
+      " busy=" + eca_engine_trace_usecs(busy);
+    for(int n = 0; n < stage_count; n++)
+      line += string(" ") + eca_engine_trace_stage_names[n] + "=" +
+	eca_engine_trace_usecs(rec.stage_ns[n]);
+    line += " wait=" + eca_engine_trace_usecs(rec.wait_ns) +
+      " period=" + eca_engine_trace_usecs(rec.period_ns) +
+      " overrun=" + (busy > rec.period_ns ? "1" : "0");
+    result.push_back(line);
+  }
+  eca_engine_trace_read_index = end;
+
+  return result;
+}
+
+/**
+ * Returns a histogram of cycle load (busy time relative
+ * to the period), and average and maximum time per
+ * stage and waiting for realtime devices, for all 
+ * cycles since the engine was created.
+ */
+std::string ECA_ENGINE_TRACE::histogram(void)
+{
+  ECA_ENGINE_TRACE_STATS stats;
+  unsigned int seq;
+  do {
+    seq = eca_engine_trace_stats_lock.read_begin();
+    stats = eca_engine_trace_stats;
+  }
+  while(eca_engine_trace_stats_lock.read_retry(seq) == true);
+
+  if (enabled_rep != true && stats.cycles == 0)
+    return "engine-trace disabled";
+
+  long int lost;
+  {
+    KVU_GUARD_LOCK guard(&eca_engine_trace_read_lock);
+    lost = eca_engine_trace_lost;
+  }
+
+  string result = "cycles " + kvu_numtostr(stats.cycles) +
+    ", overruns " + kvu_numtostr(stats.overruns) +
+    ", period " + eca_engine_trace_usecs(stats.period_ns) + "us" +
+    ", max busy " + eca_engine_trace_usecs(stats.busy_max_ns) + "us" +
+    ", lost records " + kvu_numtostr(lost);
+  for(int n = 0; n < eca_engine_trace_bins; n++)
+    result += string("\nload ") + eca_engine_trace_bin_names[n] + ": " + kvu_numtostr(stats.bins[n]);
+  for(int n = 0; n < stage_count; n++)
+    result += string("\nstage ") + eca_engine_trace_stage_names[n] +
+      ": avg " + eca_engine_trace_usecs(stats.cycles > 0 ? stats.stage_total_ns[n] / stats.cycles : 0.0) +
+      "us, max " + eca_engine_trace_usecs(stats.stage_max_ns[n]) + "us";
+  result += "\nwait: avg " + 
+    eca_engine_trace_usecs(stats.cycles > 0 ? stats.wait_total_ns / stats.cycles : 0.0) +
+    "us, max " + eca_engine_trace_usecs(stats.wait_max_ns) + "us";
+
+  return result;
+}
+
+/**
+ * Returns the number of cycles since the engine was
+ * created.
+ */
+long int ECA_ENGINE_TRACE::cycle_count(void)
+{
+  unsigned int seq;
+  long int result;
+  do {
+    seq = eca_engine_trace_stats_lock.read_begin();
+    result = eca_engine_trace_stats.cycles;
+  }
+  while(eca_engine_trace_stats_lock.read_retry(seq) == true);
+  return result;
+}
+
+/**
+ * Returns the number of cycles, since the engine was
+ * created, that were busy longer than one period.
+ */
+long int ECA_ENGINE_TRACE::overrun_count(void)
+{
+  unsigned int seq;
+  long int result;
+  do {
+    seq = eca_engine_trace_stats_lock.read_begin();
+    result = eca_engine_trace_stats.overruns;
+  }
+  while(eca_engine_trace_stats_lock.read_retry(seq) == true);
+  return result;
+}
@@ -0,0 +1,99 @@
+#ifndef INCLUDED_ECA_ENGINE_TRACE_H
+#define INCLUDED_ECA_ENGINE_TRACE_H
+
+#include <string>
+#include <vector>
+
+/**
+ * Per-cycle timing telemetry of the engine loop.
+ *
+ * For each engine iteration, the start and end times
+ * are recorded together with the time spent in each
+ * stage of the iteration:
+ *     - control: position and state handling
+ *     - inputs:  inputs_to_chains(), including device reads
+ *     - chains:  process_chains()
+ *     - mix:     mix_to_outputs(), excluding device writes
+ *     - writes:  writes to output objects
+ *
+ * Time spent blocking on realtime devices is recorded
+ * separately as 'wait', and is not included in the
+ * stage that was running.
+ *
+ * Records are stored into a fixed-size lock-free ring,
+ * which can be read with raw_trace() (ECI
+ * 'engine-trace-get'). If the ring is not read often
+ * enough, the oldest records are overwritten. A load
+ * histogram covering all cycles since the engine was
+ * created is returned by histogram() (ECI
+ * 'engine-trace-histogram').
+ *
+ * A cycle overruns if it is busy longer than one
+ * period (buffersize / sample rate). Time spent
+ * blocking on realtime devices, which pace the engine,
+ * is not counted as busy time.
+ *
+ * Recording functions may only be called from the
+ * engine thread, and are realtime-safe. Reading
+ * functions are thread-safe, but not realtime-safe.
+ *
+ * Enabled with set_enabled() (ecasoundrc option
+ * 'engine-trace').
+ *
+ * @author agent
+ */
+class ECA_ENGINE_TRACE {
+
+ public:
+
+  enum Stage {
+    stage_control = 0,
+    stage_inputs,
+    stage_chains,
+    stage_mix,
+    stage_writes,
+    stage_count
+  };
+
+  /** @name Configuration */
+  /*@{*/
+
+  static void set_enabled(bool value);
+  static bool enabled(void) { return enabled_rep; }
+  static void reset(long int period_ns);
+  static const char* stage_name(int stage);
+
+  /*@}*/
+
+  /** @name Recording */
+  /*@{*/
+
+  static void cycle_start(void);
+  static void mark(Stage stage);
+  static void wait_start(void);
+  static void wait_stop(void);
+  static void cycle_end(void);
+
+  /*@}*/
+
+  /** @name Reading */
+  /*@{*/
+
+  static std::vector<std::string> raw_trace(void);
+  static std::string histogram(void);
+  static long int cycle_count(void);
+  static long int overrun_count(void);
+
+  /*@}*/
+
+ private:
+
+  static bool enabled_rep;
+
+  ECA_ENGINE_TRACE(void);
+  ECA_ENGINE_TRACE(const ECA_ENGINE_TRACE&);
+  ECA_ENGINE_TRACE& operator=(const ECA_ENGINE_TRACE&);
+  ~ECA_ENGINE_TRACE(void);
+};
+
+#endif
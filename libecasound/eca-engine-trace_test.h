@@ -0,0 +1,170 @@
+// ------------------------------------------------------------------------
+// eca-engine-trace_test.h: Unit test for ECA_ENGINE_TRACE
+// Copyright (C) 2026 agent
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
+// ------------------------------------------------------------------------
+
+#include <cstdio>
+#include <cstdlib> /* atof(), atol() */
+#include <string>
+#include <vector>
+
+#include <kvu_utils.h> /* kvu_sleep() */
+
+#include "eca-control.h"
+#include "eca-engine-trace.h"
+#include "eca-session.h"
+#include "eca-test-case.h"
+
+using namespace std;
+
+/**
+ * Unit test for ECA_ENGINE_TRACE
+ */
+class ECA_ENGINE_TRACE_TEST : public ECA_TEST_CASE {
+
+protected:
+
+  virtual string do_name(void) const { return("ECA_ENGINE_TRACE"); }
+  virtual void do_run(void);
+
+public:
+
+  virtual ~ECA_ENGINE_TRACE_TEST(void) { }
+
+private:
+
+  void run_cycle(long int busy_ns, long int wait_ns);
+  long int lost_records(void) const;
+};
+
+/**
+ * Returns the lost record count from the histogram.
+ */
+long int ECA_ENGINE_TRACE_TEST::lost_records(void) const
+{
+  string hist = ECA_ENGINE_TRACE::histogram();
+  size_t pos = hist.find("lost records ");
+  if (pos == string::npos)
+    return -1;
+  return std::atol(hist.c_str() + pos + 13);
+}
+
+/**
+ * Records one cycle that spends 'busy_ns' processing
+ * chains and 'wait_ns' waiting for a device.
+ */
+void ECA_ENGINE_TRACE_TEST::run_cycle(long int busy_ns, long int wait_ns)
+{
+  ECA_ENGINE_TRACE::cycle_start();
+  ECA_ENGINE_TRACE::mark(ECA_ENGINE_TRACE::stage_control);
+  ECA_ENGINE_TRACE::mark(ECA_ENGINE_TRACE::stage_inputs);
+  if (busy_ns > 0)
+    kvu_sleep(0, busy_ns);
+  ECA_ENGINE_TRACE::mark(ECA_ENGINE_TRACE::stage_chains);
+  ECA_ENGINE_TRACE::mark(ECA_ENGINE_TRACE::stage_mix);
+  ECA_ENGINE_TRACE::wait_start();
+  if (wait_ns > 0)
+    kvu_sleep(0, wait_ns);
+  ECA_ENGINE_TRACE::wait_stop();
+  ECA_ENGINE_TRACE::mark(ECA_ENGINE_TRACE::stage_writes);
+  ECA_ENGINE_TRACE::cycle_end();
+}
+
+void ECA_ENGINE_TRACE_TEST::do_run(void)
+{
+  std::fprintf(stdout, "%s: tests for %s class\n",
+	       name().c_str(), __FILE__);
+
+  /* note: drain records left by earlier tests */
+  ECA_ENGINE_TRACE::raw_trace();
+
+  /* case: overruns are detected, waiting is not busy time */
+  {
+    ECA_ENGINE_TRACE::reset(5000000); /* 5ms */
+    run_cycle(0, 0);
+    run_cycle(0, 0);
+    run_cycle(15000000, 0);
+    run_cycle(0, 15000000);
+
+    if (ECA_ENGINE_TRACE::cycle_count() != 4)
+      ECA_TEST_FAILURE("wrong cycle count");
+    if (ECA_ENGINE_TRACE::overrun_count() != 1)
+      ECA_TEST_FAILURE("wrong overrun count");
+
+    vector<string> trace = ECA_ENGINE_TRACE::raw_trace();
+    if (trace.size() != 4)
+      ECA_TEST_FAILURE("wrong number of records");
+    else {
+      if (trace[2].find("cycle=2 ") != 0 ||
+	  trace[2].find(" overrun=1") == string::npos)
+	ECA_TEST_FAILURE("overrun not recorded: " + trace[2]);
+      if (trace[3].find(" overrun=0") == string::npos ||
+	  trace[3].find(" period=5000.0 ") == string::npos)
+	ECA_TEST_FAILURE("wait counted as busy: " + trace[3]);
+      size_t pos = trace[3].find(" writes=");
+      if (pos == string::npos ||
+	  std::atof(trace[3].c_str() + pos + 8) > 5000.0)
+	ECA_TEST_FAILURE("wait counted in stage: " + trace[3]);
+    }
+    if (ECA_ENGINE_TRACE::raw_trace().size() != 0)
+      ECA_TEST_FAILURE("records returned twice");
+
+    string hist = ECA_ENGINE_TRACE::histogram();
+    if (hist.find("\nload 0-10%: 3\n") == string::npos ||
+	hist.find("\nload >200%: 1\n") == string::npos)
+      ECA_TEST_FAILURE("histogram: " + hist);
+    if (hist.find("\nwait: avg ") == string::npos)
+      ECA_TEST_FAILURE("no wait in histogram: " + hist);
+  }
+
+  /* case: the oldest records are overwritten */
+  {
+    long int lost = lost_records();
+    for(int n = 0; n < 1100; n++)
+      run_cycle(0, 0);
+
+    vector<string> trace = ECA_ENGINE_TRACE::raw_trace();
+    if (trace.size() != 1024 ||
+	trace[0].find("cycle=80 ") != 0)
+      ECA_TEST_FAILURE("ring not wrapped");
+    if (lost_records() != lost + 76)
+      ECA_TEST_FAILURE("lost records not reported");
+  }
+
+  /* case: engine iterations are recorded */
+  {
+    ECA_SESSION esession;
+    ECA_CONTROL ectrl (&esession);
+
+    ectrl.add_chainsetup("default");
+    ectrl.add_chain("default");
+    ectrl.add_audio_input("null");
+    ectrl.add_audio_output("null");
+    ectrl.add_chain_operator("-ea:100");
+    ectrl.connect_chainsetup(0);
+    ectrl.start();
+    kvu_sleep(0, 50000000); /* 50ms */
+    ectrl.stop_on_condition();
+    ectrl.disconnect_chainsetup();
+
+    vector<string> trace = ECA_ENGINE_TRACE::raw_trace();
+    if (trace.size() == 0 ||
+	ECA_ENGINE_TRACE::cycle_count() < static_cast<long int>(trace.size()) ||
+	trace.back().find(" writes=") == string::npos)
+      ECA_TEST_FAILURE("engine iterations not recorded");
+  }
+}
@@ -2,6 +2,7 @@
 // eca-engine.cpp: Main processing engine
 // Copyright (C) 1999-2009,2012,2015 Kai Vehmanen
 // Copyright (C) 2005 Stuart Allie
+// Copyright (C) 2026 agent
 //
 // Attributes:
 //     eca-style-version: 3 (see Ecasound Programmer's Guide)
@@ -21,6 +22,7 @@
 // Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
 // ------------------------------------------------------------------------
 
+#include <algorithm>
 #include <iostream>
 #include <string>
 #include <vector>
@@ -39,6 +41,7 @@
 #include <kvu_procedure_timer.h>
 #include <kvu_rtcaps.h>
 #include <kvu_threads.h>
+#include <kvu_utils.h> /* kvu_sleep() */
 
 #include "samplebuffer.h"
 #include "audioio.h"
@@ -50,9 +53,15 @@
 #include "audioio-mp3.h"
 #include "midi-server.h"
 #include "eca-chain.h"
+#include "eca-chain-delay.h"
 #include "eca-chainop.h"
 #include "eca-error.h"
 #include "eca-logger.h"
+#include "eca-thread-affinity.h"
+#include "eca-engine-trace.h"
+#include "eca-rt-checker.h"
+#include "eca-rt-memory.h"
+#include "eca-trace-recorder.h"
 #include "eca-chainsetup-edit.h"
 #include "eca-engine.h"
 #include "eca-engine_impl.h"
@@ -208,6 +217,8 @@ ECA_ENGINE::ECA_ENGINE(ECA_CHAINSETUP* csetup)
   init_connection_to_chainsetup();
 
   PROFILE_ENGINE_STATEMENT(init_profiling());
+  ECA_ENGINE_TRACE::reset(static_cast<long int>(1000000000.0 * buffersize() /
+						csetup_repp->samples_per_second()));
 
   csetup_repp->toggle_locked_state(false);
 
@@ -238,10 +249,19 @@ ECA_ENGINE::~ECA_ENGINE(void)
     driver_repp = 0;
   }
 
+  reclaim_graphs(true);
+  for(size_t n = 0; n < impl_repp->spare_slots_rep.size(); n++) {
+    delete impl_repp->spare_slots_rep[n];
+  }
+
   for(size_t n = 0; n < cslots_rep.size(); n++) {
     delete cslots_rep[n];
   }
 
+  for(size_t n = 0; n < chain_delays_rep.size(); n++) {
+    delete chain_delays_rep[n];
+  }
+
   delete mixslot_repp;
   delete impl_repp;
 
@@ -352,9 +372,255 @@ void ECA_ENGINE::command(Engine_command_t cmd, double arg)
  */
 void ECA_ENGINE::command(complex_command_t ccmd)
 {
+  if (ccmd.type == ep_exec_edit)
+    __sync_fetch_and_add(&impl_repp->queued_edits_rep, 1);
   impl_repp->command_queue_rep.push_back(ccmd);
 }
 
+/**
+ * Replaces the processed chains with 'chains', without
+ * stopping the engine. Chains of the current graph that
+ * are in 'chains' are kept as is, and the ones not in it
+ * are removed. Other chains in 'chains' are added. If 
+ * 'replaces[n]' is not -1, 'chains[n]' is a copy of the 
+ * chain at index 'replaces[n]' (see CHAIN::copy_for_edit()),
+ * which it replaces. Ownership of added chains is 
+ * transferred to the chainsetup, unless false is returned.
+ *
+ * The new graph, with its buffers, delay lines and 
+ * connection caches, is prepared and added chains are
+ * initialized in the calling thread, so that all memory
+ * allocation is done here. The engine thread then adopts
+ * the graph when it next processes its command queue.
+ * If the engine is running and hot-swap crossfading is
+ * enabled (see ECA_CHAINSETUP::hot_swap_crossfade()), 
+ * removed chains are processed for one more iteration, 
+ * during which they are crossfaded with added chains.
+ *
+ * The function waits until the graph has been adopted. 
+ * If the engine does not pick it up within one second, 
+ * the change is cancelled and false is returned. Removed
+ * objects are deleted, and their buffers kept for reuse, 
+ * on later calls and when the engine is destroyed.
+ *
+ * context: C-level-0
+ *          must no be called from exec() context
+ *
+ * @pre all chains are connected to an input and an output
+ * @return false if previous graph has not been adopted yet,
+ *         or the change was cancelled
+ */
+bool ECA_ENGINE::replace_chains(const std::vector<CHAIN*>& chains, const std::vector<int>& replaces)
+{
+  // --
+  DBC_REQUIRE(chains.size() > 0);
+  DBC_REQUIRE(chains.size() == replaces.size());
+  // --
+
+  reclaim_graphs(false);
+  if (impl_repp->graphs_rep.size() > 0) {
+    ECA_LOG_MSG(ECA_LOGGER::info, 
+		"WARNING: Previous chain graph not yet adopted by the engine.");
+    return false;
+  }
+
+  const std::vector<CHAIN*>& current = *chains_repp;
+  ECA_ENGINE_GRAPH* graph = new ECA_ENGINE_GRAPH();
+  graph->chains = chains;
+  graph->replaces = replaces;
+  graph->chain_count = chains.size();
+  graph->applied = 0;
+  graph->state = ECA_ENGINE_GRAPH::state_pending;
+
+  graph->final_input_chain_count.resize(inputs_repp->size(), 0);
+  graph->final_output_chain_count.resize(outputs_repp->size(), 0);
+  for(size_t n = 0; n < chains.size(); n++) {
+    ++graph->final_input_chain_count[chains[n]->connected_input()];
+    ++graph->final_output_chain_count[chains[n]->connected_output()];
+  }
+
+  /* step: kept chains keep their buffers, and copies take 
+   *       over the buffer and delay line of the chain they 
+   *       replace */
+  std::vector<bool> added (chains.size(), false);
+  std::vector<bool> replaced (current.size(), false);
+  std::vector<bool> delay_used (current.size(), false);
+  for(size_t n = 0; n < chains.size(); n++) {
+    int output = chains[n]->connected_output();
+    int old = replaces[n];
+    std::vector<CHAIN*>::const_iterator p = 
+      std::find(current.begin(), current.end(), chains[n]);
+
+    if (p != current.end()) {
+      old = p - current.begin();
+      graph->slots.push_back(cslots_rep[old]);
+    }
+    else if (old >= 0) {
+      /* note: operators the copy shares with the replaced 
+       *       chain are bound to its buffer, and keep their 
+       *       state, so the copy is swapped in without a 
+       *       crossfade (see CHAIN::copy_for_edit()); only 
+       *       operators new to the copy are initialized, 
+       *       and the buffer is not reallocated as its 
+       *       channels and float plane are reserved for 
+       *       max_channels() */
+      int inch = (*inputs_repp)[chains[n]->connected_input()]->channels();
+      int outch = (*outputs_repp)[output]->channels();
+      chains[n]->init(cslots_rep[old], inch, outch);
+
+      replaced[old] = true;
+      graph->slots.push_back(cslots_rep[old]);
+      graph->added_chains.push_back(chains[n]);
+    }
+    else {
+      SAMPLE_BUFFER* slot = 0;
+      if (impl_repp->spare_slots_rep.size() > 0) {
+	slot = impl_repp->spare_slots_rep.back();
+	impl_repp->spare_slots_rep.pop_back();
+	slot->event_tag_set(SAMPLE_BUFFER::tag_end_of_stream, false);
+      }
+      else {
+	slot = new SAMPLE_BUFFER(buffersize(), max_channels());
+	slot->float_plane_reserve(max_channels());
+	slot->event_tag_set(SAMPLE_BUFFER::tag_var_length, false);
+      }
+      slot->set_rt_lock(is_prepared());
+
+      int inch = (*inputs_repp)[chains[n]->connected_input()]->channels();
+      int outch = (*outputs_repp)[output]->channels();
+      chains[n]->init(slot, inch, outch);
+
+      added[n] = true;
+      graph->slots.push_back(slot);
+      graph->added_chains.push_back(chains[n]);
+      graph->added_slots.push_back(slot);
+    }
+
+    ECA_CHAIN_DELAY* delay = 0;
+    if (graph->final_output_chain_count[output] > 1) {
+      if (old >= 0 && chain_delays_rep[old] != 0 && delay_used[old] != true) {
+	delay = chain_delays_rep[old];
+	delay_used[old] = true;
+      }
+      else {
+	delay = new ECA_CHAIN_DELAY(max_channels(),
+				    csetup_repp->samples_per_second() * latency_compensation_max_secs);
+	graph->added_delays.push_back(delay);
+      }
+    }
+    graph->chain_delays.push_back(delay);
+    graph->chain_latency.push_back(old >= 0 ? chain_latency_rep[old] : 0);
+  }
+
+  std::vector<bool> removed (current.size(), false);
+  for(size_t k = 0; k < current.size(); k++) {
+    if (chain_delays_rep[k] != 0 && delay_used[k] != true)
+      graph->removed_delays.push_back(chain_delays_rep[k]);
+    if (replaced[k] == true) {
+      graph->removed_chains.push_back(current[k]);
+    }
+    else if (std::find(chains.begin(), chains.end(), current[k]) == chains.end()) {
+      removed[k] = true;
+      graph->removed_chains.push_back(current[k]);
+      graph->removed_slots.push_back(cslots_rep[k]);
+    }
+  }
+
+  graph->input_chain_count = graph->final_input_chain_count;
+  graph->output_chain_count = graph->final_output_chain_count;
+
+  /* step: for crossfading, append the removed chains, and
+   *       fade gains that move the output mix from the 
+   *       current graph to the new one; removed chains 
+   *       keep their delay lines until the fade is done */
+  if (csetup_repp->hot_swap_crossfade() == true &&
+      is_running() == true &&
+      (graph->added_chains.size() > 0 || graph->removed_chains.size() > 0)) {
+    for(size_t k = 0; k < current.size(); k++) {
+      if (removed[k] == true) {
+	graph->chains.push_back(current[k]);
+	graph->slots.push_back(cslots_rep[k]);
+	graph->chain_delays.push_back(chain_delays_rep[k]);
+	graph->chain_latency.push_back(chain_latency_rep[k]);
+	++graph->input_chain_count[current[k]->connected_input()];
+	++graph->output_chain_count[current[k]->connected_output()];
+      }
+    }
+
+    /* note: in 'avg' mix mode, chains are divided by the 
+     *       number of chains mixed to the output */
+    bool avg = (csetup_repp->mix_mode() == ECA_CHAINSETUP::cs_mmode_avg);
+    for(size_t n = 0; n < graph->chains.size(); n++) {
+      int output = graph->chains[n]->connected_output();
+      SAMPLE_SPECS::sample_t mixed = graph->output_chain_count[output];
+      SAMPLE_SPECS::sample_t from = 0, to = 0;
+      if (n >= graph->chain_count || added[n] != true)
+	from = (avg == true) ? mixed / output_chain_count_rep[output] : 1;
+      if (n < graph->chain_count)
+	to = (avg == true) ? mixed / graph->final_output_chain_count[output] : 1;
+      graph->fade_from.push_back(from);
+      graph->fade_to.push_back(to);
+    }
+  }
+
+  impl_repp->graphs_rep.push_back(graph);
+
+  ECA_ENGINE::complex_command_t item;
+  item.type = ep_exec_graph;
+  item.m.graph.graph = graph;
+  command(item);
+
+  /* note: wait until the graph is visible to following 
+   *       commands; if the engine does not pick it up in 
+   *       time, the graph is cancelled, so that the caller
+   *       keeps ownership of the chains */
+  for(int n = 0; n < 1000 && graph->state == ECA_ENGINE_GRAPH::state_pending; n++) {
+    kvu_sleep(0, 1000000);
+  }
+  if (__sync_bool_compare_and_swap(&graph->state,
+				   ECA_ENGINE_GRAPH::state_pending,
+				   ECA_ENGINE_GRAPH::state_cancelled) == true) {
+    ECA_LOG_MSG(ECA_LOGGER::info, 
+		"WARNING: Engine did not adopt chain graph within 1 second, change cancelled.");
+    return false;
+  }
+
+  /* note: once committed, the graph is applied at the 
+   *       latest when the crossfade, or processing, ends */
+  while(graph->applied == 0) {
+    kvu_sleep(0, 1000000);
+  }
+
+  reclaim_graphs(false);
+
+  return true;
+}
+
+/**
+ * Replaces the chain at index 'chain' (0...N-1) with 
+ * 'replacement', which is a copy of the chain created 
+ * with CHAIN::copy_for_edit(). Other chains are kept.
+ *
+ * context: C-level-0
+ *          must no be called from exec() context
+ *
+ * @see replace_chains()
+ */
+bool ECA_ENGINE::replace_chain(int chain, CHAIN* replacement)
+{
+  // --
+  DBC_REQUIRE(chain >= 0 && chain < static_cast<int>(chains_repp->size()));
+  DBC_REQUIRE(replacement != 0);
+  // --
+
+  std::vector<CHAIN*> chains (*chains_repp);
+  std::vector<int> replaces (chains.size(), -1);
+  chains[chain] = replacement;
+  replaces[chain] = chain;
+
+  return replace_chains(chains, replaces);
+}
+
 /**
  * Wait for a stop signal. Functions blocks until 
  * the signal is received or 'timeout' seconds
@@ -495,6 +761,13 @@ ECA_ENGINE::Engine_status_t ECA_ENGINE::status(void) const
  */
 void ECA_ENGINE::check_command_queue(void)
 {
+  /* note: a deferred edit is run before later commands */
+  if (impl_repp->edit_deferred_rep == true) {
+    const complex_command_t& item = impl_repp->deferred_edit_rep;
+    if ((item.type == ep_exec_graph ? exec_graph(item) : exec_edit(item)) != true)
+      return;
+  }
+
   while(impl_repp->command_queue_rep.is_empty() != true) {
     ECA_ENGINE::complex_command_t item;
     int popres = impl_repp->command_queue_rep.pop_front(&item);
@@ -515,6 +788,7 @@ void ECA_ENGINE::check_command_queue(void)
           // FIXME: is clear the right thing or should remaining cmds
           //        be still processed? OTOH, client app should know...
           impl_repp->command_queue_rep.clear();
+          impl_repp->queued_edits_rep = 0;
           ECA_LOG_MSG(ECA_LOGGER::system_objects,"ecasound_queue: exit!");
           driver_repp->exit();
           return;
@@ -525,10 +799,15 @@ void ECA_ENGINE::check_command_queue(void)
         // ---
       case ep_exec_edit:
         {
-          csetup_repp->execute_edit(item.cs);
-          if (item.cs.need_chain_reinit) {
-            reinit_chains(true);
-          }
+          if (exec_edit(item) != true)
+            return;
+          break;
+        }
+
+      case ep_exec_graph:
+        {
+          if (exec_graph(item) != true)
+            return;
           break;
         }
 
@@ -566,7 +845,72 @@ void ECA_ENGINE::check_command_queue(void)
  */
 void ECA_ENGINE::wait_for_commands(void)
 {
-  impl_repp->command_queue_rep.poll(5, 0);
+  if (impl_repp->edit_deferred_rep == true)
+    kvu_sleep(0, 1000000);
+  else
+    impl_repp->command_queue_rep.poll(5, 0);
+}
+
+/**
+ * Executes the chainsetup edit of 'item'. If an edit is
+ * being prepared outside the engine at the same time
+ * (see ECA_CHAINSETUP::prepare_edit()), the edit is
+ * deferred to the next check_command_queue().
+ *
+ * context: E-level-1
+ *
+ * @return false if the edit was deferred
+ */
+bool ECA_ENGINE::exec_edit(const complex_command_t& item)
+{
+  if (csetup_repp->try_execute_edit(item.cs) != true) {
+    impl_repp->deferred_edit_rep = item;
+    impl_repp->edit_deferred_rep = true;
+    return false;
+  }
+
+  impl_repp->edit_deferred_rep = false;
+  if (item.cs.need_chain_reinit) {
+    reinit_chains(true);
+  }
+  __sync_fetch_and_sub(&impl_repp->queued_edits_rep, 1);
+  return true;
+}
+
+/**
+ * Adopts the chain graph of 'item' (see commit_graph()).
+ * The chainsetup edit lock is held while the chains are
+ * swapped, and if it is taken by the control thread at 
+ * the same time, the graph is deferred like an edit 
+ * (see exec_edit()).
+ *
+ * context: E-level-1
+ *
+ * @return false if the graph was deferred
+ */
+bool ECA_ENGINE::exec_graph(const complex_command_t& item)
+{
+  if (csetup_repp->try_lock_edit() != true) {
+    impl_repp->deferred_edit_rep = item;
+    impl_repp->edit_deferred_rep = true;
+    return false;
+  }
+
+  impl_repp->edit_deferred_rep = false;
+  commit_graph(item.m.graph.graph);
+  csetup_repp->unlock_edit();
+  return true;
+}
+
+/**
+ * Whether edits sent to the engine with command() have
+ * not yet been executed.
+ *
+ * context: C-level-0
+ */
+bool ECA_ENGINE::has_queued_edits(void) const
+{
+  return impl_repp->queued_edits_rep > 0;
 }
 
 /**
@@ -646,13 +990,22 @@ void ECA_ENGINE::update_engine_state(void)
 void ECA_ENGINE::engine_iteration(void)
 {
   DBC_CHECK(is_running() == true);
+
+  ECA_RT_CHECKER_SCOPE rt_section;
+  ECA_TRACE_SCOPE trace_scope ("engine", "engine_iteration");
   
   PROFILE_ENGINE_STATEMENT(impl_repp->looptimer_rep.start(); impl_repp->looptimer_range_rep.start());
+
+  bool trace = ECA_ENGINE_TRACE::enabled();
+  if (trace == true) ECA_ENGINE_TRACE::cycle_start();
   
   inputs_not_finished_rep = 0;
   prehandle_control_position();
+  if (trace == true) ECA_ENGINE_TRACE::mark(ECA_ENGINE_TRACE::stage_control);
   inputs_to_chains();
+  if (trace == true) ECA_ENGINE_TRACE::mark(ECA_ENGINE_TRACE::stage_inputs);
   process_chains();
+  if (trace == true) ECA_ENGINE_TRACE::mark(ECA_ENGINE_TRACE::stage_chains);
   // FIXME: add support for sub-buffersize offsets
   if (preroll_samples_rep >= recording_offset_rep) {
     /* record material to non-real-time outputs */
@@ -663,7 +1016,12 @@ void ECA_ENGINE::engine_iteration(void)
     mix_to_outputs(true);
     preroll_samples_rep += buffersize();
   }
+  if (trace == true) ECA_ENGINE_TRACE::mark(ECA_ENGINE_TRACE::stage_mix);
   posthandle_control_position();
+  if (impl_repp->fading_graph_repp != 0)
+    finish_graph(impl_repp->fading_graph_repp);
+
+  if (trace == true) ECA_ENGINE_TRACE::cycle_end();
   
   PROFILE_ENGINE_STATEMENT(impl_repp->looptimer_rep.stop(); impl_repp->looptimer_range_rep.stop());
 }
@@ -688,6 +1046,129 @@ void ECA_ENGINE::reinit_chains(bool force)
   }
 }
 
+/**
+ * Adopts the chain graph prepared by replace_chains().
+ *
+ * context: E-level-1
+ *          realtime-safe
+ */
+void ECA_ENGINE::commit_graph(ECA_ENGINE_GRAPH* graph)
+{
+  if (__sync_bool_compare_and_swap(&graph->state,
+				   ECA_ENGINE_GRAPH::state_pending,
+				   ECA_ENGINE_GRAPH::state_committed) != true) {
+    /* note: cancelled by replace_chains() */
+    graph->state = ECA_ENGINE_GRAPH::state_discarded;
+    return;
+  }
+
+  for(size_t n = 0; n < graph->chain_count; n++) {
+    int old = graph->replaces[n];
+    if (old >= 0) {
+      graph->chains[n]->commit_edit((*chains_repp)[old]);
+      graph->slots[n]->event_tags_add(*cslots_rep[old]);
+    }
+  }
+
+  chains_repp->swap(graph->chains);
+  cslots_rep.swap(graph->slots);
+  chain_delays_rep.swap(graph->chain_delays);
+  chain_latency_rep.swap(graph->chain_latency);
+  input_chain_count_rep.swap(graph->input_chain_count);
+  output_chain_count_rep.swap(graph->output_chain_count);
+
+  if (graph->fade_from.size() > 0 && is_running() == true)
+    impl_repp->fading_graph_repp = graph;
+  else
+    finish_graph(graph);
+}
+
+/**
+ * Applies the fade gains of the graph being crossfaded
+ * to chain outputs.
+ *
+ * context: J-level-1
+ */
+void ECA_ENGINE::fade_graph_chains(void)
+{
+  const ECA_ENGINE_GRAPH* graph = impl_repp->fading_graph_repp;
+  for(size_t n = 0; n < cslots_rep.size(); n++) {
+    if (graph->fade_from[n] != 1 || graph->fade_to[n] != 1)
+      cslots_rep[n]->multiply_by_ramp(graph->fade_from[n], graph->fade_to[n]);
+  }
+}
+
+/**
+ * Drops the removed chains from an adopted graph, and 
+ * marks it applied.
+ *
+ * context: E-level-1, J-level-0
+ *          realtime-safe
+ */
+void ECA_ENGINE::finish_graph(ECA_ENGINE_GRAPH* graph)
+{
+  /* note: shrinking does not release the vector storage */
+  chains_repp->resize(graph->chain_count);
+  cslots_rep.resize(graph->chain_count);
+  chain_delays_rep.resize(graph->chain_count);
+  chain_latency_rep.resize(graph->chain_count);
+  input_chain_count_rep.swap(graph->final_input_chain_count);
+  output_chain_count_rep.swap(graph->final_output_chain_count);
+
+  impl_repp->fading_graph_repp = 0;
+  __sync_synchronize();
+  graph->applied = 1;
+}
+
+/**
+ * Deletes objects removed by chain graphs adopted by 
+ * the engine, and keeps their buffers for reuse. Added
+ * buffers and delay lines of cancelled graphs are 
+ * reclaimed once the engine has discarded the graph. If 
+ * 'all' is true, also graphs not yet adopted are 
+ * discarded.
+ *
+ * context: C-level-0
+ */
+void ECA_ENGINE::reclaim_graphs(bool all)
+{
+  std::list<ECA_ENGINE_GRAPH*>::iterator p = impl_repp->graphs_rep.begin();
+  while(p != impl_repp->graphs_rep.end()) {
+    ECA_ENGINE_GRAPH* graph = *p;
+    __sync_synchronize();
+    bool cancelled = (graph->state == ECA_ENGINE_GRAPH::state_cancelled ||
+		      graph->state == ECA_ENGINE_GRAPH::state_discarded);
+    if (graph->applied != 0 || 
+	graph->state == ECA_ENGINE_GRAPH::state_discarded ||
+	all == true) {
+      /* note: copies in an unadopted graph do not own the 
+       *       controllers they share with current chains */
+      bool applied = (graph->applied != 0);
+      const std::vector<CHAIN*>& chains = 
+	(applied == true) ? graph->removed_chains : graph->added_chains;
+      const std::vector<SAMPLE_BUFFER*>& slots = 
+	(applied == true) ? graph->removed_slots : graph->added_slots;
+      const std::vector<ECA_CHAIN_DELAY*>& delays = 
+	(applied == true) ? graph->removed_delays : graph->added_delays;
+
+      for(size_t n = 0; n < chains.size() && cancelled != true; n++) {
+	delete chains[n];
+      }
+      for(size_t n = 0; n < slots.size(); n++) {
+	slots[n]->set_rt_lock(false);
+	impl_repp->spare_slots_rep.push_back(slots[n]);
+      }
+      for(size_t n = 0; n < delays.size(); n++) {
+	delete delays[n];
+      }
+      delete graph;
+      p = impl_repp->graphs_rep.erase(p);
+    }
+    else
+      ++p;
+  }
+}
+
 /**
  * Prepares engine for operation. Prepares all 
  * realtime devices and starts servers.
@@ -735,6 +1216,14 @@ void ECA_ENGINE::prepare_operation(void)
    * still in preroll mode */
   preroll_samples_rep = buffersize(); 
 
+  /* 5. prefault and lock the realtime working set */
+  if (ECA_RT_MEMORY::enabled() == true) {
+    ECA_RT_MEMORY::lock();
+    ECA_RT_MEMORY::prefault_stack();
+    ECA_LOG_MSG(ECA_LOGGER::user_objects, 
+		"Realtime memory: " + ECA_RT_MEMORY::status() + ".");
+  }
+
   /* 6. enable rt-scheduling */
   if (csetup_repp->raised_priority() == true) {
     if (kvu_set_thread_scheduling(SCHED_FIFO, csetup_repp->get_sched_priority()) != 0)
@@ -745,7 +1234,10 @@ void ECA_ENGINE::prepare_operation(void)
                   + kvu_numtostr(csetup_repp->get_sched_priority()) + ").");
   }
 
-  /* 7. change engine to active and running */
+  /* 7. restrict the engine thread to its CPUs */
+  ECA_THREAD_AFFINITY::apply("engine", csetup_repp->thread_affinity("engine"));
+
+  /* 8. change engine to active and running */
   prepared_rep = true;
   init_engine_state();
   ECA_LOG_MSG(ECA_LOGGER::system_objects, "engine prepared");
@@ -781,6 +1273,9 @@ void ECA_ENGINE::start_operation(void)
 
   ECA_LOG_MSG(ECA_LOGGER::system_objects, "starting engine operation!");
 
+  if (ECA_RT_CHECKER::enabled() == true)
+    ECA_RT_CHECKER::clear();
+
   start_realtime_objects();
   running_rep = true;
 
@@ -824,12 +1319,31 @@ void ECA_ENGINE::stop_operation(bool drain)
 
   prepared_rep = false;
 
+  if (impl_repp->fading_graph_repp != 0)
+    finish_graph(impl_repp->fading_graph_repp);
+
   /* release samplebuffer rt-locks */
   for(size_t n = 0; n < cslots_rep.size(); n++) {
     cslots_rep[n]->set_rt_lock(false);
   }
   mixslot_repp->set_rt_lock(false);
 
+  /* unlock the realtime memory arena */
+  if (ECA_RT_MEMORY::is_locked() == true) {
+    ECA_RT_MEMORY::unlock();
+  }
+
+  /* output messages issued by the engine while running */
+  ECA_LOGGER::instance().flush();
+
+  /* report allocations and blocking calls made while running */
+  if (ECA_RT_CHECKER::enabled() == true &&
+      ECA_RT_CHECKER::violation_count() > 0) {
+    ECA_LOG_MSG(ECA_LOGGER::info, 
+		"WARNING: Realtime checker: " + ECA_RT_CHECKER::report());
+    ECA_RT_CHECKER::clear();
+  }
+
   stop_servers();
   stop_forked_objects();
 
@@ -1274,7 +1788,7 @@ void ECA_ENGINE::posthandle_control_position(void)
   if (csetup_repp->max_length_set() == true &&
       csetup_repp->is_over_max_length() == true) {
     if (csetup_repp->looping_enabled() == true) {
-      ECA_LOG_MSG(ECA_LOGGER::system_objects,"loop point reached");
+      ECA_LOG_RT_MSG(ECA_LOGGER::system_objects, "loop point reached");
       inputs_not_finished_rep = 1;
       csetup_repp->seek_position_in_samples(0);
       for(unsigned int adev_sizet = 0; adev_sizet < non_realtime_inputs_rep.size(); adev_sizet++) {
@@ -1282,7 +1796,7 @@ void ECA_ENGINE::posthandle_control_position(void)
       }
     }
     else {
-      ECA_LOG_MSG(ECA_LOGGER::system_objects,"posthandle_c_p over_max - stop");
+      ECA_LOG_RT_MSG(ECA_LOGGER::system_objects, "posthandle_c_p over_max - stop");
       if (status() == ECA_ENGINE::engine_status_running ||
           status() == ECA_ENGINE::engine_status_finished) {
         command(ECA_ENGINE::ep_stop_with_drain, 0.0f);
@@ -1304,6 +1818,9 @@ void ECA_ENGINE::init_variables(void)
   use_midi_rep = false;
   batchmode_enabled_rep = false;
   driver_local = false;
+  impl_repp->fading_graph_repp = 0;
+  impl_repp->edit_deferred_rep = false;
+  impl_repp->queued_edits_rep = 0;
 
   pthread_cond_init(&impl_repp->ecasound_stop_cond_repp, NULL);
   pthread_mutex_init(&impl_repp->ecasound_stop_mutex_repp, NULL);
@@ -1388,9 +1905,13 @@ void ECA_ENGINE::init_chains(void)
   mixslot_repp->event_tag_set(SAMPLE_BUFFER::tag_mixed_content);
   mixslot_repp->event_tag_set(SAMPLE_BUFFER::tag_var_length, false);
 
+  /* note: the float plane is reserved up front, so that
+   *       chain copies initialized against a slot in use
+   *       do not reallocate it, see replace_chains() */
   cslots_rep.resize(chains_repp->size());
   for(size_t n = 0; n < cslots_rep.size(); n++) {
     cslots_rep[n] = new SAMPLE_BUFFER(buffersize(), max_channels());
+    cslots_rep[n]->float_plane_reserve(max_channels());
     cslots_rep[n]->event_tag_set(SAMPLE_BUFFER::tag_var_length, false);
   }
 
@@ -1409,6 +1930,9 @@ void ECA_ENGINE::init_chains(void)
  */
 void ECA_ENGINE::cleanup(void)
 {
+  if (impl_repp->fading_graph_repp != 0)
+    finish_graph(impl_repp->fading_graph_repp);
+
   if (csetup_repp != 0) {
     csetup_repp->toggle_locked_state(true);
     vector<CHAIN*>::iterator q = csetup_repp->chains.begin();
@@ -1446,6 +1970,31 @@ void ECA_ENGINE::update_cache_chain_connections(void)
     output_chain_count_rep[n] =
       csetup_repp->number_of_attached_chains_to_output(csetup_repp->outputs[n]);
   }
+
+  /* note: delay lines are only needed for chains that
+   *       are mixed with other chains */
+  for(size_t n = 0; n < chain_delays_rep.size(); n++) {
+    delete chain_delays_rep[n];
+  }
+  chain_delays_rep.resize(chains_repp->size());
+  chain_latency_rep.resize(chains_repp->size());
+  output_latency_rep.resize(outputs_repp->size());
+  int delays = 0;
+  for(size_t n = 0; n < chains_repp->size(); n++) {
+    int output = (*chains_repp)[n]->connected_output();
+    chain_delays_rep[n] = 0;
+    chain_latency_rep[n] = 0;
+    if (output >= 0 && output_chain_count_rep[output] > 1) {
+      chain_delays_rep[n] =
+        new ECA_CHAIN_DELAY(max_channels(),
+                            csetup_repp->samples_per_second() * latency_compensation_max_secs);
+      ++delays;
+    }
+  }
+  if (delays > 0)
+    ECA_LOG_MSG(ECA_LOGGER::system_objects,
+                "Latency compensation enabled for " +
+                kvu_numtostr(delays) + " chains.");
 }
 
 /**
@@ -1605,6 +2154,46 @@ void ECA_ENGINE::dump_profile_info(void)
  * Engine implementation - Private functions for signal routing
  **********************************************************************/
 
+/**
+ * Realtime devices block until the device is ready, as
+ * they pace the engine, so their I/O is excluded from
+ * realtime checking, and traced as waiting instead of
+ * busy time.
+ */
+static void eca_engine_read_buffer(AUDIO_IO* obj, SAMPLE_BUFFER* sbuf)
+{
+  if ((ECA_RT_CHECKER::enabled() == true ||
+       ECA_ENGINE_TRACE::enabled() == true) &&
+      AUDIO_IO_DEVICE::is_realtime_object(obj) == true) {
+    ECA_RT_CHECKER_PAUSE rt_pause;
+    if (ECA_ENGINE_TRACE::enabled() == true) ECA_ENGINE_TRACE::wait_start();
+    obj->read_buffer(sbuf);
+    if (ECA_ENGINE_TRACE::enabled() == true) ECA_ENGINE_TRACE::wait_stop();
+  }
+  else
+    obj->read_buffer(sbuf);
+}
+
+static void eca_engine_write_buffer(AUDIO_IO* obj, SAMPLE_BUFFER* sbuf)
+{
+  if (ECA_ENGINE_TRACE::enabled() == true)
+    ECA_ENGINE_TRACE::mark(ECA_ENGINE_TRACE::stage_mix);
+
+  if ((ECA_RT_CHECKER::enabled() == true ||
+       ECA_ENGINE_TRACE::enabled() == true) &&
+      AUDIO_IO_DEVICE::is_realtime_object(obj) == true) {
+    ECA_RT_CHECKER_PAUSE rt_pause;
+    if (ECA_ENGINE_TRACE::enabled() == true) ECA_ENGINE_TRACE::wait_start();
+    obj->write_buffer(sbuf);
+    if (ECA_ENGINE_TRACE::enabled() == true) ECA_ENGINE_TRACE::wait_stop();
+  }
+  else
+    obj->write_buffer(sbuf);
+
+  if (ECA_ENGINE_TRACE::enabled() == true)
+    ECA_ENGINE_TRACE::mark(ECA_ENGINE_TRACE::stage_writes);
+}
+
 /**
  * Reads audio data from input objects.
  *
@@ -1612,6 +2201,8 @@ void ECA_ENGINE::dump_profile_info(void)
  */
 void ECA_ENGINE::inputs_to_chains(void)
 {
+  ECA_TRACE_SCOPE trace_scope ("engine", "inputs_to_chains");
+
   /**
    * - go through all inputs
    * - depending on connectivity, read either to a mixdown slot, or 
@@ -1628,7 +2219,7 @@ void ECA_ENGINE::inputs_to_chains(void)
       mixslot_repp->length_in_samples(buffersize());
 
       if ((*inputs_repp)[inputnum]->finished() != true) {
-        (*inputs_repp)[inputnum]->read_buffer(mixslot_repp);
+        eca_engine_read_buffer((*inputs_repp)[inputnum], mixslot_repp);
         if ((*inputs_repp)[inputnum]->finished() != true) {
           inputs_not_finished_rep++;
         }
@@ -1645,7 +2236,7 @@ void ECA_ENGINE::inputs_to_chains(void)
           cslots_rep[c]->length_in_samples(buffersize());
 
           if ((*inputs_repp)[inputnum]->finished() != true) {
-            (*inputs_repp)[inputnum]->read_buffer(cslots_rep[c]);
+            eca_engine_read_buffer((*inputs_repp)[inputnum], cslots_rep[c]);
             if ((*inputs_repp)[inputnum]->finished() != true) {
               inputs_not_finished_rep++;
             }
@@ -1669,11 +2260,43 @@ void ECA_ENGINE::inputs_to_chains(void)
   }
 }
 
+/**
+ * Returns the number of chains processed on each 
+ * engine iteration.
+ */
+int ECA_ENGINE::chain_count(void) const
+{
+  return static_cast<int>(chains_repp->size());
+}
+
+/**
+ * Processes chain 'chain' for the current iteration.
+ * Chains do not share state during processing, so 
+ * different chains may be processed concurrently 
+ * from multiple threads.
+ *
+ * context: J-level-2, called from 
+ *          ECA_ENGINE_DRIVER::process_chains()
+ *
+ * @pre chain >= 0 && chain < chain_count()
+ */
+void ECA_ENGINE::process_chain(int chain)
+{
+  ECA_RT_CHECKER_SCOPE rt_section;
+  (*chains_repp)[chain]->process();
+}
+
 /**
  * context: J-level-1
  */
 void ECA_ENGINE::process_chains(void)
 {
+  ECA_TRACE_SCOPE trace_scope ("engine", "process_chains");
+
+  if (driver_repp != 0 &&
+      driver_repp->process_chains(this) == true) 
+    return;
+
   vector<CHAIN*>::const_iterator p = chains_repp->begin();
   while(p != chains_repp->end()) {
     (*p)->process();
@@ -1715,19 +2338,29 @@ void mix_to_outputs_sum_helper(const SAMPLE_BUFFER *from, SAMPLE_BUFFER *to, boo
  */
 void ECA_ENGINE::mix_to_outputs(bool skip_realtime_target_outputs)
 {
+  ECA_TRACE_SCOPE trace_scope ("engine", "mix_to_outputs");
+
+  compensate_chain_latencies();
+
+  /* note: faded after the delay lines, so that the ramps 
+   *       line up with the latency-compensated output */
+  if (impl_repp->fading_graph_repp != 0) 
+    fade_graph_chains();
+
   for(size_t outputnum = 0; outputnum < outputs_repp->size(); outputnum++) {
     if (skip_realtime_target_outputs == true) {
       if (csetup_repp->is_realtime_target_output(outputnum) == true) {
-        ECA_LOG_MSG(ECA_LOGGER::system_objects,
-                    "Skipping rt-target output " +
-                    (*outputs_repp)[outputnum]->label() + ".");
+        ECA_LOG_RT_MSG(ECA_LOGGER::system_objects,
+                       "Skipping rt-target output %s.",
+                       (*outputs_repp)[outputnum]->label());
         continue;
       }
     }
 
     int count = 0;
 
-    /* FIXME: number_of_channels() may end up allocating memory! */
+    /* note: does not allocate, as mixslot is reserved for
+     *       max_channels() in init_chains() */
     mixslot_repp->number_of_channels((*outputs_repp)[outputnum]->channels());
     
     for(size_t n = 0; n != chains_repp->size(); n++) {
@@ -1750,7 +2383,7 @@ void ECA_ENGINE::mix_to_outputs(bool skip_realtime_target_outputs)
           // there's only one output connected to this chain,
           // so we don't need to mix anything
           // --
-          (*outputs_repp)[outputnum]->write_buffer(cslots_rep[n]);
+          eca_engine_write_buffer((*outputs_repp)[outputnum], cslots_rep[n]);
           if ((*outputs_repp)[outputnum]->finished() == true) 
             /* note: loop devices always connected both as inputs as
              *       outputs, so their finished status must not be
@@ -1770,7 +2403,7 @@ void ECA_ENGINE::mix_to_outputs(bool skip_realtime_target_outputs)
           mixslot_repp->event_tags_add(*cslots_rep[n]);
 
           if (count == output_chain_count_rep[outputnum]) {
-            (*outputs_repp)[outputnum]->write_buffer(mixslot_repp);
+            eca_engine_write_buffer((*outputs_repp)[outputnum], mixslot_repp);
             if ((*outputs_repp)[outputnum]->finished() == true) 
               /* note: loop devices always connected both as inputs as
                *       outputs, so their finished status must not be
@@ -1784,6 +2417,54 @@ void ECA_ENGINE::mix_to_outputs(bool skip_realtime_target_outputs)
   } 
 }
 
+/**
+ * Delays chains that are mixed to the same output, so
+ * that all of them have the latency of the slowest 
+ * chain. Latencies are checked on every iteration, as
+ * operators may change their latency while running.
+ * Differences beyond latency_compensation_max_secs are
+ * truncated, and a warning is logged.
+ *
+ * context: J-level-1
+ */
+void ECA_ENGINE::compensate_chain_latencies(void)
+{
+  for(size_t n = 0; n < output_latency_rep.size(); n++) {
+    output_latency_rep[n] = 0;
+  }
+
+  for(size_t n = 0; n < chain_delays_rep.size(); n++) {
+    if (chain_delays_rep[n] == 0)
+      continue;
+
+    int output = (*chains_repp)[n]->connected_output();
+    if (output < 0)
+      continue;
+
+    chain_latency_rep[n] = (*chains_repp)[n]->latency();
+    if (chain_latency_rep[n] > output_latency_rep[output])
+      output_latency_rep[output] = chain_latency_rep[n];
+  }
+
+  for(size_t n = 0; n < chain_delays_rep.size(); n++) {
+    if (chain_delays_rep[n] == 0)
+      continue;
+
+    int output = (*chains_repp)[n]->connected_output();
+    if (output < 0)
+      continue;
+
+    long int delay = output_latency_rep[output] - chain_latency_rep[n];
+    if (delay > chain_delays_rep[n]->max_delay() &&
+        chain_delays_rep[n]->delay() != chain_delays_rep[n]->max_delay())
+      ECA_LOG_RT_MSG(ECA_LOGGER::info,
+                     "WARNING: latency difference of %d samples on chain %d exceeds the compensated maximum of %d samples",
+                     delay, static_cast<int>(n + 1), chain_delays_rep[n]->max_delay());
+    chain_delays_rep[n]->set_delay(delay);
+    chain_delays_rep[n]->process(cslots_rep[n]);
+  }
+}
+
 /**********************************************************************
  * Engine implementation - Obsolete functions
  **********************************************************************/
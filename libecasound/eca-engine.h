@@ -11,8 +11,10 @@ class AUDIO_IO_DB_CLIENT;
 class AUDIO_IO_DEVICE;
 class CHAIN;
 class CHAIN_OPERATOR;
+class ECA_CHAIN_DELAY;
 class ECA_CHAINSETUP;
 class ECA_ENGINE;
+class ECA_ENGINE_GRAPH;
 class ECA_ENGINE_impl;
 class SAMPLE_BUFFER;
 
@@ -93,6 +95,7 @@ class ECA_ENGINE {
     ep_exit,
     // --
     ep_exec_edit,
+    ep_exec_graph,
     // --
     ep_rewind,
     ep_forward,
@@ -116,6 +119,10 @@ class ECA_ENGINE {
 	double value;
       } legacy;
 
+      struct {
+	ECA_ENGINE_GRAPH* graph;
+      } graph;
+
     } m;
 
     ECA::chainsetup_edit_t cs;
@@ -133,6 +140,8 @@ class ECA_ENGINE {
   int exec(bool batch_mode);
   void command(Engine_command_t cmd, double arg);
   void command(complex_command_t ccmd);
+  bool replace_chains(const std::vector<CHAIN*>& chains, const std::vector<int>& replaces);
+  bool replace_chain(int chain, CHAIN* replacement);
   void wait_for_stop(int timeout);
   void wait_for_exit(int timeout);
 
@@ -143,6 +152,7 @@ class ECA_ENGINE {
 
   bool is_valid(void) const;
   bool is_finite_length(void) const;
+  bool has_queued_edits(void) const;
   Engine_status_t status(void) const;
 
   /*@}*/
@@ -152,6 +162,8 @@ class ECA_ENGINE {
 
   void check_command_queue(void);
   void wait_for_commands(void);
+  bool exec_edit(const complex_command_t& item);
+  bool exec_graph(const complex_command_t& item);
   void init_engine_state(void);
   void update_engine_state(void);
   void engine_iteration(void);
@@ -163,6 +175,9 @@ class ECA_ENGINE {
   void update_cache_chain_connections(void);
   void update_cache_latency_values(void);
 
+  int chain_count(void) const;
+  void process_chain(int chain);
+
   bool is_prepared(void) const;
   bool is_running(void) const;
   bool batch_mode(void) const { return(batchmode_enabled_rep); }
@@ -186,6 +201,12 @@ private:
   static const long int prefill_threshold_constant = 16348;
   static const int prefill_blocks_constant = 3;
 
+  /**
+   * Longest chain latency difference, in seconds, that
+   * is compensated when chains are mixed together.
+   */
+  static const int latency_compensation_max_secs = 1;
+
   ECA_ENGINE_impl* impl_repp;
 
   bool use_midi_rep;
@@ -254,6 +275,10 @@ private:
   std::vector<int> input_chain_count_rep;
   std::vector<int> output_chain_count_rep;
 
+  std::vector<ECA_CHAIN_DELAY*> chain_delays_rep;
+  std::vector<long int> chain_latency_rep;
+  std::vector<long int> output_latency_rep;
+
   /** @name Attribute functions */
   /*@{*/
 
@@ -320,6 +345,10 @@ private:
   void cleanup(void);
 
   void reinit_chains(bool force = false);
+  void commit_graph(ECA_ENGINE_GRAPH* graph);
+  void fade_graph_chains(void);
+  void finish_graph(ECA_ENGINE_GRAPH* graph);
+  void reclaim_graphs(bool all);
 
   void create_cache_object_lists(void);
 
@@ -334,6 +363,7 @@ private:
   void inputs_to_chains(void);
   void process_chains(void);
   void mix_to_outputs(bool skip_realtime_target_outputs);
+  void compensate_chain_latencies(void);
 
   /*@}*/
 
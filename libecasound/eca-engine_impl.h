@@ -2,6 +2,8 @@
 #define INCLUDED_ECA_ENGINE_IMPL_H
 
 #include <ctime>
+#include <list>
+#include <vector>
 #include <pthread.h>
 #include <unistd.h>
 #include <sys/time.h>
@@ -11,6 +13,70 @@
 
 #include "eca-chainsetup.h"
 
+class CHAIN;
+class ECA_CHAIN_DELAY;
+class SAMPLE_BUFFER;
+
+/**
+ * Chain graph prepared by ECA_ENGINE::replace_chains(). 
+ * Holds the chains to process, their buffers, and the
+ * connection and latency caches derived from them, so 
+ * that the engine thread can adopt the graph by swapping
+ * vectors, without allocating memory.
+ *
+ * When crossfading, the chains left out of the new graph
+ * follow the first 'chain_count' chains. They are 
+ * processed for one more iteration, during which their 
+ * output is faded out, and the output of new chains faded
+ * in. The graph is then truncated to 'chain_count' chains
+ * and the 'final_*' connection counts.
+ *
+ * Once 'applied' is set, the vectors hold the previous 
+ * graph, and the removed objects can be reclaimed outside
+ * the engine thread. If the graph is never applied, the
+ * added objects are reclaimed instead. 
+ *
+ * A graph not yet committed by the engine can be 
+ * cancelled by changing 'state' from state_pending to 
+ * state_cancelled. The engine then sets state_discarded 
+ * instead of committing it, after which its added 
+ * buffers and delay lines can be reclaimed. Ownership 
+ * of the added chains stays with the caller of 
+ * replace_chains().
+ */
+class ECA_ENGINE_GRAPH {
+
+ public:
+
+  std::vector<CHAIN*> chains;
+  std::vector<SAMPLE_BUFFER*> slots;
+  std::vector<ECA_CHAIN_DELAY*> chain_delays;
+  std::vector<long int> chain_latency;
+  std::vector<int> input_chain_count;
+  std::vector<int> output_chain_count;
+
+  /** index of the chain a copy replaces, or -1 */
+  std::vector<int> replaces;
+
+  size_t chain_count;
+  std::vector<int> final_input_chain_count;
+  std::vector<int> final_output_chain_count;
+  std::vector<SAMPLE_SPECS::sample_t> fade_from;
+  std::vector<SAMPLE_SPECS::sample_t> fade_to;
+
+  std::vector<CHAIN*> added_chains;
+  std::vector<CHAIN*> removed_chains;
+  std::vector<SAMPLE_BUFFER*> added_slots;
+  std::vector<SAMPLE_BUFFER*> removed_slots;
+  std::vector<ECA_CHAIN_DELAY*> added_delays;
+  std::vector<ECA_CHAIN_DELAY*> removed_delays;
+
+  enum { state_pending, state_committed, state_cancelled, state_discarded };
+
+  volatile int applied;
+  volatile int state;
+};
+
 /**
  * Private class used in ECA_ENGINE 
  * implementation.
@@ -29,6 +95,9 @@ class ECA_ENGINE_impl {
   double looptimer_high_rep;
 
   MESSAGE_QUEUE_RT_C<ECA_ENGINE::complex_command_t> command_queue_rep;
+  ECA_ENGINE::complex_command_t deferred_edit_rep;
+  bool edit_deferred_rep;
+  volatile int queued_edits_rep;
 
   pthread_cond_t editlock_cond_repp;
   pthread_mutex_t editlock_mutex_repp;
@@ -38,6 +107,10 @@ class ECA_ENGINE_impl {
   pthread_mutex_t ecasound_exit_mutex_repp;
 
   struct timeval multitrack_input_stamp_rep;
+
+  std::list<ECA_ENGINE_GRAPH*> graphs_rep;
+  ECA_ENGINE_GRAPH* fading_graph_repp;
+  std::vector<SAMPLE_BUFFER*> spare_slots_rep;
 };
 
 #endif /* INCLUDED_ECA_ENGINE_IMPL_H */
@@ -3,6 +3,7 @@
 //                        interactive mode commands.
 // Copyright (C) 1999-2005,2008,2012 Kai Vehmanen
 // Copyright (C) 2005 Stuart Allie
+// Copyright (C) 2026 agent
 //
 // Attributes:
 //     eca-style-version: 3 (see Ecasound Programmer's Guide)
@@ -111,6 +112,14 @@ void ECA_IAMODE_PARSER::register_commands_misc(void)
   (*cmd_map_repp)["engine-launch"] = ec_engine_launch;
   (*cmd_map_repp)["engine-halt"] = ec_engine_halt;
   (*cmd_map_repp)["engine-status"] = ec_engine_status;
+  (*cmd_map_repp)["engine-memory-status"] = ec_engine_memory_status;
+  (*cmd_map_repp)["engine-set-affinity"] = ec_engine_set_affinity;
+  (*cmd_map_repp)["engine-affinity-status"] = ec_engine_affinity_status;
+  (*cmd_map_repp)["engine-trace-get"] = ec_engine_trace_get;
+  (*cmd_map_repp)["engine-trace-histogram"] = ec_engine_trace_histogram;
+  (*cmd_map_repp)["trace-start"] = ec_trace_start;
+  (*cmd_map_repp)["trace-stop"] = ec_trace_stop;
+  (*cmd_map_repp)["trace-export"] = ec_trace_export;
 
   (*cmd_map_repp)["status"] = ec_cs_status;
   (*cmd_map_repp)["st"] = ec_cs_status;
@@ -359,6 +368,9 @@ bool ECA_IAMODE_PARSER::action_requires_params(int id)
   switch(id) {
   case ec_debug:
 
+  case ec_engine_set_affinity:
+  case ec_trace_export:
+
   case ec_cs_add:
   case ec_cs_select:
   case ec_cs_index_select:
@@ -589,6 +601,29 @@ bool ECA_IAMODE_PARSER::action_requires_selected_not_connected(int id)
 
 }
 
+/**
+ * Whether action, which otherwise requires that the
+ * chainsetup is not connected, can be performed while
+ * the engine is running (see ECA_ENGINE::replace_chains()).
+ */
+bool ECA_IAMODE_PARSER::action_supports_hot_swap(int id)
+{
+  switch(id) {
+  case ec_c_add:
+  case ec_c_remove:
+  case ec_c_clear:
+
+  case ec_cop_remove:
+  case ec_ctrl_remove:
+
+    return true;
+    
+  default: 
+    break;
+  }
+  return false;
+}
+
 bool ECA_IAMODE_PARSER::action_requires_selected_audio_input(int id)
 {
   switch(id) {
@@ -23,6 +23,7 @@ class ECA_IAMODE_PARSER : protected ECA_IAMODE_PARSER_COMMANDS {
   bool action_requires_params(int id);
   bool action_requires_connected(int id);
   bool action_requires_selected_not_connected(int id);
+  bool action_supports_hot_swap(int id);
   bool action_requires_selected(int id);
   bool action_requires_selected_audio_input(int id);
   bool action_requires_selected_audio_output(int id);
@@ -20,6 +20,14 @@ class ECA_IAMODE_PARSER_COMMANDS {
     ec_engine_status,
     ec_engine_launch,
     ec_engine_halt,
+    ec_engine_memory_status,
+    ec_engine_set_affinity,
+    ec_engine_affinity_status,
+    ec_engine_trace_get,
+    ec_engine_trace_histogram,
+    ec_trace_start,
+    ec_trace_stop,
+    ec_trace_export,
     // --
     ec_cs_add,
     ec_cs_remove,
@@ -1,6 +1,7 @@
 // ------------------------------------------------------------------------
 // eca-logger-interface.cpp: Logging subsystem interface
 // Copyright (C) 2002-2004,2009 Kai Vehmanen
+// Copyright (C) 2026 agent
 //
 // Attributes:
 //     eca-style-version: 3
@@ -29,6 +30,7 @@
 
 #include <cstdio>
 #include <cstdlib>
+#include <cstring> /* strncpy() */
 #include <ctime>
 
 #include <kvu_dbc.h>
@@ -44,14 +46,17 @@ const static int eca_l_i_default_extlog_level = ECA_LOGGER::errors | ECA_LOGGER:
 
 /**
  * Class constructor. Initializes log level to 'disabled'.
+ *
+ * @param external_log whether to write to the logfile
+ *        set with ECASOUND_LOGFILE
  */
-ECA_LOGGER_INTERFACE::ECA_LOGGER_INTERFACE(void) 
+ECA_LOGGER_INTERFACE::ECA_LOGGER_INTERFACE(bool external_log) 
   : debug_value_rep(0),
     log_history_len_rep(eca_l_i_default_log_history_len),
     extlog_debug_level_rep(eca_l_i_default_extlog_level),
     extlog_file_repp(0)
 {
-  char *extlog_dest = getenv("ECASOUND_LOGFILE");
+  char *extlog_dest = (external_log == true) ? getenv("ECASOUND_LOGFILE") : 0;
   char *extlog_loglevel = getenv("ECASOUND_LOGLEVEL");
   
   if (extlog_dest) {
@@ -138,6 +143,65 @@ void ECA_LOGGER_INTERFACE::msg(ECA_LOGGER::Msg_level_t level, const std::string&
   }
 }
 
+/**
+ * Issues a log message from a realtime context. Instead
+ * of a complete message, takes a format string, where
+ * each '%' conversion (e.g. "%s" or "%d") is replaced 
+ * with the next argument, and "%%" with a '%'. 
+ *
+ * 'module_name' and 'format' must point to static 
+ * storage, e.g. string literals. String arguments are 
+ * copied, and truncated to 47 characters.
+ *
+ * Does not allocate memory, but whether the message is
+ * output without blocking depends on the implementation.
+ *
+ * @see ECA_LOG_RT_MSG()
+ * @see ECA_LOGGER_RT
+ */
+void ECA_LOGGER_INTERFACE::rt_msg(ECA_LOGGER::Msg_level_t level, 
+				  const char* module_name, 
+				  const char* format,
+				  const ECA_LOGGER_ARG& arg1,
+				  const ECA_LOGGER_ARG& arg2,
+				  const ECA_LOGGER_ARG& arg3,
+				  const ECA_LOGGER_ARG& arg4)
+{
+  const ECA_LOGGER_ARG* args[ECA_LOGGER_RECORD::max_args] = { &arg1, &arg2, &arg3, &arg4 };
+  ECA_LOGGER_RECORD record;
+
+  record.level = level;
+  record.module_name = module_name;
+  record.format = format;
+  for(int n = 0; n < ECA_LOGGER_RECORD::max_args; n++) {
+    record.types[n] = args[n]->type;
+    switch(args[n]->type) 
+      {
+      case ECA_LOGGER_ARG::type_integer: { record.values[n].i = args[n]->value.i; break; }
+      case ECA_LOGGER_ARG::type_float: { record.values[n].d = args[n]->value.d; break; }
+      case ECA_LOGGER_ARG::type_string: 
+	{
+	  std::strncpy(record.strings[n], args[n]->value.s, ECA_LOGGER_RECORD::max_string - 1);
+	  record.strings[n][ECA_LOGGER_RECORD::max_string - 1] = 0;
+	  break;
+	}
+      default: { break; }
+      }
+  }
+
+  do_rt_msg(record);
+}
+
+/**
+ * Outputs a message issued with rt_msg(). The default 
+ * implementation formats and outputs the message 
+ * immediately.
+ */
+void ECA_LOGGER_INTERFACE::do_rt_msg(const ECA_LOGGER_RECORD& record)
+{
+  msg(record.level, record.module_name, format_record(record));
+}
+
 /**
  * Sets logging level to 'level' state to 'enabled'.
  */
@@ -212,3 +276,40 @@ void ECA_LOGGER_INTERFACE::format_log_msg(std::string *logmsg, ECA_LOGGER::Msg_l
     + ECA_LOGGER_INTERFACE::filter_module_name(module_name) + ") " 
     + log_message;
 }
+
+/**
+ * Formats the log message stored in 'record'.
+ */
+string ECA_LOGGER_INTERFACE::format_record(const ECA_LOGGER_RECORD& record)
+{
+  string result;
+  int arg = 0;
+
+  for(const char* p = record.format; *p != 0; p++) {
+    if (*p != '%') {
+      result += *p;
+      continue;
+    }
+
+    ++p;
+    if (*p == '%') {
+      result += '%';
+      continue;
+    }
+    if (*p == 0) 
+      break;
+
+    if (arg < ECA_LOGGER_RECORD::max_args) {
+      switch(record.types[arg])
+	{
+	case ECA_LOGGER_ARG::type_integer: { result += kvu_numtostr(record.values[arg].i); break; }
+	case ECA_LOGGER_ARG::type_float: { result += kvu_numtostr(record.values[arg].d); break; }
+	case ECA_LOGGER_ARG::type_string: { result += record.strings[arg]; break; }
+	default: { break; }
+	}
+      ++arg;
+    }
+  }
+
+  return result;
+}
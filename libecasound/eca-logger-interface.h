@@ -1,6 +1,7 @@
 // ------------------------------------------------------------------------
 // eca-logger-interface.h: Logging subsystem interface
 // Copyright (C) 2002-2004,2009 Kai Vehmanen
+// Copyright (C) 2026 agent
 //
 // Attributes:
 //     eca-style-version: 2
@@ -28,6 +29,44 @@
 #include <string>
 #include "eca-logger.h"
 
+/**
+ * Argument of a realtime log message. Strings are
+ * copied when the message is issued.
+ */
+struct ECA_LOGGER_ARG {
+
+  enum Type { type_none = 0, type_integer, type_float, type_string };
+
+  ECA_LOGGER_ARG(void) : type(type_none) { value.i = 0; }
+  ECA_LOGGER_ARG(int v) : type(type_integer) { value.i = v; }
+  ECA_LOGGER_ARG(long int v) : type(type_integer) { value.i = v; }
+  ECA_LOGGER_ARG(double v) : type(type_float) { value.d = v; }
+  ECA_LOGGER_ARG(const char* v) : type(type_string) { value.s = v; }
+  ECA_LOGGER_ARG(const std::string& v) : type(type_string) { value.s = v.c_str(); }
+
+  Type type;
+  union { long int i; double d; const char* s; } value;
+};
+
+/**
+ * Fixed-size binary log record. Holds the format
+ * string and the arguments of a message issued with
+ * ECA_LOG_RT_MSG(), so that the message can be
+ * formatted later, outside the realtime context.
+ */
+struct ECA_LOGGER_RECORD {
+
+  static const int max_args = 4;
+  static const int max_string = 48;
+
+  ECA_LOGGER::Msg_level_t level;
+  const char* module_name;
+  const char* format;
+  char types[max_args];
+  union { long int i; double d; } values[max_args];
+  char strings[max_args][max_string];
+};
+
 /**
  * Virtual base class for logging subsystem implementations.
  *
@@ -37,10 +76,17 @@ class ECA_LOGGER_INTERFACE {
 
   public:
 
-  ECA_LOGGER_INTERFACE(void);
+  ECA_LOGGER_INTERFACE(bool external_log = true);
   virtual ~ECA_LOGGER_INTERFACE(void);
 
   void msg(ECA_LOGGER::Msg_level_t level, const std::string& module_name, const std::string& log_message);
+  void rt_msg(ECA_LOGGER::Msg_level_t level, 
+	      const char* module_name, 
+	      const char* format,
+	      const ECA_LOGGER_ARG& arg1 = ECA_LOGGER_ARG(),
+	      const ECA_LOGGER_ARG& arg2 = ECA_LOGGER_ARG(),
+	      const ECA_LOGGER_ARG& arg3 = ECA_LOGGER_ARG(),
+	      const ECA_LOGGER_ARG& arg4 = ECA_LOGGER_ARG());
   void flush(void);
   void disable(void);
   void set_log_history_length(int len);
@@ -67,8 +113,10 @@ class ECA_LOGGER_INTERFACE {
   virtual void do_msg(ECA_LOGGER::Msg_level_t level, const std::string& module_name, const std::string& log_message) = 0;
   virtual void do_flush(void) = 0;
   virtual void do_log_level_changed(void) = 0;
+  virtual void do_rt_msg(const ECA_LOGGER_RECORD& record);
 
   static std::string filter_module_name(const std::string& rawmodule);
+  static std::string format_record(const ECA_LOGGER_RECORD& record);
   static void format_log_msg(std::string *logmsg, ECA_LOGGER::Msg_level_t level, const std::string& module_name, const std::string& log_message);
 
   private:
@@ -0,0 +1,271 @@
+// ------------------------------------------------------------------------
+// eca-logger-rt.cpp: Logger that defers output of messages issued
+//                    from realtime threads
+// Copyright (C) 2026 agent
+//
+// Attributes:
+//     eca-style-version: 3
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
+// ------------------------------------------------------------------------
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <string>
+#include <pthread.h>
+
+#include <kvu_dbc.h>
+#include <kvu_locks.h>
+#include <kvu_numtostr.h>
+#include <kvu_utils.h> /* kvu_sleep() */
+
+#include "eca-logger-rt.h"
+
+using std::string;
+
+/**
+ * Single-producer, single-consumer ring of log records.
+ * The producer is the thread that has claimed the ring,
+ * the consumer is whoever holds 'eca_logger_rt_drain_lock'.
+ */
+struct ECA_LOGGER_RT_RING {
+  volatile int claimed;
+  volatile long int write_index;
+  volatile long int read_index;
+  ECA_LOGGER_RECORD records[128];
+};
+
+static const int eca_logger_rt_rings = 16;
+static const long int eca_logger_rt_ring_size = 128;
+static const long int eca_logger_rt_interval_ns = 20000000;
+
+/* note: static storage, as rings are shared by all
+ *       ECA_LOGGER_RT instances and may still be in
+ *       use by their threads when an instance is
+ *       deleted */
+static ECA_LOGGER_RT_RING eca_logger_rt_ring_pool[eca_logger_rt_rings];
+static long int eca_logger_rt_dropped = 0;
+static long int eca_logger_rt_dropped_reported = 0;
+static pthread_mutex_t eca_logger_rt_drain_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_key_t eca_logger_rt_ring_key;
+static pthread_once_t eca_logger_rt_key_once = PTHREAD_ONCE_INIT;
+
+/**
+ * Releases the ring claimed by an exiting thread.
+ */
+static void eca_logger_rt_release_ring(void* arg)
+{
+  ECA_LOGGER_RT_RING* ring = reinterpret_cast<ECA_LOGGER_RT_RING*>(arg);
+  __sync_lock_release(&ring->claimed);
+}
+
+static void eca_logger_rt_create_key(void)
+{
+  pthread_key_create(&eca_logger_rt_ring_key, eca_logger_rt_release_ring);
+}
+
+/**
+ * Returns the ring of the calling thread, claiming a
+ * free one on first use. Returns 0 if all rings are
+ * in use.
+ *
+ * Realtime-safe.
+ */
+static ECA_LOGGER_RT_RING* eca_logger_rt_thread_ring(void)
+{
+  ECA_LOGGER_RT_RING* ring =
+    reinterpret_cast<ECA_LOGGER_RT_RING*>(pthread_getspecific(eca_logger_rt_ring_key));
+
+  if (ring == 0) {
+    for(int n = 0; n < eca_logger_rt_rings; n++) {
+      if (__sync_bool_compare_and_swap(&eca_logger_rt_ring_pool[n].claimed, 0, 1) == true) {
+	ring = &eca_logger_rt_ring_pool[n];
+	pthread_setspecific(eca_logger_rt_ring_key, ring);
+	break;
+      }
+    }
+  }
+
+  return ring;
+}
+
+/**
+ * Class constructor. Ownership of 'target' is
+ * transferred to the new object.
+ */
+ECA_LOGGER_RT::ECA_LOGGER_RT(ECA_LOGGER_INTERFACE* target)
+  : ECA_LOGGER_INTERFACE(false),
+    target_repp(target),
+    consumer_running_rep(false),
+    exit_request_rep(0)
+{
+  DBC_REQUIRE(target != 0);
+
+  set_log_level_bitmask(target->get_log_level_bitmask());
+  pthread_mutex_init(&output_lock_rep, NULL);
+  pthread_once(&eca_logger_rt_key_once, eca_logger_rt_create_key);
+
+  if (pthread_create(&consumer_rep, NULL, consumer_thread, this) == 0)
+    consumer_running_rep = true;
+}
+
+ECA_LOGGER_RT::~ECA_LOGGER_RT(void)
+{
+  if (consumer_running_rep == true) {
+    exit_request_rep = 1;
+    pthread_join(consumer_rep, NULL);
+    consumer_running_rep = false;
+  }
+
+  if (target_repp != 0) {
+    drain();
+    delete target_repp;
+    target_repp = 0;
+  }
+
+  pthread_mutex_destroy(&output_lock_rep);
+}
+
+/**
+ * Outputs pending messages, and releases ownership of
+ * the target logger. No output is done after this.
+ */
+ECA_LOGGER_INTERFACE* ECA_LOGGER_RT::release_target(void)
+{
+  if (consumer_running_rep == true) {
+    exit_request_rep = 1;
+    pthread_join(consumer_rep, NULL);
+    consumer_running_rep = false;
+  }
+
+  drain();
+
+  ECA_LOGGER_INTERFACE* target = target_repp;
+  target->set_log_level_bitmask(get_log_level_bitmask());
+  target_repp = 0;
+  return target;
+}
+
+/**
+ * Number of realtime messages dropped because their
+ * ring was full.
+ */
+long int ECA_LOGGER_RT::dropped_messages(void)
+{
+  return __sync_fetch_and_add(&eca_logger_rt_dropped, 0);
+}
+
+void ECA_LOGGER_RT::do_msg(ECA_LOGGER::Msg_level_t level, const std::string& module_name, const std::string& log_message)
+{
+  KVU_GUARD_LOCK guard(&output_lock_rep);
+  if (target_repp != 0) {
+    target_repp->set_log_level_bitmask(get_log_level_bitmask());
+    target_repp->msg(level, module_name, log_message);
+  }
+}
+
+void ECA_LOGGER_RT::do_flush(void)
+{
+  drain();
+
+  KVU_GUARD_LOCK guard(&output_lock_rep);
+  if (target_repp != 0)
+    target_repp->flush();
+}
+
+void ECA_LOGGER_RT::do_log_level_changed(void)
+{
+  KVU_GUARD_LOCK guard(&output_lock_rep);
+  if (target_repp != 0)
+    target_repp->set_log_level_bitmask(get_log_level_bitmask());
+}
+
+/**
+ * Stores 'record' to the ring of the calling thread.
+ *
+ * Realtime-safe, unless the calling thread does not
+ * get a ring, in which case the message is output
+ * immediately.
+ */
+void ECA_LOGGER_RT::do_rt_msg(const ECA_LOGGER_RECORD& record)
+{
+  ECA_LOGGER_RT_RING* ring = 0;
+  if (consumer_running_rep == true)
+    ring = eca_logger_rt_thread_ring();
+
+  if (ring == 0) {
+    ECA_LOGGER_INTERFACE::do_rt_msg(record);
+    return;
+  }
+
+  long int w = ring->write_index;
+  __sync_synchronize();
+  if (w - ring->read_index >= eca_logger_rt_ring_size) {
+    __sync_fetch_and_add(&eca_logger_rt_dropped, 1);
+    return;
+  }
+
+  ring->records[w % eca_logger_rt_ring_size] = record;
+  __sync_synchronize();
+  ring->write_index = w + 1;
+}
+
+void* ECA_LOGGER_RT::consumer_thread(void* arg)
+{
+  ECA_LOGGER_RT* self = reinterpret_cast<ECA_LOGGER_RT*>(arg);
+
+  while(self->exit_request_rep == 0) {
+    kvu_sleep(0, eca_logger_rt_interval_ns);
+    self->drain();
+  }
+
+  return 0;
+}
+
+/**
+ * Formats and outputs all records stored in the rings.
+ */
+void ECA_LOGGER_RT::drain(void)
+{
+  KVU_GUARD_LOCK guard(&eca_logger_rt_drain_lock);
+
+  for(int n = 0; n < eca_logger_rt_rings; n++) {
+    ECA_LOGGER_RT_RING* ring = &eca_logger_rt_ring_pool[n];
+    long int r = ring->read_index;
+
+    while(true) {
+      long int w = ring->write_index;
+      __sync_synchronize();
+      if (r == w)
+	break;
+
+      ECA_LOGGER_RECORD record = ring->records[r % eca_logger_rt_ring_size];
+      __sync_synchronize();
+      ring->read_index = ++r;
+
+      msg(record.level, record.module_name, format_record(record));
+    }
+  }
+
+  long int dropped = dropped_messages();
+  if (dropped > eca_logger_rt_dropped_reported) {
+    msg(ECA_LOGGER::info, __FILE__,
+	"WARNING: " + kvu_numtostr(dropped - eca_logger_rt_dropped_reported) +
+	" realtime log messages dropped.");
+    eca_logger_rt_dropped_reported = dropped;
+  }
+}
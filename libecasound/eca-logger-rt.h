@@ -0,0 +1,71 @@
+#ifndef INCLUDE_ECA_LOGGER_RT_H
+#define INCLUDE_ECA_LOGGER_RT_H
+
+#include <string>
+#include <pthread.h>
+
+#include "eca-logger-interface.h"
+
+/**
+ * Logging subsystem implementation that makes log
+ * messages issued from realtime threads safe to use.
+ *
+ * Wraps another logger implementation, the target, to
+ * which all output is passed. Messages issued with
+ * msg() are output immediately, as before. Messages
+ * issued with rt_msg() (see ECA_LOG_RT_MSG()) are
+ * stored as fixed-size binary records into a lock-free
+ * ring owned by the calling thread. A background thread
+ * formats the records and passes them to the target
+ * every 20ms, and when flush() is called.
+ *
+ * Rings are allocated statically, so issuing a message
+ * does not allocate memory or take locks. If a ring is
+ * full, the message is dropped and the number of
+ * dropped messages is reported later. If more threads
+ * issue realtime messages than there are rings, the
+ * extra threads fall back to immediate output.
+ *
+ * Enabled with ECA_LOGGER::set_rt_logging() (ecasoundrc
+ * option 'rt-logging').
+ *
+ * Related design patterns:
+ *     - Decorator (GoF175)
+ *
+ * @author agent
+ */
+class ECA_LOGGER_RT : public ECA_LOGGER_INTERFACE {
+
+ public:
+
+  ECA_LOGGER_RT(ECA_LOGGER_INTERFACE* target);
+  virtual ~ECA_LOGGER_RT(void);
+
+  ECA_LOGGER_INTERFACE* target(void) const { return target_repp; }
+  ECA_LOGGER_INTERFACE* release_target(void);
+
+  static long int dropped_messages(void);
+
+ protected:
+
+  virtual void do_msg(ECA_LOGGER::Msg_level_t level, const std::string& module_name, const std::string& log_message);
+  virtual void do_flush(void);
+  virtual void do_log_level_changed(void);
+  virtual void do_rt_msg(const ECA_LOGGER_RECORD& record);
+
+ private:
+
+  static void* consumer_thread(void* arg);
+  void drain(void);
+
+  ECA_LOGGER_INTERFACE* target_repp;
+  pthread_t consumer_rep;
+  pthread_mutex_t output_lock_rep;
+  bool consumer_running_rep;
+  volatile int exit_request_rep;
+
+  ECA_LOGGER_RT(const ECA_LOGGER_RT&);
+  ECA_LOGGER_RT& operator=(const ECA_LOGGER_RT&);
+};
+
+#endif /* INCLUDE_ECA_LOGGER_RT_H */
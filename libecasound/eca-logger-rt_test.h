@@ -0,0 +1,154 @@
+// ------------------------------------------------------------------------
+// eca-logger-rt_test.h: Unit test for ECA_LOGGER_RT
+// Copyright (C) 2026 agent
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
+// ------------------------------------------------------------------------
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include <kvu_numtostr.h>
+
+#include "eca-logger-interface.h"
+#include "eca-logger-rt.h"
+#include "eca-test-case.h"
+
+using namespace std;
+
+/**
+ * Logger that stores the messages it receives.
+ */
+class ECA_LOGGER_RT_TEST_TARGET : public ECA_LOGGER_INTERFACE {
+
+public:
+
+  vector<string> messages;
+
+  virtual void do_msg(ECA_LOGGER::Msg_level_t level, const std::string& module_name, const std::string& log_message) { messages.push_back(log_message); }
+  virtual void do_flush(void) { }
+  virtual void do_log_level_changed(void) { }
+  virtual ~ECA_LOGGER_RT_TEST_TARGET(void) { }
+};
+
+/**
+ * Unit test for ECA_LOGGER_RT.
+ */
+class ECA_LOGGER_RT_TEST : public ECA_TEST_CASE {
+
+protected:
+
+  virtual string do_name(void) const { return("ECA_LOGGER_RT"); }
+  virtual void do_run(void);
+
+public:
+
+  virtual ~ECA_LOGGER_RT_TEST(void) { }
+};
+
+void ECA_LOGGER_RT_TEST::do_run(void)
+{
+  std::fprintf(stdout, "%s: tests for %s class\n",
+	       name().c_str(), __FILE__);
+
+  /* case: formatting, output without deferring */
+  {
+    ECA_LOGGER_RT_TEST_TARGET target;
+    target.rt_msg(ECA_LOGGER::info, __FILE__,
+		  "%s has %d channels at %f%% of %s",
+		  string("chain1"), 2, 0.5, "a-very-long-string-that-does-not-fit-into-a-log-record");
+    if (target.messages.size() != 1)
+      ECA_TEST_FAILURE("not output");
+    else if (target.messages[0] !=
+	     "chain1 has 2 channels at 0.50% of a-very-long-string-that-does-not-fit-into-a-log")
+      ECA_TEST_FAILURE("formatting: " + target.messages[0]);
+  }
+
+  /* case: deferred output */
+  {
+    ECA_LOGGER_RT_TEST_TARGET* target = new ECA_LOGGER_RT_TEST_TARGET();
+    ECA_LOGGER_RT logger (target);
+    logger.set_log_level(ECA_LOGGER::info, true);
+
+    logger.msg(ECA_LOGGER::info, __FILE__, "direct");
+    if (target->messages.size() != 1 ||
+	target->messages[0] != "direct")
+      ECA_TEST_FAILURE("direct output");
+
+    for(int n = 0; n < 10; n++)
+      logger.rt_msg(ECA_LOGGER::info, __FILE__, "message %d", n);
+    logger.flush();
+
+    if (target->messages.size() != 11)
+      ECA_TEST_FAILURE("deferred messages lost");
+    else
+      for(int n = 0; n < 10; n++) {
+	if (target->messages[n + 1] != "message " + kvu_numtostr(n))
+	  ECA_TEST_FAILURE("deferred message order");
+      }
+
+    if (logger.target() != target ||
+	target->get_log_level_bitmask() != logger.get_log_level_bitmask())
+      ECA_TEST_FAILURE("target");
+  }
+
+  /* case: full ring */
+  {
+    ECA_LOGGER_RT_TEST_TARGET* target = new ECA_LOGGER_RT_TEST_TARGET();
+    ECA_LOGGER_RT logger (target);
+    logger.set_log_level(ECA_LOGGER::info, true);
+
+    long int dropped = ECA_LOGGER_RT::dropped_messages();
+    for(int n = 0; n < 1000; n++)
+      logger.rt_msg(ECA_LOGGER::info, __FILE__, "message %d", n);
+    logger.flush();
+    dropped = ECA_LOGGER_RT::dropped_messages() - dropped;
+
+    long int delivered = 0, warnings = 0;
+    for(size_t n = 0; n < target->messages.size(); n++) {
+      if (target->messages[n].find("message ") == 0)
+	++delivered;
+      else if (target->messages[n].find("realtime log messages dropped") != string::npos)
+	++warnings;
+    }
+
+    /* note: the consumer thread may drain the ring while
+     *       messages are issued, so not all are dropped */
+    if (delivered + dropped != 1000)
+      ECA_TEST_FAILURE("dropped messages not counted");
+    if (dropped > 0 && warnings == 0)
+      ECA_TEST_FAILURE("dropped messages not reported");
+  }
+
+  /* case: releasing the target */
+  {
+    ECA_LOGGER_RT_TEST_TARGET* target = new ECA_LOGGER_RT_TEST_TARGET();
+    ECA_LOGGER_RT* logger = new ECA_LOGGER_RT(target);
+    logger->set_log_level(ECA_LOGGER::info, true);
+    logger->rt_msg(ECA_LOGGER::info, __FILE__, "pending");
+
+    if (logger->release_target() != target)
+      ECA_TEST_FAILURE("release_target");
+    delete logger;
+
+    if (target->messages.size() != 1 ||
+	target->messages[0] != "pending")
+      ECA_TEST_FAILURE("pending message lost on release");
+    if (target->is_log_level_set(ECA_LOGGER::info) != true)
+      ECA_TEST_FAILURE("log level not passed on release");
+    delete target;
+  }
+}
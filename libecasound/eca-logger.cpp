@@ -1,6 +1,7 @@
 // ------------------------------------------------------------------------
 // eca-logger.cpp: A logging subsystem implemented as a singleton class
 // Copyright (C) 2002 Kai Vehmanen
+// Copyright (C) 2026 agent
 //
 // This program is free software; you can redistribute it and/or modify
 // it under the terms of the GNU General Public License as published by
@@ -22,10 +23,13 @@
 
 #include "eca-logger-interface.h"
 #include "eca-logger-default.h"
+#include "eca-logger-rt.h"
 #include "eca-logger.h"
 
 ECA_LOGGER_INTERFACE* ECA_LOGGER::interface_impl_repp = 0;
+std::vector<ECA_LOGGER_INTERFACE*> ECA_LOGGER::retired_repp;
 pthread_mutex_t ECA_LOGGER::lock_rep = PTHREAD_MUTEX_INITIALIZER;
+bool ECA_LOGGER::rt_logging_rep = false;
 
 static const char *level_descs[] = {
   "ERROR   ", /* 0 */
@@ -49,7 +53,7 @@ ECA_LOGGER_INTERFACE& ECA_LOGGER::instance(void)
   if (ECA_LOGGER::interface_impl_repp == 0) {
     KVU_GUARD_LOCK guard(&ECA_LOGGER::lock_rep);
     if (ECA_LOGGER::interface_impl_repp == 0) {
-      ECA_LOGGER::interface_impl_repp = new ECA_LOGGER_DEFAULT();
+      ECA_LOGGER::interface_impl_repp = wrap_logger(new ECA_LOGGER_DEFAULT());
     }
   }
   return(*interface_impl_repp);
@@ -65,13 +69,13 @@ void ECA_LOGGER::attach_logger(ECA_LOGGER_INTERFACE* logger)
   if (ECA_LOGGER::interface_impl_repp == 0) {
     KVU_GUARD_LOCK guard(&ECA_LOGGER::lock_rep);
     if (ECA_LOGGER::interface_impl_repp == 0) {
-      ECA_LOGGER::interface_impl_repp = logger;
       if (oldloglevel != -1) {
 	logger->set_log_level_bitmask(oldloglevel);
       }
+      ECA_LOGGER::interface_impl_repp = wrap_logger(logger);
     }
   }
-  DBC_ENSURE(ECA_LOGGER::interface_impl_repp == logger);
+  DBC_ENSURE(ECA_LOGGER::interface_impl_repp != 0);
 }
 
 /**
@@ -85,10 +89,47 @@ void ECA_LOGGER::detach_logger(void)
       delete ECA_LOGGER::interface_impl_repp;
       ECA_LOGGER::interface_impl_repp = 0;
     }
+    for(size_t n = 0; n < ECA_LOGGER::retired_repp.size(); n++) {
+      delete ECA_LOGGER::retired_repp[n];
+    }
+    ECA_LOGGER::retired_repp.clear();
   }
   DBC_ENSURE(ECA_LOGGER::interface_impl_repp == 0);
 }
 
+void ECA_LOGGER::set_rt_logging(bool enabled)
+{
+  KVU_GUARD_LOCK guard(&ECA_LOGGER::lock_rep);
+
+  ECA_LOGGER::rt_logging_rep = enabled;
+  if (ECA_LOGGER::interface_impl_repp != 0) {
+    ECA_LOGGER_RT* rtlogger = dynamic_cast<ECA_LOGGER_RT*>(ECA_LOGGER::interface_impl_repp);
+    if (enabled == true && rtlogger == 0) {
+      ECA_LOGGER::interface_impl_repp = wrap_logger(ECA_LOGGER::interface_impl_repp);
+    }
+    else if (enabled != true && rtlogger != 0) {
+      /* note: other threads may still be using the wrapper 
+       *       returned by instance(), so it is only deleted 
+       *       when the logger is detached */
+      ECA_LOGGER::interface_impl_repp = rtlogger->release_target();
+      ECA_LOGGER::retired_repp.push_back(rtlogger);
+    }
+  }
+}
+
+/**
+ * Wraps 'logger' with ECA_LOGGER_RT, if realtime 
+ * logging is enabled.
+ */
+ECA_LOGGER_INTERFACE* ECA_LOGGER::wrap_logger(ECA_LOGGER_INTERFACE* logger)
+{
+  if (ECA_LOGGER::rt_logging_rep == true &&
+      dynamic_cast<ECA_LOGGER_RT*>(logger) == 0) {
+    return new ECA_LOGGER_RT(logger);
+  }
+  return logger;
+}
+
 const char* ECA_LOGGER::level_to_string(ECA_LOGGER::Msg_level_t arg)
 {
   switch(arg) 
@@ -2,6 +2,7 @@
 #define INCLUDE_ECA_LOGGER_H
 
 #include <string>
+#include <vector>
 #include <pthread.h>
 
 /**
@@ -91,6 +92,18 @@ class ECA_LOGGER {
    */
   static void detach_logger(void);
 
+  /**
+   * Whether messages issued from realtime threads with 
+   * ECA_LOG_RT_MSG() are output by a background thread. 
+   * If enabled, the current and all later attached logger 
+   * implementations are wrapped with ECA_LOGGER_RT. When
+   * disabled, the wrapper is kept until detach_logger(), 
+   * as other threads may still be using it. Disabled 
+   * by default.
+   */
+  static void set_rt_logging(bool enabled);
+  static bool rt_logging(void) { return rt_logging_rep; }
+
   /**
    * Returns description of log level 'arg'.
    */
@@ -100,6 +113,10 @@ class ECA_LOGGER {
 
   static ECA_LOGGER_INTERFACE* interface_impl_repp;
   static pthread_mutex_t lock_rep;
+  static bool rt_logging_rep;
+  static std::vector<ECA_LOGGER_INTERFACE*> retired_repp;
+
+  static ECA_LOGGER_INTERFACE* wrap_logger(ECA_LOGGER_INTERFACE* logger);
 
   /** 
    * @name Constructors and destructors
@@ -137,6 +154,20 @@ class ECA_LOGGER {
 #define ECA_LOG_MSG_NOPREFIX(x,y) \
         do { ECA_LOGGER::instance().msg(x, std::string(), y); } while(0)
 
+/**
+ * Issues a log message from a realtime context, without
+ * building strings or allocating memory. 
+ *
+ * @param x log level, type 'ECA_LOGGER::Msg_level_t'
+ * @param ... format string, type 'const char*', and up to 
+ *            four arguments (integers, floats or strings)
+ *
+ * @see ECA_LOGGER_INTERFACE::rt_msg()
+ */
+#define ECA_LOG_RT_MSG(x, ...) \
+        do { if (ECA_LOGGER::instance().is_log_level_set(x) == true) \
+               ECA_LOGGER::instance().rt_msg(x, __FILE__, __VA_ARGS__); } while(0)
+
 /**
  * To make ECA_LOG_MSG work we need to include the 
  * public interface ECA_LOGGER_INTERFACE.
@@ -48,6 +48,7 @@
 #include "audioio-loop.h"
 #include "midiio.h"
 #include "audiofx_ladspa.h"
+#include "audiofx_sandbox.h"
 #include "audiofx_lv2.h"
 #include "generic-controller.h"
 #include "eca-static-object-maps.h"
@@ -461,6 +462,9 @@ CHAIN_OPERATOR* ECA_OBJECT_FACTORY::create_ladspa_plugin (const string& argu)
 	if (n + 1 < new_cop->number_of_params()) otemp << ", ";
       }
       ECA_LOG_MSG(ECA_LOGGER::user_objects, otemp.to_string());
+
+      if (EFFECT_SANDBOX::enabled() == true)
+	new_cop = new EFFECT_SANDBOX(new_cop);
     }
     else {
       ECA_LOG_MSG(ECA_LOGGER::info, 
@@ -513,6 +517,9 @@ CHAIN_OPERATOR* ECA_OBJECT_FACTORY::create_lv2_plugin (const string& argu)
 	if (n + 1 < new_cop->number_of_params()) otemp << ", ";
       }
       ECA_LOG_MSG(ECA_LOGGER::user_objects, otemp.to_string());
+
+      if (EFFECT_SANDBOX::enabled() == true)
+	new_cop = new EFFECT_SANDBOX(new_cop);
     }
     else {
       ECA_LOG_MSG(ECA_LOGGER::info, 
@@ -753,6 +760,11 @@ string ECA_OBJECT_FACTORY::chain_operator_to_eos(const CHAIN_OPERATOR* chainop)
   // special handling for LADSPA-plugins
 #ifndef ECA_DISABLE_EFFECTS
 
+  /* note: sandboxing is not stored, it is set in ecasoundrc */
+  const EFFECT_SANDBOX* sandbox = dynamic_cast<const EFFECT_SANDBOX*>(chainop);
+  if (sandbox != 0)
+    chainop = sandbox->wrapped_operator();
+
   const EFFECT_LADSPA* ladspa = dynamic_cast<const EFFECT_LADSPA*>(chainop);
   const CHAIN_OPERATOR *lv2_cop = 0;
   string lv2_arg;
@@ -88,6 +88,37 @@ class OPERATOR : public DYNAMIC_OBJECT<SAMPLE_SPECS::sample_t> {
    */
   virtual void parameter_description(int param, struct PARAM_DESCRIPTION *pd) const;
 
+  /**
+   * Whether parameter 'param' supports ramping with
+   * set_parameter_ramp().
+   *
+   * @param param parameter id
+   * @pre param > 0 && param <= number_of_params()
+   */
+  virtual bool parameter_ramp_supported(int param) const { return false; }
+
+  /**
+   * Sets a new target value for parameter 'param'. 
+   * 
+   * If parameter_ramp_supported() returns true for 'param', 
+   * the operator interpolates from the current value to 
+   * 'value' over the next processed block, so that 'value' 
+   * is reached at the last sample of the block. Otherwise the 
+   * call is equivalent to set_parameter().
+   *
+   * @param param parameter id
+   * @pre param > 0 && param <= number_of_params()
+   */
+  virtual void set_parameter_ramp(int param, parameter_t value) { set_parameter(param, value); }
+
+  /**
+   * Whether set_parameter() may be called from another
+   * thread while the operator is processing audio. If true,
+   * new values are picked up at the next block boundary, and 
+   * callers do not need to route changes via the engine thread.
+   */
+  virtual bool thread_safe_parameters(void) const { return false; }
+
   virtual OPERATOR* clone(void) const = 0;
   virtual OPERATOR* new_expr(void) const = 0;
 
@@ -0,0 +1,119 @@
+#ifndef INCLUDED_ECA_PARAMETER_BLOCK_H
+#define INCLUDED_ECA_PARAMETER_BLOCK_H
+
+#include <vector>
+
+/**
+ * Double-buffered block of control values, for plugin
+ * hosts whose control port memory is read by the plugin
+ * while it runs.
+ *
+ * Control side writes go to a staging copy with set().
+ * The engine copies staged values to the active block,
+ * which is what plugin ports are connected to, by calling
+ * update() at the start of each processing block.
+ *
+ * set() may be called from any thread, including
+ * engine-thread controllers. Neither set() nor update()
+ * takes locks: each write stores one value and then
+ * bumps a write counter. update() copies the block when
+ * the counter has changed; a write that races with the
+ * copy bumps the counter again, so the block is copied
+ * once more on the next call.
+ *
+ * The block is sized with push_back() before any ports
+ * are connected; resizing invalidates port pointers.
+ *
+ * @author agent
+ */
+template<class T>
+class ECA_PARAMETER_BLOCK {
+
+ public:
+
+  ECA_PARAMETER_BLOCK(void) : write_seq_rep(0), applied_seq_rep(0) { }
+
+  /**
+   * Adds a new value to the block. Values of output
+   * ports are written by the plugin, so update() does 
+   * not overwrite them.
+   *
+   * Not thread-safe, only to be used before processing.
+   */
+  void push_back(T value, bool output = false) {
+    staging_rep.push_back(value);
+    active_rep.push_back(value);
+    output_rep.push_back(output);
+  }
+
+  size_t size(void) const { return staging_rep.size(); }
+
+  /**
+   * Stages a new value. Takes effect at the next
+   * call to update().
+   *
+   * Realtime-safe and lock-free.
+   */
+  void set(size_t index, T value) {
+    staging_rep[index] = value;
+    /* note: full barrier, the value is visible before 
+     *       the new count */
+    __sync_fetch_and_add(&write_seq_rep, 1);
+  }
+
+  /**
+   * Returns the most recently staged value.
+   */
+  T get(size_t index) const { return staging_rep[index]; }
+
+  /**
+   * Returns the value in the active block, i.e. the
+   * value seen by, or written by, the plugin.
+   */
+  T active(size_t index) const { return active_rep[index]; }
+
+  /**
+   * Pointer to active block memory, to be connected
+   * to plugin ports.
+   */
+  T* port(size_t index) { return &active_rep[index]; }
+
+  /**
+   * Copies staged values to the active block, if any
+   * were changed since the previous update.
+   *
+   * Realtime-safe and lock-free. To be called only from 
+   * the thread that runs the plugin.
+   *
+   * @return true if new values were applied
+   */
+  bool update(void) {
+    unsigned int seq = write_seq_rep;
+    if (seq == applied_seq_rep)
+      return false;
+    __sync_synchronize();
+
+    /* note: all writes counted in 'seq' are seen; later
+     *       writes may or may not be, and are copied 
+     *       again on next call */
+    for(size_t n = 0; n < staging_rep.size(); n++)
+      if (output_rep[n] != true)
+	active_rep[n] = staging_rep[n];
+
+    applied_seq_rep = seq;
+    return true;
+  }
+
+ private:
+
+  ECA_PARAMETER_BLOCK(const ECA_PARAMETER_BLOCK&);
+  ECA_PARAMETER_BLOCK& operator=(const ECA_PARAMETER_BLOCK&);
+
+  std::vector<T> staging_rep;
+  std::vector<T> active_rep;
+  std::vector<bool> output_rep;
+  volatile unsigned int write_seq_rep;
+  unsigned int applied_seq_rep;
+};
+
+#endif
@@ -0,0 +1,366 @@
+// ------------------------------------------------------------------------
+// eca-plugin-cache.cpp: Persistent registry of plugin metadata
+// Copyright (C) 2026 agent
+//
+// Attributes:
+//     eca-style-version: 3
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
+// ------------------------------------------------------------------------
+
+#include <cstdio> /* rename(), remove() */
+#include <cstdlib> /* strtol(), strtod() */
+#include <fstream>
+#include <locale>
+#include <sstream>
+
+#include <unistd.h> /* getpid() */
+
+#include <kvu_numtostr.h>
+
+#include "eca-plugin-cache.h"
+#include "eca-resources.h"
+#include "eca-logger.h"
+
+using std::string;
+using std::vector;
+
+/**
+ * Cache file format:
+ *
+ * - first line is the format tag
+ * - 'F' lines start a new plugin file (path, mtime, size)
+ * - 'P' lines describe a plugin type of the preceding file
+ *   (index, id, input/output audio ports, label, name, maker)
+ * - 'C' lines describe a control port of the preceding
+ *   plugin (hint flags, default, lower and upper bound,
+ *   port name)
+ *
+ * Fields are separated with tabs. Tabs, linefeeds and
+ * backslashes in strings are escaped.
+ */
+static const char* eca_plugin_cache_format = "ecasound-plugin-cache 2";
+
+static string eca_plugin_cache_escape(const string& s)
+{
+  string res;
+  for(string::size_type n = 0; n < s.size(); n++) {
+    switch(s[n]) {
+    case '\\': { res += "\\\\"; break; }
+    case '\t': { res += "\\t"; break; }
+    case '\n': { res += "\\n"; break; }
+    default: res += s[n];
+    }
+  }
+  return res;
+}
+
+static string eca_plugin_cache_unescape(const string& s)
+{
+  string res;
+  for(string::size_type n = 0; n < s.size(); n++) {
+    if (s[n] == '\\' && n + 1 < s.size()) {
+      ++n;
+      if (s[n] == 't') res += '\t';
+      else if (s[n] == 'n') res += '\n';
+      else res += s[n];
+    }
+    else
+      res += s[n];
+  }
+  return res;
+}
+
+static vector<string> eca_plugin_cache_split(const string& line)
+{
+  vector<string> res;
+  string::size_type start = 0;
+  for(;;) {
+    string::size_type end = line.find('\t', start);
+    if (end == string::npos) {
+      res.push_back(line.substr(start));
+      break;
+    }
+    res.push_back(line.substr(start, end - start));
+    start = end + 1;
+  }
+  return res;
+}
+
+/* number formatting must not depend on the user's locale */
+static string eca_plugin_cache_ftos(double value)
+{
+  std::ostringstream os;
+  os.imbue(std::locale::classic());
+  os.precision(17);
+  os << value;
+  return os.str();
+}
+
+static double eca_plugin_cache_stof(const string& s)
+{
+  std::istringstream is (s);
+  is.imbue(std::locale::classic());
+  double value = 0.0;
+  is >> value;
+  return value;
+}
+
+ECA_PLUGIN_CACHE::ECA_PLUGIN_CACHE(void)
+  : modified_rep(false)
+{
+}
+
+ECA_PLUGIN_CACHE::~ECA_PLUGIN_CACHE(void)
+{
+}
+
+/**
+ * Returns the default location of the cache file for
+ * plugins of type 'kind' (e.g. "ladspa"), or an empty
+ * string if caching is disabled with the 'plugin-cache'
+ * resource.
+ */
+string ECA_PLUGIN_CACHE::default_path(const string& kind)
+{
+  ECA_RESOURCES ecarc;
+  if (ecarc.resource("plugin-cache") == "false")
+    return "";
+
+  string dir = ecarc.resource("user-resource-directory");
+  if (dir.size() == 0)
+    return "";
+
+  return dir + "/" + kind + "-plugin-cache";
+}
+
+/**
+ * Loads cache contents from 'path'. Also sets the file
+ * used by save().
+ *
+ * @return true if a valid cache was found
+ */
+bool ECA_PLUGIN_CACHE::load(const string& path)
+{
+  path_rep = path;
+  files_rep.clear();
+  modified_rep = false;
+
+  std::ifstream fin (path.c_str());
+  if (!fin)
+    return false;
+
+  string line;
+  std::getline(fin, line);
+  if (line != eca_plugin_cache_format) {
+    ECA_LOG_MSG(ECA_LOGGER::user_objects,
+		"Ignoring plugin cache \"" + path + "\" with unknown format.");
+    return false;
+  }
+
+  FILE_ENTRY* file = 0;
+  PLUGIN_INFO* plugin = 0;
+  bool valid = true;
+  while(std::getline(fin, line)) {
+    vector<string> fields = eca_plugin_cache_split(line);
+    if (fields[0] == "F" && fields.size() == 4) {
+      file = &files_rep[eca_plugin_cache_unescape(fields[1])];
+      file->mtime = std::strtol(fields[2].c_str(), 0, 10);
+      file->size = std::strtol(fields[3].c_str(), 0, 10);
+      file->seen = false;
+      file->plugins.clear();
+      plugin = 0;
+    }
+    else if (fields[0] == "P" && fields.size() == 8 && file != 0) {
+      file->plugins.push_back(PLUGIN_INFO());
+      plugin = &file->plugins.back();
+      plugin->index = std::atoi(fields[1].c_str());
+      plugin->unique_number = std::strtol(fields[2].c_str(), 0, 10);
+      plugin->in_audio_ports = std::atoi(fields[3].c_str());
+      plugin->out_audio_ports = std::atoi(fields[4].c_str());
+      plugin->unique = eca_plugin_cache_unescape(fields[5]);
+      plugin->name = eca_plugin_cache_unescape(fields[6]);
+      plugin->maker = eca_plugin_cache_unescape(fields[7]);
+    }
+    else if (fields[0] == "C" && fields.size() == 6 && plugin != 0) {
+      OPERATOR::PARAM_DESCRIPTION pd;
+      const string& flags = fields[1];
+      pd.bounded_below = flags.find('b') != string::npos;
+      pd.bounded_above = flags.find('a') != string::npos;
+      pd.toggled = flags.find('t') != string::npos;
+      pd.integer = flags.find('i') != string::npos;
+      pd.logarithmic = flags.find('l') != string::npos;
+      pd.output = flags.find('o') != string::npos;
+      pd.default_value = eca_plugin_cache_stof(fields[2]);
+      pd.lower_bound = eca_plugin_cache_stof(fields[3]);
+      pd.upper_bound = eca_plugin_cache_stof(fields[4]);
+      pd.description = eca_plugin_cache_unescape(fields[5]);
+      plugin->params.push_back(pd);
+    }
+    else {
+      valid = false;
+      break;
+    }
+  }
+
+  if (valid != true) {
+    ECA_LOG_MSG(ECA_LOGGER::user_objects,
+		"Ignoring corrupted plugin cache \"" + path + "\".");
+    files_rep.clear();
+    return false;
+  }
+
+  ECA_LOG_MSG(ECA_LOGGER::system_objects,
+	      "Loaded plugin cache \"" + path + "\" with " +
+	      kvu_numtostr(files_rep.size()) + " files.");
+
+  return true;
+}
+
+/**
+ * Writes cache contents back to the file given to load().
+ * Only files that were checked with is_current() or
+ * update() since load() are written, so entries for
+ * removed files are dropped.
+ *
+ * The file is replaced atomically, so concurrent
+ * processes always see a complete cache.
+ *
+ * @return true if cache was written
+ */
+bool ECA_PLUGIN_CACHE::save(void)
+{
+  if (path_rep.size() == 0)
+    return false;
+
+  string tmppath = path_rep + ".tmp." + kvu_numtostr(static_cast<int>(getpid()));
+  std::ofstream fout (tmppath.c_str());
+  if (!fout) {
+    ECA_LOG_MSG(ECA_LOGGER::user_objects,
+		"Unable to write plugin cache \"" + tmppath + "\".");
+    return false;
+  }
+
+  fout << eca_plugin_cache_format << "\n";
+
+  std::map<string,FILE_ENTRY>::const_iterator p = files_rep.begin();
+  while(p != files_rep.end()) {
+    if (p->second.seen == true) {
+      fout << "F\t" << eca_plugin_cache_escape(p->first) << "\t"
+	   << p->second.mtime << "\t" << p->second.size << "\n";
+
+      for(size_t n = 0; n < p->second.plugins.size(); n++) {
+	const PLUGIN_INFO& plugin = p->second.plugins[n];
+	fout << "P\t" << plugin.index << "\t" << plugin.unique_number << "\t"
+	     << plugin.in_audio_ports << "\t" << plugin.out_audio_ports << "\t"
+	     << eca_plugin_cache_escape(plugin.unique) << "\t"
+	     << eca_plugin_cache_escape(plugin.name) << "\t"
+	     << eca_plugin_cache_escape(plugin.maker) << "\n";
+
+	for(size_t m = 0; m < plugin.params.size(); m++) {
+	  const OPERATOR::PARAM_DESCRIPTION& pd = plugin.params[m];
+	  string flags;
+	  if (pd.bounded_below == true) flags += 'b';
+	  if (pd.bounded_above == true) flags += 'a';
+	  if (pd.toggled == true) flags += 't';
+	  if (pd.integer == true) flags += 'i';
+	  if (pd.logarithmic == true) flags += 'l';
+	  if (pd.output == true) flags += 'o';
+	  fout << "C\t" << flags << "\t"
+	       << eca_plugin_cache_ftos(pd.default_value) << "\t"
+	       << eca_plugin_cache_ftos(pd.bounded_below == true ? pd.lower_bound : 0.0) << "\t"
+	       << eca_plugin_cache_ftos(pd.bounded_above == true ? pd.upper_bound : 0.0) << "\t"
+	       << eca_plugin_cache_escape(pd.description) << "\n";
+	}
+      }
+    }
+    ++p;
+  }
+
+  fout.close();
+  if (!fout || std::rename(tmppath.c_str(), path_rep.c_str()) != 0) {
+    ECA_LOG_MSG(ECA_LOGGER::user_objects,
+		"Unable to write plugin cache \"" + path_rep + "\".");
+    std::remove(tmppath.c_str());
+    return false;
+  }
+
+  modified_rep = false;
+  return true;
+}
+
+/**
+ * Whether cached information for 'file' is up-to-date,
+ * i.e. the file has the same modification time and size
+ * as when it was last scanned.
+ */
+bool ECA_PLUGIN_CACHE::is_current(const string& file, long int mtime, long int size)
+{
+  std::map<string,FILE_ENTRY>::iterator p = files_rep.find(file);
+  if (p == files_rep.end() ||
+      p->second.mtime != mtime ||
+      p->second.size != size)
+    return false;
+
+  p->second.seen = true;
+  return true;
+}
+
+/**
+ * Returns the cached plugin types of 'file'.
+ *
+ * @pre is_current(file, ...) == true
+ */
+const vector<ECA_PLUGIN_CACHE::PLUGIN_INFO>& ECA_PLUGIN_CACHE::plugins(const string& file) const
+{
+  static const vector<PLUGIN_INFO> empty;
+  std::map<string,FILE_ENTRY>::const_iterator p = files_rep.find(file);
+  if (p == files_rep.end())
+    return empty;
+  return p->second.plugins;
+}
+
+/**
+ * Stores scan results for 'file'. An empty 'plugins'
+ * is also stored, so that files without usable plugins
+ * are not reopened.
+ */
+void ECA_PLUGIN_CACHE::update(const string& file, long int mtime, long int size, const vector<PLUGIN_INFO>& plugins)
+{
+  FILE_ENTRY& entry = files_rep[file];
+  entry.mtime = mtime;
+  entry.size = size;
+  entry.seen = true;
+  entry.plugins = plugins;
+  modified_rep = true;
+}
+
+/**
+ * Whether the cache file needs to be rewritten, i.e.
+ * some files were updated or were not seen since load().
+ */
+bool ECA_PLUGIN_CACHE::is_modified(void) const
+{
+  if (modified_rep == true)
+    return true;
+
+  std::map<string,FILE_ENTRY>::const_iterator p = files_rep.begin();
+  while(p != files_rep.end()) {
+    if (p->second.seen != true)
+      return true;
+    ++p;
+  }
+  return false;
+}
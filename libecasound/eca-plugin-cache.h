@@ -0,0 +1,82 @@
+#ifndef INCLUDED_ECA_PLUGIN_CACHE_H
+#define INCLUDED_ECA_PLUGIN_CACHE_H
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "eca-operator.h"
+
+/**
+ * Persistent registry of plugin metadata.
+ *
+ * Stores the information needed to register plugin
+ * types (ids, labels, port counts and control port
+ * hints) for each scanned plugin file, keyed by the
+ * file's modification time and size. Files that have
+ * not changed since the previous scan do not need
+ * to be opened at all.
+ *
+ * @author agent
+ */
+class ECA_PLUGIN_CACHE {
+
+ public:
+
+  /**
+   * Metadata for one plugin type.
+   */
+  struct PLUGIN_INFO {
+    /**
+     * Index of the plugin within its file (e.g. LADSPA
+     * descriptor index), or -1 if not applicable.
+     */
+    int index;
+
+    long int unique_number;
+    std::string unique;
+    std::string name;
+    std::string maker;
+
+    int in_audio_ports;
+    int out_audio_ports;
+
+    /**
+     * Descriptions of control ports, in port order.
+     */
+    std::vector<OPERATOR::PARAM_DESCRIPTION> params;
+  };
+
+  ECA_PLUGIN_CACHE(void);
+  ~ECA_PLUGIN_CACHE(void);
+
+  static std::string default_path(const std::string& kind);
+
+  bool load(const std::string& path);
+  bool save(void);
+
+  bool is_current(const std::string& file, long int mtime, long int size);
+  const std::vector<PLUGIN_INFO>& plugins(const std::string& file) const;
+  void update(const std::string& file, long int mtime, long int size, const std::vector<PLUGIN_INFO>& plugins);
+
+  size_t file_count(void) const { return files_rep.size(); }
+  bool is_modified(void) const;
+
+ private:
+
+  struct FILE_ENTRY {
+    long int mtime;
+    long int size;
+    bool seen;
+    std::vector<PLUGIN_INFO> plugins;
+  };
+
+  ECA_PLUGIN_CACHE(const ECA_PLUGIN_CACHE& x) { }
+  ECA_PLUGIN_CACHE& operator=(const ECA_PLUGIN_CACHE& x) { return *this; }
+
+  std::string path_rep;
+  bool modified_rep;
+  std::map<std::string,FILE_ENTRY> files_rep;
+};
+
+#endif
@@ -0,0 +1,200 @@
+// ------------------------------------------------------------------------
+// eca-plugin-cache_test.h: Unit test for ECA_PLUGIN_CACHE
+// Copyright (C) 2026 agent
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
+// ------------------------------------------------------------------------
+
+#include <cstdio> /* std::remove() */
+#include <string>
+#include <vector>
+
+#include <unistd.h> /* getpid() */
+
+#include "kvu_numtostr.h"
+
+#include "audiofx_ladspa.h"
+#include "eca-error.h"
+#include "eca-plugin-cache.h"
+#include "eca-test-case.h"
+
+using namespace std;
+
+/**
+ * Unit test for ECA_PLUGIN_CACHE.
+ *
+ * 1. Stores plugin information, reloads it and checks
+ *    that all fields are preserved.
+ * 2. Checks that changed files are detected and that
+ *    entries for files no longer seen are dropped.
+ * 3. Creates an EFFECT_LADSPA object from cached
+ *    information.
+ */
+class ECA_PLUGIN_CACHE_TEST : public ECA_TEST_CASE {
+
+protected:
+
+  virtual string do_name(void) const { return("ECA_PLUGIN_CACHE_TEST"); }
+  virtual void do_run(void);
+
+public:
+
+  virtual ~ECA_PLUGIN_CACHE_TEST(void) { }
+
+private:
+
+  static ECA_PLUGIN_CACHE::PLUGIN_INFO test_plugin(void);
+};
+
+ECA_PLUGIN_CACHE::PLUGIN_INFO ECA_PLUGIN_CACHE_TEST::test_plugin(void)
+{
+  ECA_PLUGIN_CACHE::PLUGIN_INFO info;
+  info.index = 3;
+  info.unique_number = 1234;
+  info.unique = "test_label";
+  info.name = "Test\tplugin\\name";
+  info.maker = "Maker\nwith linefeed";
+  info.in_audio_ports = 2;
+  info.out_audio_ports = 1;
+
+  OPERATOR::PARAM_DESCRIPTION pd;
+  pd.description = "Gain (dB)";
+  pd.default_value = 0.1;
+  pd.bounded_below = true;
+  pd.lower_bound = -70.0;
+  pd.bounded_above = false;
+  pd.upper_bound = 0.0;
+  pd.toggled = false;
+  pd.integer = false;
+  pd.logarithmic = true;
+  pd.output = false;
+  info.params.push_back(pd);
+
+  pd.description = "Latency";
+  pd.default_value = 0.0;
+  pd.bounded_below = false;
+  pd.lower_bound = 0.0;
+  pd.bounded_above = true;
+  pd.upper_bound = 44100.0;
+  pd.integer = true;
+  pd.logarithmic = false;
+  pd.output = true;
+  info.params.push_back(pd);
+
+  return info;
+}
+
+void ECA_PLUGIN_CACHE_TEST::do_run(void)
+{
+  std::fprintf(stdout, "%s: plugin cache\n", __FILE__);
+
+  string path = "/tmp/libecasound_tester-plugin-cache-" + kvu_numtostr(static_cast<int>(getpid()));
+  std::remove(path.c_str());
+
+  vector<ECA_PLUGIN_CACHE::PLUGIN_INFO> infos;
+  infos.push_back(test_plugin());
+
+  /* case: store and reload */
+  {
+    ECA_PLUGIN_CACHE cache;
+    if (cache.load(path) == true)
+      ECA_TEST_FAILURE("loaded a nonexistent cache");
+
+    cache.update("/plugins/a.so", 100, 2000, infos);
+    cache.update("/plugins/b.so", 5, 6, vector<ECA_PLUGIN_CACHE::PLUGIN_INFO>());
+    if (cache.is_modified() != true || cache.save() != true)
+      ECA_TEST_FAILURE("unable to save cache");
+  }
+
+  {
+    ECA_PLUGIN_CACHE cache;
+    if (cache.load(path) != true || cache.file_count() != 2)
+      ECA_TEST_FAILURE("unable to reload cache");
+
+    if (cache.is_current("/plugins/a.so", 100, 2000) != true)
+      ECA_TEST_FAILURE("unchanged file not current");
+
+    const vector<ECA_PLUGIN_CACHE::PLUGIN_INFO>& loaded = cache.plugins("/plugins/a.so");
+    ECA_PLUGIN_CACHE::PLUGIN_INFO ref = test_plugin();
+    if (loaded.size() != 1 ||
+	loaded[0].index != ref.index ||
+	loaded[0].unique_number != ref.unique_number ||
+	loaded[0].unique != ref.unique ||
+	loaded[0].name != ref.name ||
+	loaded[0].maker != ref.maker ||
+	loaded[0].in_audio_ports != ref.in_audio_ports ||
+	loaded[0].out_audio_ports != ref.out_audio_ports ||
+	loaded[0].params.size() != ref.params.size()) {
+      ECA_TEST_FAILURE("plugin information not preserved");
+    }
+    else {
+      for(size_t n = 0; n < ref.params.size(); n++) {
+	const OPERATOR::PARAM_DESCRIPTION& a = loaded[0].params[n];
+	const OPERATOR::PARAM_DESCRIPTION& b = ref.params[n];
+	if (a.description != b.description ||
+	    a.default_value != b.default_value ||
+	    a.bounded_below != b.bounded_below ||
+	    (a.bounded_below == true && a.lower_bound != b.lower_bound) ||
+	    a.bounded_above != b.bounded_above ||
+	    (a.bounded_above == true && a.upper_bound != b.upper_bound) ||
+	    a.toggled != b.toggled ||
+	    a.integer != b.integer ||
+	    a.logarithmic != b.logarithmic ||
+	    a.output != b.output) {
+	  ECA_TEST_FAILURE("parameter information not preserved");
+	}
+      }
+    }
+
+    /* case: changed and removed files */
+    if (cache.is_current("/plugins/b.so", 5, 7) == true)
+      ECA_TEST_FAILURE("changed file reported as current");
+
+    if (cache.is_modified() != true)
+      ECA_TEST_FAILURE("unseen file not detected");
+
+    cache.save();
+  }
+
+  {
+    ECA_PLUGIN_CACHE cache;
+    if (cache.load(path) != true || cache.file_count() != 1)
+      ECA_TEST_FAILURE("unseen file not dropped");
+  }
+
+  /* case: plugin object from cached information */
+  {
+    EFFECT_LADSPA proto ("/nonexistent/plugin.so", infos[0]);
+    if (proto.unique() != "test_label" ||
+	proto.unique_number() != 1234 ||
+	proto.number_of_params() != 2 ||
+	proto.get_parameter_name(1) != "Gain (dB)" ||
+	proto.get_parameter(1) != static_cast<LADSPA_Data>(infos[0].params[0].default_value) ||
+	proto.output_channels(2) != 1) {
+      ECA_TEST_FAILURE("cached EFFECT_LADSPA metadata");
+    }
+
+    bool failed = false;
+    try {
+      EFFECT_LADSPA* obj = proto.new_expr();
+      delete obj;
+    }
+    catch(ECA_ERROR& e) { failed = true; }
+    if (failed != true)
+      ECA_TEST_FAILURE("missing plugin file not detected");
+  }
+
+  std::remove(path.c_str());
+}
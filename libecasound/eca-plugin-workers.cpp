@@ -0,0 +1,323 @@
+// ------------------------------------------------------------------------
+// eca-plugin-workers.cpp: Thread pool for running plugin instances
+// Copyright (C) 2026 agent
+//
+// Attributes:
+//     eca-style-version: 3
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
+// ------------------------------------------------------------------------
+
+#include <cstdlib> /* atoi() */
+#include <sched.h>
+
+#include <kvu_dbc.h>
+#include <kvu_locks.h>
+#include <kvu_numtostr.h>
+#include <kvu_timestamp.h>
+
+#include "eca-plugin-workers.h"
+#include "eca-resources.h"
+#include "eca-rt-checker.h"
+#include "eca-logger.h"
+#include "eca-thread-affinity.h"
+
+const double ECA_PLUGIN_WORKERS::parallel_threshold_usecs = 100.0;
+
+pthread_mutex_t ECA_PLUGIN_WORKERS::users_lock_rep = PTHREAD_MUTEX_INITIALIZER;
+pthread_mutex_t ECA_PLUGIN_WORKERS::run_lock_rep = PTHREAD_MUTEX_INITIALIZER;
+int ECA_PLUGIN_WORKERS::users_rep = 0;
+int ECA_PLUGIN_WORKERS::thread_count_rep = 0;
+bool ECA_PLUGIN_WORKERS::thread_count_set_rep = false;
+
+std::vector<ECA_PLUGIN_WORKERS::WORKER*> ECA_PLUGIN_WORKERS::workers_rep;
+volatile int ECA_PLUGIN_WORKERS::worker_count_rep = 0;
+sem_t ECA_PLUGIN_WORKERS::done_sem_rep;
+volatile bool ECA_PLUGIN_WORKERS::exit_rep = false;
+
+ECA_PLUGIN_WORKERS::job_t ECA_PLUGIN_WORKERS::job_rep = 0;
+void* ECA_PLUGIN_WORKERS::arg_rep = 0;
+int ECA_PLUGIN_WORKERS::items_rep = 0;
+int ECA_PLUGIN_WORKERS::next_item_rep = 0;
+int ECA_PLUGIN_WORKERS::sched_policy_rep = SCHED_OTHER;
+struct sched_param ECA_PLUGIN_WORKERS::sched_param_rep;
+
+/**
+ * Registers a user of the pool. Starts the worker
+ * threads if this is the first user.
+ *
+ * Not realtime-safe.
+ */
+void ECA_PLUGIN_WORKERS::acquire(void)
+{
+  KVU_GUARD_LOCK guard(&ECA_PLUGIN_WORKERS::users_lock_rep);
+
+  if (users_rep++ == 0)
+    start_threads();
+}
+
+/**
+ * Unregisters a user of the pool. Stops the worker
+ * threads when the last user is gone.
+ *
+ * Not realtime-safe.
+ */
+void ECA_PLUGIN_WORKERS::release(void)
+{
+  KVU_GUARD_LOCK guard(&ECA_PLUGIN_WORKERS::users_lock_rep);
+
+  DBC_CHECK(users_rep > 0);
+  if (--users_rep == 0)
+    stop_threads();
+}
+
+/**
+ * Number of worker threads used when the pool is
+ * started. Unless set with set_thread_count(), the
+ * value is read from ecasoundrc.
+ */
+int ECA_PLUGIN_WORKERS::thread_count(void)
+{
+  if (thread_count_set_rep != true) {
+    ECA_RESOURCES ecarc;
+    int threads = std::atoi(ecarc.resource("plugin-worker-threads").c_str());
+    thread_count_rep = (threads > 0) ? threads : 0;
+    thread_count_set_rep = true;
+  }
+  return thread_count_rep;
+}
+
+/**
+ * Sets the number of worker threads. Takes effect
+ * the next time the pool is started.
+ */
+void ECA_PLUGIN_WORKERS::set_thread_count(int threads)
+{
+  thread_count_rep = (threads > 0) ? threads : 0;
+  thread_count_set_rep = true;
+}
+
+/**
+ * Runs 'items' plugin instances by calling 'job'
+ * for each of them. Instances are run in parallel
+ * if worker threads are available and the measured
+ * per-instance cost in 'load' exceeds
+ * 'parallel_threshold_usecs'. Otherwise they are run
+ * in order in the calling thread.
+ *
+ * Realtime-safe.
+ */
+void ECA_PLUGIN_WORKERS::run_instances(job_t job, void* arg, int items, LOAD_ESTIMATE* load)
+{
+  if (items < 2 || worker_count_rep == 0) {
+    for(int n = 0; n < items; n++)
+      job(arg, n);
+    return;
+  }
+
+  struct timespec start, end;
+  kvu_clock_gettime(&start);
+
+  int threads = 1;
+  if (load->parallel == true &&
+      run(job, arg, items) == true) {
+    threads = worker_count_rep + 1;
+    if (threads > items) threads = items;
+  }
+  else {
+    for(int n = 0; n < items; n++)
+      job(arg, n);
+  }
+
+  kvu_clock_gettime(&end);
+
+  /* note: estimate is smoothed to ignore single slow blocks,
+   *       and has hysteresis to avoid toggling between modes */
+  double usecs =
+    (kvu_timespec_seconds(&end) - kvu_timespec_seconds(&start)) * 1000000.0 * threads / items;
+  if (load->instance_usecs < 0.0)
+    load->instance_usecs = usecs;
+  else
+    load->instance_usecs = 0.9 * load->instance_usecs + 0.1 * usecs;
+
+  if (load->instance_usecs > parallel_threshold_usecs)
+    load->parallel = true;
+  else if (load->instance_usecs < parallel_threshold_usecs / 2)
+    load->parallel = false;
+}
+
+/**
+ * Runs 'items' plugin instances using all worker
+ * threads and the calling thread. Returns once all
+ * instances have been run.
+ *
+ * Returns false without running anything if no workers
+ * are available, or if the pool is in use by another
+ * thread.
+ *
+ * Realtime-safe.
+ */
+bool ECA_PLUGIN_WORKERS::run(job_t job, void* arg, int items)
+{
+  if (pthread_mutex_trylock(&run_lock_rep) != 0)
+    return false;
+
+  int workers = worker_count_rep;
+  if (workers == 0 || items < 2) {
+    pthread_mutex_unlock(&run_lock_rep);
+    return false;
+  }
+  if (workers > items - 1) workers = items - 1;
+
+  pthread_getschedparam(pthread_self(), &sched_policy_rep, &sched_param_rep);
+
+  job_rep = job;
+  arg_rep = arg;
+  items_rep = items;
+  next_item_rep = 0;
+  __sync_synchronize();
+
+  for(int n = 0; n < workers; n++) {
+    sem_post(&workers_rep[n]->start_sem);
+  }
+
+  run_jobs();
+
+  for(int n = 0; n < workers; n++) {
+    while(sem_wait(&done_sem_rep) != 0) ; /* EINTR */
+  }
+  __sync_synchronize();
+
+  pthread_mutex_unlock(&run_lock_rep);
+  return true;
+}
+
+/**
+ * Runs unclaimed instances of the current job until
+ * none are left.
+ */
+void ECA_PLUGIN_WORKERS::run_jobs(void)
+{
+  while(true) {
+    int item = __sync_fetch_and_add(&next_item_rep, 1);
+    if (item >= items_rep) break;
+    job_rep(arg_rep, item);
+  }
+}
+
+/**
+ * Main loop of worker threads.
+ */
+void* ECA_PLUGIN_WORKERS::worker_thread(void* arg)
+{
+  WORKER* worker = static_cast<WORKER*>(arg);
+  ECA_THREAD_AFFINITY::apply("worker");
+
+  int policy = SCHED_OTHER;
+  struct sched_param param;
+  pthread_getschedparam(pthread_self(), &policy, &param);
+
+  while(true) {
+    if (sem_wait(&worker->start_sem) != 0) continue; /* EINTR */
+    if (exit_rep == true) break;
+
+    if (policy != sched_policy_rep ||
+	param.sched_priority != sched_param_rep.sched_priority) {
+      policy = sched_policy_rep;
+      param = sched_param_rep;
+      pthread_setschedparam(pthread_self(), policy, &param);
+    }
+
+    {
+      ECA_RT_CHECKER_SCOPE rt_section;
+      run_jobs();
+    }
+    sem_post(&done_sem_rep);
+  }
+
+  return 0;
+}
+
+/**
+ * Starts the worker threads. The realtime paths only
+ * look at 'worker_count_rep', which is published under
+ * 'run_lock_rep' once all threads are running.
+ */
+void ECA_PLUGIN_WORKERS::start_threads(void)
+{
+  DBC_CHECK(workers_rep.size() == 0);
+  DBC_CHECK(worker_count_rep == 0);
+
+  int threads = thread_count();
+  if (threads == 0)
+    return;
+
+  sem_init(&done_sem_rep, 0, 0);
+  exit_rep = false;
+  std::vector<WORKER*> workers;
+  for(int n = 0; n < threads; n++) {
+    WORKER* worker = new WORKER;
+    sem_init(&worker->start_sem, 0, 0);
+    if (pthread_create(&worker->thread, 0, worker_thread, static_cast<void*>(worker)) != 0) {
+      ECA_LOG_MSG(ECA_LOGGER::info,
+		  "WARNING: Unable to create plugin worker thread, using " +
+		  kvu_numtostr(n) + " workers.");
+      sem_destroy(&worker->start_sem);
+      delete worker;
+      break;
+    }
+    workers.push_back(worker);
+  }
+
+  if (workers.size() == 0) {
+    sem_destroy(&done_sem_rep);
+    return;
+  }
+
+  {
+    KVU_GUARD_LOCK guard(&ECA_PLUGIN_WORKERS::run_lock_rep);
+    workers_rep.swap(workers);
+    __sync_synchronize();
+    worker_count_rep = static_cast<int>(workers_rep.size());
+  }
+
+  ECA_LOG_MSG(ECA_LOGGER::system_objects,
+	      "started " + kvu_numtostr(workers_rep.size()) + " plugin worker threads");
+}
+
+void ECA_PLUGIN_WORKERS::stop_threads(void)
+{
+  if (workers_rep.size() == 0)
+    return;
+
+  /* note: holding the lock keeps run() from using
+   *       the workers while they exit */
+  KVU_GUARD_LOCK guard(&ECA_PLUGIN_WORKERS::run_lock_rep);
+
+  worker_count_rep = 0;
+  exit_rep = true;
+  __sync_synchronize();
+
+  for(size_t n = 0; n < workers_rep.size(); n++) {
+    sem_post(&workers_rep[n]->start_sem);
+  }
+  for(size_t n = 0; n < workers_rep.size(); n++) {
+    pthread_join(workers_rep[n]->thread, 0);
+    sem_destroy(&workers_rep[n]->start_sem);
+    delete workers_rep[n];
+  }
+  sem_destroy(&done_sem_rep);
+  workers_rep.clear();
+}
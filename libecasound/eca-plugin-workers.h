@@ -0,0 +1,97 @@
+#ifndef INCLUDED_ECA_PLUGIN_WORKERS_H
+#define INCLUDED_ECA_PLUGIN_WORKERS_H
+
+#include <vector>
+#include <pthread.h>
+#include <semaphore.h>
+
+/**
+ * Process-wide pool of threads for running independent
+ * plugin instances in parallel.
+ *
+ * Plugin hosts that instantiate one plugin per channel
+ * register with acquire() when initialized. The pool
+ * threads are started by the first user and stopped
+ * when the last user calls release(). The number of
+ * threads is set with the 'plugin-worker-threads'
+ * ecasoundrc option (default: 0, meaning no parallel
+ * processing).
+ *
+ * run_instances() is realtime-safe. Workers adopt the
+ * scheduling policy and priority of the thread calling
+ * run_instances().
+ *
+ * @author agent
+ */
+class ECA_PLUGIN_WORKERS {
+
+ public:
+
+  /**
+   * Function that runs plugin instance 'item' of 'arg'.
+   */
+  typedef void (*job_t)(void* arg, int item);
+
+  /**
+   * Running estimate of the time one plugin instance
+   * takes to process a block. Each host object keeps
+   * its own estimate.
+   */
+  struct LOAD_ESTIMATE {
+    LOAD_ESTIMATE(void) : instance_usecs(-1.0), parallel(false) { }
+    double instance_usecs;
+    bool parallel;
+  };
+
+  /**
+   * Per-instance processing time, in microseconds, above
+   * which instances are spread across worker threads.
+   */
+  static const double parallel_threshold_usecs;
+
+  static void acquire(void);
+  static void release(void);
+
+  static void run_instances(job_t job, void* arg, int items, LOAD_ESTIMATE* load);
+  static bool run(job_t job, void* arg, int items);
+
+  static int thread_count(void);
+  static void set_thread_count(int threads);
+
+ private:
+
+  struct WORKER {
+    pthread_t thread;
+    sem_t start_sem;
+  };
+
+  static void* worker_thread(void* arg);
+  static void run_jobs(void);
+  static void start_threads(void);
+  static void stop_threads(void);
+
+  static pthread_mutex_t users_lock_rep;
+  static pthread_mutex_t run_lock_rep;
+  static int users_rep;
+  static int thread_count_rep;
+  static bool thread_count_set_rep;
+
+  static std::vector<WORKER*> workers_rep;
+  static volatile int worker_count_rep;
+  static sem_t done_sem_rep;
+  static volatile bool exit_rep;
+
+  static job_t job_rep;
+  static void* arg_rep;
+  static int items_rep;
+  static int next_item_rep;
+  static int sched_policy_rep;
+  static struct sched_param sched_param_rep;
+
+  ECA_PLUGIN_WORKERS(void);
+  ECA_PLUGIN_WORKERS(const ECA_PLUGIN_WORKERS&);
+  ECA_PLUGIN_WORKERS& operator=(const ECA_PLUGIN_WORKERS&);
+  ~ECA_PLUGIN_WORKERS(void);
+};
+
+#endif
@@ -0,0 +1,477 @@
+// ------------------------------------------------------------------------
+// eca-resampler.cpp: Windowed-sinc polyphase resampler
+// Copyright (C) 2026 agent
+//
+// Attributes:
+//     eca-style-version: 3
+//
+// References:
+//   - J.O. Smith, "Digital Audio Resampling Home Page"
+//     https://ccrma.stanford.edu/~jos/resample/
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
+// ------------------------------------------------------------------------
+
+#include <cmath>
+#include <cstring> /* memmove() */
+
+#include <kvu_dbc.h>
+#include <kvu_locks.h>
+
+#include "eca-resampler.h"
+
+/* number of precomputed phases between two input samples */
+static const int resampler_phases = 256;
+
+/* minimum supported ratio (to/from) with full anti-aliasing */
+static const int resampler_min_bucket = ECA_RESAMPLER_KERNEL::cutoff_buckets / 8;
+
+/* taps on each side, and passband edge, per quality level */
+static const int resampler_half_taps[] = { 8, 16, 24, 32 };
+static const double resampler_rolloff[] = { 0.85, 0.90, 0.93, 0.95 };
+
+/**
+ * Maps resampling quality (0-100) to one of the four
+ * precomputed filter lengths.
+ */
+int ECA_RESAMPLER_KERNEL::quality_to_level(int quality)
+{
+  if (quality <= 25) return 0;
+  if (quality <= 50) return 1;
+  if (quality <= 75) return 2;
+  return 3;
+}
+
+/**
+ * Maps resampling ratio (to/from) to a cutoff bucket.
+ * Upsampling always uses the full input bandwidth,
+ * downsampling is band-limited to the output Nyquist
+ * frequency. Rounding is done downwards so the filter
+ * never lets through more than the output can represent.
+ */
+int ECA_RESAMPLER_KERNEL::ratio_to_cutoff_bucket(double ratio)
+{
+  if (ratio >= 1.0) return cutoff_buckets;
+  int bucket = static_cast<int>(std::floor(ratio * cutoff_buckets));
+  if (bucket < resampler_min_bucket) bucket = resampler_min_bucket;
+  return bucket;
+}
+
+ECA_RESAMPLER_KERNEL::ECA_RESAMPLER_KERNEL(int quality_level, int cutoff_bucket)
+  : refcount_rep(0),
+    quality_level_rep(quality_level),
+    cutoff_bucket_rep(cutoff_bucket),
+    phases_rep(resampler_phases)
+{
+  DBC_REQUIRE(quality_level >= 0 && quality_level <= 3);
+  DBC_REQUIRE(cutoff_bucket >= resampler_min_bucket && cutoff_bucket <= cutoff_buckets);
+
+  /* the filter is stretched in time by the decimation
+   * factor, so that stopband attenuation is retained
+   * also when downsampling */
+  int half = (resampler_half_taps[quality_level] * cutoff_buckets + cutoff_bucket - 1) / cutoff_bucket;
+  taps_rep = half * 2;
+
+  double fc = 0.5 * resampler_rolloff[quality_level] * cutoff_bucket / cutoff_buckets;
+
+  bank_rep.resize((phases_rep + 1) * taps_rep);
+  for(int p = 0; p <= phases_rep; p++) {
+    double frac = static_cast<double>(p) / phases_rep;
+    sample_t* coefs = &bank_rep[p * taps_rep];
+    double sum = 0.0;
+    for(int k = 0; k < taps_rep; k++) {
+      /* distance from output position to the input sample */
+      double d = k - half + 1 - frac;
+      double x = 2.0 * fc * d;
+      double sinc = (std::fabs(x) < 1e-9) ? 1.0 : std::sin(M_PI * x) / (M_PI * x);
+      double w = 0.0;
+      if (std::fabs(d) < half) {
+	w = 0.42 + 0.5 * std::cos(M_PI * d / half) + 0.08 * std::cos(2.0 * M_PI * d / half);
+      }
+      coefs[k] = 2.0 * fc * sinc * w;
+      sum += coefs[k];
+    }
+    /* normalize to unity gain at DC */
+    for(int k = 0; k < taps_rep; k++) {
+      coefs[k] /= sum;
+    }
+  }
+}
+
+ECA_RESAMPLER_KERNEL_CACHE::kernel_map_t* ECA_RESAMPLER_KERNEL_CACHE::kernels_repp = 0;
+pthread_mutex_t ECA_RESAMPLER_KERNEL_CACHE::lock_rep = PTHREAD_MUTEX_INITIALIZER;
+
+/**
+ * Returns a kernel for resampling from 'from_rate' to
+ * 'to_rate' with quality 'quality' (0-100). The kernel
+ * must be returned with release().
+ */
+const ECA_RESAMPLER_KERNEL* ECA_RESAMPLER_KERNEL_CACHE::acquire(SAMPLE_SPECS::sample_rate_t from_rate,
+								SAMPLE_SPECS::sample_rate_t to_rate,
+								int quality)
+{
+  DBC_REQUIRE(from_rate > 0);
+  DBC_REQUIRE(to_rate > 0);
+  return acquire(static_cast<double>(to_rate) / from_rate, quality);
+}
+
+/**
+ * Returns a kernel for resampling by 'ratio' (to/from) 
+ * with quality 'quality' (0-100). The kernel must be 
+ * returned with release().
+ */
+const ECA_RESAMPLER_KERNEL* ECA_RESAMPLER_KERNEL_CACHE::acquire(double ratio, int quality)
+{
+  DBC_REQUIRE(ratio > 0.0);
+
+  std::pair<int,int> key (ECA_RESAMPLER_KERNEL::quality_to_level(quality),
+			  ECA_RESAMPLER_KERNEL::ratio_to_cutoff_bucket(ratio));
+
+  KVU_GUARD_LOCK guard(&ECA_RESAMPLER_KERNEL_CACHE::lock_rep);
+
+  if (kernels_repp == 0) {
+    kernels_repp = new kernel_map_t();
+  }
+
+  ECA_RESAMPLER_KERNEL* kernel = 0;
+  kernel_map_t::iterator p = kernels_repp->find(key);
+  if (p == kernels_repp->end()) {
+    kernel = new ECA_RESAMPLER_KERNEL(key.first, key.second);
+    (*kernels_repp)[key] = kernel;
+  }
+  else {
+    kernel = p->second;
+  }
+  ++kernel->refcount_rep;
+
+  return kernel;
+}
+
+/**
+ * Releases a kernel returned by acquire().
+ */
+void ECA_RESAMPLER_KERNEL_CACHE::release(const ECA_RESAMPLER_KERNEL* kernel)
+{
+  DBC_REQUIRE(kernel != 0);
+
+  KVU_GUARD_LOCK guard(&ECA_RESAMPLER_KERNEL_CACHE::lock_rep);
+
+  DBC_CHECK(kernels_repp != 0);
+  kernel_map_t::iterator p = 
+    kernels_repp->find(std::pair<int,int>(kernel->quality_level(), kernel->cutoff_bucket()));
+  DBC_CHECK(p != kernels_repp->end() && p->second == kernel);
+  if (p != kernels_repp->end()) {
+    DBC_CHECK(p->second->refcount_rep > 0);
+    if (--p->second->refcount_rep == 0) {
+      delete p->second;
+      kernels_repp->erase(p);
+    }
+  }
+}
+
+/**
+ * Returns the number of kernels currently in use.
+ */
+size_t ECA_RESAMPLER_KERNEL_CACHE::kernel_count(void)
+{
+  KVU_GUARD_LOCK guard(&ECA_RESAMPLER_KERNEL_CACHE::lock_rep);
+  return (kernels_repp == 0) ? 0 : kernels_repp->size();
+}
+
+/**
+ * Returns the amount of memory used by filter tables.
+ */
+size_t ECA_RESAMPLER_KERNEL_CACHE::memory_in_bytes(void)
+{
+  KVU_GUARD_LOCK guard(&ECA_RESAMPLER_KERNEL_CACHE::lock_rep);
+  size_t bytes = 0;
+  if (kernels_repp != 0) {
+    for(kernel_map_t::const_iterator p = kernels_repp->begin(); p != kernels_repp->end(); p++) {
+      bytes += p->second->memory_in_bytes();
+    }
+  }
+  return bytes;
+}
+
+ECA_RESAMPLER::ECA_RESAMPLER(void)
+  : channels_rep(0),
+    quality_rep(50),
+    keep_half_rep(0),
+    capacity_rep(0),
+    fill_rep(0),
+    pos_rep(0.0),
+    latency_rep(0),
+    kernel_repp(0)
+{
+}
+
+ECA_RESAMPLER::~ECA_RESAMPLER(void)
+{
+  release();
+}
+
+/**
+ * Prepares the resampler for processing 'channels' channels,
+ * with at most 'max_input' frames per process() call.
+ * Resets stream state.
+ *
+ * Not realtime-safe.
+ */
+void ECA_RESAMPLER::init(int channels, long int max_input, double ratio, int quality)
+{
+  DBC_REQUIRE(channels >= 0);
+  DBC_REQUIRE(ratio > 0.0);
+
+  if (ECA_RESAMPLER_KERNEL::quality_to_level(quality) !=
+      ECA_RESAMPLER_KERNEL::quality_to_level(quality_rep)) {
+    release();
+  }
+  quality_rep = quality;
+  channels_rep = channels;
+  capacity_rep = 0;
+  fill_rep = 0;
+  pos_rep = 0.0;
+  history_rep.resize(channels);
+
+  prepare_ratio(ratio);
+  select_kernel(find_kernel(ECA_RESAMPLER_KERNEL::ratio_to_cutoff_bucket(ratio)));
+
+  if (max_input > capacity_rep - keep_half_rep * 2) {
+    capacity_rep = keep_half_rep * 2 + max_input;
+    for(int c = 0; c < channels_rep; c++) {
+      history_rep[c].resize(capacity_rep);
+    }
+  }
+
+  reset();
+
+  DBC_ENSURE(is_initialized() == true);
+}
+
+/**
+ * Makes sure a filter bank for resampling at 'ratio' is
+ * available to process(). Can be used to prepare for
+ * ratio changes that happen later in realtime context.
+ *
+ * Not realtime-safe.
+ */
+void ECA_RESAMPLER::prepare_ratio(double ratio)
+{
+  int bucket = ECA_RESAMPLER_KERNEL::ratio_to_cutoff_bucket(ratio);
+  const ECA_RESAMPLER_KERNEL* kernel = find_kernel(bucket);
+  if (kernel == 0) {
+    kernel = ECA_RESAMPLER_KERNEL_CACHE::acquire(ratio, quality_rep);
+    kernels_rep.push_back(kernel);
+  }
+
+  int half = kernel->half_taps();
+  if (half > keep_half_rep) {
+    /* grow the kept history at the front so that the
+     * longer filter has enough past samples */
+    int delta = half - keep_half_rep;
+    long int input_space = capacity_rep - keep_half_rep * 2;
+    if (input_space < 0) input_space = 0;
+    capacity_rep = half * 2 + input_space;
+    for(int c = 0; c < channels_rep; c++) {
+      history_rep[c].resize(capacity_rep);
+      std::memmove(&history_rep[c][delta], &history_rep[c][0], fill_rep * sizeof(sample_t));
+      for(int n = 0; n < delta; n++) history_rep[c][n] = SAMPLE_SPECS::silent_value;
+    }
+    fill_rep += delta;
+    pos_rep += delta;
+    keep_half_rep = half;
+  }
+
+  if (static_cast<int>(coefs_rep.size()) < kernel->taps()) {
+    coefs_rep.resize(kernel->taps());
+  }
+}
+
+/**
+ * Clears the stream history.
+ */
+void ECA_RESAMPLER::reset(void)
+{
+  DBC_REQUIRE(is_initialized() == true);
+
+  /* prefill so that the first call produces a full
+   * block of output; the cost is a constant delay of
+   * 'latency()' input samples */
+  int half = kernel_repp->half_taps();
+  fill_rep = keep_half_rep - 1 + half;
+  pos_rep = keep_half_rep - 1;
+  latency_rep = half;
+  for(int c = 0; c < channels_rep; c++) {
+    for(long int n = 0; n < fill_rep; n++) history_rep[c][n] = SAMPLE_SPECS::silent_value;
+  }
+}
+
+/**
+ * Returns the delay, in input samples, added by the resampler.
+ */
+long int ECA_RESAMPLER::latency(void) const
+{
+  return latency_rep;
+}
+
+const ECA_RESAMPLER_KERNEL* ECA_RESAMPLER::find_kernel(int cutoff_bucket) const
+{
+  for(size_t n = 0; n < kernels_rep.size(); n++) {
+    if (kernels_rep[n]->cutoff_bucket() == cutoff_bucket) return kernels_rep[n];
+  }
+  return 0;
+}
+
+void ECA_RESAMPLER::select_kernel(const ECA_RESAMPLER_KERNEL* kernel)
+{
+  DBC_CHECK(kernel == 0 || kernel->half_taps() <= keep_half_rep);
+  if (kernel != 0) kernel_repp = kernel;
+}
+
+/**
+ * Returns all filter banks to the kernel cache.
+ * Call init() before using the resampler again.
+ *
+ * Not realtime-safe.
+ */
+void ECA_RESAMPLER::release(void)
+{
+  for(size_t n = 0; n < kernels_rep.size(); n++) {
+    ECA_RESAMPLER_KERNEL_CACHE::release(kernels_rep[n]);
+  }
+  kernels_rep.clear();
+  kernel_repp = 0;
+  keep_half_rep = 0;
+  fill_rep = 0;
+  pos_rep = 0.0;
+}
+
+/**
+ * Inner product of two vectors. Written with independent
+ * partial sums so that the compiler can vectorize the loop.
+ */
+static inline SAMPLE_SPECS::sample_t priv_dot_product(const SAMPLE_SPECS::sample_t* a,
+						      const SAMPLE_SPECS::sample_t* b,
+						      int len)
+{
+  SAMPLE_SPECS::sample_t s0 = 0, s1 = 0, s2 = 0, s3 = 0;
+  int n = 0;
+  for(; n + 4 <= len; n += 4) {
+    s0 += a[n] * b[n];
+    s1 += a[n + 1] * b[n + 1];
+    s2 += a[n + 2] * b[n + 2];
+    s3 += a[n + 3] * b[n + 3];
+  }
+  for(; n < len; n++) {
+    s0 += a[n] * b[n];
+  }
+  return (s0 + s1) + (s2 + s3);
+}
+
+/**
+ * Resamples 'input_frames' frames from the first 'channels'
+ * channels of 'buffers' by 'ratio' (to/from), and writes the 
+ * result back to 'buffers'.
+ * Returns the number of frames written, which is at
+ * most 'max_output_frames'. Input that is not consumed
+ * because the output limit was reached is kept, and
+ * resampled by the next call.
+ *
+ * If 'channels' is less than channels(), the remaining
+ * channels are fed silence, so that they stay aligned
+ * with the others.
+ *
+ * Input is consumed before output is written, so in-place
+ * operation is safe. If a filter bank for 'ratio' has
+ * not been prepared, the current bank is used.
+ *
+ * Realtime-safe as long as 'input_frames' does not
+ * exceed the size given to init().
+ */
+long int ECA_RESAMPLER::process(sample_t** buffers,
+				int channels,
+				long int input_frames,
+				long int max_output_frames,
+				double ratio)
+{
+  DBC_REQUIRE(is_initialized() == true);
+  DBC_REQUIRE(ratio > 0.0);
+  DBC_REQUIRE(channels <= channels_rep);
+
+  int bucket = ECA_RESAMPLER_KERNEL::ratio_to_cutoff_bucket(ratio);
+  if (bucket != kernel_repp->cutoff_bucket()) {
+    select_kernel(find_kernel(bucket));
+  }
+
+  if (fill_rep + input_frames > capacity_rep) {
+    /* note: not realtime-safe, init() was given a too small size */
+    DBC_CHECK(fill_rep + input_frames <= capacity_rep);
+    capacity_rep = fill_rep + input_frames;
+    for(int c = 0; c < channels_rep; c++) {
+      history_rep[c].resize(capacity_rep);
+    }
+  }
+
+  for(int c = 0; c < channels; c++) {
+    std::memcpy(&history_rep[c][fill_rep], buffers[c], input_frames * sizeof(sample_t));
+  }
+  for(int c = channels; c < channels_rep; c++) {
+    for(long int n = 0; n < input_frames; n++) 
+      history_rep[c][fill_rep + n] = SAMPLE_SPECS::silent_value;
+  }
+  fill_rep += input_frames;
+
+  const int taps = kernel_repp->taps();
+  const int half = kernel_repp->half_taps();
+  const int phases = kernel_repp->phases();
+  const double step = 1.0 / ratio;
+  sample_t* coefs = &coefs_rep[0];
+  long int last = fill_rep - 1 - half;
+  long int out = 0;
+
+  while(out < max_output_frames && static_cast<long int>(pos_rep) <= last) {
+    long int ipos = static_cast<long int>(pos_rep);
+    double phase = (pos_rep - ipos) * phases;
+    int p = static_cast<int>(phase);
+    sample_t a = phase - p;
+    const sample_t* r0 = kernel_repp->row(p);
+    const sample_t* r1 = kernel_repp->row(p + 1);
+
+    /* coefficients are shared by all channels */
+    for(int k = 0; k < taps; k++) {
+      coefs[k] = r0[k] + a * (r1[k] - r0[k]);
+    }
+
+    long int base = ipos - half + 1;
+    for(int c = 0; c < channels; c++) {
+      buffers[c][out] = priv_dot_product(coefs, &history_rep[c][base], taps);
+    }
+    ++out;
+    pos_rep += step;
+  }
+
+  /* drop history not needed by the next call */
+  long int drop = static_cast<long int>(pos_rep) - (keep_half_rep - 1);
+  if (drop > fill_rep) drop = fill_rep;
+  if (drop > 0) {
+    for(int c = 0; c < channels_rep; c++) {
+      std::memmove(&history_rep[c][0], &history_rep[c][drop], (fill_rep - drop) * sizeof(sample_t));
+    }
+    fill_rep -= drop;
+    pos_rep -= drop;
+  }
+
+  return out;
+}
@@ -0,0 +1,173 @@
+#ifndef INCLUDED_ECA_RESAMPLER_H
+#define INCLUDED_ECA_RESAMPLER_H
+
+#include <map>
+#include <vector>
+#include <pthread.h>
+
+#include "sample-specs.h"
+
+/**
+ * Immutable windowed-sinc (Blackman) filter bank for
+ * polyphase resampling.
+ *
+ * The bank holds 'phases() + 1' rows of 'taps()'
+ * coefficients. Row 'p' is the impulse response for an
+ * output position that lies 'p / phases()' input samples
+ * past the nearest preceding input sample. Coefficients
+ * for positions between two rows are interpolated
+ * linearly. Every row is normalized to unity DC gain.
+ *
+ * Once constructed, a kernel is only read, so it can
+ * be shared by any number of channels and streams.
+ * Kernels are created and owned by 
+ * ECA_RESAMPLER_KERNEL_CACHE.
+ *
+ * @author agent
+ */
+class ECA_RESAMPLER_KERNEL {
+
+ public:
+
+  friend class ECA_RESAMPLER_KERNEL_CACHE;
+
+  typedef SAMPLE_SPECS::sample_t sample_t;
+
+  int quality_level(void) const { return quality_level_rep; }
+  int cutoff_bucket(void) const { return cutoff_bucket_rep; }
+
+  /** Number of taps (always even) */
+  int taps(void) const { return taps_rep; }
+
+  /** Taps on each side of the output position */
+  int half_taps(void) const { return taps_rep / 2; }
+
+  int phases(void) const { return phases_rep; }
+  const sample_t* row(int phase) const { return &bank_rep[phase * taps_rep]; }
+
+  static int quality_to_level(int quality);
+  static int ratio_to_cutoff_bucket(double ratio);
+
+  /** Number of distinct cutoff frequencies */
+  static const int cutoff_buckets = 256;
+
+  size_t memory_in_bytes(void) const { return bank_rep.size() * sizeof(sample_t); }
+
+ private:
+
+  ECA_RESAMPLER_KERNEL(int quality_level, int cutoff_bucket);
+  ECA_RESAMPLER_KERNEL(const ECA_RESAMPLER_KERNEL&);
+  ECA_RESAMPLER_KERNEL& operator=(const ECA_RESAMPLER_KERNEL&);
+
+  int refcount_rep;
+  int quality_level_rep;
+  int cutoff_bucket_rep;
+  int taps_rep;
+  int phases_rep;
+  std::vector<sample_t> bank_rep;
+};
+
+/**
+ * Process-wide cache of resampler filter banks.
+ *
+ * Kernels are looked up by rate pair and quality, and
+ * shared read-only by all streams that resample with
+ * the same filter. Rate pairs that map to the same
+ * quality level and cutoff frequency (e.g. 48k->44.1k 
+ * and 96k->88.2k) share one kernel. A kernel is freed
+ * when the last stream releases it.
+ *
+ * All functions are thread-safe, but not realtime-safe.
+ *
+ * @author agent
+ */
+class ECA_RESAMPLER_KERNEL_CACHE {
+
+ public:
+
+  static const ECA_RESAMPLER_KERNEL* acquire(SAMPLE_SPECS::sample_rate_t from_rate,
+					     SAMPLE_SPECS::sample_rate_t to_rate,
+					     int quality);
+  static const ECA_RESAMPLER_KERNEL* acquire(double ratio, int quality);
+  static void release(const ECA_RESAMPLER_KERNEL* kernel);
+
+  static size_t kernel_count(void);
+  static size_t memory_in_bytes(void);
+
+ private:
+
+  typedef std::map<std::pair<int,int>, ECA_RESAMPLER_KERNEL*> kernel_map_t;
+
+  static kernel_map_t* kernels_repp;
+  static pthread_mutex_t lock_rep;
+
+  ECA_RESAMPLER_KERNEL_CACHE(void);
+  ECA_RESAMPLER_KERNEL_CACHE(const ECA_RESAMPLER_KERNEL_CACHE&);
+  ECA_RESAMPLER_KERNEL_CACHE& operator=(const ECA_RESAMPLER_KERNEL_CACHE&);
+  ~ECA_RESAMPLER_KERNEL_CACHE(void);
+};
+
+/**
+ * Streaming polyphase resampler for a set of channels
+ * sharing a common time base.
+ *
+ * All memory is allocated in init() and prepare_ratio();
+ * process() is realtime-safe. Filter banks come from
+ * ECA_RESAMPLER_KERNEL_CACHE and are shared with other
+ * resamplers; only the stream history is per-object.
+ * Filter coefficients for each output frame are computed
+ * once and applied to all channels.
+ *
+ * The resampler adds a constant delay of 'latency()'
+ * input samples.
+ *
+ * @author agent
+ */
+class ECA_RESAMPLER {
+
+ public:
+
+  typedef SAMPLE_SPECS::sample_t sample_t;
+
+  ECA_RESAMPLER(void);
+  ~ECA_RESAMPLER(void);
+
+  void init(int channels, long int max_input, double ratio, int quality);
+  void prepare_ratio(double ratio);
+  void reset(void);
+  void release(void);
+
+  long int process(sample_t** buffers,
+		   int channels,
+		   long int input_frames,
+		   long int max_output_frames,
+		   double ratio);
+
+  bool is_initialized(void) const { return kernel_repp != 0; }
+  int channels(void) const { return channels_rep; }
+  int quality(void) const { return quality_rep; }
+  long int latency(void) const;
+
+ private:
+
+  ECA_RESAMPLER(const ECA_RESAMPLER& x) { }
+  ECA_RESAMPLER& operator=(const ECA_RESAMPLER& x) { return *this; }
+
+  const ECA_RESAMPLER_KERNEL* find_kernel(int cutoff_bucket) const;
+  void select_kernel(const ECA_RESAMPLER_KERNEL* kernel);
+
+  int channels_rep;
+  int quality_rep;
+  int keep_half_rep;
+  long int capacity_rep;
+  long int fill_rep;
+  double pos_rep;
+  long int latency_rep;
+
+  const ECA_RESAMPLER_KERNEL* kernel_repp;
+  std::vector<const ECA_RESAMPLER_KERNEL*> kernels_rep;
+  std::vector<std::vector<sample_t> > history_rep;
+  std::vector<sample_t> coefs_rep;
+};
+
+#endif
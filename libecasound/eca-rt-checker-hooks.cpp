@@ -0,0 +1,190 @@
+// ------------------------------------------------------------------------
+// eca-rt-checker-hooks.cpp: Interposed allocation and blocking
+//                           functions for ECA_RT_CHECKER
+// Copyright (C) 2026 agent
+//
+// Attributes:
+//     eca-style-version: 3
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
+// ------------------------------------------------------------------------
+
+/**
+ * Replaces the allocator functions and a selection of
+ * blocking calls for the whole program. Each call is
+ * reported to ECA_RT_CHECKER and then passed on to the
+ * C library.
+ *
+ * Allocator functions are forwarded to the glibc
+ * internal entry points, as looking them up with
+ * dlsym() would itself allocate. Other functions are
+ * looked up with dlsym(RTLD_NEXT) on first use.
+ *
+ * Linked into libecasound_tester, and into libecasound
+ * when configured with '--enable-rt-checker'. Only
+ * supported with glibc.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE /* RTLD_NEXT */
+#endif
+
+#include <cerrno>
+#include <cstdlib> /* abort() */
+#include <cstddef>
+#include <dlfcn.h>
+#include <pthread.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "eca-rt-checker.h"
+
+#if defined(__GLIBC__)
+
+extern "C" {
+
+int eca_rt_checker_hooks = 1;
+
+extern void* __libc_malloc(size_t size);
+extern void* __libc_calloc(size_t nmemb, size_t size);
+extern void* __libc_realloc(void* ptr, size_t size);
+extern void* __libc_memalign(size_t alignment, size_t size);
+extern void __libc_free(void* ptr);
+
+static inline void rt_checker_hook(const char* call)
+{
+  if (ECA_RT_CHECKER::in_section() == true)
+    ECA_RT_CHECKER::violation(call);
+}
+
+static void* rt_checker_next(const char* name)
+{
+  void* func = ::dlsym(RTLD_NEXT, name);
+  if (func == 0) ::abort();
+  return func;
+}
+
+/* ---------------------------------------------------------------------
+ * Allocation
+ */
+
+void* malloc(size_t size) __THROW
+{
+  rt_checker_hook("malloc");
+  return __libc_malloc(size);
+}
+
+void* calloc(size_t nmemb, size_t size) __THROW
+{
+  rt_checker_hook("calloc");
+  return __libc_calloc(nmemb, size);
+}
+
+void* realloc(void* ptr, size_t size) __THROW
+{
+  rt_checker_hook("realloc");
+  return __libc_realloc(ptr, size);
+}
+
+void free(void* ptr) __THROW
+{
+  if (ptr != 0)
+    rt_checker_hook("free");
+  __libc_free(ptr);
+}
+
+void* memalign(size_t alignment, size_t size) __THROW
+{
+  rt_checker_hook("memalign");
+  return __libc_memalign(alignment, size);
+}
+
+void* aligned_alloc(size_t alignment, size_t size) __THROW
+{
+  rt_checker_hook("aligned_alloc");
+  return __libc_memalign(alignment, size);
+}
+
+int posix_memalign(void** memptr, size_t alignment, size_t size) __THROW
+{
+  rt_checker_hook("posix_memalign");
+  if (alignment % sizeof(void*) != 0 ||
+      (alignment & (alignment - 1)) != 0)
+    return EINVAL;
+
+  void* ptr = __libc_memalign(alignment, size);
+  if (ptr == 0)
+    return ENOMEM;
+
+  *memptr = ptr;
+  return 0;
+}
+
+/* ---------------------------------------------------------------------
+ * Blocking calls
+ */
+
+int nanosleep(const struct timespec* req, struct timespec* rem)
+{
+  typedef int (*func_t)(const struct timespec*, struct timespec*);
+  static func_t next = 0;
+  if (next == 0) next = reinterpret_cast<func_t>(rt_checker_next("nanosleep"));
+  rt_checker_hook("nanosleep");
+  return next(req, rem);
+}
+
+int usleep(useconds_t usec)
+{
+  typedef int (*func_t)(useconds_t);
+  static func_t next = 0;
+  if (next == 0) next = reinterpret_cast<func_t>(rt_checker_next("usleep"));
+  rt_checker_hook("usleep");
+  return next(usec);
+}
+
+int pthread_mutex_lock(pthread_mutex_t* mutex) __THROW
+{
+  typedef int (*func_t)(pthread_mutex_t*);
+  static func_t next = 0;
+  if (next == 0) next = reinterpret_cast<func_t>(rt_checker_next("pthread_mutex_lock"));
+  rt_checker_hook("pthread_mutex_lock");
+  return next(mutex);
+}
+
+ssize_t read(int fd, void* buf, size_t count)
+{
+  typedef ssize_t (*func_t)(int, void*, size_t);
+  static func_t next = 0;
+  if (next == 0) next = reinterpret_cast<func_t>(rt_checker_next("read"));
+  rt_checker_hook("read");
+  return next(fd, buf, count);
+}
+
+ssize_t write(int fd, const void* buf, size_t count)
+{
+  typedef ssize_t (*func_t)(int, const void*, size_t);
+  static func_t next = 0;
+  if (next == 0) next = reinterpret_cast<func_t>(rt_checker_next("write"));
+  rt_checker_hook("write");
+  return next(fd, buf, count);
+}
+
+} /* extern "C" */
+
+#endif /* __GLIBC__ */
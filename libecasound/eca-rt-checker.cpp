@@ -0,0 +1,219 @@
+// ------------------------------------------------------------------------
+// eca-rt-checker.cpp: Checker for allocations and blocking calls in
+//                     realtime code paths
+// Copyright (C) 2026 agent
+//
+// Attributes:
+//     eca-style-version: 3
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
+// ------------------------------------------------------------------------
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <cstdlib> /* free() */
+
+#if defined(__GLIBC__)
+#include <execinfo.h> /* backtrace() */
+#endif
+
+#include <kvu_numtostr.h>
+
+#include "eca-rt-checker.h"
+
+/**
+ * Defined by eca-rt-checker-hooks.cpp, if linked in.
+ */
+extern "C" int eca_rt_checker_hooks __attribute__((weak));
+
+/**
+ * Recorded violation. Storage is static, so that
+ * recording does not allocate.
+ */
+struct ECA_RT_CHECKER_VIOLATION {
+  const char* call;
+  int frames;
+  void* trace[24];
+};
+
+static const long int rt_checker_max_violations = 64;
+static const int rt_checker_max_frames = 24;
+
+static ECA_RT_CHECKER_VIOLATION rt_checker_violations[rt_checker_max_violations];
+static long int rt_checker_count = 0;
+
+/* note: initial-exec TLS, so that accessing these from
+ *       malloc() does not allocate */
+static __thread int rt_checker_depth __attribute__((tls_model("initial-exec"))) = 0;
+static __thread int rt_checker_recording __attribute__((tls_model("initial-exec"))) = 0;
+
+bool ECA_RT_CHECKER::enabled_rep = false;
+
+/**
+ * Whether the interposed functions are linked in. If not,
+ * marking sections has no effect.
+ */
+bool ECA_RT_CHECKER::available(void)
+{
+  return (&eca_rt_checker_hooks != 0);
+}
+
+void ECA_RT_CHECKER::set_enabled(bool value)
+{
+#if defined(__GLIBC__)
+  if (value == true) {
+    /* note: first call of backtrace() loads the unwinder,
+     *       which allocates memory */
+    void* trace[2];
+    ::backtrace(trace, 2);
+  }
+#endif
+
+  enabled_rep = value;
+}
+
+/**
+ * Marks the start of a realtime section for the
+ * calling thread. Sections can be nested.
+ *
+ * Realtime-safe.
+ */
+void ECA_RT_CHECKER::enter(void)
+{
+  ++rt_checker_depth;
+}
+
+/**
+ * Marks the end of a realtime section for the
+ * calling thread.
+ *
+ * Realtime-safe.
+ */
+void ECA_RT_CHECKER::leave(void)
+{
+  if (rt_checker_depth > 0)
+    --rt_checker_depth;
+}
+
+/**
+ * Whether calling thread is inside a realtime
+ * section.
+ */
+bool ECA_RT_CHECKER::in_section(void)
+{
+  return (rt_checker_depth > 0 && rt_checker_recording == 0);
+}
+
+/**
+ * Leaves all realtime sections of the calling
+ * thread.
+ *
+ * @return section depth to pass to resume()
+ */
+int ECA_RT_CHECKER::suspend(void)
+{
+  int depth = rt_checker_depth;
+  rt_checker_depth = 0;
+  return depth;
+}
+
+/**
+ * Reenters sections left with suspend().
+ */
+void ECA_RT_CHECKER::resume(int depth)
+{
+  rt_checker_depth = depth;
+}
+
+/**
+ * Records a call to 'call' made inside a realtime
+ * section. Only the first 64 violations are stored
+ * with their stack traces, but all are counted.
+ *
+ * Does not allocate memory. 'call' must point to
+ * static storage.
+ */
+void ECA_RT_CHECKER::violation(const char* call)
+{
+  if (in_section() != true)
+    return;
+
+  rt_checker_recording = 1;
+
+  long int slot = __sync_fetch_and_add(&rt_checker_count, 1);
+  if (slot < rt_checker_max_violations) {
+    ECA_RT_CHECKER_VIOLATION* v = &rt_checker_violations[slot];
+    v->call = call;
+#if defined(__GLIBC__)
+    v->frames = ::backtrace(v->trace, rt_checker_max_frames);
+#else
+    v->frames = 0;
+#endif
+  }
+
+  rt_checker_recording = 0;
+}
+
+/**
+ * Number of violations recorded since the last clear().
+ */
+long int ECA_RT_CHECKER::violation_count(void)
+{
+  return __sync_fetch_and_add(&rt_checker_count, 0);
+}
+
+/**
+ * Returns a description of the recorded violations,
+ * including stack traces. Must not be called while
+ * sections are being run.
+ */
+std::string ECA_RT_CHECKER::report(void)
+{
+  long int count = violation_count();
+  std::string result =
+    kvu_numtostr(count) + " realtime violation(s)";
+
+  if (count > rt_checker_max_violations)
+    count = rt_checker_max_violations;
+
+  for(long int n = 0; n < count; n++) {
+    const ECA_RT_CHECKER_VIOLATION& v = rt_checker_violations[n];
+    result += "\n#" + kvu_numtostr(n + 1) + ": " + v.call + "()";
+
+#if defined(__GLIBC__)
+    char** symbols = ::backtrace_symbols(v.trace, v.frames);
+    if (symbols != 0) {
+      /* note: skip violation() and the interposed function */
+      for(int f = 2; f < v.frames; f++) {
+	result += "\n    ";
+	result += symbols[f];
+      }
+      std::free(symbols);
+    }
+#endif
+  }
+
+  return result;
+}
+
+/**
+ * Forgets all recorded violations.
+ */
+void ECA_RT_CHECKER::clear(void)
+{
+  __sync_lock_test_and_set(&rt_checker_count, 0);
+}
@@ -0,0 +1,111 @@
+#ifndef INCLUDED_ECA_RT_CHECKER_H
+#define INCLUDED_ECA_RT_CHECKER_H
+
+#include <string>
+
+/**
+ * Debug tool for catching heap allocations and blocking
+ * calls in realtime code paths.
+ *
+ * Code that must be realtime-safe is marked with
+ * ECA_RT_CHECKER_SCOPE. The engine marks engine_iteration()
+ * and the processing done by chain and plugin worker
+ * threads. If a thread calls an interposed function
+ * (malloc(), free(), nanosleep(), pthread_mutex_lock(),
+ * etc) while inside a marked section, the call is recorded
+ * together with a stack trace.
+ *
+ * The interposed functions are defined in
+ * eca-rt-checker-hooks.cpp, which is linked into
+ * libecasound_tester, and into libecasound when
+ * configured with '--enable-rt-checker'. Whether they are
+ * present can be queried with available(). Checking is
+ * enabled with set_enabled() (ecasoundrc option
+ * 'rt-checker').
+ *
+ * @author agent
+ */
+class ECA_RT_CHECKER {
+
+ public:
+
+  /** @name Configuration */
+  /*@{*/
+
+  static bool available(void);
+  static void set_enabled(bool value);
+  static bool enabled(void) { return enabled_rep; }
+
+  /*@}*/
+
+  /** @name Marking realtime sections */
+  /*@{*/
+
+  static void enter(void);
+  static void leave(void);
+  static bool in_section(void);
+  static int suspend(void);
+  static void resume(int depth);
+
+  /*@}*/
+
+  /** @name Violations */
+  /*@{*/
+
+  static void violation(const char* call);
+  static long int violation_count(void);
+  static std::string report(void);
+  static void clear(void);
+
+  /*@}*/
+
+ private:
+
+  static bool enabled_rep;
+
+  ECA_RT_CHECKER(void);
+  ECA_RT_CHECKER(const ECA_RT_CHECKER&);
+  ECA_RT_CHECKER& operator=(const ECA_RT_CHECKER&);
+  ~ECA_RT_CHECKER(void);
+};
+
+/**
+ * Marks the enclosing block as a realtime section.
+ * Does nothing if the checker is not enabled.
+ */
+class ECA_RT_CHECKER_SCOPE {
+
+ public:
+
+  ECA_RT_CHECKER_SCOPE(void) : active_rep(ECA_RT_CHECKER::enabled()) { if (active_rep == true) ECA_RT_CHECKER::enter(); }
+  ~ECA_RT_CHECKER_SCOPE(void) { if (active_rep == true) ECA_RT_CHECKER::leave(); }
+
+ private:
+
+  bool active_rep;
+
+  ECA_RT_CHECKER_SCOPE(const ECA_RT_CHECKER_SCOPE&);
+  ECA_RT_CHECKER_SCOPE& operator=(const ECA_RT_CHECKER_SCOPE&);
+};
+
+/**
+ * Suspends checking for the enclosing block. Used for
+ * calls that block by design, like I/O of realtime
+ * devices that drive the engine.
+ */
+class ECA_RT_CHECKER_PAUSE {
+
+ public:
+
+  ECA_RT_CHECKER_PAUSE(void) : depth_rep(ECA_RT_CHECKER::enabled() == true ? ECA_RT_CHECKER::suspend() : 0) { }
+  ~ECA_RT_CHECKER_PAUSE(void) { if (depth_rep > 0) ECA_RT_CHECKER::resume(depth_rep); }
+
+ private:
+
+  int depth_rep;
+
+  ECA_RT_CHECKER_PAUSE(const ECA_RT_CHECKER_PAUSE&);
+  ECA_RT_CHECKER_PAUSE& operator=(const ECA_RT_CHECKER_PAUSE&);
+};
+
+#endif
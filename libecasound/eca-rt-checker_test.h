@@ -0,0 +1,157 @@
+// ------------------------------------------------------------------------
+// eca-rt-checker_test.h: Unit test for ECA_RT_CHECKER
+// Copyright (C) 2026 agent
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
+// ------------------------------------------------------------------------
+
+#include <cstdio>
+#include <cstdlib>
+#include <list>
+#include <string>
+
+#include "eca-chainop.h"
+#include "eca-object-factory.h"
+#include "eca-object-map.h"
+#include "eca-rt-checker.h"
+#include "samplebuffer.h"
+#include "eca-test-case.h"
+
+using namespace std;
+
+/* note: volatile, so that the allocation is not optimized away */
+static void* volatile eca_rt_checker_test_ptr = 0;
+
+/**
+ * Unit test for ECA_RT_CHECKER.
+ *
+ * Also checks that the builtin chain operators
+ * do not allocate memory or block in process().
+ */
+class ECA_RT_CHECKER_TEST : public ECA_TEST_CASE {
+
+protected:
+
+  virtual string do_name(void) const { return("ECA_RT_CHECKER"); }
+  virtual void do_run(void);
+
+public:
+
+  virtual ~ECA_RT_CHECKER_TEST(void) { }
+
+private:
+
+  void test_chain_operators(void);
+};
+
+void ECA_RT_CHECKER_TEST::test_chain_operators(void)
+{
+  const ECA_OBJECT_MAP& objmap = ECA_OBJECT_FACTORY::chain_operator_map();
+  const list<string>& regobjs = objmap.registered_objects();
+
+  for(list<string>::const_iterator p = regobjs.begin(); p != regobjs.end(); p++) {
+    const CHAIN_OPERATOR* proto = dynamic_cast<const CHAIN_OPERATOR*>(objmap.object(*p));
+    if (proto == 0)
+      continue;
+
+    CHAIN_OPERATOR* op = dynamic_cast<CHAIN_OPERATOR*>(proto->clone());
+    SAMPLE_BUFFER sbuf (256, 2);
+    op->init(&sbuf);
+
+    /* note: delay times are often modulated by controllers,
+     *       so changing them must not allocate either */
+    bool sweep = (*p == "etd" || *p == "etf" || *p == "etr" ||
+		  *p == "efa" || *p == "efc" || *p == "efi");
+    CHAIN_OPERATOR::parameter_t delay = op->get_parameter(1);
+
+    ECA_RT_CHECKER::clear();
+    for(int iter = 0; iter < 16; iter++) {
+      sbuf.number_of_channels(2);
+      for(int ch = 0; ch < 2; ch++)
+	for(int n = 0; n < 256; n++)
+	  sbuf.buffer[ch][n] = ((n * 7 + iter * 3 + ch) % 64 - 32) / 64.0;
+
+      /* note: first iteration is run outside the section, so
+       *       that one-time initialization is not reported */
+      if (iter > 0) ECA_RT_CHECKER::enter();
+      if (sweep == true && iter > 0)
+	op->set_parameter(1, delay * (1 + iter % 4) / 2.0);
+      op->process();
+      if (iter > 0) ECA_RT_CHECKER::leave();
+    }
+
+    if (ECA_RT_CHECKER::violation_count() > 0) {
+      std::fprintf(stdout, "%s: -%s: %s\n",
+		   name().c_str(), p->c_str(), ECA_RT_CHECKER::report().c_str());
+      ECA_TEST_FAILURE("chain operator \"" + op->name() + "\" not realtime-safe");
+    }
+
+    op->release();
+    delete op;
+  }
+
+  ECA_RT_CHECKER::clear();
+}
+
+void ECA_RT_CHECKER_TEST::do_run(void)
+{
+  std::fprintf(stdout, "%s: tests for %s class\n",
+	       name().c_str(), __FILE__);
+
+  if (ECA_RT_CHECKER::available() != true) {
+    std::fprintf(stdout, "%s: interposed functions not available, skipping\n",
+		 name().c_str());
+    return;
+  }
+
+  bool was_enabled = ECA_RT_CHECKER::enabled();
+  ECA_RT_CHECKER::set_enabled(true);
+  ECA_RT_CHECKER::clear();
+
+  /* case: calls outside sections are not recorded */
+  {
+    eca_rt_checker_test_ptr = std::malloc(100);
+    std::free(eca_rt_checker_test_ptr);
+    if (ECA_RT_CHECKER::violation_count() != 0)
+      ECA_TEST_FAILURE("violation outside section");
+  }
+
+  /* case: allocation inside a section is recorded */
+  {
+    {
+      ECA_RT_CHECKER_SCOPE rt_section;
+      if (ECA_RT_CHECKER::in_section() != true)
+	ECA_TEST_FAILURE("not in section");
+      eca_rt_checker_test_ptr = std::malloc(100);
+    }
+    std::free(eca_rt_checker_test_ptr);
+
+    if (ECA_RT_CHECKER::in_section() == true)
+      ECA_TEST_FAILURE("section not left");
+    if (ECA_RT_CHECKER::violation_count() != 1)
+      ECA_TEST_FAILURE("allocation not recorded");
+    if (ECA_RT_CHECKER::report().find("malloc()") == string::npos)
+      ECA_TEST_FAILURE("report");
+
+    ECA_RT_CHECKER::clear();
+    if (ECA_RT_CHECKER::violation_count() != 0)
+      ECA_TEST_FAILURE("clear");
+  }
+
+  /* case: chain operators */
+  test_chain_operators();
+
+  ECA_RT_CHECKER::set_enabled(was_enabled);
+}
@@ -0,0 +1,544 @@
+// ------------------------------------------------------------------------
+// eca-rt-memory.cpp: Memory arena for realtime processing
+// Copyright (C) 2026 agent
+//
+// Attributes:
+//     eca-style-version: 3
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
+// ------------------------------------------------------------------------
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <stdlib.h> /* posix_memalign() */
+#include <sys/mman.h> /* mmap(), mlock() */
+#include <unistd.h> /* sysconf() */
+
+#include <kvu_dbc.h>
+#include <kvu_locks.h>
+#include <kvu_numtostr.h>
+
+#include "eca-logger.h"
+#include "eca-rt-memory.h"
+
+#if !defined(MAP_ANONYMOUS) && defined(MAP_ANON)
+#define MAP_ANONYMOUS MAP_ANON
+#endif
+
+bool ECA_RT_MEMORY::enabled_rep = false;
+ECA_RT_MEMORY::Hugepage_mode ECA_RT_MEMORY::hugepage_mode_rep = ECA_RT_MEMORY::hugepages_none;
+bool ECA_RT_MEMORY::locked_rep = false;
+std::vector<ECA_RT_MEMORY::CHUNK>* ECA_RT_MEMORY::chunks_repp = 0;
+ECA_RT_MEMORY::FREE_BLOCK* ECA_RT_MEMORY::free_bins_rep[ECA_RT_MEMORY::free_bin_count];
+size_t ECA_RT_MEMORY::used_rep = 0;
+pthread_mutex_t ECA_RT_MEMORY::lock_rep = PTHREAD_MUTEX_INITIALIZER;
+
+/**
+ * Header stored in front of every block. Keeps the
+ * returned pointer aligned to 16 octets. For arena
+ * blocks, 'size' is the size of the whole block, and 
+ * the next block starts right after it.
+ */
+struct ECA_RT_MEMORY_HEADER {
+  size_t size;
+  size_t flags;
+};
+
+/**
+ * Free arena block. The links are stored in the block
+ * itself, and the size is repeated in the last word 
+ * of the block, so that a released block can be 
+ * merged with a free block preceding it.
+ */
+struct ECA_RT_MEMORY::FREE_BLOCK {
+  ECA_RT_MEMORY_HEADER header;
+  FREE_BLOCK* next;
+  FREE_BLOCK* prev;
+};
+
+/* block was allocated from the arena */
+static const size_t rt_memory_flag_arena = 1;
+/* arena block is free */
+static const size_t rt_memory_flag_free = 2;
+/* block preceding this one in the chunk is free */
+static const size_t rt_memory_flag_prev_free = 4;
+
+static const size_t rt_memory_header_size = 16;
+static const size_t rt_memory_block_align = 64;
+static const size_t rt_memory_chunk_size = 4 * 1024 * 1024;
+static const size_t rt_memory_hugepage_size = 2 * 1024 * 1024;
+static const size_t rt_memory_stack_prefault = 128 * 1024;
+
+static size_t rt_memory_round_up(size_t value, size_t align)
+{
+  return ((value + align - 1) / align) * align;
+}
+
+static size_t rt_memory_page_size(void)
+{
+  long int size = ::sysconf(_SC_PAGESIZE);
+  return (size > 0) ? static_cast<size_t>(size) : 4096;
+}
+
+static ECA_RT_MEMORY_HEADER* rt_memory_header(char* block)
+{
+  return reinterpret_cast<ECA_RT_MEMORY_HEADER*>(block);
+}
+
+/**
+ * Returns the free list for blocks of 'size' octets. 
+ * Lists hold blocks from 2^n up to 2^(n+1) octets.
+ */
+static int rt_memory_bin(size_t size, int bins)
+{
+  int bin = 0;
+  while((size >>= 1) != 0 && bin < bins - 1) ++bin;
+  return bin;
+}
+
+/**
+ * Enables or disables the arena. Affects only
+ * allocations made after the call.
+ */
+void ECA_RT_MEMORY::set_enabled(bool value)
+{
+  enabled_rep = value;
+}
+
+/**
+ * Sets whether new arena mappings are backed with
+ * hugepages.
+ */
+void ECA_RT_MEMORY::set_hugepage_mode(Hugepage_mode mode)
+{
+  hugepage_mode_rep = mode;
+}
+
+/**
+ * Sets the hugepage mode from an ecasoundrc value:
+ * 'none', 'transparent' or 'explicit'.
+ */
+void ECA_RT_MEMORY::set_hugepage_mode(const std::string& mode)
+{
+  if (mode == "transparent")
+    set_hugepage_mode(hugepages_transparent);
+  else if (mode == "explicit")
+    set_hugepage_mode(hugepages_explicit);
+  else
+    set_hugepage_mode(hugepages_none);
+}
+
+/**
+ * Allocates a block of 'bytes' octets, aligned to
+ * 16 octets. The block must be freed with release().
+ */
+void* ECA_RT_MEMORY::allocate(size_t bytes)
+{
+  if (enabled_rep == true) {
+    size_t size = rt_memory_round_up(bytes + rt_memory_header_size, rt_memory_block_align);
+    KVU_GUARD_LOCK guard(&ECA_RT_MEMORY::lock_rep);
+    char* block = arena_allocate(size);
+    if (block != 0) {
+      used_rep += rt_memory_header(block)->size;
+      return block + rt_memory_header_size;
+    }
+  }
+
+  char* block = 0;
+  size_t size = bytes + rt_memory_header_size;
+  {
+    void* ptr = 0;
+#ifdef HAVE_POSIX_MEMALIGN
+    if (::posix_memalign(&ptr, 16, size) != 0)
+      ptr = 0;
+#else
+    ptr = ::malloc(size);
+#endif
+    if (ptr == 0)
+      throw std::bad_alloc();
+    block = static_cast<char*>(ptr);
+  }
+
+  rt_memory_header(block)->size = size;
+  rt_memory_header(block)->flags = 0;
+
+  return block + rt_memory_header_size;
+}
+
+/**
+ * Frees a block returned by allocate(). Arena blocks
+ * are merged with adjacent free blocks, and kept for
+ * reuse. Does not allocate memory.
+ */
+void ECA_RT_MEMORY::release(void* ptr)
+{
+  if (ptr == 0)
+    return;
+
+  char* block = static_cast<char*>(ptr) - rt_memory_header_size;
+  ECA_RT_MEMORY_HEADER* header = rt_memory_header(block);
+
+  if ((header->flags & rt_memory_flag_arena) == 0) {
+    ::free(block);
+    return;
+  }
+
+  KVU_GUARD_LOCK guard(&ECA_RT_MEMORY::lock_rep);
+  DBC_CHECK((header->flags & rt_memory_flag_free) == 0);
+  DBC_CHECK(used_rep >= header->size);
+  used_rep -= header->size;
+
+  size_t size = header->size;
+  ECA_RT_MEMORY_HEADER* next = rt_memory_header(block + size);
+  if ((next->flags & rt_memory_flag_free) != 0) {
+    unlink_free(reinterpret_cast<FREE_BLOCK*>(next));
+    size += next->size;
+  }
+  if ((header->flags & rt_memory_flag_prev_free) != 0) {
+    size_t prev_size = *reinterpret_cast<size_t*>(block - sizeof(size_t));
+    block -= prev_size;
+    unlink_free(reinterpret_cast<FREE_BLOCK*>(block));
+    size += prev_size;
+  }
+
+  insert_free(block, size);
+}
+
+/**
+ * Marks the 'size' octets at 'block' as a free block
+ * and adds it to the free lists. Must be called with
+ * 'lock_rep' held.
+ */
+void ECA_RT_MEMORY::insert_free(char* block, size_t size)
+{
+  FREE_BLOCK* free_block = reinterpret_cast<FREE_BLOCK*>(block);
+  free_block->header.size = size;
+  /* note: free blocks are always merged, so the block
+   *       preceding a free block is in use */
+  free_block->header.flags = rt_memory_flag_arena | rt_memory_flag_free;
+  *reinterpret_cast<size_t*>(block + size - sizeof(size_t)) = size;
+  rt_memory_header(block + size)->flags |= rt_memory_flag_prev_free;
+
+  int bin = rt_memory_bin(size, free_bin_count);
+  free_block->prev = 0;
+  free_block->next = free_bins_rep[bin];
+  if (free_block->next != 0)
+    free_block->next->prev = free_block;
+  free_bins_rep[bin] = free_block;
+}
+
+/**
+ * Removes 'free_block' from the free lists. Must be 
+ * called with 'lock_rep' held.
+ */
+void ECA_RT_MEMORY::unlink_free(FREE_BLOCK* free_block)
+{
+  if (free_block->prev != 0)
+    free_block->prev->next = free_block->next;
+  else
+    free_bins_rep[rt_memory_bin(free_block->header.size, free_bin_count)] = free_block->next;
+  if (free_block->next != 0)
+    free_block->next->prev = free_block->prev;
+}
+
+/**
+ * Returns the first free block of at least 'size' 
+ * octets, or 0 if there is none. Must be called with
+ * 'lock_rep' held.
+ */
+ECA_RT_MEMORY::FREE_BLOCK* ECA_RT_MEMORY::find_free(size_t size)
+{
+  for(int bin = rt_memory_bin(size, free_bin_count); bin < free_bin_count; bin++) {
+    for(FREE_BLOCK* p = free_bins_rep[bin]; p != 0; p = p->next) {
+      if (p->header.size >= size)
+	return p;
+    }
+  }
+  return 0;
+}
+
+/**
+ * Takes a block of 'size' octets from the free lists,
+ * mapping a new chunk if no free block is large 
+ * enough. The remainder of a larger free block is 
+ * put back to the free lists. Must be called with
+ * 'lock_rep' held.
+ *
+ * @return 0 if no memory could be mapped
+ */
+char* ECA_RT_MEMORY::arena_allocate(size_t size)
+{
+  FREE_BLOCK* free_block = find_free(size);
+  if (free_block == 0) {
+    /* note: the last block of each chunk is an empty 
+     *       block marked in use, so that blocks are
+     *       never merged past the end of the chunk */
+    size_t needed = size + rt_memory_block_align;
+    CHUNK* chunk = add_chunk(needed > rt_memory_chunk_size ? needed : rt_memory_chunk_size);
+    if (chunk == 0)
+      return 0;
+
+    char* end = chunk->base + chunk->size - rt_memory_block_align;
+    rt_memory_header(end)->size = 0;
+    rt_memory_header(end)->flags = rt_memory_flag_arena;
+    insert_free(chunk->base, end - chunk->base);
+
+    free_block = find_free(size);
+    DBC_CHECK(free_block != 0);
+  }
+
+  unlink_free(free_block);
+  char* block = reinterpret_cast<char*>(free_block);
+  size_t block_size = free_block->header.size;
+  if (block_size - size >= rt_memory_block_align) {
+    insert_free(block + size, block_size - size);
+    block_size = size;
+  }
+  else {
+    rt_memory_header(block + block_size)->flags &= ~rt_memory_flag_prev_free;
+  }
+
+  rt_memory_header(block)->size = block_size;
+  rt_memory_header(block)->flags = rt_memory_flag_arena;
+
+  return block;
+}
+
+/**
+ * Maps a new chunk of at least 'size' octets and
+ * prefaults it. If the arena is locked, the chunk is
+ * locked, too. Must be called with 'lock_rep' held.
+ */
+ECA_RT_MEMORY::CHUNK* ECA_RT_MEMORY::add_chunk(size_t size)
+{
+  size_t page = rt_memory_page_size();
+  bool huge = false;
+  void* ptr = MAP_FAILED;
+
+  if (hugepage_mode_rep != hugepages_none)
+    size = rt_memory_round_up(size, rt_memory_hugepage_size);
+  else
+    size = rt_memory_round_up(size, page);
+
+#ifdef MAP_HUGETLB
+  if (hugepage_mode_rep == hugepages_explicit) {
+    ptr = ::mmap(0, size, PROT_READ | PROT_WRITE,
+		 MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+    if (ptr != MAP_FAILED)
+      huge = true;
+    else
+      ECA_LOG_MSG(ECA_LOGGER::info,
+		  "WARNING: Unable to map explicit hugepages, using transparent hugepages instead.");
+  }
+#endif
+
+  if (ptr == MAP_FAILED) {
+    if (hugepage_mode_rep != hugepages_none) {
+      /* note: map extra space so that the chunk can be
+       *       aligned to the hugepage size */
+      size_t mapped = size + rt_memory_hugepage_size;
+      char* raw = static_cast<char*>(::mmap(0, mapped, PROT_READ | PROT_WRITE,
+					    MAP_PRIVATE | MAP_ANONYMOUS, -1, 0));
+      if (raw != MAP_FAILED) {
+	char* aligned = reinterpret_cast<char*>(rt_memory_round_up(reinterpret_cast<size_t>(raw),
+								   rt_memory_hugepage_size));
+	if (aligned > raw)
+	  ::munmap(raw, aligned - raw);
+	if (raw + mapped > aligned + size)
+	  ::munmap(aligned + size, (raw + mapped) - (aligned + size));
+	ptr = aligned;
+#ifdef MADV_HUGEPAGE
+	if (::madvise(ptr, size, MADV_HUGEPAGE) == 0)
+	  huge = true;
+#endif
+      }
+    }
+    else {
+      ptr = ::mmap(0, size, PROT_READ | PROT_WRITE,
+		   MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    }
+  }
+
+  if (ptr == MAP_FAILED) {
+    ECA_LOG_MSG(ECA_LOGGER::info,
+		"WARNING: Unable to map " + kvu_numtostr(size) +
+		" octets for realtime memory, using the system allocator.");
+    return 0;
+  }
+
+  CHUNK chunk;
+  chunk.base = static_cast<char*>(ptr);
+  chunk.size = size;
+  chunk.locked = false;
+  chunk.huge = huge;
+
+  /* note: the mapping is new, so pages can be written
+   *       without regard to their contents */
+  for(size_t n = 0; n < size; n += page)
+    chunk.base[n] = 0;
+
+  if (chunks_repp == 0)
+    chunks_repp = new std::vector<CHUNK>();
+  chunks_repp->push_back(chunk);
+  if (locked_rep == true)
+    lock_chunk(&chunks_repp->back());
+
+  ECA_LOG_MSG(ECA_LOGGER::system_objects,
+	      "Mapped " + kvu_numtostr(size) + " octets of realtime memory" +
+	      std::string(huge == true ? " (hugepages)." : "."));
+
+  return &chunks_repp->back();
+}
+
+/**
+ * Locks 'chunk' into memory. Must be called with
+ * 'lock_rep' held.
+ */
+void ECA_RT_MEMORY::lock_chunk(CHUNK* chunk)
+{
+#ifdef HAVE_MLOCKALL
+  if (::mlock(chunk->base, chunk->size) == 0) {
+    chunk->locked = true;
+  }
+  else {
+    ECA_LOG_MSG(ECA_LOGGER::info,
+		"WARNING: Unable to lock " + kvu_numtostr(chunk->size) +
+		" octets of realtime memory. Check the memlock resource limit.");
+  }
+#endif
+}
+
+/**
+ * Locks all current and future arena mappings into
+ * memory. Called by the engine when it is prepared
+ * for processing.
+ */
+void ECA_RT_MEMORY::lock(void)
+{
+  KVU_GUARD_LOCK guard(&ECA_RT_MEMORY::lock_rep);
+
+  locked_rep = true;
+  if (chunks_repp != 0) {
+    for(size_t n = 0; n < chunks_repp->size(); n++) {
+      if ((*chunks_repp)[n].locked != true)
+	lock_chunk(&(*chunks_repp)[n]);
+    }
+  }
+}
+
+/**
+ * Unlocks all arena mappings. The memory stays
+ * allocated. Called by the engine when it stops.
+ */
+void ECA_RT_MEMORY::unlock(void)
+{
+  KVU_GUARD_LOCK guard(&ECA_RT_MEMORY::lock_rep);
+
+  locked_rep = false;
+  if (chunks_repp != 0) {
+    for(size_t n = 0; n < chunks_repp->size(); n++) {
+      CHUNK& chunk = (*chunks_repp)[n];
+      if (chunk.locked == true) {
+	::munlock(chunk.base, chunk.size);
+	chunk.locked = false;
+      }
+    }
+  }
+}
+
+bool ECA_RT_MEMORY::is_locked(void)
+{
+  KVU_GUARD_LOCK guard(&ECA_RT_MEMORY::lock_rep);
+  return locked_rep;
+}
+
+/**
+ * Touches the top of the calling thread's stack, so
+ * that processing does not fault in new stack pages.
+ * Should be called from the thread that runs the
+ * engine.
+ */
+void __attribute__((noinline)) ECA_RT_MEMORY::prefault_stack(void)
+{
+  volatile char stack[rt_memory_stack_prefault];
+  size_t page = rt_memory_page_size();
+  for(size_t n = 0; n < sizeof(stack); n += page)
+    stack[n] = 0;
+}
+
+/**
+ * Total size of the arena mappings in octets.
+ */
+size_t ECA_RT_MEMORY::reserved_bytes(void)
+{
+  KVU_GUARD_LOCK guard(&ECA_RT_MEMORY::lock_rep);
+
+  size_t bytes = 0;
+  if (chunks_repp != 0) {
+    for(size_t n = 0; n < chunks_repp->size(); n++)
+      bytes += (*chunks_repp)[n].size;
+  }
+  return bytes;
+}
+
+/**
+ * Size of the arena blocks currently in use, in octets.
+ */
+size_t ECA_RT_MEMORY::used_bytes(void)
+{
+  KVU_GUARD_LOCK guard(&ECA_RT_MEMORY::lock_rep);
+  return used_rep;
+}
+
+/**
+ * Size of the arena mappings locked into memory,
+ * in octets.
+ */
+size_t ECA_RT_MEMORY::locked_bytes(void)
+{
+  KVU_GUARD_LOCK guard(&ECA_RT_MEMORY::lock_rep);
+
+  size_t bytes = 0;
+  if (chunks_repp != 0) {
+    for(size_t n = 0; n < chunks_repp->size(); n++)
+      if ((*chunks_repp)[n].locked == true)
+	bytes += (*chunks_repp)[n].size;
+  }
+  return bytes;
+}
+
+/**
+ * Returns a string describing the arena. Used by
+ * the 'engine-memory-status' ECI command.
+ */
+std::string ECA_RT_MEMORY::status(void)
+{
+  if (enabled_rep != true && reserved_bytes() == 0)
+    return "rt-memory disabled";
+
+  std::string mode ("none");
+  if (hugepage_mode_rep == hugepages_transparent)
+    mode = "transparent";
+  else if (hugepage_mode_rep == hugepages_explicit)
+    mode = "explicit";
+
+  return std::string("rt-memory ") + (enabled_rep == true ? "enabled" : "disabled") +
+    ", hugepages " + mode +
+    ", reserved " + kvu_numtostr(reserved_bytes()) +
+    ", used " + kvu_numtostr(used_bytes()) +
+    ", locked " + kvu_numtostr(locked_bytes()) + " octets";
+}
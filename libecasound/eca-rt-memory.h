@@ -0,0 +1,158 @@
+#ifndef INCLUDED_ECA_RT_MEMORY_H
+#define INCLUDED_ECA_RT_MEMORY_H
+
+#include <cstddef>
+#include <new> /* placement new */
+#include <string>
+#include <vector>
+#include <pthread.h>
+
+/**
+ * Process-wide memory arena for data accessed by
+ * the engine during processing.
+ *
+ * Sample buffers (chains, mixing and double-buffering),
+ * scratch buffers and chain delay lines are allocated
+ * with allocate(). If the arena is disabled, allocations
+ * are passed to the system allocator.
+ *
+ * When enabled with set_enabled() (ecasoundrc option
+ * 'rt-memory'), memory is taken from large anonymous
+ * mappings. Each mapping is prefaulted when created, so
+ * first-touch page faults do not happen during
+ * processing. lock() additionally locks the mappings
+ * into memory with mlock(). The mappings can be backed
+ * with transparent or explicit hugepages. Released
+ * blocks are merged with adjacent free blocks and kept
+ * for reuse, so memory released with one block size 
+ * can be reused for another. Memory is never returned
+ * to the system.
+ *
+ * All functions are thread-safe, but not realtime-safe.
+ *
+ * @author agent
+ */
+class ECA_RT_MEMORY {
+
+ public:
+
+  enum Hugepage_mode {
+    /* normal pages */
+    hugepages_none = 0,
+    /* request transparent hugepages with madvise() */
+    hugepages_transparent,
+    /* map from the hugetlbfs pool (MAP_HUGETLB) */
+    hugepages_explicit
+  };
+
+  /** @name Configuration */
+  /*@{*/
+
+  static void set_enabled(bool value);
+  static bool enabled(void) { return enabled_rep; }
+  static void set_hugepage_mode(Hugepage_mode mode);
+  static void set_hugepage_mode(const std::string& mode);
+  static Hugepage_mode hugepage_mode(void) { return hugepage_mode_rep; }
+
+  /*@}*/
+
+  /** @name Allocation */
+  /*@{*/
+
+  static void* allocate(size_t bytes);
+  static void release(void* ptr);
+
+  /*@}*/
+
+  /** @name Locking and prefaulting */
+  /*@{*/
+
+  static void lock(void);
+  static void unlock(void);
+  static bool is_locked(void);
+  static void prefault_stack(void);
+
+  /*@}*/
+
+  /** @name Status */
+  /*@{*/
+
+  static size_t reserved_bytes(void);
+  static size_t used_bytes(void);
+  static size_t locked_bytes(void);
+  static std::string status(void);
+
+  /*@}*/
+
+ private:
+
+  struct CHUNK {
+    char* base;
+    size_t size;
+    bool locked;
+    bool huge;
+  };
+
+  struct FREE_BLOCK;
+
+  static const int free_bin_count = 48;
+
+  static bool enabled_rep;
+  static Hugepage_mode hugepage_mode_rep;
+  static bool locked_rep;
+  static std::vector<CHUNK>* chunks_repp;
+  static FREE_BLOCK* free_bins_rep[free_bin_count];
+  static size_t used_rep;
+  static pthread_mutex_t lock_rep;
+
+  static char* arena_allocate(size_t size);
+  static FREE_BLOCK* find_free(size_t size);
+  static void insert_free(char* block, size_t size);
+  static void unlink_free(FREE_BLOCK* free_block);
+  static CHUNK* add_chunk(size_t size);
+  static void lock_chunk(CHUNK* chunk);
+
+  ECA_RT_MEMORY(void);
+  ECA_RT_MEMORY(const ECA_RT_MEMORY&);
+  ECA_RT_MEMORY& operator=(const ECA_RT_MEMORY&);
+  ~ECA_RT_MEMORY(void);
+};
+
+/**
+ * Allocator for standard containers that takes
+ * memory from ECA_RT_MEMORY.
+ */
+template<class T>
+class ECA_RT_ALLOCATOR {
+
+ public:
+
+  typedef T value_type;
+  typedef T* pointer;
+  typedef const T* const_pointer;
+  typedef T& reference;
+  typedef const T& const_reference;
+  typedef size_t size_type;
+  typedef ptrdiff_t difference_type;
+
+  template<class U> struct rebind { typedef ECA_RT_ALLOCATOR<U> other; };
+
+  ECA_RT_ALLOCATOR(void) { }
+  ECA_RT_ALLOCATOR(const ECA_RT_ALLOCATOR&) { }
+  template<class U> ECA_RT_ALLOCATOR(const ECA_RT_ALLOCATOR<U>&) { }
+
+  pointer address(reference x) const { return &x; }
+  const_pointer address(const_reference x) const { return &x; }
+
+  pointer allocate(size_type n, const void* hint = 0) { return static_cast<pointer>(ECA_RT_MEMORY::allocate(n * sizeof(T))); }
+  void deallocate(pointer p, size_type n) { ECA_RT_MEMORY::release(p); }
+  size_type max_size(void) const { return static_cast<size_type>(-1) / sizeof(T); }
+
+  void construct(pointer p, const T& value) { new(static_cast<void*>(p)) T(value); }
+  void destroy(pointer p) { p->~T(); }
+
+  bool operator==(const ECA_RT_ALLOCATOR&) const { return true; }
+  bool operator!=(const ECA_RT_ALLOCATOR&) const { return false; }
+};
+
+#endif
@@ -0,0 +1,166 @@
+// ------------------------------------------------------------------------
+// eca-rt-memory_test.h: Unit test for ECA_RT_MEMORY
+// Copyright (C) 2026 agent
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
+// ------------------------------------------------------------------------
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "eca-rt-memory.h"
+#include "samplebuffer.h"
+#include "eca-test-case.h"
+
+using namespace std;
+
+/**
+ * Unit test for ECA_RT_MEMORY
+ */
+class ECA_RT_MEMORY_TEST : public ECA_TEST_CASE {
+
+protected:
+
+  virtual string do_name(void) const { return("ECA_RT_MEMORY"); }
+  virtual void do_run(void);
+
+public:
+
+  virtual ~ECA_RT_MEMORY_TEST(void) { }
+};
+
+void ECA_RT_MEMORY_TEST::do_run(void)
+{
+  std::fprintf(stdout, "%s: tests for %s class\n",
+	       name().c_str(), __FILE__);
+
+  bool was_enabled = ECA_RT_MEMORY::enabled();
+
+  /* case: system allocator when disabled */
+  {
+    ECA_RT_MEMORY::set_enabled(false);
+    size_t used = ECA_RT_MEMORY::used_bytes();
+    void* ptr = ECA_RT_MEMORY::allocate(1000);
+    if ((reinterpret_cast<size_t>(ptr) & 15) != 0)
+      ECA_TEST_FAILURE("unaligned block");
+    if (ECA_RT_MEMORY::used_bytes() != used)
+      ECA_TEST_FAILURE("disabled arena used");
+    ECA_RT_MEMORY::release(ptr);
+  }
+
+  ECA_RT_MEMORY::set_enabled(true);
+
+  /* case: arena blocks are aligned and reused */
+  {
+    size_t used = ECA_RT_MEMORY::used_bytes();
+    char* a = static_cast<char*>(ECA_RT_MEMORY::allocate(1000));
+    char* b = static_cast<char*>(ECA_RT_MEMORY::allocate(24));
+    if ((reinterpret_cast<size_t>(a) & 15) != 0 ||
+	(reinterpret_cast<size_t>(b) & 15) != 0)
+      ECA_TEST_FAILURE("unaligned arena block");
+    if (ECA_RT_MEMORY::used_bytes() <= used ||
+	ECA_RT_MEMORY::reserved_bytes() < ECA_RT_MEMORY::used_bytes())
+      ECA_TEST_FAILURE("arena not used");
+    for(int n = 0; n < 1000; n++) a[n] = 1;
+    for(int n = 0; n < 24; n++) b[n] = 2;
+    if (a[999] != 1)
+      ECA_TEST_FAILURE("arena blocks overlap");
+
+    ECA_RT_MEMORY::release(a);
+    char* c = static_cast<char*>(ECA_RT_MEMORY::allocate(1000));
+    if (c != a)
+      ECA_TEST_FAILURE("released block not reused");
+    ECA_RT_MEMORY::release(b);
+    ECA_RT_MEMORY::release(c);
+    if (ECA_RT_MEMORY::used_bytes() != used)
+      ECA_TEST_FAILURE("arena blocks not released");
+  }
+
+  /* case: released blocks are merged and reused for other sizes */
+  {
+    size_t used = ECA_RT_MEMORY::used_bytes();
+    char* a = static_cast<char*>(ECA_RT_MEMORY::allocate(4000));
+    char* b = static_cast<char*>(ECA_RT_MEMORY::allocate(4000));
+    char* c = static_cast<char*>(ECA_RT_MEMORY::allocate(4000));
+    char* d = static_cast<char*>(ECA_RT_MEMORY::allocate(24));
+    size_t reserved = ECA_RT_MEMORY::reserved_bytes();
+
+    /* note: release in an order that merges both with 
+     *       the preceding and the following block */
+    ECA_RT_MEMORY::release(a);
+    ECA_RT_MEMORY::release(c);
+    ECA_RT_MEMORY::release(b);
+    char* e = static_cast<char*>(ECA_RT_MEMORY::allocate(12000));
+    if (e != a)
+      ECA_TEST_FAILURE("released blocks not merged");
+    for(int n = 0; n < 12000; n++) e[n] = 3;
+    if (d[0] == 3)
+      ECA_TEST_FAILURE("merged block overlaps");
+
+    ECA_RT_MEMORY::release(e);
+    char* f = static_cast<char*>(ECA_RT_MEMORY::allocate(6000));
+    char* g = static_cast<char*>(ECA_RT_MEMORY::allocate(5000));
+    if (f != a || g <= f || g >= d)
+      ECA_TEST_FAILURE("merged block not split");
+    if (ECA_RT_MEMORY::reserved_bytes() != reserved)
+      ECA_TEST_FAILURE("new chunk mapped for reused block");
+
+    ECA_RT_MEMORY::release(d);
+    ECA_RT_MEMORY::release(g);
+    ECA_RT_MEMORY::release(f);
+    if (ECA_RT_MEMORY::used_bytes() != used)
+      ECA_TEST_FAILURE("arena blocks not released");
+  }
+
+  /* case: sample buffers and containers from the arena */
+  {
+    size_t used = ECA_RT_MEMORY::used_bytes();
+    {
+      SAMPLE_BUFFER sbuf (512, 2);
+      sbuf.length_in_samples(4096);
+      std::vector<float, ECA_RT_ALLOCATOR<float> > line (10000, 0.5f);
+      if (ECA_RT_MEMORY::used_bytes() < used + 2 * 4096 * sizeof(SAMPLE_SPECS::sample_t) + 10000 * sizeof(float))
+	ECA_TEST_FAILURE("sample buffer not allocated from arena");
+      if (line[9999] != 0.5f)
+	ECA_TEST_FAILURE("allocator");
+    }
+    if (ECA_RT_MEMORY::used_bytes() != used)
+      ECA_TEST_FAILURE("sample buffer not released");
+  }
+
+  /* case: locking */
+  {
+    ECA_RT_MEMORY::lock();
+    ECA_RT_MEMORY::prefault_stack();
+    if (ECA_RT_MEMORY::is_locked() != true)
+      ECA_TEST_FAILURE("not locked");
+
+    /* note: mlock() may fail if the memlock limit is low */
+    size_t locked = ECA_RT_MEMORY::locked_bytes();
+    if (locked != 0 && locked != ECA_RT_MEMORY::reserved_bytes())
+      ECA_TEST_FAILURE("partially locked arena");
+
+    if (ECA_RT_MEMORY::status().find("locked") == string::npos)
+      ECA_TEST_FAILURE("status string");
+
+    ECA_RT_MEMORY::unlock();
+    if (ECA_RT_MEMORY::is_locked() == true ||
+	ECA_RT_MEMORY::locked_bytes() != 0)
+      ECA_TEST_FAILURE("not unlocked");
+  }
+
+  ECA_RT_MEMORY::set_enabled(was_enabled);
+}
@@ -53,105 +53,105 @@ void ECA_SAMPLE_CONVERSION_TEST::do_run(void)
   if (getenv("V") != NULL)
     verbose = true;
 
-  uint8_t u8min = eca_sample_convert_float_to_u8(dmin);
+  uint8_t u8min = eca_sample_convert_sample_to_u8(dmin);
   if (verbose) cout << "-unity to u8 =" << (int)u8min << "\n";
   if (abs((int)(u8min - UINT8_MIN)) > 1) {
     ECA_TEST_FAILURE("abs(u8min - UINT8_MIN) > 1");
   }
 
-  uint8_t u8max = eca_sample_convert_float_to_u8(dmax);
+  uint8_t u8max = eca_sample_convert_sample_to_u8(dmax);
   if (verbose) cout << "unity to u8 =" << (int)u8max << "\n";
   if (abs((int)(u8max - UINT8_MAX)) > 1) {
     ECA_TEST_FAILURE("abs(u8max - UINT8_MAX) > 1");
   }
 
-  uint8_t u8zero = eca_sample_convert_float_to_u8(dzero);
+  uint8_t u8zero = eca_sample_convert_sample_to_u8(dzero);
   if (verbose) cout << "zero to u8 =" << (int)u8zero << "\n";
   if (u8zero != 128) {
     ECA_TEST_FAILURE("u8zero != 128");
   }
 
-  int16_t s16min = eca_sample_convert_float_to_s16(dmin);
+  int16_t s16min = eca_sample_convert_sample_to_s16(dmin);
   if (verbose) cout << "-unity to s16 =" << s16min << "\n";
   if (abs(s16min - INT16_MIN) > 1) {
     ECA_TEST_FAILURE("abs(s16min - INT16_MIN) > 1");
   }
 
-  int16_t s16max = eca_sample_convert_float_to_s16(dmax);
+  int16_t s16max = eca_sample_convert_sample_to_s16(dmax);
   if (verbose) cout << "unity to s16 =" << s16max << "\n";
   if (abs(s16max - INT16_MAX) > 1) {
     ECA_TEST_FAILURE("abs(s16max - INT16_MAX) > 1");
   }
 
-  int16_t s16zero = eca_sample_convert_float_to_s16(dzero);
+  int16_t s16zero = eca_sample_convert_sample_to_s16(dzero);
   if (verbose) cout << "zero to s16 =" << s16zero << "\n";
   if (s16zero != 0) {
     ECA_TEST_FAILURE("s16zero != 0");
   }
 
-  int32_t s32min = eca_sample_convert_float_to_s32(dmin);
+  int32_t s32min = eca_sample_convert_sample_to_s32(dmin);
   if (verbose) cout << "-unity to s32 =" << s32min << "\n";
   if (labs(s32min - INT32_MIN) > 1) {
     ECA_TEST_FAILURE("labs(s32min - INT32_MIN) > 1");
   }
   
-  int32_t s32max = eca_sample_convert_float_to_s32(dmax);
+  int32_t s32max = eca_sample_convert_sample_to_s32(dmax);
   if (verbose) cout << "unity to s32 =" << s32max << "\n";
   if (labs(s32max - INT32_MAX) > 1) {
     ECA_TEST_FAILURE("labs(s32max - INT32_MAX) > 1");
   }
 
-  int32_t s32zero = eca_sample_convert_float_to_s32(dzero);
+  int32_t s32zero = eca_sample_convert_sample_to_s32(dzero);
   if (verbose) cout << "zero to s32 =" << s16zero << "\n";
   if (s32zero != 0) {
     ECA_TEST_FAILURE("s32zero != 0");
   }
 
-  float cur = eca_sample_convert_u8_to_float(UINT8_MIN);
+  float cur = eca_sample_convert_u8_to_sample(UINT8_MIN);
     if (verbose) cout << "u8min to float =" << cur << "\n";
   if (cur > -1.0f || cur < -1.0f) {
     ECA_TEST_FAILURE("to_float: u8min");
   }
 
-  cur = eca_sample_convert_u8_to_float(UINT8_MAX);
+  cur = eca_sample_convert_u8_to_sample(UINT8_MAX);
   if (verbose) cout << "u8max to float =" << cur << "\n";
   if (cur > 1.0f) {
     ECA_TEST_FAILURE("to_float: u8max");
   }
 
-  cur = eca_sample_convert_s16_to_float(INT16_MIN);
+  cur = eca_sample_convert_s16_to_sample(INT16_MIN);
   if (verbose) cout << "s16min to float =" << cur << "\n";
   if (cur > -1.0f || cur < -1.0f) {
     if (verbose) cout << "s16min to float: WARNING, suspect value\n";
     // ECA_TEST_FAILURE("to_float: s16min");
   }
 
-  cur = eca_sample_convert_s16_to_float(INT16_MIN + 1);
+  cur = eca_sample_convert_s16_to_sample(INT16_MIN + 1);
   if (verbose) cout << "s16min+1 to float =" << cur << "\n";
   if (cur > -1.0f || cur < -1.0f) {
     if (verbose) cout << "s16min+1 to float: WARNING, suspect value\n";
     // ECA_TEST_FAILURE("to_float: s16min");
   }
 
-  cur = eca_sample_convert_s16_to_float(INT16_MAX);
+  cur = eca_sample_convert_s16_to_sample(INT16_MAX);
   if (verbose) cout << "s16max to float =" << cur << "\n";
   if (cur > 1.0f) {
     ECA_TEST_FAILURE("to_float: s16max");
   }
 
-  cur = eca_sample_convert_s32_to_float(INT32_MIN + 1);
+  cur = eca_sample_convert_s32_to_sample(INT32_MIN + 1);
   if (verbose) cout << "s32min+1 to float =" << cur << "\n";
   if (cur > -1.0f || cur < -1.0f) {
     ECA_TEST_FAILURE("to_float: s32min+1");
   }
 
-  cur = eca_sample_convert_s32_to_float(INT32_MIN);
+  cur = eca_sample_convert_s32_to_sample(INT32_MIN);
   if (verbose) cout << "s32min to float =" << cur << "\n";
   if (cur > -1.0f || cur < -1.0f) {
     ECA_TEST_FAILURE("to_float: s32min");
   }
 
-  cur = eca_sample_convert_s32_to_float(INT32_MAX);
+  cur = eca_sample_convert_s32_to_sample(INT32_MAX);
   if (verbose) cout << "s32max to float =" << cur << "\n";
   if (cur < 1.0f || cur > 1.0f) {
     ECA_TEST_FAILURE("to_float: s32max");
@@ -159,8 +159,8 @@ void ECA_SAMPLE_CONVERSION_TEST::do_run(void)
 
 #define S16INTFLOATINT(y) \
   { \
-    float mid = eca_sample_convert_s16_to_float(y); \
-    int16_t res = eca_sample_convert_float_to_s16(mid); \
+    float mid = eca_sample_convert_s16_to_sample(y); \
+    int16_t res = eca_sample_convert_sample_to_s16(mid); \
     if (verbose) cout << "s16 ifi " << (y) << " to " << mid << " to " << res << endl; \
     if (res != (y)) { \
       if (verbose) cout << "s16 ifi: WARNING, suspect value\n";	\
@@ -179,8 +179,8 @@ void ECA_SAMPLE_CONVERSION_TEST::do_run(void)
 
 #define S32INTFLOATINT(y) \
   { \
-    float mid = eca_sample_convert_s32_to_float(y); \
-    int32_t res = eca_sample_convert_float_to_s32(mid); \
+    float mid = eca_sample_convert_s32_to_sample(y); \
+    int32_t res = eca_sample_convert_sample_to_s32(mid); \
     cout << "s32 ifi " << (y) << " to " << mid << " to " << res << endl; \
     if (res != (y)) { \
       if (verbose) cout << "s32 ifi: WARNING, suspect value\n";		\
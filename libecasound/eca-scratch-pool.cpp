@@ -0,0 +1,90 @@
+// ------------------------------------------------------------------------
+// eca-scratch-pool.cpp: Process-wide pool of scratch audio buffers
+// Copyright (C) 2026 agent
+//
+// Attributes:
+//     eca-style-version: 3
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
+// ------------------------------------------------------------------------
+
+#include <kvu_dbc.h>
+#include <kvu_locks.h>
+
+#include "eca-rt-memory.h"
+#include "eca-scratch-pool.h"
+
+ECA_SCRATCH_POOL::free_map_t* ECA_SCRATCH_POOL::free_repp = 0;
+pthread_mutex_t ECA_SCRATCH_POOL::lock_rep = PTHREAD_MUTEX_INITIALIZER;
+
+/**
+ * Returns a silent buffer of 'length' samples. A
+ * previously released buffer of the same length is
+ * reused if available.
+ */
+ECA_SCRATCH_POOL::sample_t* ECA_SCRATCH_POOL::acquire(long int length)
+{
+  DBC_REQUIRE(length > 0);
+
+  sample_t* buffer = 0;
+  {
+    KVU_GUARD_LOCK guard(&ECA_SCRATCH_POOL::lock_rep);
+    if (free_repp != 0) {
+      free_map_t::iterator p = free_repp->find(length);
+      if (p != free_repp->end() && p->second.size() > 0) {
+	buffer = p->second.back();
+	p->second.pop_back();
+      }
+    }
+  }
+
+  if (buffer == 0)
+    buffer = static_cast<sample_t*>(ECA_RT_MEMORY::allocate(sizeof(sample_t) * length));
+
+  for(long int n = 0; n < length; n++)
+    buffer[n] = SAMPLE_SPECS::silent_value;
+
+  return buffer;
+}
+
+/**
+ * Returns 'buffer' of 'length' samples, acquired
+ * with acquire(), back to the pool.
+ */
+void ECA_SCRATCH_POOL::release(sample_t* buffer, long int length)
+{
+  DBC_REQUIRE(buffer != 0);
+  DBC_REQUIRE(length > 0);
+
+  KVU_GUARD_LOCK guard(&ECA_SCRATCH_POOL::lock_rep);
+  if (free_repp == 0)
+    free_repp = new free_map_t();
+  (*free_repp)[length].push_back(buffer);
+}
+
+/**
+ * Number of buffers available for reuse.
+ */
+size_t ECA_SCRATCH_POOL::free_count(void)
+{
+  KVU_GUARD_LOCK guard(&ECA_SCRATCH_POOL::lock_rep);
+
+  size_t count = 0;
+  if (free_repp != 0) {
+    for(free_map_t::const_iterator p = free_repp->begin(); p != free_repp->end(); p++)
+      count += p->second.size();
+  }
+  return count;
+}
@@ -0,0 +1,48 @@
+#ifndef INCLUDED_ECA_SCRATCH_POOL_H
+#define INCLUDED_ECA_SCRATCH_POOL_H
+
+#include <map>
+#include <vector>
+#include <pthread.h>
+
+#include "sample-specs.h"
+
+/**
+ * Process-wide pool of scratch audio buffers.
+ *
+ * Operators that need temporary audio buffers (for
+ * instance plugin hosts running out-of-place) take
+ * them from the pool when initialized and return them
+ * when released. Returned buffers are kept for reuse,
+ * so reinitializing chains does not allocate memory
+ * again.
+ *
+ * All functions are thread-safe, but not realtime-safe.
+ *
+ * @author agent
+ */
+class ECA_SCRATCH_POOL {
+
+ public:
+
+  typedef SAMPLE_SPECS::sample_t sample_t;
+
+  static sample_t* acquire(long int length);
+  static void release(sample_t* buffer, long int length);
+
+  static size_t free_count(void);
+
+ private:
+
+  typedef std::map<long int, std::vector<sample_t*> > free_map_t;
+
+  static free_map_t* free_repp;
+  static pthread_mutex_t lock_rep;
+
+  ECA_SCRATCH_POOL(void);
+  ECA_SCRATCH_POOL(const ECA_SCRATCH_POOL&);
+  ECA_SCRATCH_POOL& operator=(const ECA_SCRATCH_POOL&);
+  ~ECA_SCRATCH_POOL(void);
+};
+
+#endif
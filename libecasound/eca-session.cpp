@@ -1,6 +1,7 @@
 // ------------------------------------------------------------------------
 // eca-session.cpp: Ecasound runtime setup and parameters.
 // Copyright (C) 1999-2004,2007 Kai Vehmanen
+// Copyright (C) 2026 agent
 //
 // Attributes:
 //     eca-style-version: 3
@@ -36,6 +37,10 @@
 #include <kvu_dbc.h>
 
 #include "eca-resources.h"
+#include "eca-engine-trace.h"
+#include "eca-rt-checker.h"
+#include "eca-rt-memory.h"
+#include "eca-thread-affinity.h"
 #include "eca-version.h"
 
 #include "eca-chain.h"
@@ -174,6 +179,28 @@ void ECA_SESSION::set_cs_param_defaults(void)
     if (v.size() > 0)
       AAC_FORKED_INTERFACE::set_output_cmd(v);
 
+    ECA_RT_MEMORY::set_enabled(ecaresources.boolean_resource("rt-memory"));
+    ECA_RT_MEMORY::set_hugepage_mode(ecaresources.resource("rt-memory-hugepages"));
+
+    const std::vector<string>& classes = ECA_THREAD_AFFINITY::thread_classes();
+    for(size_t n = 0; n < classes.size(); n++) {
+      v = ecaresources.resource("affinity-" + classes[n]);
+      if (ECA_THREAD_AFFINITY::set_cpus(classes[n], v) != true)
+	ECA_LOG_MSG(ECA_LOGGER::info, 
+		    "WARNING: Invalid CPU list \"" + v + "\" for 'affinity-" + classes[n] + "'.");
+    }
+
+    if (ecaresources.boolean_resource("rt-checker") == true) {
+      if (ECA_RT_CHECKER::available() == true)
+	ECA_RT_CHECKER::set_enabled(true);
+      else
+	ECA_LOG_MSG(ECA_LOGGER::info, 
+		    "WARNING: Realtime checker not available, reconfigure with '--enable-rt-checker'.");
+    }
+
+    ECA_LOGGER::set_rt_logging(ecaresources.resource("rt-logging") == "true");
+    ECA_ENGINE_TRACE::set_enabled(ecaresources.resource("engine-trace") != "false");
+
     cs_defaults_set_rep = true;
   }
 }
@@ -1,6 +1,7 @@
 // ------------------------------------------------------------------------
 // eca-static-object-maps.h: Static object map instances
 // Copyright (C) 2000-2004,2006,2008,2009 Kai Vehmanen
+// Copyright (C) 2026 agent
 //
 // Attributes:
 //     eca-style-version: 3 (see Ecasound Programmer's Guide)
@@ -85,6 +86,7 @@
 #include "audioio-rtnull.h"
 #include "audioio-typeselect.h"
 #include "audioio-resample.h"
+#include "audioio-rtbridge.h"
 #include "audioio-reverse.h"
 #include "audioio-tone.h"
 #include "audioio-acseq.h"
@@ -114,6 +116,7 @@
 #endif
 
 #include "eca-object-map.h"
+#include "eca-plugin-cache.h"
 #include "eca-preset-map.h"
 #include "eca-static-object-maps.h"
 
@@ -132,7 +135,7 @@ using std::vector;
  * Declarations for static private helper functions
  */
 
-static vector<EFFECT_LADSPA*> eca_create_ladspa_plugins(const string& fname);
+static vector<EFFECT_LADSPA*> eca_create_ladspa_plugins(const string& fname, vector<ECA_PLUGIN_CACHE::PLUGIN_INFO>* infos);
 static void eca_import_lv2_plugins(ECA_OBJECT_MAP* objmap);
 static void eca_import_ladspa_plugins(ECA_OBJECT_MAP* objmap, bool reg_with_id);
 
@@ -140,6 +143,11 @@ static void eca_import_ladspa_plugins(ECA_OBJECT_MAP* objmap, bool reg_with_id);
 static void eca_import_internal_audioio_plugin(ECA_OBJECT_MAP* objmap, const string& filename);
 #endif
 
+#if !defined(ECA_DISABLE_EFFECTS) && defined(ECA_USE_LIBLILV)
+static string eca_lv2_search_path(void);
+static void eca_lv2_bundle_stamp(const string& lv2_path, long int* mtime, long int* size);
+#endif
+
 /**
  * Definitions of static member functions
  */
@@ -308,6 +316,7 @@ void ECA_STATIC_OBJECT_MAPS::register_audio_io_nonrt_objects(ECA_OBJECT_MAP* obj
   objmap->register_object("resample", "^resample$", new AUDIO_IO_RESAMPLE());
   objmap->register_object("resample-hq", "^resample-hq$", new AUDIO_IO_RESAMPLE());
   objmap->register_object("resample-lq", "^resample-lq$", new AUDIO_IO_RESAMPLE());
+  objmap->register_object("rtbridge", "^rtbridge$", new AUDIO_IO_RT_BRIDGE());
   objmap->register_object("reverse", "^reverse$", new AUDIO_IO_REVERSE());
   objmap->register_object("tone", "^tone$", new AUDIO_IO_TONE());
   objmap->register_object("audioloop", "^(audioloop|select|playat)$", new AUDIO_CLIP_SEQUENCER());
@@ -346,6 +355,7 @@ void ECA_STATIC_OBJECT_MAPS::register_chain_operator_objects(ECA_OBJECT_MAP* obj
   objmap->register_object("efr", "^efr$", new EFFECT_BANDREJECT());
   objmap->register_object("efs", "^efs$", new EFFECT_RESONATOR());
   objmap->register_object("ei", "^ei$", new EFFECT_PITCH_SHIFT());
+  objmap->register_object("eip", "^eip$", new EFFECT_PITCH_SHIFT_WSOLA());
   objmap->register_object("enm", "^enm$", new EFFECT_NOISEGATE());
   objmap->register_object("epp", "^epp$", new EFFECT_NORMAL_PAN());
   objmap->register_object("chorder", "^chorder$", new EFFECT_CHANNEL_ORDER());
@@ -539,6 +549,13 @@ static void eca_import_ladspa_plugins(ECA_OBJECT_MAP* objmap, bool reg_with_id)
     ++di;
   }
 
+  /* plugin files that have not changed since the previous
+   * scan are registered from the cache without opening them */
+  ECA_PLUGIN_CACHE cache;
+  string cache_path = ECA_PLUGIN_CACHE::default_path("ladspa");
+  if (cache_path.size() > 0)
+    cache.load(cache_path);
+
   /* go through all directories in the list and 
    * try to open all encountered files as LADSPA plugins */
   struct stat statbuf;
@@ -585,11 +602,31 @@ static void eca_import_ladspa_plugins(ECA_OBJECT_MAP* objmap, bool reg_with_id)
 
 	vector<EFFECT_LADSPA*> ladspa_plugins;
 
-	try {
-	  if (entry->d_name[0] != '.')
-	    ladspa_plugins = eca_create_ladspa_plugins(full_path_str.c_str());
+	if (entry->d_name[0] == '.')
+	  continue;
+
+	/* note: cache key is the link target's stamp */
+	struct stat filebuf;
+	bool cacheable = 
+	  cache_path.size() > 0 &&
+	  stat(full_path_str.c_str(), &filebuf) == 0;
+
+	if (cacheable == true &&
+	    cache.is_current(full_path_str, filebuf.st_mtime, filebuf.st_size) == true) {
+	  const vector<ECA_PLUGIN_CACHE::PLUGIN_INFO>& infos = cache.plugins(full_path_str);
+	  for(unsigned int n = 0; n < infos.size(); n++) {
+	    ladspa_plugins.push_back(new EFFECT_LADSPA(full_path_str, infos[n]));
+	  }
+	}
+	else {
+	  vector<ECA_PLUGIN_CACHE::PLUGIN_INFO> infos;
+	  try {
+	    ladspa_plugins = eca_create_ladspa_plugins(full_path_str, &infos);
+	  }
+	  catch(ECA_ERROR& e) {  }
+	  if (cacheable == true)
+	    cache.update(full_path_str, filebuf.st_mtime, filebuf.st_size, infos);
 	}
-	catch(ECA_ERROR& e) {  }
 
 	for(unsigned int n = 0; n < ladspa_plugins.size(); n++) {
 	  if (reg_with_id == true) {
@@ -604,12 +641,22 @@ static void eca_import_ladspa_plugins(ECA_OBJECT_MAP* objmap, bool reg_with_id)
 	  }
 	}
       }
+      closedir(dp);
     }
     ++p;
   }
+
+  if (cache_path.size() > 0 && cache.is_modified() == true)
+    cache.save();
 }
 
-static vector<EFFECT_LADSPA*> eca_create_ladspa_plugins(const string& fname)
+/**
+ * Opens plugin file 'fname' and creates one object for 
+ * each plugin type found. Information about the created 
+ * plugin types is stored to 'infos'.
+ */
+static vector<EFFECT_LADSPA*> eca_create_ladspa_plugins(const string& fname, 
+							vector<ECA_PLUGIN_CACHE::PLUGIN_INFO>* infos)
 {
   vector<EFFECT_LADSPA*> plugins;
 
@@ -626,6 +673,10 @@ static vector<EFFECT_LADSPA*> eca_create_ladspa_plugins(const string& fname)
 	if (plugin_desc == 0) break;
 	try {
 	  plugins.push_back(new EFFECT_LADSPA(plugin_desc));
+	  ECA_PLUGIN_CACHE::PLUGIN_INFO info;
+	  plugins.back()->plugin_info(&info);
+	  info.index = i;
+	  infos->push_back(info);
 	}
 	catch (ECA_ERROR&) { }
 	plugin_desc = 0;
@@ -649,9 +700,32 @@ static vector<EFFECT_LADSPA*> eca_create_ladspa_plugins(const string& fname)
 static void eca_import_lv2_plugins(ECA_OBJECT_MAP* objmap)
 {
 #if !defined(ECA_DISABLE_EFFECTS) && defined(ECA_USE_LIBLILV)
-	LilvWorld* world=ECA_LV2_WORLD::World();
-	lilv_world_load_all(world);
-	const LilvPlugins* plugins=lilv_world_get_all_plugins(world);
+	/* LV2 metadata is parsed for all bundles at once, so the
+	 * cache is used only if no bundle has changed */
+	ECA_PLUGIN_CACHE cache;
+	string cache_path = ECA_PLUGIN_CACHE::default_path("lv2");
+	string lv2_path = eca_lv2_search_path();
+	long int mtime = 0, size = 0;
+	if (cache_path.size() > 0) {
+		eca_lv2_bundle_stamp(lv2_path, &mtime, &size);
+		cache.load(cache_path);
+		if (cache.is_current(lv2_path, mtime, size) == true) {
+			const vector<ECA_PLUGIN_CACHE::PLUGIN_INFO>& infos = cache.plugins(lv2_path);
+			for(unsigned int n = 0; n < infos.size(); n++) {
+				EFFECT_LV2* eff=new EFFECT_LV2(infos[n]);
+				objmap->register_object(eff->unique(), 
+					"^" + kvu_string_regex_meta_escape(eff->unique()) + "$",
+					eff);
+			}
+			if (cache.is_modified() == true)
+				cache.save();
+			return;
+		}
+	}
+
+	vector<ECA_PLUGIN_CACHE::PLUGIN_INFO> infos;
+	ECA_LV2_WORLD::LoadAll();
+	const LilvPlugins* plugins=lilv_world_get_all_plugins(ECA_LV2_WORLD::World());
 	LILV_FOREACH(plugins,i,plugins) {
 		const LilvPlugin* p=lilv_plugins_get(plugins,i);
 		try {
@@ -659,7 +733,82 @@ static void eca_import_lv2_plugins(ECA_OBJECT_MAP* objmap)
 		objmap->register_object(eff->unique(), 
 			"^" + kvu_string_regex_meta_escape(eff->unique()) + "$",
 			eff);
+		ECA_PLUGIN_CACHE::PLUGIN_INFO info;
+		eff->plugin_info(&info);
+		infos.push_back(info);
 		} catch (ECA_ERROR&) { }
     }
+
+	if (cache_path.size() > 0) {
+		cache.update(lv2_path, mtime, size, infos);
+		cache.save();
+	}
 #endif
 }
+
+#if !defined(ECA_DISABLE_EFFECTS) && defined(ECA_USE_LIBLILV)
+/**
+ * Returns the LV2 bundle search path, using the
+ * same defaults as lilv.
+ */
+static string eca_lv2_search_path(void)
+{
+  char* env = std::getenv("LV2_PATH");
+  if (env != 0)
+    return string(env);
+
+  string home;
+  env = std::getenv("HOME");
+  if (env != 0)
+    home = string(env);
+
+  return home + "/.lv2:/usr/local/lib/lv2:/usr/lib/lv2";
+}
+
+/**
+ * Computes a stamp for all LV2 bundles found in 
+ * 'lv2_path': the latest modification time of any
+ * bundle or bundle file, and the total size and 
+ * number of bundle files.
+ */
+static void eca_lv2_bundle_stamp(const string& lv2_path, long int* mtime, long int* size)
+{
+  *mtime = 0;
+  *size = 0;
+
+  vector<string> dir_names = kvu_string_to_vector(lv2_path, ':');
+  for(unsigned int n = 0; n < dir_names.size(); n++) {
+    DIR *dp = opendir(dir_names[n].c_str());
+    if (dp == 0) 
+      continue;
+
+    for(struct dirent *entry = readdir(dp); entry != 0; entry = readdir(dp)) {
+      if (entry->d_name[0] == '.')
+	continue;
+
+      string bundle = dir_names[n] + "/" + entry->d_name;
+      struct stat statbuf;
+      if (stat(bundle.c_str(), &statbuf) != 0 ||
+	  S_ISDIR(statbuf.st_mode) != true)
+	continue;
+
+      if (statbuf.st_mtime > *mtime) *mtime = statbuf.st_mtime;
+
+      DIR *bp = opendir(bundle.c_str());
+      if (bp == 0)
+	continue;
+
+      for(struct dirent *f = readdir(bp); f != 0; f = readdir(bp)) {
+	string file = bundle + "/" + f->d_name;
+	if (f->d_name[0] != '.' && 
+	    stat(file.c_str(), &statbuf) == 0) {
+	  if (statbuf.st_mtime > *mtime) *mtime = statbuf.st_mtime;
+	  *size += statbuf.st_size + 1;
+	}
+      }
+      closedir(bp);
+    }
+    closedir(dp);
+  }
+}
+#endif /* !ECA_DISABLE_EFFECTS && ECA_USE_LIBLILV */
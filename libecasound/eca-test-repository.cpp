@@ -21,6 +21,10 @@
 // Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
 // ------------------------------------------------------------------------
 
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
 #include "kvu_locks.h"
 #include "kvu_numtostr.h"
 
@@ -52,10 +56,25 @@ ECA_TEST_REPOSITORY& ECA_TEST_REPOSITORY::instance(void)
  */
 
 #include "audiofx_amplitude_test.h"
+#include "audiofx_ladspa_test.h"
+#if ECA_USE_LIBLILV
+#include "audiofx_lv2_worker_test.h"
+#endif
+#include "audiofx_sandbox_test.h"
+#include "audiofx_timebased_test.h"
 #include "eca-audio-time_test.h"
+#include "eca-chain-delay_test.h"
+#include "eca-engine-trace_test.h"
+#include "eca-logger-rt_test.h"
+#include "eca-async-resampler_test.h"
+#include "eca-rt-checker_test.h"
+#include "eca-rt-memory_test.h"
+#include "eca-thread-affinity_test.h"
+#include "eca-trace-recorder_test.h"
 #include "eca-control_test.h"
 #include "eca-session_test.h"
 #include "eca-object-factory_test.h"
+#include "eca-plugin-cache_test.h"
 #include "eca-sample-conversion_test.h"
 #include "eca-chainsetup_test.h"
 #include "eca-chainsetup-parser_test.h"
@@ -72,10 +91,26 @@ ECA_TEST_REPOSITORY::ECA_TEST_REPOSITORY(void)
 {
   test_cases_rep.push_back(new EFFECT_AMPLIFY_TEST());
   test_cases_rep.push_back(new EFFECT_AMPLIFY_CHANNEL_TEST());
+  test_cases_rep.push_back(new EFFECT_LADSPA_TEST());
+#if ECA_USE_LIBLILV
+  test_cases_rep.push_back(new ECA_LV2_WORKER_TEST());
+#endif
+  test_cases_rep.push_back(new EFFECT_SANDBOX_TEST());
+  test_cases_rep.push_back(new EFFECT_DELAY_TEST());
+  test_cases_rep.push_back(new EFFECT_PITCH_SHIFT_WSOLA_TEST());
   test_cases_rep.push_back(new ECA_AUDIO_TIME_TEST());
+  test_cases_rep.push_back(new ECA_CHAIN_DELAY_TEST());
+  test_cases_rep.push_back(new ECA_ASYNC_RESAMPLER_TEST());
+  test_cases_rep.push_back(new ECA_LOGGER_RT_TEST());
+  test_cases_rep.push_back(new ECA_RT_MEMORY_TEST());
+  test_cases_rep.push_back(new ECA_RT_CHECKER_TEST());
+  test_cases_rep.push_back(new ECA_THREAD_AFFINITY_TEST());
+  test_cases_rep.push_back(new ECA_ENGINE_TRACE_TEST());
+  test_cases_rep.push_back(new ECA_TRACE_RECORDER_TEST());
   test_cases_rep.push_back(new ECA_SESSION_TEST());
   test_cases_rep.push_back(new ECA_CONTROL_TEST());
   test_cases_rep.push_back(new ECA_OBJECT_FACTORY_TEST());
+  test_cases_rep.push_back(new ECA_PLUGIN_CACHE_TEST());
   test_cases_rep.push_back(new ECA_SAMPLE_CONVERSION_TEST());
   test_cases_rep.push_back(new ECA_CHAINSETUP_TEST());
   test_cases_rep.push_back(new ECA_CHAINSETUP_PARSER_TEST());
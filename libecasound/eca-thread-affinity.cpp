@@ -0,0 +1,306 @@
+// ------------------------------------------------------------------------
+// eca-thread-affinity.cpp: CPU affinity settings for ecasound threads
+// Copyright (C) 2026 agent
+//
+// Attributes:
+//     eca-style-version: 3
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
+// ------------------------------------------------------------------------
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <algorithm>
+#include <iterator> /* back_inserter() */
+
+#include <kvu_dbc.h>
+#include <kvu_locks.h>
+#include <kvu_rtcaps.h>
+
+#include "eca-logger.h"
+#include "eca-thread-affinity.h"
+
+ECA_THREAD_AFFINITY::cpu_map_t* ECA_THREAD_AFFINITY::requested_repp = 0;
+ECA_THREAD_AFFINITY::cpu_map_t* ECA_THREAD_AFFINITY::applied_repp = 0;
+ECA_THREAD_AFFINITY::cpu_map_t* ECA_THREAD_AFFINITY::applied_request_repp = 0;
+std::string* ECA_THREAD_AFFINITY::default_repp = 0;
+ECA_THREAD_AFFINITY::flag_map_t* ECA_THREAD_AFFINITY::restricted_repp = 0;
+pthread_mutex_t ECA_THREAD_AFFINITY::lock_rep = PTHREAD_MUTEX_INITIALIZER;
+
+/**
+ * Thread classes that process audio.
+ */
+static const char* thread_affinity_audio_classes[] = { "engine", "audio", 0 };
+
+/**
+ * Thread classes that should not share CPUs with
+ * threads processing audio.
+ */
+static const char* thread_affinity_io_classes[] = { "io", "midi", "neteci", 0 };
+
+/**
+ * Returns names of all thread classes.
+ */
+const std::vector<std::string>& ECA_THREAD_AFFINITY::thread_classes(void)
+{
+  static std::vector<std::string> classes;
+  KVU_GUARD_LOCK guard(&lock_rep);
+  if (classes.size() == 0) {
+    classes.push_back("engine");
+    classes.push_back("audio");
+    classes.push_back("io");
+    classes.push_back("midi");
+    classes.push_back("neteci");
+    classes.push_back("worker");
+  }
+  return classes;
+}
+
+bool ECA_THREAD_AFFINITY::is_thread_class(const std::string& thread_class)
+{
+  const std::vector<std::string>& classes = thread_classes();
+  return (std::find(classes.begin(), classes.end(), thread_class) != classes.end());
+}
+
+/**
+ * Restricts threads of class 'thread_class' to 'cpus'.
+ * An empty 'cpus' removes the restriction. Affects
+ * threads started after the call.
+ *
+ * @return false if 'thread_class' or 'cpus' is invalid
+ */
+bool ECA_THREAD_AFFINITY::set_cpus(const std::string& thread_class, const std::string& cpus)
+{
+  std::vector<int> cpuset;
+  if (is_thread_class(thread_class) != true ||
+      (cpus.size() > 0 && kvu_parse_cpu_list(cpus, &cpuset) != true))
+    return false;
+
+  KVU_GUARD_LOCK guard(&lock_rep);
+  store_default();
+  if (requested_repp == 0)
+    requested_repp = new cpu_map_t();
+  (*requested_repp)[thread_class] = kvu_cpu_list_to_string(cpuset);
+
+  return true;
+}
+
+/**
+ * Returns the CPUs threads of class 'thread_class' are
+ * restricted to, or an empty string if not restricted.
+ */
+std::string ECA_THREAD_AFFINITY::cpus(const std::string& thread_class)
+{
+  KVU_GUARD_LOCK guard(&lock_rep);
+  if (requested_repp == 0 ||
+      requested_repp->find(thread_class) == requested_repp->end())
+    return "";
+
+  return (*requested_repp)[thread_class];
+}
+
+/**
+ * Applies the affinity set for 'thread_class' to the
+ * calling thread.
+ *
+ * @see apply(const std::string&, const std::string&)
+ */
+bool ECA_THREAD_AFFINITY::apply(const std::string& thread_class)
+{
+  return apply(thread_class, cpus(thread_class));
+}
+
+/**
+ * Restricts the calling thread, which is of class
+ * 'thread_class', to 'cpus'. If 'cpus' is empty, the
+ * thread is allowed to run on all CPUs the process 
+ * could run on when first configured. This way 
+ * threads do not inherit restrictions from the 
+ * thread that created them. In both cases, the CPUs
+ * the thread is allowed to run on are stored for 
+ * status().
+ *
+ * @return false if affinity could not be set
+ */
+bool ECA_THREAD_AFFINITY::apply(const std::string& thread_class, const std::string& cpus)
+{
+  // --
+  DBC_REQUIRE(is_thread_class(thread_class) == true);
+  // --
+
+  std::string target (cpus);
+  if (target.size() == 0) {
+    KVU_GUARD_LOCK guard(&lock_rep);
+    store_default();
+    target = *default_repp;
+  }
+
+  bool result = true;
+  std::vector<int> cpuset;
+  if (target.size() > 0) {
+    if (kvu_parse_cpu_list(target, &cpuset) != true ||
+	kvu_set_thread_affinity(cpuset) != 0) {
+      ECA_LOG_MSG(ECA_LOGGER::info,
+		  "WARNING: Unable to restrict " + thread_class +
+		  " thread to CPUs " + target + ".");
+      result = false;
+    }
+  }
+
+  std::string applied;
+  if (kvu_get_thread_affinity(&cpuset) == 0)
+    applied = kvu_cpu_list_to_string(cpuset);
+
+  {
+    KVU_GUARD_LOCK guard(&lock_rep);
+    if (applied_repp == 0) {
+      applied_repp = new cpu_map_t();
+      applied_request_repp = new cpu_map_t();
+    }
+    (*applied_repp)[thread_class] = applied;
+    (*applied_request_repp)[thread_class] = cpus;
+    if (restricted_repp == 0)
+      restricted_repp = new flag_map_t();
+    (*restricted_repp)[thread_class] = (cpus.size() > 0 && result == true);
+  }
+
+  if (cpus.size() > 0 && result == true)
+    ECA_LOG_MSG(ECA_LOGGER::user_objects,
+		"Restricted " + thread_class + " thread to CPUs " + applied + ".");
+
+  /* note: only warn if the audio thread has been 
+   *       restricted, otherwise sharing is expected */
+  for(int m = 0; thread_affinity_audio_classes[m] != 0; m++) {
+    std::string audio_class (thread_affinity_audio_classes[m]);
+    if (restricted(audio_class) != true)
+      continue;
+    for(int n = 0; thread_affinity_io_classes[n] != 0; n++) {
+      std::string io_class (thread_affinity_io_classes[n]);
+      if (thread_class != audio_class && thread_class != io_class)
+	continue;
+      std::string shared = 
+	shared_cpus(applied_cpus(audio_class), applied_cpus(io_class));
+      if (shared.size() > 0)
+	ECA_LOG_MSG(ECA_LOGGER::info,
+		    "WARNING: " + audio_class + " thread shares CPUs " + shared +
+		    " with " + io_class + " thread.");
+    }
+  }
+
+  return result;
+}
+
+/**
+ * Returns the CPUs the last started thread of class
+ * 'thread_class' was allowed to run on, or an empty
+ * string if no such thread has been started.
+ */
+std::string ECA_THREAD_AFFINITY::applied_cpus(const std::string& thread_class)
+{
+  KVU_GUARD_LOCK guard(&lock_rep);
+  if (applied_repp == 0 ||
+      applied_repp->find(thread_class) == applied_repp->end())
+    return "";
+
+  return (*applied_repp)[thread_class];
+}
+
+/**
+ * Returns a description of requested and applied
+ * affinities, one line per thread class. For started
+ * threads, the request is the one they applied, which
+ * may come from a chainsetup. If the engine or the
+ * audio threads are restricted, also lists I/O threads
+ * that may run on their CPUs.
+ */
+std::string ECA_THREAD_AFFINITY::status(void)
+{
+  const std::vector<std::string>& classes = thread_classes();
+
+  std::string result;
+  for(size_t n = 0; n < classes.size(); n++) {
+    std::string requested = cpus(classes[n]);
+    std::string applied = applied_cpus(classes[n]);
+    if (applied.size() > 0) {
+      KVU_GUARD_LOCK guard(&lock_rep);
+      requested = (*applied_request_repp)[classes[n]];
+    }
+    if (n > 0) result += "\n";
+    result += classes[n] +
+      ": requested " + (requested.size() > 0 ? requested : "any") +
+      ", applied " + (applied.size() > 0 ? applied : "not started");
+  }
+
+  for(int m = 0; thread_affinity_audio_classes[m] != 0; m++) {
+    std::string audio_class (thread_affinity_audio_classes[m]);
+    if (restricted(audio_class) != true)
+      continue;
+    for(int n = 0; thread_affinity_io_classes[n] != 0; n++) {
+      std::string shared = shared_cpus(applied_cpus(audio_class), 
+				       applied_cpus(thread_affinity_io_classes[n]));
+      if (shared.size() > 0)
+	result += "\nWARNING: " + audio_class + " shares CPUs " +
+	  shared + " with " + thread_affinity_io_classes[n] + " thread";
+    }
+  }
+
+  return result;
+}
+
+/**
+ * Whether the last started thread of class 'thread_class'
+ * was restricted to the CPUs requested for it.
+ */
+bool ECA_THREAD_AFFINITY::restricted(const std::string& thread_class)
+{
+  KVU_GUARD_LOCK guard(&lock_rep);
+  if (restricted_repp == 0 ||
+      restricted_repp->find(thread_class) == restricted_repp->end())
+    return false;
+
+  return (*restricted_repp)[thread_class];
+}
+
+/**
+ * Stores the CPUs the calling thread may run on as
+ * the default, unless already stored. Must be called
+ * with 'lock_rep' held.
+ */
+void ECA_THREAD_AFFINITY::store_default(void)
+{
+  if (default_repp == 0) {
+    std::vector<int> cpuset;
+    default_repp = new std::string();
+    if (kvu_get_thread_affinity(&cpuset) == 0)
+      *default_repp = kvu_cpu_list_to_string(cpuset);
+  }
+}
+
+/**
+ * Returns CPUs in both 'cpus_a' and 'cpus_b'.
+ */
+std::string ECA_THREAD_AFFINITY::shared_cpus(const std::string& cpus_a, const std::string& cpus_b)
+{
+  std::vector<int> a, b, shared;
+  if (kvu_parse_cpu_list(cpus_a, &a) != true ||
+      kvu_parse_cpu_list(cpus_b, &b) != true)
+    return "";
+
+  std::set_intersection(a.begin(), a.end(), b.begin(), b.end(),
+			std::back_inserter(shared));
+  return kvu_cpu_list_to_string(shared);
+}
@@ -0,0 +1,89 @@
+#ifndef INCLUDED_ECA_THREAD_AFFINITY_H
+#define INCLUDED_ECA_THREAD_AFFINITY_H
+
+#include <map>
+#include <string>
+#include <vector>
+#include <pthread.h>
+
+/**
+ * Process-wide CPU affinity settings for the threads
+ * ecasound creates.
+ *
+ * Threads are grouped into classes:
+ *     - engine: thread running the engine (with JACK,
+ *               the JACK process thread is created
+ *               by JACK and not affected)
+ *     - audio:  JACK chain worker threads
+ *     - io:     double-buffering server and resampling
+ *               bridge threads
+ *     - midi:   MIDI server thread
+ *     - neteci: NetECI server thread
+ *     - worker: plugin and LV2 worker threads
+ *
+ * Each class can be restricted to a set of CPUs, given
+ * as a list like "0-3,6" (ecasoundrc options
+ * 'affinity-CLASS'). Chainsetups can override the
+ * setting for engine, io and midi threads (see
+ * ECA_CHAINSETUP::set_thread_affinity()). Threads call
+ * apply() when they start, after which the CPUs the
+ * thread was actually allowed to run on are reported
+ * by status().
+ *
+ * All functions are thread-safe, but not realtime-safe.
+ *
+ * @author agent
+ */
+class ECA_THREAD_AFFINITY {
+
+ public:
+
+  /** @name Configuration */
+  /*@{*/
+
+  static const std::vector<std::string>& thread_classes(void);
+  static bool is_thread_class(const std::string& thread_class);
+  static bool set_cpus(const std::string& thread_class, const std::string& cpus);
+  static std::string cpus(const std::string& thread_class);
+
+  /*@}*/
+
+  /** @name Applying */
+  /*@{*/
+
+  static bool apply(const std::string& thread_class);
+  static bool apply(const std::string& thread_class, const std::string& cpus);
+
+  /*@}*/
+
+  /** @name Status */
+  /*@{*/
+
+  static std::string applied_cpus(const std::string& thread_class);
+  static std::string status(void);
+
+  /*@}*/
+
+ private:
+
+  typedef std::map<std::string, std::string> cpu_map_t;
+  typedef std::map<std::string, bool> flag_map_t;
+
+  static cpu_map_t* requested_repp;
+  static cpu_map_t* applied_repp;
+  static cpu_map_t* applied_request_repp;
+  static std::string* default_repp;
+  static flag_map_t* restricted_repp;
+  static pthread_mutex_t lock_rep;
+
+  static bool restricted(const std::string& thread_class);
+  static void store_default(void);
+  static std::string shared_cpus(const std::string& cpus_a, const std::string& cpus_b);
+
+  ECA_THREAD_AFFINITY(void);
+  ECA_THREAD_AFFINITY(const ECA_THREAD_AFFINITY&);
+  ECA_THREAD_AFFINITY& operator=(const ECA_THREAD_AFFINITY&);
+  ~ECA_THREAD_AFFINITY(void);
+};
+
+#endif
@@ -0,0 +1,179 @@
+// ------------------------------------------------------------------------
+// eca-thread-affinity_test.h: Unit test for ECA_THREAD_AFFINITY
+// Copyright (C) 2026 agent
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
+// ------------------------------------------------------------------------
+
+#include <cstdio>
+#include <string>
+#include <vector>
+#include <pthread.h>
+
+#include <kvu_numtostr.h>
+#include <kvu_rtcaps.h>
+
+#include "eca-chainsetup.h"
+#include "eca-thread-affinity.h"
+#include "eca-test-case.h"
+
+using namespace std;
+
+/**
+ * Unit test for ECA_THREAD_AFFINITY
+ */
+class ECA_THREAD_AFFINITY_TEST : public ECA_TEST_CASE {
+
+protected:
+
+  virtual string do_name(void) const { return("ECA_THREAD_AFFINITY"); }
+  virtual void do_run(void);
+
+public:
+
+  virtual ~ECA_THREAD_AFFINITY_TEST(void) { }
+
+private:
+
+  static void* worker_thread(void* arg);
+  static void* audio_io_thread(void* arg);
+};
+
+/**
+ * Applies the 'worker' affinity, and stores the
+ * resulting CPU list to 'arg'.
+ */
+void* ECA_THREAD_AFFINITY_TEST::worker_thread(void* arg)
+{
+  ECA_THREAD_AFFINITY::apply("worker");
+
+  vector<int> cpus;
+  kvu_get_thread_affinity(&cpus);
+  *static_cast<string*>(arg) = kvu_cpu_list_to_string(cpus);
+  return 0;
+}
+
+/**
+ * Applies the 'audio' and then the 'io' affinity.
+ */
+void* ECA_THREAD_AFFINITY_TEST::audio_io_thread(void* arg)
+{
+  ECA_THREAD_AFFINITY::apply("audio");
+  ECA_THREAD_AFFINITY::apply("io");
+  return 0;
+}
+
+void ECA_THREAD_AFFINITY_TEST::do_run(void)
+{
+  std::fprintf(stdout, "%s: tests for %s class\n",
+	       name().c_str(), __FILE__);
+
+  /* case: validation */
+  {
+    if (ECA_THREAD_AFFINITY::set_cpus("dsp", "0") == true)
+      ECA_TEST_FAILURE("unknown thread class accepted");
+    if (ECA_THREAD_AFFINITY::set_cpus("worker", "0-") == true)
+      ECA_TEST_FAILURE("invalid CPU list accepted");
+    if (ECA_THREAD_AFFINITY::set_cpus("worker", "3,1-2") != true ||
+	ECA_THREAD_AFFINITY::cpus("worker") != "1-3")
+      ECA_TEST_FAILURE("CPU list not stored");
+    ECA_THREAD_AFFINITY::set_cpus("worker", "");
+    if (ECA_THREAD_AFFINITY::cpus("worker").size() != 0)
+      ECA_TEST_FAILURE("CPU list not cleared");
+  }
+
+  /* case: chainsetup overrides */
+  {
+    ECA_CHAINSETUP csetup;
+    ECA_THREAD_AFFINITY::set_cpus("midi", "0");
+    if (csetup.set_thread_affinity("neteci", "0") == true)
+      ECA_TEST_FAILURE("neteci override accepted");
+    if (csetup.thread_affinity("midi") != "0")
+      ECA_TEST_FAILURE("process-wide setting not used");
+    if (csetup.set_thread_affinity("midi", "1,0") != true ||
+	csetup.thread_affinity("midi") != "0-1")
+      ECA_TEST_FAILURE("override not used");
+    csetup.set_thread_affinity("midi", "");
+    if (csetup.thread_affinity("midi") != "0")
+      ECA_TEST_FAILURE("override not removed");
+    ECA_THREAD_AFFINITY::set_cpus("midi", "");
+  }
+
+  /* case: applying to a new thread */
+  vector<int> orig;
+  if (kvu_get_thread_affinity(&orig) != 0) {
+    std::fprintf(stdout, "%s: thread affinity not supported, skipping\n",
+		 name().c_str());
+    return;
+  }
+
+  {
+    string cpu = kvu_numtostr(orig.back());
+    ECA_THREAD_AFFINITY::set_cpus("worker", cpu);
+
+    string result;
+    pthread_t thread;
+    pthread_create(&thread, NULL, worker_thread, &result);
+    pthread_join(thread, NULL);
+
+    if (result != cpu)
+      ECA_TEST_FAILURE("affinity not applied: " + result);
+    if (ECA_THREAD_AFFINITY::applied_cpus("worker") != cpu)
+      ECA_TEST_FAILURE("applied affinity not reported");
+    if (ECA_THREAD_AFFINITY::status().find("worker: requested " + cpu +
+					     ", applied " + cpu) == string::npos)
+      ECA_TEST_FAILURE("status: " + ECA_THREAD_AFFINITY::status());
+
+    ECA_THREAD_AFFINITY::set_cpus("worker", "");
+  }
+
+  /* case: I/O thread sharing CPUs with audio threads */
+  {
+    string cpu = kvu_numtostr(orig.back());
+    ECA_THREAD_AFFINITY::set_cpus("audio", cpu);
+    ECA_THREAD_AFFINITY::set_cpus("io", cpu);
+
+    pthread_t thread;
+    pthread_create(&thread, NULL, audio_io_thread, NULL);
+    pthread_join(thread, NULL);
+
+    if (ECA_THREAD_AFFINITY::status().find("WARNING: audio shares CPUs " + cpu +
+					     " with io thread") == string::npos)
+      ECA_TEST_FAILURE("sharing not reported: " + ECA_THREAD_AFFINITY::status());
+
+    ECA_THREAD_AFFINITY::set_cpus("audio", "");
+    ECA_THREAD_AFFINITY::set_cpus("io", "");
+    pthread_create(&thread, NULL, audio_io_thread, NULL);
+    pthread_join(thread, NULL);
+
+    if (ECA_THREAD_AFFINITY::status().find("WARNING") != string::npos)
+      ECA_TEST_FAILURE("sharing reported without restriction");
+  }
+
+  /* case: threads do not inherit restrictions */
+  if (orig.size() > 1) {
+    kvu_set_thread_affinity(vector<int> (1, orig[0]));
+
+    string result;
+    pthread_t thread;
+    pthread_create(&thread, NULL, worker_thread, &result);
+    pthread_join(thread, NULL);
+
+    kvu_set_thread_affinity(orig);
+
+    if (result != kvu_cpu_list_to_string(orig))
+      ECA_TEST_FAILURE("restriction inherited: " + result);
+  }
+}
@@ -0,0 +1,575 @@
+// ------------------------------------------------------------------------
+// eca-trace-recorder.cpp: Timeline trace recorder for ecasound threads
+// Copyright (C) 2026 agent
+//
+// Attributes:
+//     eca-style-version: 3
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
+// ------------------------------------------------------------------------
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <algorithm>
+#include <fstream>
+#include <set>
+#include <string>
+#include <vector>
+#include <cstdio> /* snprintf() */
+#include <cstring>
+#include <pthread.h>
+#include <unistd.h> /* getpid() */
+
+#include <kvu_dbc.h>
+#include <kvu_inttypes.h>
+#include <kvu_locks.h>
+#include <kvu_numtostr.h>
+#include <kvu_timestamp.h>
+
+#include "eca-trace-recorder.h"
+
+using std::string;
+using std::vector;
+
+/**
+ * One recorded event. Times are in nanoseconds of the
+ * monotonic clock.
+ */
+struct ECA_TRACE_EVENT {
+  int tid;
+  const char* category;
+  char name[sizeof(((ECA_TRACE_SPAN*)0)->name)];
+  int64_t start_ns;
+  int64_t dur_ns;
+};
+
+/**
+ * Ring slot. 'index' is the position of the event in
+ * the stream of events written to the ring, which tells
+ * the reader whether the slot has been overwritten.
+ */
+struct ECA_TRACE_SLOT {
+  KVU_SEQLOCK lock;
+  long int index;
+  ECA_TRACE_EVENT event;
+};
+
+static const int eca_trace_rings = 16;
+static const long int eca_trace_ring_size = 4096;
+static const int eca_trace_named_threads = 256;
+
+/**
+ * Single-producer ring of events. The producer is the
+ * thread that has claimed the ring. 'first_index' is
+ * only used by readers, under 'eca_trace_lock'.
+ */
+struct ECA_TRACE_RING {
+  volatile int claimed;
+  int tid;
+  volatile long int write_index;
+  long int first_index;
+  ECA_TRACE_SLOT slots[eca_trace_ring_size];
+};
+
+/* note: allocated when first enabled, and never freed, as
+ *       threads may record into the rings at any time */
+static ECA_TRACE_RING* eca_trace_ring_pool = 0;
+static volatile int eca_trace_next_tid = 0;
+static volatile long int eca_trace_dropped = 0;
+static char eca_trace_thread_names[eca_trace_named_threads][24];
+static pthread_mutex_t eca_trace_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_key_t eca_trace_ring_key;
+static pthread_key_t eca_trace_name_key;
+static pthread_once_t eca_trace_key_once = PTHREAD_ONCE_INIT;
+
+bool ECA_TRACE_RECORDER::enabled_rep = false;
+
+/**
+ * Releases the ring claimed by an exiting thread. Events
+ * stay in the ring, tagged with the thread's id.
+ */
+static void eca_trace_release_ring(void* arg)
+{
+  ECA_TRACE_RING* ring = reinterpret_cast<ECA_TRACE_RING*>(arg);
+  __sync_lock_release(&ring->claimed);
+}
+
+static void eca_trace_create_key(void)
+{
+  pthread_key_create(&eca_trace_ring_key, eca_trace_release_ring);
+  pthread_key_create(&eca_trace_name_key, NULL);
+}
+
+/**
+ * Copies the name set with set_thread_name(), if any,
+ * to the name table entry of 'ring'.
+ */
+static void eca_trace_store_name(const ECA_TRACE_RING* ring)
+{
+  const char* name =
+    reinterpret_cast<const char*>(pthread_getspecific(eca_trace_name_key));
+  if (ring->tid < eca_trace_named_threads) {
+    char* dst = eca_trace_thread_names[ring->tid];
+    dst[0] = 0;
+    if (name != 0) {
+      strncpy(dst, name, sizeof(eca_trace_thread_names[0]) - 1);
+      dst[sizeof(eca_trace_thread_names[0]) - 1] = 0;
+    }
+  }
+}
+
+/**
+ * Returns the ring of the calling thread, claiming a
+ * free one on first use. Each claim gets a new thread
+ * id. Returns 0 if all rings are in use.
+ *
+ * Realtime-safe.
+ */
+static ECA_TRACE_RING* eca_trace_thread_ring(void)
+{
+  if (eca_trace_ring_pool == 0)
+    return 0;
+
+  ECA_TRACE_RING* ring =
+    reinterpret_cast<ECA_TRACE_RING*>(pthread_getspecific(eca_trace_ring_key));
+
+  if (ring == 0) {
+    for(int n = 0; n < eca_trace_rings; n++) {
+      if (__sync_bool_compare_and_swap(&eca_trace_ring_pool[n].claimed, 0, 1) == true) {
+	ring = &eca_trace_ring_pool[n];
+	ring->tid = __sync_add_and_fetch(&eca_trace_next_tid, 1);
+	eca_trace_store_name(ring);
+	pthread_setspecific(eca_trace_ring_key, ring);
+	break;
+      }
+    }
+  }
+
+  return ring;
+}
+
+static int64_t eca_trace_ns(const struct timespec& ts)
+{
+  return static_cast<int64_t>(ts.tv_sec) * 1000000000 + ts.tv_nsec;
+}
+
+/**
+ * Returns a copy of all events in the rings, and the
+ * names of the threads that recorded them.
+ *
+ * Must be called with 'eca_trace_lock' held.
+ */
+static vector<ECA_TRACE_EVENT> eca_trace_collect(std::set<int>* tids)
+{
+  vector<ECA_TRACE_EVENT> result;
+
+  for(int n = 0; eca_trace_ring_pool != 0 && n < eca_trace_rings; n++) {
+    const ECA_TRACE_RING& ring = eca_trace_ring_pool[n];
+    long int end = ring.write_index;
+    __sync_synchronize();
+
+    long int first = ring.first_index;
+    if (end - first > eca_trace_ring_size)
+      first = end - eca_trace_ring_size;
+
+    for(long int i = first; i < end; i++) {
+      const ECA_TRACE_SLOT& slot = ring.slots[i % eca_trace_ring_size];
+      ECA_TRACE_EVENT event;
+      long int index;
+      unsigned int seq;
+      do {
+	seq = slot.lock.read_begin();
+	index = slot.index;
+	event = slot.event;
+      }
+      while(slot.lock.read_retry(seq) == true);
+
+      /* note: skip events overwritten while reading */
+      if (index != i)
+	continue;
+
+      result.push_back(event);
+      tids->insert(event.tid);
+    }
+  }
+
+  return result;
+}
+
+static string eca_trace_thread_name(int tid)
+{
+  string name;
+  if (tid < eca_trace_named_threads)
+    name = string(eca_trace_thread_names[tid],
+		  strnlen(eca_trace_thread_names[tid], sizeof(eca_trace_thread_names[tid])));
+  if (name.size() == 0)
+    name = "thread-" + kvu_numtostr(tid);
+  return name;
+}
+
+static string eca_trace_json_string(const char* str)
+{
+  string result ("\"");
+  for(const char* p = str; *p != 0; p++) {
+    unsigned char c = static_cast<unsigned char>(*p);
+    if (c == '"' || c == '\\') {
+      result += '\\';
+      result += *p;
+    }
+    else if (c < 0x20) {
+      char buf[8];
+      snprintf(buf, sizeof(buf), "\\u%04x", c);
+      result += buf;
+    }
+    else
+      result += *p;
+  }
+  result += "\"";
+  return result;
+}
+
+static string eca_trace_json_usecs(int64_t ns)
+{
+  return kvu_numtostr(static_cast<double>(ns) / 1000.0, 3);
+}
+
+static void eca_trace_pb_varint(string* out, uint64_t value)
+{
+  while(value >= 0x80) {
+    *out += static_cast<char>((value & 0x7f) | 0x80);
+    value >>= 7;
+  }
+  *out += static_cast<char>(value);
+}
+
+static void eca_trace_pb_uint(string* out, int field, uint64_t value)
+{
+  eca_trace_pb_varint(out, static_cast<uint64_t>(field) << 3);
+  eca_trace_pb_varint(out, value);
+}
+
+static void eca_trace_pb_bytes(string* out, int field, const string& value)
+{
+  eca_trace_pb_varint(out, (static_cast<uint64_t>(field) << 3) | 2);
+  eca_trace_pb_varint(out, value.size());
+  *out += value;
+}
+
+/**
+ * Slice begin or end, ordered so that slices on each
+ * track nest properly.
+ */
+struct ECA_TRACE_EDGE {
+  int64_t ts;
+  bool begin;
+  const ECA_TRACE_EVENT* event;
+
+  bool operator<(const ECA_TRACE_EDGE& x) const {
+    if (ts != x.ts) return ts < x.ts;
+    if (begin != x.begin) return begin != true;
+    if (begin == true) return event->dur_ns > x.event->dur_ns;
+    return event->start_ns > x.event->start_ns;
+  }
+};
+
+/**
+ * Field numbers of the Perfetto trace protobuf messages
+ * (Trace, TracePacket, TrackEvent, TrackDescriptor,
+ * ProcessDescriptor and ThreadDescriptor)
+ */
+static const int eca_trace_pb_trace_packet = 1;
+static const int eca_trace_pb_packet_timestamp = 8;
+static const int eca_trace_pb_packet_sequence_id = 10;
+static const int eca_trace_pb_packet_track_event = 11;
+static const int eca_trace_pb_packet_sequence_flags = 13;
+static const int eca_trace_pb_packet_track_descriptor = 60;
+static const int eca_trace_pb_event_type = 9;
+static const int eca_trace_pb_event_track_uuid = 11;
+static const int eca_trace_pb_event_categories = 22;
+static const int eca_trace_pb_event_name = 23;
+static const int eca_trace_pb_track_uuid = 1;
+static const int eca_trace_pb_track_process = 3;
+static const int eca_trace_pb_track_thread = 4;
+static const int eca_trace_pb_track_parent_uuid = 5;
+static const int eca_trace_pb_process_pid = 1;
+static const int eca_trace_pb_process_name = 6;
+static const int eca_trace_pb_thread_pid = 1;
+static const int eca_trace_pb_thread_tid = 2;
+static const int eca_trace_pb_thread_name = 5;
+static const int eca_trace_pb_slice_begin = 1;
+static const int eca_trace_pb_slice_end = 2;
+static const int eca_trace_pb_sequence_id = 1;
+static const uint64_t eca_trace_pb_process_uuid = 1;
+static const uint64_t eca_trace_pb_thread_uuid_base = 1000;
+
+/**
+ * Enables or disables recording. Rings are allocated,
+ * and their memory touched, when first enabled.
+ */
+void ECA_TRACE_RECORDER::set_enabled(bool value)
+{
+  KVU_GUARD_LOCK guard(&eca_trace_lock);
+
+  if (value == true && eca_trace_ring_pool == 0) {
+    pthread_once(&eca_trace_key_once, eca_trace_create_key);
+    ECA_TRACE_RING* pool = new ECA_TRACE_RING [eca_trace_rings] ();
+    __sync_synchronize();
+    eca_trace_ring_pool = pool;
+  }
+  __sync_synchronize();
+  enabled_rep = value;
+}
+
+/**
+ * Discards all recorded events.
+ */
+void ECA_TRACE_RECORDER::clear(void)
+{
+  KVU_GUARD_LOCK guard(&eca_trace_lock);
+
+  for(int n = 0; eca_trace_ring_pool != 0 && n < eca_trace_rings; n++)
+    eca_trace_ring_pool[n].first_index = eca_trace_ring_pool[n].write_index;
+  eca_trace_dropped = 0;
+}
+
+/**
+ * Names the calling thread in exported traces. 'name'
+ * must be a string constant. Can be called before
+ * recording is enabled.
+ *
+ * Realtime-safe, if the thread's name has not changed.
+ */
+void ECA_TRACE_RECORDER::set_thread_name(const char* name)
+{
+  pthread_once(&eca_trace_key_once, eca_trace_create_key);
+  if (pthread_getspecific(eca_trace_name_key) == name)
+    return;
+
+  pthread_setspecific(eca_trace_name_key, name);
+  ECA_TRACE_RING* ring =
+    reinterpret_cast<ECA_TRACE_RING*>(pthread_getspecific(eca_trace_ring_key));
+  if (ring != 0)
+    eca_trace_store_name(ring);
+}
+
+/**
+ * Starts recording 'span'.
+ *
+ * Realtime-safe.
+ *
+ * @see ECA_TRACE_SCOPE
+ */
+void ECA_TRACE_RECORDER::begin(ECA_TRACE_SPAN* span, const char* category, const char* name, const char* detail)
+{
+  span->category = category;
+
+  size_t len = 0;
+  const size_t max = sizeof(span->name) - 1;
+  for(const char* p = name; *p != 0 && len < max; p++)
+    span->name[len++] = *p;
+  if (detail != 0 && len < max) {
+    span->name[len++] = ' ';
+    for(const char* p = detail; *p != 0 && len < max; p++)
+      span->name[len++] = *p;
+  }
+  span->name[len] = 0;
+
+  kvu_clock_gettime(&span->start);
+}
+
+/**
+ * Stores 'span' as an event ending now.
+ *
+ * Realtime-safe.
+ */
+void ECA_TRACE_RECORDER::end(const ECA_TRACE_SPAN* span)
+{
+  struct timespec now;
+  kvu_clock_gettime(&now);
+
+  ECA_TRACE_RING* ring = eca_trace_thread_ring();
+  if (ring == 0) {
+    __sync_fetch_and_add(&eca_trace_dropped, 1);
+    return;
+  }
+
+  long int index = ring->write_index;
+  ECA_TRACE_SLOT& slot = ring->slots[index % eca_trace_ring_size];
+  slot.lock.write_begin();
+  slot.index = index;
+  slot.event.tid = ring->tid;
+  slot.event.category = span->category;
+  std::memcpy(slot.event.name, span->name, sizeof(slot.event.name));
+  slot.event.start_ns = eca_trace_ns(span->start);
+  slot.event.dur_ns = eca_trace_ns(now) - slot.event.start_ns;
+  slot.lock.write_end();
+  __sync_synchronize();
+  ring->write_index = index + 1;
+}
+
+/**
+ * Writes recorded events to 'filename'. Files ending
+ * with '.pftrace' or '.perfetto-trace' are written as
+ * Perfetto protobuf, others as Chrome JSON.
+ *
+ * @return false if the file could not be written
+ */
+bool ECA_TRACE_RECORDER::export_file(const std::string& filename)
+{
+  string data;
+  if ((filename.size() > 8 &&
+       filename.compare(filename.size() - 8, 8, ".pftrace") == 0) ||
+      (filename.size() > 15 &&
+       filename.compare(filename.size() - 15, 15, ".perfetto-trace") == 0))
+    data = perfetto_protobuf();
+  else
+    data = chrome_json();
+
+  std::ofstream fout (filename.c_str(), std::ios::out | std::ios::binary);
+  if (!fout)
+    return false;
+  fout.write(data.data(), data.size());
+  fout.close();
+  return !fout.fail();
+}
+
+/**
+ * Returns recorded events in the Chrome trace event
+ * JSON format, as complete ('X') events. Times are in
+ * microseconds of the monotonic clock.
+ */
+std::string ECA_TRACE_RECORDER::chrome_json(void)
+{
+  KVU_GUARD_LOCK guard(&eca_trace_lock);
+
+  std::set<int> tids;
+  vector<ECA_TRACE_EVENT> events = eca_trace_collect(&tids);
+  string pid = kvu_numtostr(static_cast<int>(getpid()));
+
+  string result = "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+  result += "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":" + pid +
+    ",\"tid\":0,\"args\":{\"name\":\"ecasound\"}}";
+  for(std::set<int>::const_iterator p = tids.begin(); p != tids.end(); ++p)
+    result += ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":" + pid +
+      ",\"tid\":" + kvu_numtostr(*p) +
+      ",\"args\":{\"name\":" + eca_trace_json_string(eca_trace_thread_name(*p).c_str()) + "}}";
+  for(size_t n = 0; n < events.size(); n++)
+    result += ",\n{\"name\":" + eca_trace_json_string(events[n].name) +
+      ",\"cat\":" + eca_trace_json_string(events[n].category) +
+      ",\"ph\":\"X\",\"pid\":" + pid +
+      ",\"tid\":" + kvu_numtostr(events[n].tid) +
+      ",\"ts\":" + eca_trace_json_usecs(events[n].start_ns) +
+      ",\"dur\":" + eca_trace_json_usecs(events[n].dur_ns) + "}";
+  result += "\n]}\n";
+
+  return result;
+}
+
+/**
+ * Returns recorded events as a Perfetto trace (protobuf
+ * 'Trace' message). Each thread gets a track, on which
+ * events are stored as slice begin and end events.
+ * Timestamps are in nanoseconds of the monotonic clock.
+ */
+std::string ECA_TRACE_RECORDER::perfetto_protobuf(void)
+{
+  KVU_GUARD_LOCK guard(&eca_trace_lock);
+
+  std::set<int> tids;
+  vector<ECA_TRACE_EVENT> events = eca_trace_collect(&tids);
+  int pid = static_cast<int>(getpid());
+
+  string result, packet, track, desc;
+
+  desc.resize(0);
+  eca_trace_pb_uint(&desc, eca_trace_pb_process_pid, pid);
+  eca_trace_pb_bytes(&desc, eca_trace_pb_process_name, "ecasound");
+  track.resize(0);
+  eca_trace_pb_uint(&track, eca_trace_pb_track_uuid, eca_trace_pb_process_uuid);
+  eca_trace_pb_bytes(&track, eca_trace_pb_track_process, desc);
+  packet.resize(0);
+  eca_trace_pb_uint(&packet, eca_trace_pb_packet_sequence_id, eca_trace_pb_sequence_id);
+  eca_trace_pb_uint(&packet, eca_trace_pb_packet_sequence_flags, 1);
+  eca_trace_pb_bytes(&packet, eca_trace_pb_packet_track_descriptor, track);
+  eca_trace_pb_bytes(&result, eca_trace_pb_trace_packet, packet);
+
+  for(std::set<int>::const_iterator p = tids.begin(); p != tids.end(); ++p) {
+    desc.resize(0);
+    eca_trace_pb_uint(&desc, eca_trace_pb_thread_pid, pid);
+    eca_trace_pb_uint(&desc, eca_trace_pb_thread_tid, *p);
+    eca_trace_pb_bytes(&desc, eca_trace_pb_thread_name, eca_trace_thread_name(*p));
+    track.resize(0);
+    eca_trace_pb_uint(&track, eca_trace_pb_track_uuid, eca_trace_pb_thread_uuid_base + *p);
+    eca_trace_pb_uint(&track, eca_trace_pb_track_parent_uuid, eca_trace_pb_process_uuid);
+    eca_trace_pb_bytes(&track, eca_trace_pb_track_thread, desc);
+    packet.resize(0);
+    eca_trace_pb_uint(&packet, eca_trace_pb_packet_sequence_id, eca_trace_pb_sequence_id);
+    eca_trace_pb_bytes(&packet, eca_trace_pb_packet_track_descriptor, track);
+    eca_trace_pb_bytes(&result, eca_trace_pb_trace_packet, packet);
+  }
+
+  vector<ECA_TRACE_EDGE> edges;
+  for(size_t n = 0; n < events.size(); n++) {
+    ECA_TRACE_EDGE edge;
+    edge.event = &events[n];
+    edge.ts = events[n].start_ns;
+    edge.begin = true;
+    edges.push_back(edge);
+    edge.ts = events[n].start_ns + events[n].dur_ns;
+    edge.begin = false;
+    edges.push_back(edge);
+  }
+  std::stable_sort(edges.begin(), edges.end());
+
+  for(size_t n = 0; n < edges.size(); n++) {
+    track.resize(0);
+    eca_trace_pb_uint(&track, eca_trace_pb_event_type,
+		      edges[n].begin == true ? eca_trace_pb_slice_begin : eca_trace_pb_slice_end);
+    eca_trace_pb_uint(&track, eca_trace_pb_event_track_uuid,
+		      eca_trace_pb_thread_uuid_base + edges[n].event->tid);
+    if (edges[n].begin == true) {
+      eca_trace_pb_bytes(&track, eca_trace_pb_event_categories, edges[n].event->category);
+      eca_trace_pb_bytes(&track, eca_trace_pb_event_name, edges[n].event->name);
+    }
+    packet.resize(0);
+    eca_trace_pb_uint(&packet, eca_trace_pb_packet_timestamp, edges[n].ts);
+    eca_trace_pb_uint(&packet, eca_trace_pb_packet_sequence_id, eca_trace_pb_sequence_id);
+    eca_trace_pb_bytes(&packet, eca_trace_pb_packet_track_event, track);
+    eca_trace_pb_bytes(&result, eca_trace_pb_trace_packet, packet);
+  }
+
+  return result;
+}
+
+/**
+ * Returns the number of events that would be exported.
+ */
+long int ECA_TRACE_RECORDER::event_count(void)
+{
+  KVU_GUARD_LOCK guard(&eca_trace_lock);
+  std::set<int> tids;
+  return static_cast<long int>(eca_trace_collect(&tids).size());
+}
+
+/**
+ * Returns the number of events dropped because their
+ * thread had no ring.
+ */
+long int ECA_TRACE_RECORDER::dropped_events(void)
+{
+  return eca_trace_dropped;
+}
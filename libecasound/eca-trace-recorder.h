@@ -0,0 +1,113 @@
+#ifndef INCLUDED_ECA_TRACE_RECORDER_H
+#define INCLUDED_ECA_TRACE_RECORDER_H
+
+#include <string>
+#include <time.h>
+
+/**
+ * Timed span that is being recorded.
+ *
+ * @see ECA_TRACE_SCOPE
+ */
+struct ECA_TRACE_SPAN {
+  const char* category;
+  char name[40];
+  struct timespec start;
+};
+
+/**
+ * Records timed events from ecasound threads, for
+ * timeline analysis of real sessions.
+ *
+ * Events are recorded with ECA_TRACE_SCOPE. The engine
+ * marks engine iterations and their stages, the
+ * double-buffering server its I/O rounds, the JACK
+ * manager its process callbacks, ECA_CONTROL the commands
+ * it executes, and chainsetups the opening and closing of
+ * audio objects.
+ *
+ * Each thread records into a fixed-size lock-free ring
+ * of its own, claimed from a pool on first use. When a
+ * ring is full, the oldest events are overwritten, so
+ * the rings hold the latest events of each thread. If
+ * more threads record than there are rings, the
+ * events of the extra threads are dropped. Threads can
+ * be named with set_thread_name().
+ *
+ * Recorded events are exported with export_file(),
+ * either as Chrome JSON (chrome://tracing, Perfetto UI)
+ * or as Perfetto protobuf.
+ *
+ * Enabled with set_enabled() (ECI 'trace-start', or
+ * ecasound option '--trace'). Recording functions are
+ * realtime-safe, other functions are not.
+ *
+ * @author agent
+ */
+class ECA_TRACE_RECORDER {
+
+ public:
+
+  /** @name Configuration */
+  /*@{*/
+
+  static void set_enabled(bool value);
+  static bool enabled(void) { return enabled_rep; }
+  static void clear(void);
+
+  /*@}*/
+
+  /** @name Recording */
+  /*@{*/
+
+  static void set_thread_name(const char* name);
+  static void begin(ECA_TRACE_SPAN* span, const char* category, const char* name, const char* detail);
+  static void end(const ECA_TRACE_SPAN* span);
+
+  /*@}*/
+
+  /** @name Exporting */
+  /*@{*/
+
+  static bool export_file(const std::string& filename);
+  static std::string chrome_json(void);
+  static std::string perfetto_protobuf(void);
+  static long int event_count(void);
+  static long int dropped_events(void);
+
+  /*@}*/
+
+ private:
+
+  static bool enabled_rep;
+
+  ECA_TRACE_RECORDER(void);
+  ECA_TRACE_RECORDER(const ECA_TRACE_RECORDER&);
+  ECA_TRACE_RECORDER& operator=(const ECA_TRACE_RECORDER&);
+  ~ECA_TRACE_RECORDER(void);
+};
+
+/**
+ * Records the enclosing block as an event. The event
+ * name is 'name', followed by 'detail' if given, and
+ * is copied, so both may be temporaries. Does nothing
+ * if the recorder is not enabled.
+ */
+class ECA_TRACE_SCOPE {
+
+ public:
+
+  ECA_TRACE_SCOPE(const char* category, const char* name, const char* detail = 0)
+    : active_rep(ECA_TRACE_RECORDER::enabled()) { if (active_rep == true) ECA_TRACE_RECORDER::begin(&span_rep, category, name, detail); }
+  ~ECA_TRACE_SCOPE(void) { if (active_rep == true) ECA_TRACE_RECORDER::end(&span_rep); }
+
+ private:
+
+  bool active_rep;
+  ECA_TRACE_SPAN span_rep;
+
+  ECA_TRACE_SCOPE(const ECA_TRACE_SCOPE&);
+  ECA_TRACE_SCOPE& operator=(const ECA_TRACE_SCOPE&);
+};
+
+#endif
@@ -0,0 +1,169 @@
+// ------------------------------------------------------------------------
+// eca-trace-recorder_test.h: Unit test for ECA_TRACE_RECORDER
+// Copyright (C) 2026 agent
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
+// ------------------------------------------------------------------------
+
+#include <cstdio> /* std::remove() */
+#include <fstream>
+#include <iterator> /* istreambuf_iterator */
+#include <string>
+#include <pthread.h>
+#include <unistd.h> /* getpid() */
+
+#include <kvu_numtostr.h>
+
+#include "eca-trace-recorder.h"
+#include "eca-test-case.h"
+
+using namespace std;
+
+/**
+ * Unit test for ECA_TRACE_RECORDER
+ */
+class ECA_TRACE_RECORDER_TEST : public ECA_TEST_CASE {
+
+protected:
+
+  virtual string do_name(void) const { return("ECA_TRACE_RECORDER"); }
+  virtual void do_run(void);
+
+public:
+
+  virtual ~ECA_TRACE_RECORDER_TEST(void) { }
+
+private:
+
+  static void* worker_thread(void* arg);
+  static int protobuf_packets(const string& data);
+};
+
+/**
+ * Records one event from a named thread, and exits.
+ */
+void* ECA_TRACE_RECORDER_TEST::worker_thread(void* arg)
+{
+  ECA_TRACE_RECORDER::set_thread_name("test-worker");
+  ECA_TRACE_SCOPE trace_scope ("test", "worker");
+  return 0;
+}
+
+/**
+ * Returns the number of packets in a Perfetto trace, or
+ * -1 if 'data' is not a sequence of length-delimited
+ * field 1 records.
+ */
+int ECA_TRACE_RECORDER_TEST::protobuf_packets(const string& data)
+{
+  int packets = 0;
+  size_t pos = 0;
+  while(pos < data.size()) {
+    if (data[pos++] != 0x0a)
+      return -1;
+    size_t len = 0;
+    int shift = 0;
+    unsigned char c;
+    do {
+      if (pos >= data.size())
+	return -1;
+      c = static_cast<unsigned char>(data[pos++]);
+      len |= static_cast<size_t>(c & 0x7f) << shift;
+      shift += 7;
+    }
+    while(c & 0x80);
+    pos += len;
+    ++packets;
+  }
+  return (pos == data.size() ? packets : -1);
+}
+
+void ECA_TRACE_RECORDER_TEST::do_run(void)
+{
+  std::fprintf(stdout, "%s: tests for %s class\n",
+	       name().c_str(), __FILE__);
+
+  ECA_TRACE_RECORDER::set_thread_name("tester");
+  ECA_TRACE_RECORDER::set_enabled(true);
+  ECA_TRACE_RECORDER::clear();
+
+  /* case: events are recorded and exported */
+  {
+    {
+      ECA_TRACE_SCOPE outer ("test", "outer");
+      ECA_TRACE_SCOPE inner ("test", "inner", string("\"quoted\"").c_str());
+    }
+    pthread_t thread;
+    pthread_create(&thread, NULL, worker_thread, 0);
+    pthread_join(thread, NULL);
+
+    if (ECA_TRACE_RECORDER::event_count() != 3)
+      ECA_TEST_FAILURE("wrong event count: " + kvu_numtostr(ECA_TRACE_RECORDER::event_count()));
+
+    string json = ECA_TRACE_RECORDER::chrome_json();
+    if (json.find("{\"name\":\"inner \\\"quoted\\\"\",\"cat\":\"test\",\"ph\":\"X\"") == string::npos ||
+	json.find("\"args\":{\"name\":\"tester\"}") == string::npos ||
+	json.find("\"args\":{\"name\":\"test-worker\"}") == string::npos)
+      ECA_TEST_FAILURE("JSON: " + json);
+
+    /* note: process and two threads, begin and end of each event */
+    string pb = ECA_TRACE_RECORDER::perfetto_protobuf();
+    if (protobuf_packets(pb) != 3 + 2 * 3 ||
+	pb.find("test-worker") == string::npos)
+      ECA_TEST_FAILURE("malformed protobuf trace");
+
+    string path = "/tmp/libecasound_tester-trace-" + kvu_numtostr(static_cast<int>(getpid()));
+    if (ECA_TRACE_RECORDER::export_file(path + ".json") != true)
+      ECA_TEST_FAILURE("export failed");
+    else {
+      std::ifstream fin ((path + ".json").c_str());
+      string first;
+      std::getline(fin, first);
+      if (first != "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[")
+	ECA_TEST_FAILURE("export not in JSON format");
+    }
+    if (ECA_TRACE_RECORDER::export_file(path + ".pftrace") != true)
+      ECA_TEST_FAILURE("export failed");
+    else {
+      std::ifstream fin ((path + ".pftrace").c_str(), std::ios::binary);
+      string data ((std::istreambuf_iterator<char>(fin)), std::istreambuf_iterator<char>());
+      if (data != pb)
+	ECA_TEST_FAILURE("export not in protobuf format");
+    }
+    std::remove((path + ".json").c_str());
+    std::remove((path + ".pftrace").c_str());
+  }
+
+  /* case: the latest events are kept */
+  {
+    ECA_TRACE_RECORDER::clear();
+    for(int n = 0; n < 5000; n++) {
+      ECA_TRACE_SCOPE scope ("test", "loop");
+    }
+    if (ECA_TRACE_RECORDER::event_count() != 4096)
+      ECA_TEST_FAILURE("ring not wrapped");
+  }
+
+  /* case: nothing is recorded when disabled */
+  {
+    ECA_TRACE_RECORDER::set_enabled(false);
+    ECA_TRACE_RECORDER::clear();
+    {
+      ECA_TRACE_SCOPE scope ("test", "disabled");
+    }
+    if (ECA_TRACE_RECORDER::event_count() != 0)
+      ECA_TEST_FAILURE("recorded while disabled");
+  }
+}
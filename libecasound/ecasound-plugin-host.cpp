@@ -0,0 +1,36 @@
+// ------------------------------------------------------------------------
+// ecasound-plugin-host.cpp: Host process for sandboxed plugins
+// Copyright (C) 2026 agent
+//
+// Attributes:
+//     eca-style-version: 3
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307  USA
+// ------------------------------------------------------------------------
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include "audiofx_sandbox.h"
+
+/**
+ * Runs one sandboxed chain operator. Started by
+ * EFFECT_SANDBOX, not meant to be run directly.
+ */
+int main(int argc, char *argv[])
+{
+  return EFFECT_SANDBOX::host_main(argc, argv);
+}
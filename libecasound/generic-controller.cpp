@@ -89,6 +89,42 @@ CONTROLLER_SOURCE::parameter_t GENERIC_CONTROLLER::value(double pos)
   return new_value;
 }
 
+/**
+ * Updates the target parameter for a block of audio 
+ * that starts at 'pos_secs' and is 'block_secs' long.
+ *
+ * If the target supports ramping of the controlled 
+ * parameter, the source is evaluated at the end of the 
+ * block and the result is set as the ramp target. 
+ * Otherwise this is equivalent to value(pos_secs).
+ *
+ * @pre is_valid() == true
+ */
+CONTROLLER_SOURCE::parameter_t GENERIC_CONTROLLER::value_for_block(double pos_secs, double block_secs)
+{
+  // --------
+  DBC_REQUIRE(is_valid() == true);
+  // --------
+
+  if (block_secs <= 0.0 ||
+      target->parameter_ramp_supported(param_id_rep) != true)
+    return value(pos_secs);
+
+  double end_pos = pos_secs + block_secs;
+  double new_value = rangelow_rep +
+    (source->value(end_pos) * (rangehigh_rep - rangelow_rep));
+
+  DEBUG_CTRL_STATEMENT(std::cerr << "generic-controller: type '"
+		       << source->name() << "', ramp to pos_sec " << end_pos 
+		       << ", scaled_value " << new_value << "." << std::endl);
+
+  target->set_parameter_ramp(param_id_rep, new_value);
+
+  last_value_pos_rep = end_pos;
+
+  return new_value;
+}
+
 string GENERIC_CONTROLLER::status(void) const
 {
   if (is_valid() == true) {
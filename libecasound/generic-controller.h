@@ -67,6 +67,8 @@ class GENERIC_CONTROLLER : public CONTROLLER_SOURCE {
   /** @name Public functions  */
   /*@{*/
 
+  parameter_t value_for_block(double pos_secs, double block_secs);
+
   bool is_valid(void) const { return(target != 0 && source != 0); }
   std::string status(void) const;
 
@@ -1,6 +1,7 @@
 // ------------------------------------------------------------------------
 // midi-server.cpp: MIDI i/o engine serving generic clients.
 // Copyright (C) 2001-2002,2005,2007 Kai Vehmanen
+// Copyright (C) 2026 agent
 //
 // Attributes:
 //     eca-style-version: 3
@@ -38,6 +39,7 @@
 #include "midi-parser.h"
 #include "midi-server.h"
 #include "eca-logger.h"
+#include "eca-thread-affinity.h"
 
 const unsigned int MIDI_SERVER::max_queue_size_rep = 32768;
 
@@ -54,6 +56,8 @@ void* start_midi_server_io_thread(void *ptr)
   MIDI_SERVER* mserver =
     static_cast<MIDI_SERVER*>(ptr);
 
+  ECA_THREAD_AFFINITY::apply("midi", mserver->affinity_rep);
+
   if (mserver->schedrealtime_rep == true) {
     if (kvu_set_thread_scheduling(SCHED_FIFO, mserver->schedpriority_rep) != 0)
       ECA_LOG_MSG(ECA_LOGGER::system_objects, "Unable to change scheduling policy!");
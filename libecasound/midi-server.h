@@ -50,6 +50,7 @@ class MIDI_SERVER {
 
   void set_schedrealtime(bool v) { schedrealtime_rep = v; }
   void set_schedpriority(int v) { schedpriority_rep = v; }
+  void set_affinity(const std::string& cpus) { affinity_rep = cpus; }
 
   void register_client(MIDI_IO* mobject);
   void unregister_client(MIDI_IO* mobject);
@@ -95,6 +96,7 @@ class MIDI_SERVER {
   bool thread_running_rep;
   bool schedrealtime_rep;
   int schedpriority_rep;
+  std::string affinity_rep;
   ATOMIC_INTEGER exit_request_rep;
   ATOMIC_INTEGER stop_request_rep;
   ATOMIC_INTEGER running_rep;
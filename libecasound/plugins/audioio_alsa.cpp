@@ -2,6 +2,7 @@
 // audioio-alsa.cpp: ALSA 0.9.x PCM input and output.
 // Copyright (C) 1999-2004,2008 Kai Vehmanen
 // Copyright (C) 2001,2002 Jeremy Hall 
+// Copyright (C) 2026 agent
 //
 // Attributes:
 //     eca-style-version: 3
@@ -86,6 +87,16 @@ do { \
 
 const string AUDIO_IO_ALSA_PCM::default_pcm_device_rep = "default";
 
+/**
+ * Returns a pointer to the sample at frame 'offset' in 
+ * mmap channel area 'area'.
+ */
+static inline unsigned char* eca_alsa_area_ptr(const snd_pcm_channel_area_t* area,
+					       snd_pcm_uframes_t offset)
+{
+  return reinterpret_cast<unsigned char*>(area->addr) + (area->first + offset * area->step) / 8;
+}
+
 AUDIO_IO_ALSA_PCM::AUDIO_IO_ALSA_PCM (int card, 
 				      int device, 
 				      int subdevice) 
@@ -96,6 +107,8 @@ AUDIO_IO_ALSA_PCM::AUDIO_IO_ALSA_PCM (int card,
   device_number_rep = device;
   subdevice_number_rep = subdevice;
   trigger_request_rep = false;
+  mmap_request_rep = false;
+  mmap_active_rep = false;
   overruns_rep = underruns_rep = 0;
   nbufs_repp = 0;
   allocate_structs();
@@ -241,7 +254,25 @@ void AUDIO_IO_ALSA_PCM::fill_and_set_hw_params(void)
   else
     ECA_LOG_MSG(ECA_LOGGER::user_objects, "Using noninterleaved stream format.");
 
-  if (interleaved_channels() == true)
+  mmap_active_rep = false;
+  if (mmap_request_rep == true) {
+    if (interleaved_channels() == true)
+      err = snd_pcm_hw_params_set_access(audio_fd_repp, pcm_hw_params_repp,
+					 SND_PCM_ACCESS_MMAP_INTERLEAVED);
+    else
+      err = snd_pcm_hw_params_set_access(audio_fd_repp, pcm_hw_params_repp,
+					 SND_PCM_ACCESS_MMAP_NONINTERLEAVED);
+    if (err < 0)
+      ECA_LOG_MSG(ECA_LOGGER::info, 
+		  "Warning! mmap transfers not supported by '" + pcm_device_name() + 
+		  "', falling back to read/write transfers.");
+    else
+      mmap_active_rep = true;
+  }
+  
+  if (mmap_active_rep == true)
+    ECA_LOG_MSG(ECA_LOGGER::user_objects, "Using mmap transfers.");
+  else if (interleaved_channels() == true)
     err = snd_pcm_hw_params_set_access(audio_fd_repp, pcm_hw_params_repp,
 					 SND_PCM_ACCESS_RW_INTERLEAVED);
   else
@@ -428,6 +459,179 @@ void AUDIO_IO_ALSA_PCM::start(void)
   AUDIO_IO_DEVICE::start();
 }
 
+/**
+ * Reimplemented to convert directly from the device's 
+ * mmap area when mmap transfers are in use.
+ */
+void AUDIO_IO_ALSA_PCM::read_buffer(SAMPLE_BUFFER* sbuf)
+{
+  if (mmap_active_rep != true) {
+    AUDIO_IO_DEVICE::read_buffer(sbuf);
+    return;
+  }
+
+  read_buffer_mmap(sbuf);
+
+  change_position_in_samples(sbuf->length_in_samples());
+
+  // --------
+  DBC_ENSURE(sbuf->number_of_channels() == channels());
+  // --------
+}
+
+/**
+ * Reimplemented to convert directly to the device's 
+ * mmap area when mmap transfers are in use.
+ */
+void AUDIO_IO_ALSA_PCM::write_buffer(SAMPLE_BUFFER* sbuf)
+{
+  if (mmap_active_rep != true) {
+    AUDIO_IO_DEVICE::write_buffer(sbuf);
+    return;
+  }
+
+  /* see AUDIO_IO_DEVICE::write_buffer() */
+  if (sbuf->length_in_samples() != buffersize() &&
+      sbuf->event_tag_test(SAMPLE_BUFFER::tag_var_length) != true) {
+    sbuf->length_in_samples(buffersize());
+  }
+
+  write_buffer_mmap(sbuf);
+
+  change_position_in_samples(sbuf->length_in_samples());
+  extend_position();
+}
+
+/**
+ * Handles a negative return value 'err' from one of
+ * the mmap functions. 
+ *
+ * @return true if transfer can be continued
+ */
+bool AUDIO_IO_ALSA_PCM::handle_mmap_error(int err)
+{
+  /* EPIPE=xrun, ESTRPIPE=suspend, see read_samples() for EIO */
+  if (err == -EPIPE || err == -ESTRPIPE || err == -EIO) {
+    if (ignore_xruns() == true) {
+      if (io_mode() == io_read) 
+	handle_xrun_capture();
+      else
+	handle_xrun_playback();
+      return is_open();
+    }
+    cerr << "ALSA: " << (io_mode() == io_read ? "Overrun" : "Underrun") 
+	 << "! Stopping operation!" << endl;
+  }
+  else {
+    cerr << "ALSA: mmap transfer error (" << err << ")! Stopping operation." << endl;
+  }
+  stop();
+  close();
+  return false;
+}
+
+void AUDIO_IO_ALSA_PCM::read_buffer_mmap(SAMPLE_BUFFER* sbuf)
+{
+  sbuf->number_of_channels(channels());
+  sbuf->length_in_samples(buffersize());
+
+  long int done = 0;
+  while(done < buffersize() && is_open() == true) {
+    snd_pcm_sframes_t avail = snd_pcm_avail_update(audio_fd_repp);
+    if (avail < 0) {
+      if (handle_mmap_error(avail) != true) break;
+      continue;
+    }
+    if (avail < buffersize() - done) {
+      /* blocks until at least one period is available */
+      int err = snd_pcm_wait(audio_fd_repp, -1);
+      if (err < 0 && handle_mmap_error(err) != true) break;
+      continue;
+    }
+
+    const snd_pcm_channel_area_t* areas;
+    snd_pcm_uframes_t offset;
+    snd_pcm_uframes_t frames = buffersize() - done;
+    int err = snd_pcm_mmap_begin(audio_fd_repp, &areas, &offset, &frames);
+    if (err < 0) {
+      if (handle_mmap_error(err) != true) break;
+      continue;
+    }
+
+    for(int c = 0; c < channels(); c++) {
+      sbuf->import_channel_strided(c, done,
+				   eca_alsa_area_ptr(&areas[c], offset),
+				   frames,
+				   areas[c].step / 8,
+				   sample_format());
+    }
+
+    snd_pcm_sframes_t committed = snd_pcm_mmap_commit(audio_fd_repp, offset, frames);
+    if (committed < 0 || static_cast<snd_pcm_uframes_t>(committed) != frames) {
+      if (handle_mmap_error(committed < 0 ? committed : -EPIPE) != true) break;
+      continue;
+    }
+    done += frames;
+  }
+
+  sbuf->length_in_samples(done);
+}
+
+void AUDIO_IO_ALSA_PCM::write_buffer_mmap(SAMPLE_BUFFER* sbuf)
+{
+  if (trigger_request_rep == true) {
+    trigger_request_rep = false;
+    start();
+  }
+
+  if (sbuf->number_of_channels() < channels()) 
+    sbuf->number_of_channels(channels());
+
+  long int samples = sbuf->length_in_samples();
+  long int done = 0;
+  while(done < samples && is_open() == true) {
+    snd_pcm_sframes_t avail = snd_pcm_avail_update(audio_fd_repp);
+    if (avail < 0) {
+      if (handle_mmap_error(avail) != true) break;
+      continue;
+    }
+    if (avail == 0) {
+      /* buffer full: a stream that is not yet triggered
+       * (see fill_and_set_sw_params()) must be started, 
+       * otherwise space never becomes available */
+      if (snd_pcm_state(audio_fd_repp) == SND_PCM_STATE_PREPARED)
+	snd_pcm_start(audio_fd_repp);
+      int err = snd_pcm_wait(audio_fd_repp, -1);
+      if (err < 0 && handle_mmap_error(err) != true) break;
+      continue;
+    }
+
+    const snd_pcm_channel_area_t* areas;
+    snd_pcm_uframes_t offset;
+    snd_pcm_uframes_t frames = samples - done;
+    int err = snd_pcm_mmap_begin(audio_fd_repp, &areas, &offset, &frames);
+    if (err < 0) {
+      if (handle_mmap_error(err) != true) break;
+      continue;
+    }
+
+    for(int c = 0; c < channels(); c++) {
+      sbuf->export_channel_strided(c, done,
+				   eca_alsa_area_ptr(&areas[c], offset),
+				   frames,
+				   areas[c].step / 8,
+				   sample_format());
+    }
+
+    snd_pcm_sframes_t committed = snd_pcm_mmap_commit(audio_fd_repp, offset, frames);
+    if (committed < 0 || static_cast<snd_pcm_uframes_t>(committed) != frames) {
+      if (handle_mmap_error(committed < 0 ? committed : -EPIPE) != true) break;
+      continue;
+    }
+    done += frames;
+  }
+}
+
 long int AUDIO_IO_ALSA_PCM::read_samples(void* target_buffer, 
 					   long int samples)
 {
@@ -469,14 +673,14 @@ long int AUDIO_IO_ALSA_PCM::read_samples(void* target_buffer,
       nbufs_repp[channel] = ptr_to_channel;
       ptr_to_channel += samples * sample_size();
     }
-    realsamples = snd_pcm_readn(audio_fd_repp, reinterpret_cast<void**>(target_buffer), buffersize());
+    realsamples = snd_pcm_readn(audio_fd_repp, reinterpret_cast<void**>(nbufs_repp), buffersize());
     if (realsamples < 0) {
       /* Note! ALSA versions <=0.9.1 sometimes return -EIO in xrun-state;
        *       EPIPE=xrun, ESTRPIPE=xrun) */
       if (realsamples == -EPIPE || realsamples == -ESTRPIPE || realsamples == -EIO) {
 	if (ignore_xruns() == true) {
 	  handle_xrun_capture();
-	  realsamples = snd_pcm_readn(audio_fd_repp, reinterpret_cast<void**>(target_buffer), buffersize());
+	  realsamples = snd_pcm_readn(audio_fd_repp, reinterpret_cast<void**>(nbufs_repp), buffersize());
 	  if (realsamples < 0) realsamples = 0;
 	}
 	else {
@@ -682,6 +886,10 @@ void AUDIO_IO_ALSA_PCM::set_parameter(int param,
   case 4: 
     subdevice_number_rep = atoi(value.c_str());
     break;
+
+  case 5: 
+    set_transfer_mode(value);
+    break;
   }
 
   if (using_plugin_rep)
@@ -716,6 +924,9 @@ string AUDIO_IO_ALSA_PCM::get_parameter(int param) const
 
   case 4: 
     return kvu_numtostr(subdevice_number_rep);
+
+  case 5: 
+    return transfer_mode();
   }
   return "";
 }
@@ -727,3 +938,19 @@ void AUDIO_IO_ALSA_PCM::set_pcm_device_name(const string& n)
   else
     pcm_device_name_rep = default_pcm_device_rep;
 }
+
+/**
+ * Selects how audio data is transferred to/from the device:
+ * "mmap" converts directly between the device's mmap area
+ * and the engine buffers, anything else uses the read/write 
+ * transfer calls. Takes effect when the device is opened.
+ */
+void AUDIO_IO_ALSA_PCM::set_transfer_mode(const string& mode)
+{
+  mmap_request_rep = (mode == "mmap");
+}
+
+string AUDIO_IO_ALSA_PCM::transfer_mode(void) const
+{
+  return mmap_request_rep == true ? "mmap" : "rw";
+}
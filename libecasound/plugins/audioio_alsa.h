@@ -40,11 +40,14 @@ class AUDIO_IO_ALSA_PCM : public AUDIO_IO_DEVICE {
   /*@{*/
 
   virtual int supported_io_modes(void) const { return(io_read | io_write); }
-  virtual string parameter_names(void) const { return("label,card,device,subdevice"); }
+  virtual string parameter_names(void) const { return("label,card,device,subdevice,transfer"); }
 
   virtual void open(void) throw(AUDIO_IO::SETUP_ERROR&);
   virtual void close(void);
   
+  virtual void read_buffer(SAMPLE_BUFFER* sbuf);
+  virtual void write_buffer(SAMPLE_BUFFER* sbuf);
+
   virtual long int read_samples(void* target_buffer, long int samples);
   virtual void write_samples(void* target_buffer, long int samples);
 
@@ -76,6 +79,9 @@ private:
   void print_pcm_info(void);
   void handle_xrun_capture(void);
   void handle_xrun_playback(void);
+  bool handle_mmap_error(int err);
+  void read_buffer_mmap(SAMPLE_BUFFER* sbuf);
+  void write_buffer_mmap(SAMPLE_BUFFER* sbuf);
 
 private:
 
@@ -98,11 +104,16 @@ private:
 
   bool using_plugin_rep;
   bool trigger_request_rep;
+  bool mmap_request_rep;
+  bool mmap_active_rep;
 
  protected:
 
   void set_pcm_device_name(const string& n);
   const string& pcm_device_name(void) const { return(pcm_device_name_rep); }
+
+  void set_transfer_mode(const string& mode);
+  string transfer_mode(void) const;
   
  private:
 
@@ -68,6 +68,10 @@ void AUDIO_IO_ALSA_PCM_NAMED::set_parameter(int param,
   case 2: 
     set_pcm_device_name(value);
     break;
+
+  case 3: 
+    set_transfer_mode(value);
+    break;
   }
 }
 
@@ -79,6 +83,9 @@ string AUDIO_IO_ALSA_PCM_NAMED::get_parameter(int param) const
 
   case 2: 
     return(pcm_device_name());
+
+  case 3: 
+    return(transfer_mode());
   }
   return("");
 }
@@ -14,7 +14,7 @@ class AUDIO_IO_ALSA_PCM_NAMED : public AUDIO_IO_ALSA_PCM {
   virtual string name(void) const { return("ALSA named PCM device"); }
   virtual string description(void) const { return("ALSA named PCM device. Library versions 0.6.x and newer."); }
 
-  virtual string parameter_names(void) const { return("label,pcm_name"); }
+  virtual string parameter_names(void) const { return("label,pcm_name,transfer"); }
   virtual void set_parameter(int param, string value);
   virtual string get_parameter(int param) const;
 
@@ -233,11 +233,30 @@ long int AUDIO_IO_JACK::read_samples(void* target_buffer, long int samples)
   return 0;
 }
 
-void AUDIO_IO_JACK::write_buffer(SAMPLE_BUFFER* sbuf)
+/**
+ * Reimplemented to convert directly from the JACK port 
+ * buffers to 'sbuf', bypassing read_samples() and the 
+ * intermediate i/o buffer.
+ */
+void AUDIO_IO_JACK::read_buffer(SAMPLE_BUFFER* sbuf)
 {
-  /* note: this is reimplemented only to catch errors with unsupported
-   *       input streams (e.g. one produces by 'resample' object' */
+  if (jackmgr_rep != 0) {
+    jackmgr_rep->read_buffer(myid_rep, sbuf);
+  }
+  else {
+    sbuf->length_in_samples(0);
+  }
 
+  change_position_in_samples(sbuf->length_in_samples());
+}
+
+/**
+ * Reimplemented to catch errors with unsupported input 
+ * streams (e.g. ones produced by a 'resample' object), and 
+ * to convert directly from 'sbuf' to the JACK port buffers.
+ */
+void AUDIO_IO_JACK::write_buffer(SAMPLE_BUFFER* sbuf)
+{
   if (sbuf->length_in_samples() > 0 &&
       sbuf->length_in_samples() != jackmgr_rep->buffersize() &&
       sbuf->event_tag_test(SAMPLE_BUFFER::tag_end_of_stream) != true) {
@@ -247,7 +266,18 @@ void AUDIO_IO_JACK::write_buffer(SAMPLE_BUFFER* sbuf)
 		"This can happen e.g. with a 'resample' input object.");
   }
 
-  AUDIO_IO_DEVICE::write_buffer(sbuf);
+  /* see AUDIO_IO_DEVICE::write_buffer() */
+  if (sbuf->length_in_samples() != buffersize() &&
+      sbuf->event_tag_test(SAMPLE_BUFFER::tag_var_length) != true) {
+    sbuf->length_in_samples(buffersize());
+  }
+
+  if (jackmgr_rep != 0) {
+    jackmgr_rep->write_buffer(myid_rep, sbuf);
+  }
+
+  change_position_in_samples(sbuf->length_in_samples());
+  extend_position();
 }
 
 void AUDIO_IO_JACK::write_samples(void* target_buffer, long int samples)
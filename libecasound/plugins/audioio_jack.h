@@ -41,6 +41,7 @@ class AUDIO_IO_JACK : public AUDIO_IO_DEVICE {
 
   virtual bool finished(void) const;
 
+  virtual void read_buffer(SAMPLE_BUFFER* sbuf);
   virtual void write_buffer(SAMPLE_BUFFER* sbuf);
 
   virtual long int read_samples(void* target_buffer, long int samples);
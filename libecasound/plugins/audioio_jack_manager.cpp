@@ -1,6 +1,7 @@
 // ------------------------------------------------------------------------
 // audioio_jack_manager.cpp: Manager for JACK client objects
 // Copyright (C) 2001-2004,2008,2009,2011 Kai Vehmanen
+// Copyright (C) 2026 agent
 //
 // Attributes:
 //     eca-style-version: 3
@@ -28,6 +29,7 @@
 #endif
 
 #include <algorithm> /* std::count() */
+#include <cstdlib> /* atoi() */
 #include <iostream>
 #include <string>
 #include <utility>
@@ -38,13 +40,17 @@
 
 #include <kvu_dbc.h>
 #include <kvu_numtostr.h>
+#include <kvu_locks.h>
 #include <kvu_procedure_timer.h>
 #include <kvu_threads.h>
 
 #include "audioio.h"
+#include "samplebuffer.h"
 #include "eca-engine.h"
 #include "eca-chainsetup.h"
 #include "eca-logger.h"
+#include "eca-thread-affinity.h"
+#include "eca-trace-recorder.h"
 
 #include <cstring>
 
@@ -97,6 +103,7 @@ static void eca_jack_process_profile_post(void);
 static int eca_jack_bsize_cb(jack_nframes_t nframes, void *arg);
 static int eca_jack_srate_cb(jack_nframes_t nframes, void *arg);
 static void eca_jack_shutdown_cb(void *arg);
+static void* eca_jack_worker_thread(void *arg);
 
 static std::string eca_get_jack_port_item(const char **ports, int item);
 
@@ -124,6 +131,7 @@ const int AUDIO_IO_JACK_MANAGER::instance_limit = 8;
  *  J = originates from JACK callback
  *  E = ----- " ------- engine thread (exec())
  *  C = ----- " ------- control/client thread
+ *  W = ----- " ------- chain worker thread
  */
 
 #if ECA_JACK_TRANSPORT_API >= 3
@@ -360,6 +368,9 @@ static int eca_jack_process_callback(jack_nframes_t nframes, void *arg)
 {
   AUDIO_IO_JACK_MANAGER* current = static_cast<AUDIO_IO_JACK_MANAGER*>(arg);
 
+  ECA_TRACE_RECORDER::set_thread_name("jack");
+  ECA_TRACE_SCOPE trace_scope ("jack", "eca_jack_process_callback");
+
   PROFILE_CE_STATEMENT(eca_jack_process_profile_pre());
 
   if (current->exit_request_rep == 1 || current->shutdown_request_rep == 1) { 
@@ -435,16 +446,22 @@ static void eca_jack_process_engine_iteration(jack_nframes_t nframes, void* arg)
 
   if (current->engine_repp->status() != ECA_ENGINE::engine_status_finished) {
 
-    /* 1. copy audio data from port input buffers to ecasound buffers */
+    /* 1. map port buffers for the duration of this cycle; JACK
+     *    objects convert directly between these and the engine's 
+     *    sample buffers (see read_buffer() and write_buffer()) */
     for(size_t n = 0; n < current->inports_rep.size(); n++) {
-      if (current->inports_rep[n]->cb_buffer != 0) {
-	jack_default_audio_sample_t* in_cb_buffer = 
+      if (current->inports_rep[n]->jackport != 0) {
+	current->inports_rep[n]->cycle_buffer = 
 	  static_cast<jack_default_audio_sample_t*>
 	  (jack_port_get_buffer(current->inports_rep[n]->jackport, nframes));
-	
-	memcpy(current->inports_rep[n]->cb_buffer, 
-	       in_cb_buffer, 
-	       current->buffersize_rep * sizeof(jack_default_audio_sample_t));
+      }
+    }
+    for(size_t n = 0; n < current->outports_rep.size(); n++) {
+      if (current->outports_rep[n]->jackport != 0) {
+	current->outports_rep[n]->cycle_buffer = 
+	  static_cast<jack_default_audio_sample_t*>
+	  (jack_port_get_buffer(current->outports_rep[n]->jackport, nframes));
+	current->outports_rep[n]->cycle_written = false;
       }
     }
     
@@ -455,17 +472,19 @@ static void eca_jack_process_engine_iteration(jack_nframes_t nframes, void* arg)
     
     // DEBUG_CFLOW_STATEMENT(cerr << endl << "eca_jack_PROCESS: engine_iter_out");
     
-    /* 3. copy data from ecasound buffers to port output buffers */
+    /* 3. mute output ports that were not written to, and 
+     *    unmap all port buffers */
     for(size_t n = 0; n < current->outports_rep.size(); n++) {
-      if (current->outports_rep[n]->cb_buffer != 0) {
-	jack_default_audio_sample_t* out_cb_buffer = 
-	  static_cast<jack_default_audio_sample_t*>
-	  (jack_port_get_buffer(current->outports_rep[n]->jackport, nframes));
-	
-	memcpy(out_cb_buffer, 
-	       current->outports_rep[n]->cb_buffer, 
+      AUDIO_IO_JACK_MANAGER::eca_jack_port_data_t* port = current->outports_rep[n];
+      if (port->cycle_buffer != 0 && port->cycle_written != true) {
+	memset(port->cycle_buffer, 
+	       0, 
 	       current->buffersize_rep * sizeof(jack_default_audio_sample_t));
       }
+      port->cycle_buffer = 0;
+    }
+    for(size_t n = 0; n < current->inports_rep.size(); n++) {
+      current->inports_rep[n]->cycle_buffer = 0;
     }
   }
   else {
@@ -488,7 +507,7 @@ static void eca_jack_process_mute(jack_nframes_t nframes, void* arg)
   AUDIO_IO_JACK_MANAGER* current = static_cast<AUDIO_IO_JACK_MANAGER*>(arg);
 
   for(size_t n = 0; n < current->outports_rep.size(); n++) {
-    if (current->outports_rep[n]->cb_buffer != 0) {
+    if (current->outports_rep[n]->jackport != 0) {
       jack_default_audio_sample_t* out_cb_buffer = 
 	static_cast<jack_default_audio_sample_t*>
 	(jack_port_get_buffer(current->outports_rep[n]->jackport, nframes));
@@ -677,6 +696,34 @@ static void eca_jack_shutdown_cb(void *arg)
   current->shutdown_request_rep = true;
 }
 
+/**
+ * Main loop of chain worker threads. Each wake-up
+ * processes chains of one engine iteration, after 
+ * which the worker reports completion and sleeps 
+ * again.
+ *
+ * context: W-level-0
+ */
+static void* eca_jack_worker_thread(void *arg)
+{
+  AUDIO_IO_JACK_MANAGER::eca_jack_worker_t* worker = 
+    static_cast<AUDIO_IO_JACK_MANAGER::eca_jack_worker_t*>(arg);
+  AUDIO_IO_JACK_MANAGER* current = worker->mgr;
+
+  /* note: the JACK process thread itself can't be
+   *       restricted, as it is created by JACK */
+  ECA_THREAD_AFFINITY::apply("audio");
+
+  while(true) {
+    if (sem_wait(&worker->start_sem) != 0) continue; /* EINTR */
+    if (current->workers_exit_rep == true) break;
+    current->run_chain_jobs();
+    sem_post(&current->workers_done_rep);
+  }
+
+  return 0;
+}
+
 /**
  * Implementations of non-static functions
  *
@@ -704,8 +751,14 @@ AUDIO_IO_JACK_MANAGER::AUDIO_IO_JACK_MANAGER(void)
   mode_rep = AUDIO_IO_JACK_MANAGER::Transport_invalid;
 
   shutdown_request_rep = false;
-  cb_allocated_frames_rep = 0;
   buffersize_rep = 0;
+
+  worker_count_rep = 0;
+  workers_exit_rep = false;
+  worker_next_chain_rep = 0;
+  worker_chain_count_rep = 0;
+  worker_engine_repp = 0;
+  sem_init(&workers_done_rep, 0, 0);
 }
 
 /**
@@ -723,10 +776,6 @@ AUDIO_IO_JACK_MANAGER::~AUDIO_IO_JACK_MANAGER(void)
   /* 2. clear input ports */
   vector<eca_jack_port_data_t*>::iterator q = inports_rep.begin();
   while(q != inports_rep.end()) {
-    if ((*q)->cb_buffer != 0) {
-      delete[] (*q)->cb_buffer;
-      (*q)->cb_buffer = 0;
-    }
     delete *q;
     ++q;
   }
@@ -734,10 +783,6 @@ AUDIO_IO_JACK_MANAGER::~AUDIO_IO_JACK_MANAGER(void)
   /* 3. clear output ports */
   q = inports_rep.begin();
   while(q != inports_rep.end()) {
-    if ((*q)->cb_buffer != 0) {
-      delete[] (*q)->cb_buffer;
-      (*q)->cb_buffer = 0;
-    }
     delete *q;
     ++q;
   }
@@ -748,6 +793,8 @@ AUDIO_IO_JACK_MANAGER::~AUDIO_IO_JACK_MANAGER(void)
     delete *p;
     ++p;
   }
+
+  sem_destroy(&workers_done_rep);
 }
 
 /**
@@ -947,6 +994,18 @@ void AUDIO_IO_JACK_MANAGER::set_parameter(int param, std::string value)
 #endif /* ECA_JACK_TRANSPORT_API */
 	break;
       }
+
+    case 3:
+      {
+	int workers = std::atoi(value.c_str());
+	worker_count_rep = (workers > 0) ? workers : 0;
+	if (worker_count_rep > 0) {
+	  ECA_LOG_MSG(ECA_LOGGER::user_objects, 
+		      "using " + kvu_numtostr(worker_count_rep) + 
+		      " worker threads for chain processing");
+	}
+	break;
+      }
     }
 }
 
@@ -973,6 +1032,11 @@ std::string AUDIO_IO_JACK_MANAGER::get_parameter(int param) const
 	}
 	break;
       }
+
+    case 3:
+      {
+	return kvu_numtostr(worker_count_rep);
+      }
     }
   return "";
 }
@@ -1337,6 +1401,126 @@ void AUDIO_IO_JACK_MANAGER::exit(void)
   if (engine_repp->is_prepared() == true) engine_repp->stop_operation();
 }
 
+/**
+ * Processes the engine's chains using the worker 
+ * threads. The calling thread takes part in processing 
+ * and returns once all chains are done. Chains are 
+ * claimed one at a time, so that uneven chain loads 
+ * are balanced between threads.
+ *
+ * context: J-level-2
+ */
+bool AUDIO_IO_JACK_MANAGER::process_chains(ECA_ENGINE* engine)
+{
+  int chains = engine->chain_count();
+  int workers = static_cast<int>(workers_rep.size());
+
+  if (workers == 0 || chains < 2) 
+    return false;
+
+  if (workers > chains - 1) workers = chains - 1;
+
+  worker_engine_repp = engine;
+  worker_chain_count_rep = chains;
+  worker_next_chain_rep = 0;
+  __sync_synchronize();
+
+  for(int n = 0; n < workers; n++) {
+    sem_post(&workers_rep[n]->start_sem);
+  }
+
+  run_chain_jobs();
+
+  for(int n = 0; n < workers; n++) {
+    while(sem_wait(&workers_done_rep) != 0) ; /* EINTR */
+  }
+  __sync_synchronize();
+
+  return true;
+}
+
+/**
+ * Processes unclaimed chains of the current iteration
+ * until none are left.
+ *
+ * context: J-level-3, W-level-1
+ */
+void AUDIO_IO_JACK_MANAGER::run_chain_jobs(void)
+{
+  while(true) {
+    int chain = __sync_fetch_and_add(&worker_next_chain_rep, 1);
+    if (chain >= worker_chain_count_rep) break;
+    worker_engine_repp->process_chain(chain);
+  }
+}
+
+/**
+ * Launches 'worker_count_rep' chain worker threads. 
+ * Threads are created with jack_client_create_thread()
+ * so they get the same scheduling class and priority 
+ * as the JACK process thread, and they are restricted
+ * to the CPUs of the 'audio' thread class.
+ *
+ * context: C-level-2
+ */
+void AUDIO_IO_JACK_MANAGER::start_workers(void)
+{
+  DBC_CHECK(workers_rep.size() == 0);
+
+  workers_exit_rep = false;
+  for(int n = 0; n < worker_count_rep; n++) {
+    eca_jack_worker_t* worker = new eca_jack_worker_t;
+    worker->mgr = this;
+    sem_init(&worker->start_sem, 0, 0);
+
+    int ret = jack_client_create_thread(client_repp, 
+					&worker->thread,
+					jack_client_real_time_priority(client_repp),
+					jack_is_realtime(client_repp),
+					eca_jack_worker_thread,
+					static_cast<void*>(worker));
+    if (ret != 0) {
+      ECA_LOG_MSG(ECA_LOGGER::info, 
+		  "WARNING: Unable to create JACK worker thread, using " + 
+		  kvu_numtostr(n) + " workers.");
+      sem_destroy(&worker->start_sem);
+      delete worker;
+      break;
+    }
+    workers_rep.push_back(worker);
+  }
+
+  if (workers_rep.size() > 0) {
+    ECA_LOG_MSG(ECA_LOGGER::system_objects, 
+		"started " + kvu_numtostr(workers_rep.size()) + " chain worker threads");
+  }
+}
+
+/**
+ * Terminates all chain worker threads.
+ *
+ * context: C-level-2
+ */
+void AUDIO_IO_JACK_MANAGER::stop_workers(void)
+{
+  /* note: holding the lock keeps the process callback 
+   *       out of process_chains() while workers exit */
+  KVU_GUARD_LOCK guard(&engine_mod_lock_rep);
+
+  workers_exit_rep = true;
+  __sync_synchronize();
+
+  for(size_t n = 0; n < workers_rep.size(); n++) {
+    sem_post(&workers_rep[n]->start_sem);
+  }
+  for(size_t n = 0; n < workers_rep.size(); n++) {
+    jack_client_stop_thread(client_repp, workers_rep[n]->thread);
+    sem_destroy(&workers_rep[n]->start_sem);
+    delete workers_rep[n];
+  }
+  workers_rep.clear();
+}
+
 /**
  * Returns a pointer to a 'eca_jack_node_t' structure 
  * matching client 'client_id'.
@@ -1525,7 +1709,8 @@ void AUDIO_IO_JACK_MANAGER::register_jack_ports(int client_id, int ports, const
     portdata->jackport = 0;
     portdata->autoconnect_string = "";
     portdata->total_latency = 0;
-    portdata->cb_buffer = new jack_default_audio_sample_t [cb_allocated_frames_rep];
+    portdata->cycle_buffer = 0;
+    portdata->cycle_written = false;
 
     std::map<string, int>::iterator it = port_numbers_rep.find(portprefix);
     if (it == port_numbers_rep.end()) {
@@ -1607,18 +1792,13 @@ void AUDIO_IO_JACK_MANAGER::unregister_jack_ports(int client_id)
       ++q;
     }
     
-    /* 3. delete sub-structures */
-      
-    delete[] (*p)->cb_buffer;
-    (*p)->cb_buffer = 0;
-
-    /* 4. delete the actual port_data object */
+    /* 3. delete the actual port_data object */
     delete *p;
 
     ++p;
   }
 
-  /* 5. clear the whole node port list */
+  /* 4. clear the whole node port list */
   node->ports.clear();
 
   // ---
@@ -1694,6 +1874,11 @@ SAMPLE_SPECS::sample_rate_t AUDIO_IO_JACK_MANAGER::samples_per_second(void) cons
 }
 
 /**
+ * Copies data from the port buffers of client 'client_id' 
+ * to 'target_buffer'. Port buffers are only available 
+ * during the JACK process callback; outside it, silence 
+ * is returned.
+ *
  * context: J-E-C-level-3
  */
 long int AUDIO_IO_JACK_MANAGER::read_samples(int client_id, void* target_buffer, long int samples)
@@ -1706,8 +1891,11 @@ long int AUDIO_IO_JACK_MANAGER::read_samples(int client_id, void* target_buffer,
 
   list<eca_jack_port_data*>::const_iterator p = node->ports.begin();
   while(p != node->ports.end()) {
-    if ((*p)->cb_buffer != 0) {
-      memcpy(ptr, (*p)->cb_buffer, buffersize_rep * sizeof(jack_default_audio_sample_t));
+    if ((*p)->jackport != 0) {
+      if ((*p)->cycle_buffer != 0)
+	memcpy(ptr, (*p)->cycle_buffer, buffersize_rep * sizeof(jack_default_audio_sample_t));
+      else
+	memset(ptr, 0, buffersize_rep * sizeof(jack_default_audio_sample_t));
       ptr += buffersize_rep;
     }
     ++p;
@@ -1730,14 +1918,77 @@ void AUDIO_IO_JACK_MANAGER::write_samples(int client_id, void* target_buffer, lo
   eca_jack_node_t* node = get_node(client_id);
   list<eca_jack_port_data*>::const_iterator p = node->ports.begin();
   while(p != node->ports.end()) {
-    if ((*p)->cb_buffer != 0) {
-      /* note: cb_buffer points to jack_default_audio_sample_t* */
-      memcpy((*p)->cb_buffer, ptr, writesamples * sample_size);
+    if ((*p)->jackport != 0) {
+      if ((*p)->cycle_buffer != 0) {
+	memcpy((*p)->cycle_buffer, ptr, writesamples * sample_size);
+	memset((*p)->cycle_buffer + writesamples,
+	       0,
+	       (buffersize_rep - writesamples) * sample_size);
+	(*p)->cycle_written = true;
+      }
       ptr += writesamples;
-      memset((*p)->cb_buffer + writesamples,
+    }
+    ++p;
+  }
+}
+
+/**
+ * Reads one buffer of audio from the port buffers of 
+ * client 'client_id' directly into 'sbuf'. 
+ *
+ * Compared to read_samples(), this avoids the 
+ * intermediate non-interleaved byte buffer.
+ *
+ * context: J-level-3
+ */
+void AUDIO_IO_JACK_MANAGER::read_buffer(int client_id, SAMPLE_BUFFER* sbuf)
+{
+  eca_jack_node_t* node = get_node(client_id);
+  int channels = static_cast<int>(node->ports.size());
+
+  if (sbuf->number_of_channels() != channels) 
+    sbuf->number_of_channels(channels);
+  if (sbuf->length_in_samples() != buffersize_rep)
+    sbuf->length_in_samples(buffersize_rep);
+
+  int c = 0;
+  list<eca_jack_port_data*>::const_iterator p = node->ports.begin();
+  while(p != node->ports.end()) {
+    sbuf->import_channel_float(c++, (*p)->cycle_buffer);
+    ++p;
+  }
+}
+
+/**
+ * Writes contents of 'sbuf' directly to the port 
+ * buffers of client 'client_id'. Ports that have no 
+ * matching channel in 'sbuf' are muted.
+ *
+ * context: J-level-3
+ */
+void AUDIO_IO_JACK_MANAGER::write_buffer(int client_id, SAMPLE_BUFFER* sbuf)
+{
+  if (sbuf->length_in_samples() > buffersize_rep)
+    sbuf->length_in_samples(buffersize_rep);
+
+  eca_jack_node_t* node = get_node(client_id);
+
+  int c = 0;
+  list<eca_jack_port_data*>::const_iterator p = node->ports.begin();
+  while(p != node->ports.end()) {
+    jack_default_audio_sample_t* dst = (*p)->cycle_buffer;
+    if (dst != 0) {
+      long int written = 0;
+      if (c < sbuf->number_of_channels()) {
+	sbuf->export_channel_float(c, dst);
+	written = sbuf->length_in_samples();
+      }
+      memset(dst + written,
 	     0,
-	     (buffersize_rep - writesamples) * sample_size);
+	     (buffersize_rep - written) * sizeof(jack_default_audio_sample_t));
+      (*p)->cycle_written = true;
     }
+    ++c;
     ++p;
   }
 }
@@ -1769,7 +2020,7 @@ void AUDIO_IO_JACK_MANAGER::open_server_connection(void)
   if (n != AUDIO_IO_JACK_MANAGER::instance_limit) {
     srate_rep = static_cast<long int>(jack_get_sample_rate(client_repp));
     /* FIXME: add better control of allocated memory */
-    cb_allocated_frames_rep = buffersize_rep = static_cast<long int>(jack_get_buffer_size(client_repp));
+    buffersize_rep = static_cast<long int>(jack_get_buffer_size(client_repp));
     shutdown_request_rep = false;
     jackslave_seekahead_rep = 4096 / buffersize_rep + 1;
 
@@ -1788,6 +2039,8 @@ void AUDIO_IO_JACK_MANAGER::open_server_connection(void)
 
     open_rep = true;
 
+    start_workers();
+
 #ifdef PROFILE_CALLBACK_EXECUTION
     profile_callback_timer.set_lower_bound_seconds(0.001f);
     profile_callback_timer.set_upper_bound_seconds(0.005f);
@@ -1819,6 +2072,8 @@ void AUDIO_IO_JACK_MANAGER::close_server_connection(void)
   // FIXME: add proper unregistration
   // iterate over cids: unregister_jack_ports()
 
+  stop_workers();
+
   jack_client_close (client_repp);
   shutdown_request_rep = false;
   open_rep = false;
@@ -1881,7 +2136,7 @@ void AUDIO_IO_JACK_MANAGER::set_node_connection(eca_jack_node_t* node, bool conn
 {
   list<eca_jack_port_data*>::iterator p = node->ports.begin();
   while(p != node->ports.end()) {
-    if ((*p)->cb_buffer != 0) {
+    if ((*p)->jackport != 0) {
       string ecaport = (*p)->autoconnect_string;
       if (ecaport.size() > 0) {
 	string jackport (jack_port_name((*p)->jackport));
@@ -7,6 +7,7 @@
 #include <map>
 
 #include <pthread.h>
+#include <semaphore.h>
 #include <jack/jack.h>
 
 #include "sample-specs.h"
@@ -16,6 +17,7 @@
 #include "audioio_jack.h"
 
 class AUDIO_IO;
+class SAMPLE_BUFFER;
 
 using std::list;
 using std::string;
@@ -46,6 +48,7 @@ class AUDIO_IO_JACK_MANAGER : public AUDIO_IO_MANAGER,
   friend int eca_jack_bsize_cb(jack_nframes_t nframes, void *arg);
   friend int eca_jack_srate_cb(jack_nframes_t nframes, void *arg);
   friend void eca_jack_shutdown_cb(void *arg);
+  friend void* eca_jack_worker_thread(void *arg);
 
   static const int instance_limit;
 
@@ -55,7 +58,8 @@ public:
     jack_port_t* jackport;
     string autoconnect_string;
     jack_nframes_t total_latency;
-    jack_default_audio_sample_t* cb_buffer;
+    jack_default_audio_sample_t* cycle_buffer;  /**< port buffer, valid only during process callback */
+    bool cycle_written;                         /**< output port written during this cycle */
   } eca_jack_port_data_t;
 
   typedef struct eca_jack_node {
@@ -65,6 +69,12 @@ public:
     int client_id;
   } eca_jack_node_t;
 
+  typedef struct eca_jack_worker {
+    AUDIO_IO_JACK_MANAGER* mgr;
+    pthread_t thread;
+    sem_t start_sem;
+  } eca_jack_worker_t;
+
  private:
 
   typedef enum Operation_mode {
@@ -107,7 +117,7 @@ public:
   /** @name Function reimplemented from DYNAMIC_PARAMETERS */
   /*@{*/
 
-  virtual std::string parameter_names(void) const { return("clientname,mode"); }
+  virtual std::string parameter_names(void) const { return("clientname,mode,workers"); }
   virtual void set_parameter(int param, std::string value);
   virtual std::string get_parameter(int param) const;
 
@@ -129,6 +139,7 @@ public:
   virtual void start(void);
   virtual void stop(bool drain);
   virtual void exit(void);
+  virtual bool process_chains(ECA_ENGINE* engine);
 
   /*@}*/
 
@@ -147,6 +158,8 @@ public:
   
   long int read_samples(int client_id, void* target_buffer, long int samples);
   void write_samples(int client_id, void* target_buffer, long int samples);
+  void read_buffer(int client_id, SAMPLE_BUFFER* sbuf);
+  void write_buffer(int client_id, SAMPLE_BUFFER* sbuf);
 
   bool is_open(void) const { return(open_rep); }
   bool is_connection_active(void) const { return(activated_rep); }
@@ -181,6 +194,10 @@ private:
   void disconnect_all_nodes(void);
   eca_jack_node_t* get_node(int client_id);
 
+  void start_workers(void);
+  void stop_workers(void);
+  void run_chain_jobs(void);
+
   void wait_for_exit(void);
   void signal_exit(void);
   void wait_for_stop(void);
@@ -222,7 +239,14 @@ private:
 
   SAMPLE_SPECS::sample_rate_t srate_rep;
   long int buffersize_rep;
-  long int cb_allocated_frames_rep;
+
+  int worker_count_rep;                   /**< requested number of worker threads */
+  vector<eca_jack_worker_t*> workers_rep; /**< running worker threads */
+  sem_t workers_done_rep;
+  bool workers_exit_rep;
+  volatile int worker_next_chain_rep;     /**< next unclaimed chain in current cycle */
+  int worker_chain_count_rep;
+  ECA_ENGINE* worker_engine_repp;
 };
 
 #endif
@@ -1,6 +1,7 @@
 // ------------------------------------------------------------------------
 // sample-specs.h: Sample value defaults and constants.
 // Copyright (C) 1999-2004 Kai Vehmanen
+// Copyright (C) 2026 agent
 //
 // Attributes:
 //     eca-style-version: 2
@@ -32,8 +33,17 @@ namespace SAMPLE_SPECS {
   /**
    * Type used to represent one sample value; should
    * be a floating point value (floating-point type)
+   *
+   * Single precision is used if libecasound was configured
+   * with '--enable-float-samples'. Applications must then be
+   * compiled with ECA_USE_FLOAT_SAMPLES defined (included in
+   * 'libecasound-config --cflags').
    */
+#ifdef ECA_USE_FLOAT_SAMPLES
+  typedef float sample_t;
+#else
   typedef double sample_t;
+#endif
 
   /**
    * Type used to represent position in sample 
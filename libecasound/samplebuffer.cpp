@@ -1,6 +1,7 @@
 // ------------------------------------------------------------------------
 // samplebuffer.cpp: Class representing a buffer of audio samples.
 // Copyright (C) 1999-2005,2009 Kai Vehmanen
+// Copyright (C) 2026 agent
 //
 // Attributes:
 //     eca-style-version: 3
@@ -53,6 +54,12 @@ extern "C" {
 }
 #endif
 
+#if defined(__SSE2__) && !defined(ECA_USE_FLOAT_SAMPLES)
+#include <emmintrin.h>
+#endif
+
+#include "eca-resampler.h"
+#include "eca-rt-memory.h"
 #include "eca-sample-conversion.h"
 #include "samplebuffer.h"
 #include "samplebuffer_impl.h"
@@ -75,16 +82,70 @@ static const bool is_system_littleendian = true;
 
 using namespace std;
 
-static void priv_alloc_sample_buf(SAMPLE_SPECS::sample_t **memptr, size_t size)
+/**
+ * Whether the built-in polyphase resampler is used
+ * at resampling quality 'quality'.
+ */
+static bool priv_use_polyphase(int quality)
 {
-#ifdef HAVE_POSIX_MEMALIGN
-  /* align buffers to 128bit/16octet boundary */
-  posix_memalign(reinterpret_cast<void**>(memptr), 16, size);
+#ifdef ECA_COMPILE_SAMPLERATE
+  return quality > 5 && quality <= 75;
 #else
-  *memptr = reinterpret_cast<SAMPLE_SPECS::sample_t*>(malloc(size));
+  return quality > 5;
+#endif
+}
+
+static void priv_alloc_sample_buf(SAMPLE_SPECS::sample_t **memptr, size_t size)
+{
+  /* note: buffers are aligned to 128bit/16octet boundary */
+  *memptr = reinterpret_cast<SAMPLE_SPECS::sample_t*>(ECA_RT_MEMORY::allocate(size));
+}
+
+#ifndef ECA_USE_FLOAT_SAMPLES
+static float* priv_alloc_float_buf(size_t samples)
+{
+  void* ptr = ECA_RT_MEMORY::allocate(sizeof(float) * samples);
+  std::memset(ptr, 0, sizeof(float) * samples);
+  return reinterpret_cast<float*>(ptr);
+}
+
+/**
+ * Converts 'samples' samples from 'src' to single precision.
+ * Uses SSE2 to convert four samples per iteration when
+ * available.
+ */
+static void priv_convert_to_float(float* dst, const SAMPLE_SPECS::sample_t* src, long int samples)
+{
+  long int n = 0;
+#ifdef __SSE2__
+  for(; n + 4 <= samples; n += 4) {
+    __m128 lo = _mm_cvtpd_ps(_mm_loadu_pd(src + n));
+    __m128 hi = _mm_cvtpd_ps(_mm_loadu_pd(src + n + 2));
+    _mm_storeu_ps(dst + n, _mm_movelh_ps(lo, hi));
+  }
 #endif
+  for(; n < samples; n++)
+    dst[n] = static_cast<float>(src[n]);
+}
 
+/**
+ * Converts 'samples' single precision samples from 'src'
+ * to sample_t.
+ */
+static void priv_convert_from_float(SAMPLE_SPECS::sample_t* dst, const float* src, long int samples)
+{
+  long int n = 0;
+#ifdef __SSE2__
+  for(; n + 4 <= samples; n += 4) {
+    __m128 f = _mm_loadu_ps(src + n);
+    _mm_storeu_pd(dst + n, _mm_cvtps_pd(f));
+    _mm_storeu_pd(dst + n + 2, _mm_cvtps_pd(_mm_movehl_ps(f, f)));
+  }
+#endif
+  for(; n < samples; n++)
+    dst[n] = src[n];
 }
+#endif
 
 /**
  * Constructs a new sample buffer object.
@@ -116,6 +177,8 @@ SAMPLE_BUFFER::SAMPLE_BUFFER (buf_size_t buffersize, channel_size_t channels)
   impl_repp->rt_lock_rep = false;
   impl_repp->lockref_rep = 0;
   impl_repp->old_buffer_repp = 0;
+  impl_repp->resample_ratio_rep = 0.0;
+  impl_repp->float_current_rep = false;
 #ifdef ECA_COMPILE_SAMPLERATE
   impl_repp->quality_rep = 50;
   impl_repp->src_state_rep.resize(channels);
@@ -146,16 +209,20 @@ SAMPLE_BUFFER::~SAMPLE_BUFFER (void)
 
   for(size_t n = 0; n < buffer.size(); n++) {
     if (buffer[n] != 0) {
-      ::free(buffer[n]);
+      ECA_RT_MEMORY::release(buffer[n]);
       buffer[n] = 0;
     }
   }
 
   if (impl_repp->old_buffer_repp != 0) {
-    ::free(impl_repp->old_buffer_repp);
+    ECA_RT_MEMORY::release(impl_repp->old_buffer_repp);
     impl_repp->old_buffer_repp = 0;
   }
 
+  for(size_t n = 0; n < impl_repp->float_plane_rep.size(); n++) {
+    ECA_RT_MEMORY::release(impl_repp->float_plane_rep[n]);
+  }
+
 #ifdef ECA_COMPILE_SAMPLERATE
   for(size_t n = 0; n < impl_repp->src_state_rep.size(); n++) {
     if (impl_repp->src_state_rep[n] != 0) {
@@ -376,6 +443,53 @@ void SAMPLE_BUFFER::multiply_by_ref(SAMPLE_BUFFER::sample_t factor, int channel)
   }
 }
 
+/**
+ * Multiplies all samples with a gain that moves from 'from'
+ * to 'to' over the length of the buffer. The last sample
+ * of the buffer is multiplied with 'to'.
+ *
+ * Exponential ramps fall back to linear ramps if either
+ * of the endpoints is not positive.
+ */
+void SAMPLE_BUFFER::multiply_by_ramp(SAMPLE_BUFFER::sample_t from, SAMPLE_BUFFER::sample_t to, Ramp_shape shape)
+{
+  for(channel_size_t n = 0; n < channel_count_rep; n++) {
+    multiply_by_ramp(from, to, n, shape);
+  }
+}
+
+/**
+ * Multiplies samples of 'channel' with a gain that moves 
+ * from 'from' to 'to' over the length of the buffer.
+ *
+ * @see multiply_by_ramp(sample_t,sample_t,Ramp_shape)
+ */
+void SAMPLE_BUFFER::multiply_by_ramp(SAMPLE_BUFFER::sample_t from, SAMPLE_BUFFER::sample_t to, int channel, Ramp_shape shape)
+{
+  if (buffersize_rep == 0)
+    return;
+
+  sample_t* data = buffer[channel];
+
+  if (shape == ramp_exponential && from > 0 && to > 0) {
+    sample_t ratio = std::pow(to / from, 1.0 / buffersize_rep);
+    sample_t gain = from;
+    for(buf_size_t m = 0; m < buffersize_rep - 1; m++) {
+      gain *= ratio;
+      data[m] *= gain;
+    }
+  }
+  else {
+    sample_t step = (to - from) / buffersize_rep;
+    for(buf_size_t m = 0; m < buffersize_rep - 1; m++) {
+      data[m] *= from + step * (m + 1);
+    }
+  }
+
+  /* note: avoid accumulated rounding errors at the end point */
+  data[buffersize_rep - 1] *= to;
+}
+
 /**
  * Divides all samples by 'dvalue'.
  */
@@ -526,19 +640,22 @@ void SAMPLE_BUFFER::resample(SAMPLE_SPECS::sample_rate_t from_rate,
   DBC_DECLARE(buf_size_t old_length_in_samples = length_in_samples());
 #endif
 
+  if (priv_use_polyphase(impl_repp->quality_rep) == true) {
+    resample_polyphase(from_rate, to_rate);
+  }
 #ifdef ECA_COMPILE_SAMPLERATE
-  if (impl_repp->quality_rep > 5) {
+  else if (impl_repp->quality_rep > 5) {
     resample_secret_rabbit_code(from_rate, to_rate);
   }
-  else 
 #endif
-    {
-      DBC_CHECK(impl_repp->quality_rep <= 5);
-      resample_with_memory(from_rate, to_rate); 
-    }
+  else {
+    DBC_CHECK(impl_repp->quality_rep <= 5);
+    resample_with_memory(from_rate, to_rate); 
+  }
 
 #ifndef ECA_COMPILE_SAMPLERATE
-  /* with libsamplerate, the output sample count can vary from call to call */
+  /* with libsamplerate and the polyphase resampler, the output
+   * sample count can vary by one from call to call */
   DBC_CHECK((static_cast<double>(to_rate) / from_rate * old_length_in_samples - length_in_samples()) >= -1);
 #endif
 }
@@ -546,26 +663,33 @@ void SAMPLE_BUFFER::resample(SAMPLE_SPECS::sample_rate_t from_rate,
 /**
  * Set resampling quality. 
  *
- * Depending on build options, not all quality levels
- * are necessarily supported. If the requested quality level 
- * exceeds the available resamplers, the quality setting 
- * is set to the highest available algorithm. You can use
- * the get_resample_quality() function to query the current level.
+ * Levels up to 5 select linear interpolation. Higher
+ * levels use the built-in polyphase resampler, whose
+ * filter length grows with the quality level. When 
+ * compiled with libsamplerate, levels above 75 use 
+ * libsamplerate's best sinc converter.
+ *
+ * If resample_init_memory() has already been called,
+ * changing the quality is not realtime-safe.
  *
  * @param quality value between 0 (lowest) to 100 (highest)
  */
 void SAMPLE_BUFFER::resample_set_quality(int quality)
 {
-#ifdef ECA_COMPILE_SAMPLERATE
   impl_repp->quality_rep = quality;
-#else
-  if (quality > 10) {
-    ECA_LOG_MSG(ECA_LOGGER::info, 
-		"WARNING: Libsamplerate is required for high-quality resampling. "
-		"Using the internal resampler instead.");
-    impl_repp->quality_rep = 5;
+
+  if (priv_use_polyphase(quality) == true &&
+      impl_repp->resample_ratio_rep > 0.0 &&
+      (impl_repp->polyphase_rep.is_initialized() != true ||
+       ECA_RESAMPLER_KERNEL::quality_to_level(impl_repp->polyphase_rep.quality()) !=
+       ECA_RESAMPLER_KERNEL::quality_to_level(quality))) {
+    resample_init_polyphase();
+  }
+  else if (priv_use_polyphase(quality) != true &&
+	   impl_repp->polyphase_rep.is_initialized() == true) {
+    /* return the filter tables to the shared cache */
+    impl_repp->polyphase_rep.release();
   }
-#endif
 }
 
 /**
@@ -762,6 +886,124 @@ void SAMPLE_BUFFER::export_noninterleaved(unsigned char* target,
   // -------
 }
 
+/**
+ * Copies length_in_samples() samples from a native 
+ * floating-point array 'source' to channel 'channel'.
+ * Meant for devices that hand out per-channel float 
+ * buffers (e.g. JACK ports), so that no intermediate 
+ * byte buffer is needed. If 'source' is null, the 
+ * channel is silenced.
+ *
+ * @pre channel >= 0 && channel < number_of_channels()
+ */
+void SAMPLE_BUFFER::import_channel_float(channel_size_t channel, const float* source)
+{
+  // --------
+  DBC_REQUIRE(channel >= 0 && channel < number_of_channels());
+  // --------
+
+  sample_t* dst = buffer[channel];
+  if (source == 0) {
+    for(buf_size_t n = 0; n < buffersize_rep; n++) 
+      dst[n] = SAMPLE_SPECS::silent_value;
+  }
+  else {
+    for(buf_size_t n = 0; n < buffersize_rep; n++) 
+      dst[n] = source[n];
+  }
+}
+
+/**
+ * Copies length_in_samples() samples from channel 
+ * 'channel' to a native floating-point array 'target'.
+ * Values are clipped like in export_noninterleaved().
+ *
+ * @pre channel >= 0 && channel < number_of_channels()
+ * @pre target != 0
+ */
+void SAMPLE_BUFFER::export_channel_float(channel_size_t channel, float* target) const
+{
+  // --------
+  DBC_REQUIRE(channel >= 0 && channel < number_of_channels());
+  DBC_REQUIRE(target != 0);
+  // --------
+
+  const sample_t* src = buffer[channel];
+  for(buf_size_t n = 0; n < buffersize_rep; n++) {
+    sample_t stemp = src[n];
+    if (stemp > SAMPLE_SPECS::impl_max_value) stemp = SAMPLE_SPECS::impl_max_value;
+    else if (stemp < SAMPLE_SPECS::impl_min_value) stemp = SAMPLE_SPECS::impl_min_value;
+    target[n] = static_cast<float>(stemp);
+  }
+}
+
+/**
+ * Converts 'samples' samples from 'source' to channel 
+ * 'channel', starting at sample 'offset'. Consecutive
+ * source samples are 'stride' bytes apart. This matches
+ * the channel area layout of memory-mapped devices
+ * (e.g. ALSA mmap), and allows converting directly from 
+ * the device buffer without an intermediate copy.
+ *
+ * @pre channel >= 0 && channel < number_of_channels()
+ * @pre offset + samples <= length_in_samples()
+ * @pre source != 0
+ */
+void SAMPLE_BUFFER::import_channel_strided(channel_size_t channel,
+					   buf_size_t offset,
+					   const unsigned char* source,
+					   buf_size_t samples,
+					   long int stride,
+					   ECA_AUDIO_FORMAT::Sample_format fmt)
+{
+  // --------
+  DBC_REQUIRE(channel >= 0 && channel < number_of_channels());
+  DBC_REQUIRE(offset + samples <= length_in_samples());
+  DBC_REQUIRE(source != 0);
+  // --------
+
+  for(buf_size_t n = 0; n < samples; n++) {
+    buf_size_t iptr = 0;
+    import_helper(source + n * stride, &iptr, buffer[channel], offset + n, fmt);
+  }
+}
+
+/**
+ * Converts 'samples' samples from channel 'channel', 
+ * starting at sample 'offset', to 'target'. Consecutive
+ * target samples are 'stride' bytes apart. Values are 
+ * clipped like in export_noninterleaved().
+ *
+ * @see import_channel_strided()
+ *
+ * @pre channel >= 0 && channel < number_of_channels()
+ * @pre offset + samples <= length_in_samples()
+ * @pre target != 0
+ */
+void SAMPLE_BUFFER::export_channel_strided(channel_size_t channel,
+					   buf_size_t offset,
+					   unsigned char* target,
+					   buf_size_t samples,
+					   long int stride,
+					   ECA_AUDIO_FORMAT::Sample_format fmt) const
+{
+  // --------
+  DBC_REQUIRE(channel >= 0 && channel < number_of_channels());
+  DBC_REQUIRE(offset + samples <= length_in_samples());
+  DBC_REQUIRE(target != 0);
+  // --------
+
+  const sample_t* src = buffer[channel] + offset;
+  for(buf_size_t n = 0; n < samples; n++) {
+    sample_t stemp = src[n];
+    if (stemp > SAMPLE_SPECS::impl_max_value) stemp = SAMPLE_SPECS::impl_max_value;
+    else if (stemp < SAMPLE_SPECS::impl_min_value) stemp = SAMPLE_SPECS::impl_min_value;
+
+    buf_size_t optr = 0;
+    export_helper(target + n * stride, &optr, stemp, fmt);
+  }
+}
+
 void SAMPLE_BUFFER::import_helper(const unsigned char *ibuffer,
 				  buf_size_t* iptr,
 				  sample_t* obuffer,
@@ -1031,6 +1273,17 @@ void SAMPLE_BUFFER::number_of_channels(channel_size_t len)
     // ECA_LOG_MSG(ECA_LOGGER::system_objects, "Increasing channel-count (2).");
   }
 
+#ifndef ECA_USE_FLOAT_SAMPLES
+  if (impl_repp->float_current_rep == true) {
+    /* note: new channels are silent in the float plane, too */
+    for(channel_size_t n = channel_count_rep; 
+	n < len && n < static_cast<channel_size_t>(impl_repp->float_plane_rep.size());
+	n++) {
+      std::memset(impl_repp->float_plane_rep[n], 0, sizeof(float) * reserved_samples_rep);
+    }
+  }
+#endif
+
   channel_count_rep = len;
 }
 
@@ -1056,13 +1309,22 @@ void SAMPLE_BUFFER::length_in_samples(buf_size_t len)
       priv_alloc_sample_buf(&buffer[n], sizeof(sample_t) * reserved_samples_rep);
       for (buf_size_t m = 0; m < buffersize_rep; m++)
 	buffer[n][m] = prev_buffer[m];
-      ::free(prev_buffer);
+      ECA_RT_MEMORY::release(prev_buffer);
     }
 
     if (impl_repp->old_buffer_repp != 0) {
-      ::free(impl_repp->old_buffer_repp);
+      ECA_RT_MEMORY::release(impl_repp->old_buffer_repp);
       priv_alloc_sample_buf(&impl_repp->old_buffer_repp, sizeof(sample_t) * reserved_samples_rep);
     }
+
+#ifndef ECA_USE_FLOAT_SAMPLES
+    for(size_t n = 0; n < impl_repp->float_plane_rep.size(); n++) {
+      float* prev_plane = impl_repp->float_plane_rep[n];
+      impl_repp->float_plane_rep[n] = priv_alloc_float_buf(reserved_samples_rep);
+      std::memcpy(impl_repp->float_plane_rep[n], prev_plane, sizeof(float) * buffersize_rep);
+      ECA_RT_MEMORY::release(prev_plane);
+    }
+#endif
   }
 
   if (len > buffersize_rep) {
@@ -1072,6 +1334,14 @@ void SAMPLE_BUFFER::length_in_samples(buf_size_t len)
 	buffer[n][m] = SAMPLE_SPECS::silent_value;
       }
     }
+#ifndef ECA_USE_FLOAT_SAMPLES
+    if (impl_repp->float_current_rep == true) {
+      for(size_t n = 0; n < impl_repp->float_plane_rep.size(); n++) {
+	std::memset(impl_repp->float_plane_rep[n] + buffersize_rep, 0, 
+		    sizeof(float) * (reserved_samples_rep - buffersize_rep));
+      }
+    }
+#endif
   }
 
   buffersize_rep = len;
@@ -1088,16 +1358,23 @@ void SAMPLE_BUFFER::length_in_samples(buf_size_t len)
 void SAMPLE_BUFFER::resample_init_memory(SAMPLE_SPECS::sample_rate_t from_srate,
 					 SAMPLE_SPECS::sample_rate_t to_srate)
 {
+  if (priv_use_polyphase(impl_repp->quality_rep) == true) {
+    ECA_LOG_MSG(ECA_LOGGER::system_objects, 
+		"Resampler selected: internal polyphase resampler.");
+  }
+  else {
 #ifdef ECA_COMPILE_SAMPLERATE
-  ECA_LOG_MSG(ECA_LOGGER::system_objects, 
+    ECA_LOG_MSG(ECA_LOGGER::system_objects, 
 		"Resampler selected: libsamplerate (Secret Rabbit Code).");
 #else
-  ECA_LOG_MSG(ECA_LOGGER::system_objects, 
+    ECA_LOG_MSG(ECA_LOGGER::system_objects, 
 		"Resampler selected: internal resampler.");
 #endif
+  }
 
   double step = 1.0;
   if (from_srate != 0) { step = static_cast<double>(to_srate) / from_srate; }
+  impl_repp->resample_ratio_rep = step;
 
   /* add at least one word of extra space */
   buf_size_t new_buffer_size = static_cast<buf_size_t>((step * buffersize_rep)) + sizeof(buf_size_t);
@@ -1111,7 +1388,7 @@ void SAMPLE_BUFFER::resample_init_memory(SAMPLE_SPECS::sample_rate_t from_srate,
 #endif
 
     for(int c = 0; c < channel_count_rep; c++) {
-      ::free(buffer[c]);
+      ECA_RT_MEMORY::release(buffer[c]);
       priv_alloc_sample_buf(&buffer[c], sizeof(sample_t) * reserved_samples_rep);
     }
   }
@@ -1140,13 +1417,37 @@ void SAMPLE_BUFFER::resample_init_memory(SAMPLE_SPECS::sample_rate_t from_srate,
 #endif
     impl_repp->resample_memory_rep.resize(channel_count_rep, 0.0f);
   }
+
+  if (priv_use_polyphase(impl_repp->quality_rep) == true) {
+    resample_init_polyphase();
+  }
+}
+
+/**
+ * Allocates polyphase resampler state and filter
+ * tables for the ratio given to resample_init_memory().
+ */
+void SAMPLE_BUFFER::resample_init_polyphase(void)
+{
+#ifdef ECA_DEBUG_MODE
+  DBC_CHECK(impl_repp->rt_lock_rep != true);
+#endif
+  double ratio = impl_repp->resample_ratio_rep > 0.0 ? impl_repp->resample_ratio_rep : 1.0;
+  impl_repp->polyphase_rep.init(channel_count_rep, 
+				reserved_samples_rep,
+				ratio,
+				impl_repp->quality_rep);
 }
 
 void SAMPLE_BUFFER::reserve_channels(channel_size_t num)
 {
-  channel_size_t oldcount = number_of_channels();
-  number_of_channels(num);
-  number_of_channels(oldcount);
+  /* note: does not touch a buffer that already has room, 
+   *       as it may be in use by another thread */
+  if (num > static_cast<channel_size_t>(buffer.size())) {
+    channel_size_t oldcount = number_of_channels();
+    number_of_channels(num);
+    number_of_channels(oldcount);
+  }
 }
 
 void SAMPLE_BUFFER::reserve_length_in_samples(buf_size_t len)
@@ -1156,6 +1457,110 @@ void SAMPLE_BUFFER::reserve_length_in_samples(buf_size_t len)
   length_in_samples(oldlen);
 }
 
+/**
+ * Allocates the single precision plane for at least
+ * 'channels' channels of reserved_length_in_samples().
+ *
+ * Operators hosting plugin APIs that only support 32bit
+ * floats (LADSPA, LV2) call this when initialized, and
+ * connect the plugin ports to float_plane_channel(). 
+ * Like 'buffer', the plane is reallocated if the
+ * reserved length grows, so the pointer reflock
+ * must be held.
+ *
+ * When sample_t is float, the plane is 'buffer' itself.
+ * Not realtime-safe, unless the plane already has room 
+ * for 'channels', in which case the buffer is not 
+ * modified.
+ */
+void SAMPLE_BUFFER::float_plane_reserve(channel_size_t channels)
+{
+  reserve_channels(channels);
+
+#ifndef ECA_USE_FLOAT_SAMPLES
+  std::vector<float*>& plane = impl_repp->float_plane_rep;
+  if (plane.size() < static_cast<size_t>(channels)) {
+    DBC_CHECK(impl_repp->rt_lock_rep != true);
+  }
+  while(plane.size() < static_cast<size_t>(channels)) {
+    plane.push_back(priv_alloc_float_buf(reserved_samples_rep > 0 ? reserved_samples_rep : 1));
+  }
+#endif
+}
+
+/**
+ * Returns the single precision samples of 'channel'.
+ *
+ * @pre channel >= 0 
+ * @pre float_plane_reserve() called for 'channel'
+ */
+float* SAMPLE_BUFFER::float_plane_channel(channel_size_t channel)
+{
+#ifdef ECA_USE_FLOAT_SAMPLES
+  DBC_REQUIRE(channel >= 0 && channel < static_cast<channel_size_t>(buffer.size()));
+  return buffer[channel];
+#else
+  DBC_REQUIRE(channel >= 0 && channel < static_cast<channel_size_t>(impl_repp->float_plane_rep.size()));
+  return impl_repp->float_plane_rep[channel];
+#endif
+}
+
+/**
+ * Makes the float plane hold the current audio data,
+ * converting it from 'buffer' unless it already does.
+ * The float plane remains current until the next call 
+ * to float_plane_sync(), so consecutive float-only
+ * operators share a single conversion. Until then,
+ * 'buffer' must not be accessed.
+ *
+ * Realtime-safe.
+ */
+void SAMPLE_BUFFER::float_plane_acquire(void)
+{
+#ifndef ECA_USE_FLOAT_SAMPLES
+  if (impl_repp->float_current_rep != true) {
+    std::vector<float*>& plane = impl_repp->float_plane_rep;
+    for(channel_size_t n = 0; 
+	n < channel_count_rep && n < static_cast<channel_size_t>(plane.size());
+	n++) {
+      priv_convert_to_float(plane[n], buffer[n], buffersize_rep);
+    }
+    impl_repp->float_current_rep = true;
+  }
+#endif
+}
+
+/**
+ * Copies the audio data back to 'buffer', if
+ * float_plane_acquire() has been called since 
+ * the previous sync.
+ *
+ * Realtime-safe.
+ */
+void SAMPLE_BUFFER::float_plane_sync(void)
+{
+#ifndef ECA_USE_FLOAT_SAMPLES
+  if (impl_repp->float_current_rep == true) {
+    std::vector<float*>& plane = impl_repp->float_plane_rep;
+    for(channel_size_t n = 0; 
+	n < channel_count_rep && n < static_cast<channel_size_t>(plane.size());
+	n++) {
+      priv_convert_from_float(buffer[n], plane[n], buffersize_rep);
+    }
+    impl_repp->float_current_rep = false;
+  }
+#endif
+}
+
+/**
+ * Whether the float plane holds the current audio
+ * data, i.e. 'buffer' is out of date.
+ */
+bool SAMPLE_BUFFER::float_plane_current(void) const
+{
+  return impl_repp->float_current_rep;
+}
+
 /**
  * Sets the realtime-lock state. When realtime-lock
  * is enabled, all non-rt-safe operations 
@@ -1442,12 +1847,36 @@ void SAMPLE_BUFFER::resample_secret_rabbit_code(SAMPLE_SPECS::sample_rate_t from
 #endif /* ECA_COMPILE_SAMPLERATE */
 }
 
-void SAMPLE_BUFFER::resample_extfilter(SAMPLE_SPECS::sample_rate_t from_srate,
-					SAMPLE_SPECS::sample_rate_t to_srate) 
-{
-}
-
-void SAMPLE_BUFFER::resample_simplefilter(SAMPLE_SPECS::sample_rate_t from_srate,
-					  SAMPLE_SPECS::sample_rate_t to_srate) 
+/**
+ * Resamples samplebuffer contents using the built-in
+ * windowed-sinc polyphase resampler.
+ *
+ * Note! 'resample_init_memory()' must be called before 
+ *       before calling this function.
+ */
+void SAMPLE_BUFFER::resample_polyphase(SAMPLE_SPECS::sample_rate_t from_srate,
+				       SAMPLE_SPECS::sample_rate_t to_srate) 
 { 
+  double step = static_cast<double>(to_srate) / from_srate;
+
+  DEBUG_RESAMPLING_STATEMENT(std::cerr << "(samplebuffer) resample_polyphase from " << from_srate << " to " << to_srate << "." << std::endl); 
+
+  if (impl_repp->polyphase_rep.is_initialized() != true ||
+      impl_repp->polyphase_rep.channels() < channel_count_rep) {
+    /* note: not realtime-safe, resample_init_memory() not called */
+    DBC_CHECK(impl_repp->polyphase_rep.is_initialized() == true);
+    if (impl_repp->resample_ratio_rep <= 0.0) impl_repp->resample_ratio_rep = step;
+    resample_init_polyphase();
+  }
+
+  buf_size_t out = impl_repp->polyphase_rep.process(&buffer[0], 
+						    channel_count_rep,
+						    buffersize_rep, 
+						    reserved_samples_rep, 
+						    step);
+
+  /* note: we set buffersize_rep directly and bypass
+   * length_in_samples(), but in this case it is safe as 
+   * we have used 'reserved_samples_rep' as the upper limit */
+  buffersize_rep = out;
 }
@@ -29,6 +29,7 @@ class SAMPLE_BUFFER_impl;
  *  - changing channel count and length
  *  - reserving space before-hand
  *  - realtime-safety and pointer locking
+ *  - single precision copy for float-only plugin APIs
  *  - access to event tags
  */
 class SAMPLE_BUFFER {
@@ -61,6 +62,13 @@ class SAMPLE_BUFFER {
     tag_all = 0xffffffff
   };
 
+  enum Ramp_shape {
+    /* constant increment per sample */
+    ramp_linear = 0,
+    /* constant ratio per sample; requires positive endpoints */
+    ramp_exponential
+  };
+
   /*@}*/
 
  public:
@@ -96,6 +104,8 @@ class SAMPLE_BUFFER {
   void multiply_by(sample_t factor, int channel);
   void multiply_by_ref(sample_t factor);
   void multiply_by_ref(sample_t factor, int channel);
+  void multiply_by_ramp(sample_t from, sample_t to, Ramp_shape shape = ramp_linear);
+  void multiply_by_ramp(sample_t from, sample_t to, int channel, Ramp_shape shape = ramp_linear);
   void limit_values(void);
   void limit_values_ref(void);
   void make_empty(void);
@@ -119,6 +129,10 @@ class SAMPLE_BUFFER {
   void import_noninterleaved(unsigned char* source, buf_size_t samples, ECA_AUDIO_FORMAT::Sample_format fmt, channel_size_t ch);
   void export_interleaved(unsigned char* target, ECA_AUDIO_FORMAT::Sample_format fmt, channel_size_t ch);
   void export_noninterleaved(unsigned char* target, ECA_AUDIO_FORMAT::Sample_format fmt, channel_size_t ch);
+  void import_channel_float(channel_size_t channel, const float* source);
+  void export_channel_float(channel_size_t channel, float* target) const;
+  void import_channel_strided(channel_size_t channel, buf_size_t offset, const unsigned char* source, buf_size_t samples, long int stride, ECA_AUDIO_FORMAT::Sample_format fmt);
+  void export_channel_strided(channel_size_t channel, buf_size_t offset, unsigned char* target, buf_size_t samples, long int stride, ECA_AUDIO_FORMAT::Sample_format fmt) const;
   
   /*@}*/
         
@@ -141,6 +155,18 @@ class SAMPLE_BUFFER {
   void resample_init_memory(SAMPLE_SPECS::sample_rate_t from_rate, SAMPLE_SPECS::sample_rate_t to_rate);
   void reserve_channels(channel_size_t num);
   void reserve_length_in_samples(buf_size_t len);
+  inline buf_size_t reserved_length_in_samples(void) const { return(reserved_samples_rep); }
+
+  /*@}*/
+
+  /** @name Single precision plane for float-only plugin APIs */
+  /*@{*/
+
+  void float_plane_reserve(channel_size_t channels);
+  float* float_plane_channel(channel_size_t channel);
+  void float_plane_acquire(void);
+  void float_plane_sync(void);
+  bool float_plane_current(void) const;
 
   /*@}*/
 
@@ -166,9 +192,9 @@ class SAMPLE_BUFFER {
 
  private:
 
-  void resample_extfilter(SAMPLE_SPECS::sample_rate_t from_rate, SAMPLE_SPECS::sample_rate_t to_rate);
   void resample_secret_rabbit_code(SAMPLE_SPECS::sample_rate_t from_srate, SAMPLE_SPECS::sample_rate_t to_srate);
-  void resample_simplefilter(SAMPLE_SPECS::sample_rate_t from_rate, SAMPLE_SPECS::sample_rate_t to_rate);
+  void resample_polyphase(SAMPLE_SPECS::sample_rate_t from_rate, SAMPLE_SPECS::sample_rate_t to_rate);
+  void resample_init_polyphase(void);
   void resample_nofilter(SAMPLE_SPECS::sample_rate_t from_rate, SAMPLE_SPECS::sample_rate_t to_rate);
   void resample_with_memory(SAMPLE_SPECS::sample_rate_t from_rate, SAMPLE_SPECS::sample_rate_t to_rate);
 
@@ -3,6 +3,7 @@
 
 #include <vector>
 #include "samplebuffer.h" 
+#include "eca-resampler.h"
 
 #ifdef HAVE_CONFIG_H
 #include <config.h>
@@ -30,6 +31,10 @@ class SAMPLE_BUFFER_impl {
 
   SAMPLE_BUFFER::sample_t* old_buffer_repp; // for resampling
   std::vector<SAMPLE_BUFFER::sample_t> resample_memory_rep;
+  double resample_ratio_rep;
+  std::vector<float*> float_plane_rep; // for float-only plugin APIs
+  bool float_current_rep;
+  ECA_RESAMPLER polyphase_rep;
 #ifdef ECA_COMPILE_SAMPLERATE
   int src_state_channels_rep;
   std::vector<SRC_STATE*> src_state_rep;
@@ -18,11 +18,15 @@
 // ------------------------------------------------------------------------
 
 #include <string>
+#include <vector>
+#include <cmath>
 #include <cstdio>
+#include <cstring>
 
 #include "kvu_dbc.h"
 #include "kvu_inttypes.h"
 
+#include "eca-resampler.h"
 #include "samplebuffer.h"
 #include "samplebuffer_functions.h"
 #include "eca-test-case.h"
@@ -45,8 +49,44 @@ public:
 
 private:
 
+  double resample_peak(double freq, SAMPLE_SPECS::sample_rate_t from, SAMPLE_SPECS::sample_rate_t to, int quality, long int* out_samples);
 };
 
+/**
+ * Resamples a sine of 'freq' Hz and returns its peak 
+ * level after the filter has settled.
+ */
+double SAMPLE_BUFFER_TEST::resample_peak(double freq,
+					 SAMPLE_SPECS::sample_rate_t from,
+					 SAMPLE_SPECS::sample_rate_t to,
+					 int quality,
+					 long int* out_samples)
+{
+  const int bufsize = 1024;
+  const int blocks = 32;
+  SAMPLE_BUFFER sbuf (bufsize, 2);
+  sbuf.resample_set_quality(quality);
+  sbuf.resample_init_memory(from, to);
+
+  double peak = 0.0;
+  *out_samples = 0;
+  for(int b = 0; b < blocks; b++) {
+    sbuf.length_in_samples(bufsize);
+    for(int n = 0; n < bufsize; n++) {
+      double v = std::sin(2.0 * M_PI * freq * (b * bufsize + n) / from);
+      sbuf.buffer[0][n] = v;
+      sbuf.buffer[1][n] = -v;
+    }
+    sbuf.resample(from, to);
+    *out_samples += sbuf.length_in_samples();
+    for(int n = 0; b >= 4 && n < sbuf.length_in_samples(); n++) {
+      if (std::fabs(sbuf.buffer[0][n] + sbuf.buffer[1][n]) > 1e-9) return -1.0;
+      if (std::fabs(sbuf.buffer[0][n]) > peak) peak = std::fabs(sbuf.buffer[0][n]);
+    }
+  }
+  return peak;
+}
+
 void SAMPLE_BUFFER_TEST::do_run(void)
 {
   const int bufsize = 1024;
@@ -122,4 +162,271 @@ void SAMPLE_BUFFER_TEST::do_run(void)
       ECA_TEST_FAILURE("optimized add_matching_channels");
     }
   }
+
+  /* case: polyphase resampling */
+  {
+    std::fprintf(stdout, "%s: polyphase resample\n",
+		 __FILE__);
+
+    long int out = 0;
+    double peak = resample_peak(1000.0, 48000, 44100, 50, &out);
+    if (peak < 0.98 || peak > 1.02) {
+      ECA_TEST_FAILURE("polyphase resample, passband level");
+    }
+    long int expected = static_cast<long int>(32 * 1024 * 44100.0 / 48000);
+    if (out < expected - 1 || out > expected + 1) {
+      ECA_TEST_FAILURE("polyphase resample, output length");
+    }
+
+    /* 20kHz does not fit under the 11025Hz output Nyquist */
+    peak = resample_peak(20000.0, 48000, 22050, 75, &out);
+    if (peak < 0.0 || peak > 0.01) {
+      ECA_TEST_FAILURE("polyphase resample, stopband level");
+    }
+
+    peak = resample_peak(1000.0, 22050, 48000, 100, &out);
+    if (peak < 0.98 || peak > 1.02) {
+      ECA_TEST_FAILURE("polyphase resample, upsampling level");
+    }
+  }
+
+  /* case: resampler output limit, input that does not fit
+   *       is resampled by the following calls */
+  {
+    std::fprintf(stdout, "%s: resampler output limit\n",
+		 __FILE__);
+
+    const long int frames = 1024;
+    const double ratio = 44100.0 / 48000.0;
+    vector<SAMPLE_SPECS::sample_t> input (frames);
+    for(long int n = 0; n < frames; n++)
+      input[n] = std::sin(n * 0.1);
+
+    ECA_RESAMPLER ref;
+    ref.init(1, frames, ratio, 50);
+    vector<SAMPLE_SPECS::sample_t> ref_out (input);
+    SAMPLE_SPECS::sample_t* ref_buf = &ref_out[0];
+    long int ref_count = ref.process(&ref_buf, 1, frames, frames, ratio);
+
+    ECA_RESAMPLER limited;
+    limited.init(1, frames, ratio, 50);
+    vector<SAMPLE_SPECS::sample_t> out;
+    vector<SAMPLE_SPECS::sample_t> chunk (frames);
+    SAMPLE_SPECS::sample_t* chunk_buf = &chunk[0];
+    for(long int n = 0; n < frames; n += 256) {
+      std::memcpy(chunk_buf, &input[n], 256 * sizeof(SAMPLE_SPECS::sample_t));
+      long int count = limited.process(&chunk_buf, 1, 256, 100, ratio);
+      if (count > 100)
+	ECA_TEST_FAILURE("resampler output limit, limit exceeded");
+      out.insert(out.end(), chunk.begin(), chunk.begin() + count);
+    }
+    for(int n = 0; n < 16; n++) {
+      long int count = limited.process(&chunk_buf, 1, 0, 100, ratio);
+      out.insert(out.end(), chunk.begin(), chunk.begin() + count);
+    }
+
+    if (static_cast<long int>(out.size()) != ref_count) {
+      ECA_TEST_FAILURE("resampler output limit, frames lost");
+    }
+    else {
+      /* note: read positions are rebased between calls, so
+       *       filter phases can differ by rounding */
+      for(long int n = 0; n < ref_count; n++) {
+	if (std::fabs(out[n] - ref_out[n]) > 0.0001) {
+	  ECA_TEST_FAILURE("resampler output limit, output differs");
+	  break;
+	}
+      }
+    }
+  }
+
+  /* case: resampling fewer channels than initialized keeps
+   *       the other channels aligned */
+  {
+    std::fprintf(stdout, "%s: resampler channel subset\n",
+		 __FILE__);
+
+    const long int frames = 256;
+    const double ratio = 48000.0 / 44100.0;
+    const long int max_out = frames * 2;
+
+    ECA_RESAMPLER stereo, left, right;
+    stereo.init(2, frames, ratio, 50);
+    left.init(1, frames, ratio, 50);
+    right.init(1, frames, ratio, 50);
+
+    vector<SAMPLE_SPECS::sample_t> bufs[4];
+    for(int c = 0; c < 4; c++) bufs[c].resize(max_out);
+    SAMPLE_SPECS::sample_t* sbufs[2] = { &bufs[0][0], &bufs[1][0] };
+    SAMPLE_SPECS::sample_t* lbuf = &bufs[2][0];
+    SAMPLE_SPECS::sample_t* rbuf = &bufs[3][0];
+
+    for(int b = 0; b < 3; b++) {
+      for(long int n = 0; n < frames; n++) {
+	bufs[0][n] = bufs[2][n] = std::sin((b * frames + n) * 0.1);
+	/* note: the right channel is not given in the 2nd block */
+	bufs[1][n] = bufs[3][n] = (b == 1 ? 0.0 : std::cos((b * frames + n) * 0.07));
+      }
+      int channels = (b == 1 ? 1 : 2);
+      long int count = stereo.process(sbufs, channels, frames, max_out, ratio);
+      long int lcount = left.process(&lbuf, 1, frames, max_out, ratio);
+      long int rcount = right.process(&rbuf, 1, frames, max_out, ratio);
+      if (count != lcount || count != rcount) {
+	ECA_TEST_FAILURE("resampler channel subset, output length");
+	break;
+      }
+      bool aligned = true;
+      for(long int n = 0; n < count; n++) {
+	if (bufs[0][n] != bufs[2][n] ||
+	    (channels == 2 && bufs[1][n] != bufs[3][n]))
+	  aligned = false;
+      }
+      if (aligned != true) {
+	ECA_TEST_FAILURE("resampler channel subset, channels not aligned");
+	break;
+      }
+    }
+  }
+
+  /* case: resampler kernels are shared between buffers */
+  {
+    std::fprintf(stdout, "%s: shared resampler kernels\n",
+		 __FILE__);
+
+    size_t kernels = ECA_RESAMPLER_KERNEL_CACHE::kernel_count();
+    {
+      SAMPLE_BUFFER sbuf_a (bufsize, channels);
+      SAMPLE_BUFFER sbuf_b (bufsize, 2);
+      SAMPLE_BUFFER sbuf_c (bufsize, 1);
+      sbuf_a.resample_set_quality(50);
+      sbuf_b.resample_set_quality(50);
+      sbuf_c.resample_set_quality(50);
+      sbuf_a.resample_init_memory(48000, 44100);
+      sbuf_b.resample_init_memory(48000, 44100);
+      sbuf_c.resample_init_memory(96000, 88200);
+      if (ECA_RESAMPLER_KERNEL_CACHE::kernel_count() != kernels + 1) {
+	ECA_TEST_FAILURE("shared resampler kernels, not shared");
+      }
+    }
+    if (ECA_RESAMPLER_KERNEL_CACHE::kernel_count() != kernels) {
+      ECA_TEST_FAILURE("shared resampler kernels, not released");
+    }
+  }
+
+  /* case: per-channel float import/export */
+  {
+    std::fprintf(stdout, "%s: import/export_channel_float\n",
+		 __FILE__);
+
+    SAMPLE_BUFFER sbuf (bufsize, 2);
+    std::vector<float> in (bufsize), out (bufsize);
+    for(int n = 0; n < bufsize; n++) in[n] = (n % 7) * 0.25f - 0.75f;
+    in[3] = 1.5f;
+
+    sbuf.import_channel_float(0, &in[0]);
+    sbuf.import_channel_float(1, 0);
+    sbuf.export_channel_float(0, &out[0]);
+    for(int n = 0; n < bufsize; n++) {
+      float expected = (n == 3) ? 1.0f : in[n];
+      if (out[n] != expected || sbuf.buffer[1][n] != SAMPLE_SPECS::silent_value) {
+	ECA_TEST_FAILURE("import/export_channel_float");
+	break;
+      }
+    }
+  }
+
+  /* case: strided import/export matches the interleaved variants */
+  {
+    std::fprintf(stdout, "%s: import/export_channel_strided\n",
+		 __FILE__);
+
+    const int ch = 3;
+    SAMPLE_BUFFER sbuf (bufsize, ch);
+    for(int c = 0; c < ch; c++) 
+      for(int n = 0; n < bufsize; n++) 
+	sbuf.buffer[c][n] = ((n + c) % 9) * 0.2 - 0.8;
+
+    std::vector<unsigned char> ref (bufsize * ch * 2), out (bufsize * ch * 2);
+    sbuf.export_interleaved(&ref[0], ECA_AUDIO_FORMAT::sfmt_s16_le, ch);
+
+    /* two partial transfers, like a wrapping mmap area */
+    int split = bufsize / 3;
+    for(int c = 0; c < ch; c++) {
+      sbuf.export_channel_strided(c, 0, &out[c * 2], split, ch * 2, ECA_AUDIO_FORMAT::sfmt_s16_le);
+      sbuf.export_channel_strided(c, split, &out[(split * ch + c) * 2], bufsize - split, ch * 2, ECA_AUDIO_FORMAT::sfmt_s16_le);
+    }
+    if (ref != out) {
+      ECA_TEST_FAILURE("export_channel_strided");
+    }
+
+    SAMPLE_BUFFER sbuf_b (bufsize, ch);
+    for(int c = 0; c < ch; c++) 
+      sbuf_b.import_channel_strided(c, 0, &out[c * 2], bufsize, ch * 2, ECA_AUDIO_FORMAT::sfmt_s16_le);
+    SAMPLE_BUFFER sbuf_c (bufsize, ch);
+    sbuf_c.import_interleaved(&ref[0], bufsize, ECA_AUDIO_FORMAT::sfmt_s16_le, ch);
+    for(int c = 0; c < ch; c++) {
+      if (std::memcmp(sbuf_b.buffer[c], sbuf_c.buffer[c], bufsize * sizeof(SAMPLE_SPECS::sample_t)) != 0) {
+	ECA_TEST_FAILURE("import_channel_strided");
+	break;
+      }
+    }
+  }
+
+  /* case: single precision plane */
+  {
+    std::fprintf(stdout, "%s: float plane\n",
+		 __FILE__);
+
+    /* note: odd length exercises the non-vectorized tail */
+    const int len = 19;
+    SAMPLE_BUFFER sbuf (len, 1);
+    sbuf.float_plane_reserve(2);
+    for(int n = 0; n < len; n++) sbuf.buffer[0][n] = n * 0.125 - 1.0;
+
+    sbuf.float_plane_acquire();
+    float* plane = sbuf.float_plane_channel(0);
+    for(int n = 0; n < len; n++) {
+      if (plane[n] != static_cast<float>(n * 0.125 - 1.0)) {
+	ECA_TEST_FAILURE("float plane conversion");
+	break;
+      }
+    }
+    for(int n = 0; n < len; n++) plane[n] *= 2.0f;
+
+    /* note: a second user shares the converted data */
+    sbuf.float_plane_acquire();
+    if (sbuf.float_plane_channel(0)[1] != plane[1])
+      ECA_TEST_FAILURE("float plane converted twice");
+
+    sbuf.number_of_channels(2);
+    for(int n = 0; n < len; n++) sbuf.float_plane_channel(1)[n] += 0.5f;
+
+    sbuf.float_plane_sync();
+    if (sbuf.float_plane_current() == true)
+      ECA_TEST_FAILURE("float plane current after sync");
+    for(int n = 0; n < len; n++) {
+      if (sbuf.buffer[0][n] != static_cast<float>(n * 0.125 - 1.0) * 2.0f ||
+	  sbuf.buffer[1][n] != 0.5) {
+	ECA_TEST_FAILURE("float plane sync");
+	break;
+      }
+    }
+  }
+
+  /* case: reserving room that already exists does not
+   *       modify a buffer that is in use */
+  {
+    SAMPLE_BUFFER sbuf (16, 4);
+    sbuf.float_plane_reserve(4);
+    sbuf.number_of_channels(1);
+    sbuf.buffer[1][0] = 0.25;
+
+    sbuf.set_rt_lock(true);
+    sbuf.float_plane_reserve(3);
+    sbuf.reserve_channels(4);
+    if (sbuf.number_of_channels() != 1 ||
+	sbuf.buffer[1][0] != 0.25)
+      ECA_TEST_FAILURE("reserve modified buffer");
+    sbuf.set_rt_lock(false);
+  }
 }
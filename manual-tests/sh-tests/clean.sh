@@ -3,4 +3,4 @@
 # License: GPL (see ecasound/{AUTHORS,COPYING})
 # ----------------------------------------------------------------------
 
-rm -vf *dst*.wav src*.wav *.foobar
+rm -vf *dst*.wav src*.wav *dst*.raw src*.raw *.foobar
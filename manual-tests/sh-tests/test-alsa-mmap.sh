@@ -0,0 +1,67 @@
+#!/bin/bash
+# 
+# version:20261019-1
+#
+# Script to test ALSA mmap transfers ('-o:alsa,pcm,mmap').
+# Uses the userspace 'file' PCM plugin on top of 'null' 
+# (no sound hardware needed), and checks that mmap and 
+# read/write transfers produce identical data for both 
+# playback and capture.
+#
+# ----------------------------------------------------------------------
+# File: ecasound/manual-tests/test-alsa-mmap.sh
+# License: GPL (see ecasound/{AUTHORS,COPYING})
+# ----------------------------------------------------------------------
+
+. test-common-sh
+
+set_ecasound_envvar
+check_ecabin
+
+# private alsa-lib configuration, read via ~/.asoundrc
+HOME=`pwd`/alsa-mmap-home
+export HOME
+mkdir -p $HOME
+cat > $HOME/.asoundrc <<EOC
+pcm.ecatest_out_rw {
+  type file
+  slave.pcm "null"
+  file "`pwd`/dst-am-rw.raw"
+  format "raw"
+}
+pcm.ecatest_out_mmap {
+  type file
+  slave.pcm "null"
+  file "`pwd`/dst-am-mmap.raw"
+  format "raw"
+}
+pcm.ecatest_in {
+  type file
+  slave.pcm "null"
+  file "/dev/null"
+  infile "`pwd`/src-am.raw"
+  format "raw"
+}
+EOC
+
+$TESTECASOUND -q -f:s16_le,2,44100 -i tone,sine,440,2 -o src-am.raw -x || error_exit
+
+# playback, small periods
+for mode in rw mmap ; do
+  rm -f dst-am-$mode.raw
+  $TESTECASOUND -q -z:nodb -b:64 -f:s16_le,2,44100 \
+    -i src-am.raw -o alsa,ecatest_out_$mode,$mode || error_exit
+done
+cmp dst-am-rw.raw dst-am-mmap.raw || error_exit
+
+# capture
+for mode in rw mmap ; do
+  $TESTECASOUND -q -z:nodb -b:64 -f:s16_le,2,44100 \
+    -i alsa,ecatest_in,$mode -o dst-am-in-$mode.wav -t:1 || error_exit
+done
+check_zerosum dst-am-in-rw.wav dst-am-in-mmap.wav
+
+rm -rf $HOME
+
+echo "Test run succesful."
+exit 0
@@ -0,0 +1,52 @@
+#!/bin/bash
+# 
+# version:20261019-2
+#
+# Script to test parallel chain processing with JACK
+# worker threads ('-G:jack,name,mode,workers'). Starts
+# a private jackd instance with the dummy backend, renders 
+# the same multi-chain setup with and without workers, 
+# and checks that the results are identical.
+#
+# ----------------------------------------------------------------------
+# File: ecasound/manual-tests/test-jack-workers.sh
+# License: GPL (see ecasound/{AUTHORS,COPYING})
+# ----------------------------------------------------------------------
+
+. test-common-sh
+
+set_ecasound_envvar
+check_ecabin
+
+JACK_DEFAULT_SERVER=ecatest-workers
+export JACK_DEFAULT_SERVER
+
+jackd --no-realtime -n $JACK_DEFAULT_SERVER -d dummy -r 48000 -p 64 &
+jackpid=$!
+sleep 2
+
+$TESTECASOUND -q -f:f32,1,48000 -i tone,sine,440,4 -o src-jw.wav -x || error_exit
+
+# note: chain operators can only be added to one chain at a time
+chainops=""
+for n in 1 2 3 4 5 6 7 8 ; do
+  chainops="$chainops -a:$n -efl:2000 -efh:100"
+done
+
+function render() {
+  $TESTECASOUND -q -G:jack,ecatest,notransport,$1 \
+    -a:1,2,3,4,5,6,7,8 -i src-jw.wav $chainops \
+    -a:1,2,3,4,5,6,7,8 -o $2 -x \
+    -a:9 -i null -o jack \
+    -t:3 || error_exit
+}
+
+render 0 dst-jw-serial.wav
+render 3 dst-jw-workers.wav
+
+kill $jackpid
+
+check_zerosum dst-jw-serial.wav dst-jw-workers.wav
+
+echo "Test run succesful."
+exit 0